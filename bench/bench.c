@@ -0,0 +1,518 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file bench.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for clock_gettime, mkstemp and unlink) */
+
+/* C89 standard */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "abuf.h"
+#include "file.h"
+#include "offset.h"
+#include "stats.h"
+
+
+#define RHD_BENCH_USAGE "Usage: %s [-r | --rows <rows>] [-c | --cols <cols>] [-n | --length <length>] [--min-mbps <MB/s>] [--max-allocs <allocs>] [<file-path>...]\n"
+
+/* Default size of the (emulated) terminal */
+#define RHD_BENCH_ROWS 50
+#define RHD_BENCH_COLS 240
+
+/* Columns taken by the offsets column of the viewer (8 digits, then 2 spaces), left of the bytes */
+#define RHD_BENCH_GUTTER_COLS 10
+
+/* Max amount of rows (and columns) of the emulated terminal */
+#define RHD_BENCH_SIZE_MAX 10000
+
+/* Default amount of bytes of the file rendered by each benchmark */
+#define RHD_BENCH_LENGTH ((off_t)1 << 28)
+
+/* Length of the synthetic file (used if no file is given) */
+#define RHD_BENCH_SYNTHETIC_LEN ((size_t)1 << 26)
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Function pointer type of the file_append_* formatters
+ */
+typedef size_t (*bench_append_t)(rhd_file_t*, abuf_t*, const size_t);
+
+/**
+ * Struct containing the measurements of a benchmark
+ */
+typedef struct bench_result_tag {
+    double        start;     /* Time when the benchmark started (in seconds) */
+    double        secs;
+    double        bytes;     /* Bytes of the file rendered */
+    double        rows;
+    double        frames;    /* Frames rendered (or their equivalent, meaning all the rows of a page) */
+    unsigned long allocs;
+    unsigned long syscalls;
+} bench_result_t;
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Returns the time elapsed from an arbitrary point (in seconds, from a monotonic clock)
+ */
+static double bench_now(void);
+
+/**
+ * Creates a synthetic file in the temporary directory (random bytes, text and zeros, in blocks
+ * of 4 KiB), writing its path into "path" (that must have room for 4096 chars).
+ * If successful returns 0, else 1.
+ */
+static int bench_synthetic(char* path);
+
+/**
+ * Returns the amount of bytes in a row of the emulated terminal, like the viewer lays it out
+ * (with the offsets column shown, and "byte_cols" columns for each byte)
+ */
+static size_t bench_row_len(const unsigned int byte_cols);
+
+/**
+ * Starts measuring "result" (saving the time and the counters)
+ */
+static void bench_begin(bench_result_t* result);
+
+/**
+ * Ends measuring "result" (computing the time and the counters elapsed since bench_begin())
+ */
+static void bench_end(bench_result_t* result);
+
+/**
+ * Prints a row of the table of the results, for the benchmark "name", counting it as a regression
+ * if it is past the thresholds (see bench.min_mbps and bench.max_allocs)
+ */
+static void bench_print(const char* name, const bench_result_t* result);
+
+/**
+ * Renders rows of "row_len" bytes of the file with "append" (starting over at the end of the file).
+ * If successful returns 0, else 1.
+ */
+static int bench_rows(rhd_file_t* f, bench_append_t append, const size_t row_len, bench_result_t* result);
+
+/**
+ * Appends rows as long as the terminal is wide into a frame buffer (emptied at each frame).
+ * If successful returns 0, else 1.
+ */
+static int bench_abuf(bench_result_t* result);
+
+/**
+ * Renders frames of the file like a screen refresh does in the hexadecimal view (with the
+ * cursor movement and the erase sequence of every row), moving down one page at each frame.
+ * If successful returns 0, else 1.
+ */
+static int bench_frames(rhd_file_t* f, bench_result_t* result);
+
+/**
+ * Runs all benchmarks on the file "filename" (read with the backend described by "backend").
+ * If successful returns 0, else 1.
+ */
+static int bench_file(const char* filename, const char* backend);
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Struct containing the options of the benchmarks
+ */
+static struct bench_tag {
+    unsigned int rows;    /* Size of the emulated terminal */
+    unsigned int cols;
+    double       length;  /* Bytes of the file rendered by each benchmark */
+    double       min_mbps;    /* Thresholds of the results (not checked if negative) */
+    double       max_allocs;  /* (allocations per frame) */
+    size_t       n_regressions;
+} bench;
+
+
+/* --------------------------------- MAIN ---------------------------------- */
+
+int main(int argc, char* argv[]) {
+    const char** filenames;
+    char         synthetic[4096];
+    char*        end;
+    double       threshold;
+    size_t       n_files;
+    off_t        value;
+    int          ret;
+    int          i;
+    int          j;
+
+    /* Handle arguments */
+    bench.rows   = RHD_BENCH_ROWS;
+    bench.cols   = RHD_BENCH_COLS;
+    bench.length = (double)RHD_BENCH_LENGTH;
+    bench.min_mbps      = -1;
+    bench.max_allocs    = -1;
+    bench.n_regressions = 0;
+    if ((filenames = malloc((size_t)argc * sizeof(*filenames))) == NULL)
+        exit(EXIT_FAILURE);
+    n_files = 0;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            fprintf(stdout, RHD_BENCH_USAGE, argv[0]);
+            fprintf(stdout, "\nMeasures the formatters, the frame buffer and a full frame, without a terminal.\n");
+            fprintf(stdout, "If no file is given, a synthetic file of 64 MiB is used.\n");
+            fprintf(stdout, "\nOptions:\n");
+            fprintf(stdout, "    -r | --rows <rows> = rows of the emulated terminal (50 by default)\n");
+            fprintf(stdout, "    -c | --cols <cols> = columns of the emulated terminal (240 by default)\n");
+            fprintf(stdout, "    -n | --length <length> = bytes of the file rendered by each benchmark (256 MiB by default)\n");
+            fprintf(stdout, "    --min-mbps <MB/s> = fail if a benchmark renders less than <MB/s> megabytes per second\n");
+            fprintf(stdout, "    --max-allocs <allocs> = fail if a benchmark makes more than <allocs> allocations per frame\n");
+            exit(EXIT_SUCCESS);
+        } else if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--rows") == 0) {
+            if (++i >= argc || offset_parse(argv[i], &value) != 0 || value < 2 || value > RHD_BENCH_SIZE_MAX) {
+                fprintf(stderr, "ERROR: Invalid or missing amount of rows!\n");
+                exit(EXIT_FAILURE);
+            }
+            bench.rows = (unsigned int)value;
+        } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cols") == 0) {
+            if (++i >= argc || offset_parse(argv[i], &value) != 0 || value < 1 || value > RHD_BENCH_SIZE_MAX) {
+                fprintf(stderr, "ERROR: Invalid or missing amount of columns!\n");
+                exit(EXIT_FAILURE);
+            }
+            bench.cols = (unsigned int)value;
+        } else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--length") == 0) {
+            if (++i >= argc || offset_parse(argv[i], &value) != 0 || value <= 0) {
+                fprintf(stderr, "ERROR: Invalid or missing length!\n");
+                exit(EXIT_FAILURE);
+            }
+            bench.length = (double)value;
+        } else if (strcmp(argv[i], "--min-mbps") == 0 || strcmp(argv[i], "--max-allocs") == 0) {
+            if (i + 1 >= argc || (threshold = strtod(argv[i + 1], &end)) < 0 || end == argv[i + 1] || *end != '\0') {
+                fprintf(stderr, "ERROR: Invalid or missing threshold!\n");
+                exit(EXIT_FAILURE);
+            }
+            if (strcmp(argv[i], "--min-mbps") == 0)
+                bench.min_mbps = threshold;
+            else
+                bench.max_allocs = threshold;
+            i++;
+        } else {
+            filenames[n_files++] = argv[i];
+        }
+    }
+
+    /* Without files, use a synthetic one (removed at the end) */
+    synthetic[0] = '\0';
+    if (n_files == 0) {
+        if (bench_synthetic(synthetic) != 0) {
+            fprintf(stderr, "ERROR: Could not create the synthetic file!\n");
+            fprintf(stderr, "    -> %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        filenames[n_files++] = synthetic;
+    }
+
+    /* Each file is read memory-mapped first, and then through the page cache */
+    fprintf(stdout, "Terminal of %u rows and %u columns, %.0f bytes rendered by each benchmark\n",
+            bench.rows, bench.cols, bench.length);
+    ret = 0;
+    for (j = 0; j < 2 && ret == 0; j++) {
+        if (j == 1)
+            file_disable_mmap();
+        for (i = 0; (size_t)i < n_files && ret == 0; i++)
+            ret = bench_file(filenames[i], j == 0 ? "mmap" : "page cache");
+    }
+
+    if (synthetic[0] != '\0')
+        unlink(synthetic);
+    free(filenames);
+
+    /* The results past the thresholds make the run fail (after all of them are printed) */
+    if (ret == 0 && bench.n_regressions > 0) {
+        fprintf(stderr, "ERROR: %lu results are past the thresholds!\n", (unsigned long)bench.n_regressions);
+        ret = 1;
+    }
+
+    exit(ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static double bench_now(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+
+static int bench_synthetic(char* path) {
+    unsigned char block[4096];
+    unsigned long state;
+    size_t        len;
+    size_t        i;
+    FILE*         f;
+    int           fd;
+
+    sprintf(path, "%.4000s/rhd-bench-XXXXXX", getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp");
+    if ((fd = mkstemp(path)) == -1)
+        return 1;
+    if ((f = fdopen(fd, "wb")) == NULL) {
+        close(fd);
+        unlink(path);
+        return 1;
+    }
+
+    /* Random bytes (from a xorshift generator), text and zeros, as found in real files */
+    state = 2463534242UL;
+    for (len = 0; len < RHD_BENCH_SYNTHETIC_LEN; len += sizeof(block)) {
+        for (i = 0; i < sizeof(block); i++) {
+            switch ((len / sizeof(block)) % 3) {
+                case 0:
+                    state ^= (state << 13) & 0xFFFFFFFFUL;
+                    state ^= state >> 17;
+                    state ^= (state << 5) & 0xFFFFFFFFUL;
+                    block[i] = (unsigned char)state;
+                    break;
+                case 1:
+                    block[i] = (unsigned char)"rawhexdump benchmark\n"[i % 21];
+                    break;
+                default:
+                    block[i] = 0;
+                    break;
+            }
+        }
+        if (fwrite(block, 1, sizeof(block), f) != sizeof(block)) {
+            fclose(f);
+            unlink(path);
+            return 1;
+        }
+    }
+
+    if (fclose(f) != 0) {
+        unlink(path);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+static size_t bench_row_len(const unsigned int byte_cols) {
+    unsigned int cols;
+
+    /* (the offsets column is shown only if a byte in hexadecimal fits next to it) */
+    cols = bench.cols >= RHD_BENCH_GUTTER_COLS + 3 ? bench.cols - RHD_BENCH_GUTTER_COLS : bench.cols;
+    return cols / byte_cols > 0 ? cols / byte_cols : 1;
+}
+
+
+static void bench_begin(bench_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    result->allocs   = stats_get(RHD_STATS_ALLOCS);
+    result->syscalls = stats_get(RHD_STATS_READS) + stats_get(RHD_STATS_SEEKS);
+    result->start    = bench_now();
+}
+
+
+static void bench_end(bench_result_t* result) {
+    result->secs     = bench_now() - result->start;
+    result->allocs   = stats_get(RHD_STATS_ALLOCS) - result->allocs;
+    result->syscalls = stats_get(RHD_STATS_READS) + stats_get(RHD_STATS_SEEKS) - result->syscalls;
+    if (result->frames == 0)
+        result->frames = result->rows / (double)(bench.rows - 1);
+}
+
+
+static void bench_print(const char* name, const bench_result_t* result) {
+    double mbps;
+    double allocs;
+    int    is_regression;
+
+    mbps   = result->secs > 0 ? result->bytes / result->secs / 1e6 : 0.0;
+    allocs = result->frames > 0 ? result->allocs / result->frames : 0.0;
+    is_regression = (bench.min_mbps >= 0 && mbps < bench.min_mbps) || (bench.max_allocs >= 0 && allocs > bench.max_allocs);
+    if (is_regression)
+        bench.n_regressions++;
+
+    fprintf(stdout, "  %-28s %10.1f %10.1f %14.3f %16.3f%s\n", name, mbps,
+            result->rows > 0 ? result->secs * 1e9 / result->rows : 0.0,
+            allocs,
+            result->frames > 0 ? result->syscalls / result->frames : 0.0,
+            is_regression ? "  <- past the thresholds" : "");
+}
+
+
+static int bench_rows(rhd_file_t* f, bench_append_t append, const size_t row_len, bench_result_t* result) {
+    abuf_t row = ABUF_INIT;
+    size_t n;
+
+    if (file_seek_set(f, 0) != 0)
+        return 1;
+
+    bench_begin(result);
+    while (result->bytes < bench.length) {
+        ab_reset(&row);
+        if ((n = append(f, &row, row_len)) == 0) {
+            /* At the end of the file, start over (unless it is empty) */
+            if (file_has_error(f) || result->bytes == 0 || file_seek_set(f, 0) != 0)
+                break;
+            continue;
+        }
+        result->bytes += (double)n;
+        result->rows++;
+    }
+    bench_end(result);
+
+    ab_free(&row);
+    return file_has_error(f) ? 1 : 0;
+}
+
+
+static int bench_abuf(bench_result_t* result) {
+    abuf_t       frame = ABUF_INIT;
+    char*        row;
+    unsigned int y;
+
+    if ((row = malloc(bench.cols)) == NULL)
+        return 1;
+    memset(row, 'x', bench.cols);
+
+    bench_begin(result);
+    while (result->bytes < bench.length) {
+        ab_reset(&frame);
+        for (y = 0; y < bench.rows - 1; y++) {
+            if (ab_append(&frame, row, bench.cols) != 0) {
+                free(row);
+                ab_free(&frame);
+                return 1;
+            }
+        }
+        result->bytes  += (double)(bench.rows - 1) * bench.cols;
+        result->rows   += bench.rows - 1;
+        result->frames += 1;
+    }
+    bench_end(result);
+
+    free(row);
+    ab_free(&frame);
+    return 0;
+}
+
+
+static int bench_frames(rhd_file_t* f, bench_result_t* result) {
+    abuf_t       frame = ABUF_INIT;
+    abuf_t       row   = ABUF_INIT;
+    char         seq[32];
+    size_t       row_len;
+    size_t       n;
+    unsigned int y;
+    int          ret;
+
+    if (file_seek_set(f, 0) != 0)
+        return 1;
+
+    /* Same row length as the hexadecimal view */
+    row_len = bench_row_len(3);
+    ret     = 0;
+    bench_begin(result);
+    while (ret == 0 && result->bytes < bench.length) {
+        ab_reset(&frame);
+        n = row_len;
+        for (y = 0; ret == 0 && y < bench.rows - 1; y++) {
+            ab_reset(&row);
+            n = file_append_formatted_hexs(f, &row, row_len);
+            sprintf(seq, "\x1b[%u;1H", y + 1);
+            ret = ab_append(&frame, seq, strlen(seq)) || ab_append(&frame, row.b, row.len) ||
+                  ab_append(&frame, "\x1b[0K", 4);
+            result->bytes += (double)n;
+            result->rows++;
+        }
+        result->frames++;
+
+        /* After the last page, start over from the first one */
+        if (n < row_len && (file_has_error(f) || result->bytes == 0 || file_seek_set(f, 0) != 0))
+            break;
+    }
+    bench_end(result);
+
+    ab_free(&frame);
+    ab_free(&row);
+    return ret != 0 || file_has_error(f) ? 1 : 0;
+}
+
+
+static int bench_file(const char* filename, const char* backend) {
+    bench_result_t result;
+    rhd_file_t*    f;
+    size_t         hex_len;
+    int            ret;
+
+    if (file_open(&f, filename, "rb") != 0) {
+        fprintf(stderr, "ERROR: Could not open file!\n");
+        fprintf(stderr, "    -> %s: %s\n", filename, strerror(errno));
+        return 1;
+    }
+    if (file_length(f) < 0) {
+        fprintf(stderr, "ERROR: Streams can't be benchmarked!\n");
+        fprintf(stderr, "    -> %s\n", filename);
+        file_close(f);
+        return 1;
+    }
+
+    fprintf(stdout, "\n%s (%s, %ld bytes)\n", filename, backend, (long)file_length(f));
+    fprintf(stdout, "  %-28s %10s %10s %14s %16s\n", "benchmark", "MB/s", "ns/row", "allocs/frame", "syscalls/frame");
+
+    /* Formatters, with the row lengths of the outputs */
+    hex_len = bench_row_len(3);
+    ret     = 0;
+    if (ret == 0 && (ret = bench_rows(f, file_append_bytes, hex_len, &result)) == 0)
+        bench_print("file_append_bytes", &result);
+    if (ret == 0 && (ret = bench_rows(f, file_append_formatted_hexs, hex_len, &result)) == 0)
+        bench_print("file_append_formatted_hexs", &result);
+    if (ret == 0 && (ret = bench_rows(f, file_append_formatted_chars, hex_len, &result)) == 0)
+        bench_print("file_append_formatted_chars", &result);
+    if (ret == 0 && (ret = bench_rows(f, file_append_chars, bench_row_len(1), &result)) == 0)
+        bench_print("file_append_chars", &result);
+
+    /* Frame buffer, and full frames */
+    if (ret == 0 && (ret = bench_abuf(&result)) == 0)
+        bench_print("ab_append", &result);
+    if (ret == 0 && (ret = bench_frames(f, &result)) == 0)
+        bench_print("frame (hexadecimal view)", &result);
+
+    if (ret != 0)
+        fprintf(stderr, "ERROR: Could not read file!\n");
+    if (file_close(f) != 0)
+        ret = 1;
+
+    return ret;
+}
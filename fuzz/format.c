@@ -0,0 +1,262 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file format.c */
+
+
+/* C89 standard */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "abuf.h"
+#include "dump.h"
+#include "format.h"
+#include "fuzz.h"
+
+
+/* Length of the header of the inputs: the options, the split of the rows, and the position */
+#define RHD_FUZZ_FORMAT_HEADER 6
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Allocates exactly "len" chars (at least 1, zeroed), so that the sanitizers catch the kernels writing
+ * past the room they are given. Aborts if the allocation fails.
+ */
+static char* fuzz_alloc(const size_t len);
+
+/**
+ * Writes the "n" bytes of "src" like format_hexs() does, one byte at a time
+ */
+static void fuzz_ref_hexs(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case);
+
+/**
+ * Writes the "n" bytes of "src" like format_formatted_chars() does, one byte at a time
+ */
+static void fuzz_ref_formatted_chars(char* dst, const unsigned char* src, const size_t n);
+
+/**
+ * Writes the "n" bytes of "src" like format_chars() does, one byte at a time
+ */
+static void fuzz_ref_chars(char* dst, const unsigned char* src, const size_t n);
+
+/**
+ * Writes the "n" bytes of "data" found at "pos" like dump_format_rows() does (like the rows of
+ * "hexdump -C"), with sprintf(). Returns the amount of chars written.
+ */
+static size_t fuzz_ref_rows(char* dst, const off_t pos, const unsigned char* data, const size_t n);
+
+/**
+ * Checks that "append" appends to a buffer holding a prefix the "n" * 3 - 1 chars of "expected"
+ * (meaning all of them, without the space after the last byte)
+ */
+static void fuzz_check_append(int (*append)(abuf_t*, const unsigned char*, const size_t), const unsigned char* src,
+                              const size_t n, const char* expected);
+
+/**
+ * format_append_hexs() in upper case, and in lower case (with the signature of the other appends)
+ */
+static int fuzz_append_hexs_upper(abuf_t* ab, const unsigned char* src, const size_t n);
+static int fuzz_append_hexs_lower(abuf_t* ab, const unsigned char* src, const size_t n);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int LLVMFuzzerTestOneInput(const unsigned char* data, size_t size) {
+    dump_squeeze_t       squeeze;
+    const unsigned char* src;
+    format_case_t        letter_case;
+    unsigned long        value;
+    char*                dst;
+    char*                expected;
+    size_t               split;
+    size_t               len;
+    size_t               n;
+    off_t                pos;
+
+    /* The header chooses the case, where the rows are split, and their position */
+    if (size < RHD_FUZZ_FORMAT_HEADER)
+        return 0;
+    letter_case = (data[0] & 1) ? RHD_FORMAT_CASE_LOWER : RHD_FORMAT_CASE_UPPER;
+    split = (size_t)data[1] * RHD_DUMP_ROW_LEN;
+    value = ((unsigned long)data[2] << 24) | ((unsigned long)data[3] << 16) | ((unsigned long)data[4] << 8) | data[5];
+    pos   = (off_t)value << ((data[0] >> 1) % 29);
+    src   = data + RHD_FUZZ_FORMAT_HEADER;
+    n     = size - RHD_FUZZ_FORMAT_HEADER;
+
+    /* Each kernel must write what the plain loop writes (and no more than the room it is given) */
+    dst      = fuzz_alloc(n * 3);
+    expected = fuzz_alloc(n * 3);
+    format_hexs(dst, src, n, letter_case);
+    fuzz_ref_hexs(expected, src, n, letter_case);
+    if (memcmp(dst, expected, n * 3) != 0)
+        abort();
+    fuzz_check_append(letter_case == RHD_FORMAT_CASE_LOWER ? fuzz_append_hexs_lower : fuzz_append_hexs_upper, src, n, expected);
+
+    format_formatted_chars(dst, src, n);
+    fuzz_ref_formatted_chars(expected, src, n);
+    if (memcmp(dst, expected, n * 3) != 0)
+        abort();
+    fuzz_check_append(format_append_formatted_chars, src, n, expected);
+    free(dst);
+    free(expected);
+
+    dst      = fuzz_alloc(n);
+    expected = fuzz_alloc(n);
+    format_chars(dst, src, n);
+    fuzz_ref_chars(expected, src, n);
+    if (memcmp(dst, expected, n) != 0)
+        abort();
+    free(dst);
+    free(expected);
+
+    /* The rows formatted at once, and split in two consecutive calls, must be the same */
+    dst      = fuzz_alloc(RHD_DUMP_ROWS_MAX(n));
+    expected = fuzz_alloc(RHD_DUMP_ROWS_MAX(n));
+    memset(&squeeze, 0, sizeof(squeeze));
+    len = dump_format_rows(dst, pos, src, n, &squeeze);
+    if (len > RHD_DUMP_ROWS_MAX(n) || len != fuzz_ref_rows(expected, pos, src, n) || memcmp(dst, expected, len) != 0)
+        abort();
+    if (split > n)
+        split = n;
+    memset(&squeeze, 0, sizeof(squeeze));
+    len  = dump_format_rows(dst, pos, src, split, &squeeze);
+    len += dump_format_rows(dst + len, pos + (off_t)split, src + split, n - split, &squeeze);
+    if (len != fuzz_ref_rows(expected, pos, src, n) || memcmp(dst, expected, len) != 0)
+        abort();
+    free(dst);
+    free(expected);
+
+    return 0;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static char* fuzz_alloc(const size_t len) {
+    char* p;
+
+    if ((p = calloc(len > 0 ? len : 1, 1)) == NULL)
+        abort();
+    return p;
+}
+
+
+static void fuzz_ref_hexs(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    const char* digits;
+    size_t      i;
+
+    digits = letter_case == RHD_FORMAT_CASE_LOWER ? "0123456789abcdef" : "0123456789ABCDEF";
+    for (i = 0; i < n; i++) {
+        dst[i * 3]     = digits[src[i] >> 4];
+        dst[i * 3 + 1] = digits[src[i] & 0x0F];
+        dst[i * 3 + 2] = ' ';
+    }
+}
+
+
+static void fuzz_ref_formatted_chars(char* dst, const unsigned char* src, const size_t n) {
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        dst[i * 3]     = ' ';
+        dst[i * 3 + 1] = src[i] >= 0x20 && src[i] <= 0x7E ? (char)src[i] : '.';
+        dst[i * 3 + 2] = ' ';
+    }
+}
+
+
+static void fuzz_ref_chars(char* dst, const unsigned char* src, const size_t n) {
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        dst[i] = src[i] >= 0x20 && src[i] <= 0x7E ? (char)src[i] : '.';
+}
+
+
+static size_t fuzz_ref_rows(char* dst, const off_t pos, const unsigned char* data, const size_t n) {
+    const unsigned char* prev;
+    size_t               row_len;
+    size_t               len;
+    size_t               i;
+    size_t               j;
+    int                  is_squeezing;
+
+    prev         = NULL;
+    is_squeezing = 0;
+    for (len = 0, i = 0; i < n; i += row_len) {
+        row_len = n - i < RHD_DUMP_ROW_LEN ? n - i : RHD_DUMP_ROW_LEN;
+
+        /* A full row equal to the previous one is squeezed (a single "*" for a whole run) */
+        if (row_len == RHD_DUMP_ROW_LEN && prev != NULL && memcmp(prev, &data[i], RHD_DUMP_ROW_LEN) == 0) {
+            if (!is_squeezing)
+                len += (size_t)sprintf(&dst[len], "*\n");
+            is_squeezing = 1;
+        } else {
+            len += (size_t)sprintf(&dst[len], "%08lx ", (unsigned long)(pos + (off_t)i));
+            for (j = 0; j < RHD_DUMP_ROW_LEN; j++) {
+                if (j == RHD_DUMP_ROW_LEN / 2)
+                    dst[len++] = ' ';
+                if (j < row_len)
+                    len += (size_t)sprintf(&dst[len], " %02x", data[i + j]);
+                else
+                    len += (size_t)sprintf(&dst[len], "   ");
+            }
+            len += (size_t)sprintf(&dst[len], "  |");
+            fuzz_ref_chars(&dst[len], &data[i], row_len);
+            len += row_len;
+            len += (size_t)sprintf(&dst[len], "|\n");
+            is_squeezing = 0;
+        }
+        prev = &data[i];
+    }
+
+    return len;
+}
+
+
+static void fuzz_check_append(int (*append)(abuf_t*, const unsigned char*, const size_t), const unsigned char* src,
+                              const size_t n, const char* expected) {
+    abuf_t ab = ABUF_INIT;
+
+    if (ab_append(&ab, "ab:", 3) != 0 || append(&ab, src, n) != 0)
+        abort();
+    if (memcmp(ab.b, "ab:", 3) != 0 || ab.len != (n > 0 ? 3 + n * 3 - 1 : 3) || (n > 0 && memcmp(ab.b + 3, expected, n * 3 - 1) != 0))
+        abort();
+    ab_free(&ab);
+}
+
+
+static int fuzz_append_hexs_upper(abuf_t* ab, const unsigned char* src, const size_t n) {
+    return format_append_hexs(ab, src, n, RHD_FORMAT_CASE_UPPER);
+}
+
+
+static int fuzz_append_hexs_lower(abuf_t* ab, const unsigned char* src, const size_t n) {
+    return format_append_hexs(ab, src, n, RHD_FORMAT_CASE_LOWER);
+}
@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file nav.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for mkstemp) */
+
+/* C89 standard */
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <unistd.h>
+
+#include "fuzz.h"
+#include "raw_terminal.h"
+
+
+/* Length of the header of the inputs: the options, and the size of the window */
+#define RHD_FUZZ_NAV_HEADER 3
+
+/* Max amount of keys of an input (so that they fit in a pipe, written before the session starts) */
+#define RHD_FUZZ_NAV_KEYS_MAX 4096
+
+/* Length of the file navigated (a pattern of text, zeros, and random bytes) */
+#define RHD_FUZZ_NAV_FILE_LEN 8192
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Creates the file navigated in the temporary directory, writing its path into "path" (that must
+ * have room for 4096 chars). Aborts if it fails.
+ */
+static void fuzz_nav_file(char* path);
+
+/**
+ * Runs the session on the file "path", reading the keys from "keys_fd", and then resets the viewer
+ * for the next one
+ */
+static void fuzz_nav_session(const char* path, const int keys_fd, const unsigned char* header);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int LLVMFuzzerTestOneInput(const unsigned char* data, size_t size) {
+    char   path[4096];
+    size_t n_keys;
+    int    keys_fds[2];
+
+    /* The header chooses the options and the size of the window, the rest are the keys pressed */
+    if (size < RHD_FUZZ_NAV_HEADER)
+        return 0;
+    n_keys = size - RHD_FUZZ_NAV_HEADER < RHD_FUZZ_NAV_KEYS_MAX ? size - RHD_FUZZ_NAV_HEADER : RHD_FUZZ_NAV_KEYS_MAX;
+
+    /* Each session runs in this process (so that the fuzzer sees its coverage), on a file of its
+       own (the edit mode may change it), with all the keys waiting in the pipe. The keys end with
+       CTRL+Q (twice, to leave the changes not saved), else with the end of the pipe. */
+    fuzz_nav_file(path);
+    signal(SIGPIPE, SIG_IGN);
+    if (pipe(keys_fds) == -1)
+        abort();
+    if (write(keys_fds[1], data + RHD_FUZZ_NAV_HEADER, n_keys) != (ssize_t)n_keys ||
+        write(keys_fds[1], "\x11\x11", 2) != 2)
+        abort();
+    close(keys_fds[1]);
+
+    /* Errors of the session are fine, but not crashes (nor the reports of the sanitizers) */
+    fuzz_nav_session(path, keys_fds[0], data);
+    close(keys_fds[0]);
+    unlink(path);
+
+    return 0;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static void fuzz_nav_file(char* path) {
+    unsigned char block[RHD_FUZZ_NAV_FILE_LEN];
+    unsigned long state;
+    size_t        i;
+    int           fd;
+
+    state = 2463534242UL;
+    for (i = 0; i < sizeof(block); i++) {
+        switch ((i / 1024) % 3) {
+            case 0:
+                block[i] = (unsigned char)"rawhexdump fuzz\n"[i % 16];
+                break;
+            case 1:
+                block[i] = 0;
+                break;
+            default:
+                state ^= (state << 13) & 0xFFFFFFFFUL;
+                state ^= state >> 17;
+                state ^= (state << 5) & 0xFFFFFFFFUL;
+                block[i] = (unsigned char)state;
+                break;
+        }
+    }
+
+    sprintf(path, "%.4000s/rhd-fuzz-XXXXXX", getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp");
+    if ((fd = mkstemp(path)) == -1)
+        abort();
+    if (write(fd, block, sizeof(block)) != (ssize_t)sizeof(block) || close(fd) != 0) {
+        unlink(path);
+        abort();
+    }
+}
+
+
+static void fuzz_nav_session(const char* path, const int keys_fd, const unsigned char* header) {
+    const char* filenames[1];
+    int         frames_fd;
+
+    /* The frames are thrown away (the renderer still formats all of them) */
+    if ((frames_fd = open("/dev/null", O_WRONLY)) == -1)
+        abort();
+    if (header[0] & 1)
+        term_edit();
+
+    /* (the session can also end with an error, like when the keys run out in a prompt) */
+    filenames[0] = path;
+    term_headless(keys_fd, frames_fd, 1 + (unsigned int)header[1] % 80, 1 + (unsigned int)header[2]);
+    if (term_init(filenames, 1) == 0) {
+        term_loop();
+        term_disable_raw_mode();
+    }
+    term_reset();
+
+    close(frames_fd);
+}
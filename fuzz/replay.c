@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file replay.c */
+
+
+/* C89 standard */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+
+#define RHD_REPLAY_USAGE "Usage: %s <input-path>...\n"
+
+/* Max length of an input */
+#define RHD_REPLAY_INPUT_MAX ((size_t)1 << 20)
+
+
+/* --------------------------------- MAIN ---------------------------------- */
+
+int main(int argc, char* argv[]) {
+    unsigned char* input;
+    size_t         len;
+    FILE*          f;
+    int            i;
+
+    /* Handle arguments */
+    if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        fprintf(stdout, RHD_REPLAY_USAGE, argv[0]);
+        fprintf(stdout, "\nRuns a fuzz target on each input given (like the corpus, or a crash), without libFuzzer.\n");
+        exit(argc < 2 ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+    if ((input = malloc(RHD_REPLAY_INPUT_MAX)) == NULL)
+        exit(EXIT_FAILURE);
+
+    /* The target aborts if it misbehaves on an input */
+    for (i = 1; i < argc; i++) {
+        if ((f = fopen(argv[i], "rb")) == NULL) {
+            fprintf(stderr, "ERROR: Could not open input \"%s\"!\n", argv[i]);
+            fprintf(stderr, "    -> %s\n", strerror(errno));
+            free(input);
+            exit(EXIT_FAILURE);
+        }
+        len = fread(input, 1, RHD_REPLAY_INPUT_MAX, f);
+        if (ferror(f)) {
+            fprintf(stderr, "ERROR: Could not read input \"%s\"!\n", argv[i]);
+            fclose(f);
+            free(input);
+            exit(EXIT_FAILURE);
+        }
+        fclose(f);
+        LLVMFuzzerTestOneInput(input, len);
+    }
+
+    fprintf(stdout, "ok    %s (%d inputs)\n", argv[0], argc - 1);
+    free(input);
+    exit(EXIT_SUCCESS);
+}
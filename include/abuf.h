@@ -32,22 +32,40 @@
 #include <stddef.h>
 
 
-#define ABUF_INIT  {NULL, 0}
+#define ABUF_INIT  {NULL, 0, 0}
 
 
-/* struct for string that supports append method */
+/* struct for string that supports append method ("cap" is the allocated size of "b") */
 typedef struct abuf_tag {
     char*  b;
     size_t len;
+    size_t cap;
 } abuf_t;
 
 
 /*
- * Appends "len" bytes from string "s" to "ab".
+ * Appends "len" bytes from string "s" to "ab" (growing it geometrically when needed).
  * If successful returns 0, else 1.
  */
 int ab_append(abuf_t* ab, const char* s, const size_t len);
 
+/*
+ * Makes room for "len" more bytes at the end of "ab" (growing it geometrically when needed),
+ * without changing "ab->len", so that they can be written in place.
+ * If successful returns a pointer to the room (meaning "&ab->b[ab->len]"), else NULL.
+ * After writing "n" bytes (at most "len"), the caller must add "n" to "ab->len".
+ */
+char* ab_extend(abuf_t* ab, const size_t len);
+
+/*
+ * Makes sure that "ab" can hold at least "cap" bytes without reallocating.
+ * If successful returns 0, else 1.
+ */
+int ab_reserve(abuf_t* ab, const size_t cap);
+
+/* Empties ab, without freeing it (so that it can be reused) */
+void ab_reset(abuf_t* ab);
+
 /* Frees ab */
 void ab_free(abuf_t* ab);
 
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file diff.h */
+
+
+#ifndef RHD_DIFF_INCLUDE
+#define RHD_DIFF_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "file.h"
+
+
+/* Bytes of the files covered by each bit of the "equal/different" bitmap */
+#define RHD_DIFF_BLOCK_LEN ((off_t)1 << 20)
+
+
+/**
+ * Enum type that describes the direction of a lookup of the differences
+ */
+typedef enum diff_dir_tag {
+    RHD_DIFF_DIR_FORWARD,
+    RHD_DIFF_DIR_BACKWARD
+} diff_dir_t;
+
+/**
+ * Enum type that describes the state of the background comparison
+ */
+typedef enum diff_state_tag {
+    RHD_DIFF_STATE_IDLE,
+    RHD_DIFF_STATE_RUNNING,
+    RHD_DIFF_STATE_DONE,         /* All blocks were compared */
+    RHD_DIFF_STATE_ERROR
+} diff_state_t;
+
+/**
+ * Enum type that describes the result of a lookup of the differences
+ */
+typedef enum diff_result_tag {
+    RHD_DIFF_RESULT_FOUND,
+    RHD_DIFF_RESULT_NOT_FOUND,
+    RHD_DIFF_RESULT_PENDING,     /* The block that could contain the difference is not compared yet */
+    RHD_DIFF_RESULT_ERROR
+} diff_result_t;
+
+
+/**
+ * Returns the index of the first byte that differs between "a" and "b" (both of "len" bytes),
+ * or "len" if they are equal. They are compared with memcmp() in lanes of 64 bytes, and
+ * only the lane that differs is then scanned byte by byte.
+ */
+size_t diff_first(const unsigned char* a, const unsigned char* b, const size_t len);
+
+/**
+ * Returns the index of the last byte that differs between "a" and "b" (both of "len" bytes),
+ * or "len" if they are equal (like diff_first(), but starting from the end).
+ */
+size_t diff_last(const unsigned char* a, const unsigned char* b, const size_t len);
+
+/**
+ * Starts comparing the opened files "a" and "b" in the background, one block of
+ * RHD_DIFF_BLOCK_LEN bytes at a time (starting from the block containing "from"), to build
+ * the bitmap of the blocks that differ. The bytes past the end of the shorter file differ.
+ * If successful returns 0, else 1.
+ */
+int diff_start(rhd_file_t* a, rhd_file_t* b, const off_t from);
+
+/**
+ * Returns a file descriptor that becomes readable when the background comparison makes
+ * progress or ends (to be used with poll()), or -1 if no comparison was ever started.
+ */
+int diff_fd(void);
+
+/**
+ * Returns the state of the background comparison. If "total" is not NULL, it gets the amount
+ * of blocks to compare, and "compared" those already compared (of which "different" differ).
+ * An ended comparison is joined.
+ */
+diff_state_t diff_poll(size_t* compared, size_t* different, size_t* total);
+
+/**
+ * Looks up the first byte that differs at or after "from" (RHD_DIFF_DIR_FORWARD), or the last
+ * one at or before "from" (RHD_DIFF_DIR_BACKWARD), and stores its offset in "hit".
+ * The blocks that are known to be equal are skipped without reading them.
+ * Can be called while the comparison is running.
+ */
+diff_result_t diff_find(const off_t from, const diff_dir_t dir, off_t* hit);
+
+/**
+ * Stops the background comparison (if running), waiting for it, and frees its resources.
+ * If successful returns 0, else 1.
+ */
+int diff_stop(void);
+
+
+#endif  /* RHD_DIFF_INCLUDE */
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file dump.h */
+
+
+#ifndef RHD_DUMP_INCLUDE
+#define RHD_DUMP_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "file.h"
+
+
+/* Amount of bytes in each row (like "hexdump -C") */
+#define RHD_DUMP_ROW_LEN 16
+
+/* Upper bound of the chars of a single formatted row (with the longest possible offset) */
+#define RHD_DUMP_ROW_MAX 96
+
+/* Upper bound of the chars of "n" formatted bytes */
+#define RHD_DUMP_ROWS_MAX(n) (((n) + RHD_DUMP_ROW_LEN - 1) / RHD_DUMP_ROW_LEN * RHD_DUMP_ROW_MAX)
+
+
+/**
+ * Struct containing what is needed to squeeze runs of identical rows (like "hexdump -C"),
+ * meaning the previous row, and whether it was already squeezed
+ */
+typedef struct dump_squeeze_tag {
+    unsigned char prev[RHD_DUMP_ROW_LEN];
+    int           has_prev;
+    int           is_squeezing;
+} dump_squeeze_t;
+
+
+/**
+ * Writes to stdout (in the same format as "hexdump -C") "length" bytes of the open file "f",
+ * starting from "offset". If "length" is -1, the file is dumped until its end.
+ * Works also for streams (like pipes), skipping the first "offset" bytes by reading them.
+ * If successful returns 0, else:
+ * - 1 = couldn't allocate output buffer
+ * - 2 = couldn't move to given "offset"
+ * - 3 = error while reading the file
+ * - 4 = error in function write()
+ */
+int dump_file(rhd_file_t* f, const off_t offset, const off_t length);
+
+/**
+ * Writes to stdout the "n" given "ranges" of the open seekable file "f", each one like dump_file()
+ * would (ending with the offset of its end), after sorting them and merging the ones that overlap
+ * or are adjacent ("ranges" is reordered, see file_ranges_coalesce()). The ranges are clamped to
+ * the end of the file, and read in batches (see file_read_ranges()).
+ * If successful returns 0, else the same codes of dump_file().
+ */
+int dump_ranges(rhd_file_t* f, rhd_range_t* ranges, const size_t n);
+
+/**
+ * Reads the list of ranges in the text file "path" (the standard input if it is RHD_FILE_STDIN),
+ * one per line as "<offset> <length>" (decimal, or hexadecimal with "0x", '#' starts a comment, and
+ * empty lines are skipped), then dumps them with dump_ranges().
+ * If successful returns 0, else the same codes of dump_ranges(), or:
+ * - 5 = couldn't read the list, or it is invalid
+ */
+int dump_ranges_file(rhd_file_t* f, const char* path);
+
+/**
+ * Writes "offset" in hexadecimal form (with at least 8 digits) into "dst", like the offsets of the
+ * rows (the dumps end with a row containing only the offset of their end, and a newline).
+ * Returns the amount of chars written.
+ */
+size_t dump_format_offset(char* dst, off_t offset);
+
+/**
+ * Writes the "n" bytes of "data" found at "pos" as rows into "dst" (that must have room for
+ * RHD_DUMP_ROWS_MAX("n") chars), squeezing identical rows with (and updating) "squeeze", so that
+ * consecutive parts of a dump can be formatted by consecutive calls.
+ * Doesn't use any global state, so it can be called from multiple threads (see format_init()).
+ * Returns the amount of chars written.
+ */
+size_t dump_format_rows(char* dst, const off_t pos, const unsigned char* data, const size_t n, dump_squeeze_t* squeeze);
+
+
+#endif  /* RHD_DUMP_INCLUDE */
@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file edits.h */
+
+
+#ifndef RHD_EDITS_INCLUDE
+#define RHD_EDITS_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+
+#define EDITS_INIT {NULL, 0, 0, NULL, 0, 0, NULL, 0, 0, 0, NULL, 0, 0}
+
+
+/**
+ * Struct containing a piece of the piece table: "len" bytes of the file starting from "pos",
+ * that are the bytes of "added" starting from "add"
+ */
+typedef struct edits_piece_tag {
+    off_t  pos;
+    size_t len;
+    size_t add;
+} edits_piece_t;
+
+/**
+ * Struct containing a change (see edits_write()), and the pieces it replaced (so that it can be
+ * undone), that are the "n_replaced" ones of "replaced" starting from "replaced_first"
+ */
+typedef struct edits_change_tag {
+    off_t  pos;
+    size_t len;
+    size_t add;
+    size_t replaced_first;
+    size_t n_replaced;
+} edits_change_t;
+
+/**
+ * Struct containing the changes made to the bytes of a file (that keeps its length), as a piece
+ * table: the bytes written are only ever appended to "added", and the ordered "pieces" tell which
+ * bytes of the file they replace (the gaps between the pieces are the bytes of the original file).
+ * So each change takes memory only for its bytes and a few pieces (whatever the length of the file),
+ * and reading a range of the file is a binary search over the pieces.
+ * The "changes" after the first "n_applied" ones were undone (and can be redone).
+ */
+typedef struct edits_tag {
+    edits_piece_t*  pieces;
+    size_t          n_pieces;
+    size_t          pieces_cap;
+    unsigned char*  added;
+    size_t          added_len;
+    size_t          added_cap;
+    edits_change_t* changes;
+    size_t          n_changes;
+    size_t          n_applied;
+    size_t          changes_cap;
+    edits_piece_t*  replaced;
+    size_t          n_replaced;
+    size_t          replaced_cap;
+} edits_t;
+
+
+/**
+ * Changes the "len" bytes starting from "pos" to given "bytes" (the changes undone can't be redone
+ * anymore afterwards).
+ * If successful returns 0, else 1 (then "edits" is left untouched).
+ */
+int edits_write(edits_t* edits, const off_t pos, const unsigned char* bytes, const size_t len);
+
+/**
+ * Undoes the last change, setting "pos" to its offset (or to -1 if there is none).
+ * If successful returns 0, else 1.
+ */
+int edits_undo(edits_t* edits, off_t* pos);
+
+/**
+ * Redoes the last change undone, setting "pos" to its offset (or to -1 if there is none).
+ * If successful returns 0, else 1.
+ */
+int edits_redo(edits_t* edits, off_t* pos);
+
+/**
+ * Returns 1 if any of the "len" bytes starting from "pos" was changed, else 0.
+ */
+int edits_is_changed(const edits_t* edits, const off_t pos, const size_t len);
+
+/**
+ * Copies into "dst" the changed bytes among the "len" ones starting from "pos" (the other bytes
+ * of "dst" are left untouched).
+ */
+void edits_apply(const edits_t* edits, unsigned char* dst, const off_t pos, const size_t len);
+
+/**
+ * Frees "edits" (that can then be reused, without changes)
+ */
+void edits_free(edits_t* edits);
+
+
+#endif  /* RHD_EDITS_INCLUDE */
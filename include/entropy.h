@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file entropy.h */
+
+
+#ifndef RHD_ENTROPY_INCLUDE
+#define RHD_ENTROPY_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "file.h"
+
+
+/* Amount of buckets the file is split into (whatever its length, so that the map always takes
+   the same memory, and the same time to build) */
+#define RHD_ENTROPY_BUCKETS 1024
+
+/* Bytes sampled from each bucket: the whole bucket when shorter, else RHD_ENTROPY_SAMPLE_CHUNKS
+   chunks spread evenly over it (so a 50 GB file is mapped reading 256 MiB of it) */
+#define RHD_ENTROPY_SAMPLE_LEN    ((size_t)1 << 18)
+#define RHD_ENTROPY_SAMPLE_CHUNKS 8
+
+/* Max entropy of a byte (8 bits), in hundredths of a bit */
+#define RHD_ENTROPY_MAX 800
+
+
+/**
+ * Enum type that describes the state of the background scan
+ */
+typedef enum entropy_state_tag {
+    RHD_ENTROPY_STATE_IDLE,
+    RHD_ENTROPY_STATE_RUNNING,
+    RHD_ENTROPY_STATE_DONE,      /* All buckets were scanned */
+    RHD_ENTROPY_STATE_ERROR
+} entropy_state_t;
+
+/**
+ * Struct type that describes a bucket of the map
+ */
+typedef struct entropy_bucket_tag {
+    off_t        start;         /* Offset of the first byte of the bucket */
+    off_t        len;
+    int          is_done;       /* 0 if the bucket was not scanned yet (then the fields below are 0) */
+    int          is_zero;       /* 1 if all the sampled bytes are zero */
+    unsigned int entropy;       /* Shannon entropy of the sampled bytes, in hundredths of a bit per byte */
+} entropy_bucket_t;
+
+
+/**
+ * Computes the Shannon entropy of the "n" bytes of "bytes", in hundredths of a bit per byte
+ * (from 0 to RHD_ENTROPY_MAX). The bytes are counted into four interleaved histograms, so that
+ * consecutive equal bytes don't wait for each other's increment.
+ */
+unsigned int entropy_of(const unsigned char* bytes, const size_t n);
+
+/**
+ * Starts scanning the opened file "f" in the background, one bucket at a time (starting from
+ * the one containing "from", so that the map is first filled around it).
+ * If successful returns 0, else 1.
+ */
+int entropy_start(rhd_file_t* f, const off_t from);
+
+/**
+ * Returns a file descriptor that becomes readable when the background scan makes progress
+ * or ends (to be used with poll()), or -1 if no scan was ever started.
+ */
+int entropy_fd(void);
+
+/**
+ * Returns the state of the background scan. If "total" is not NULL, it gets the amount of
+ * buckets of the map, and "scanned" those already scanned. An ended scan is joined.
+ */
+entropy_state_t entropy_poll(size_t* scanned, size_t* total);
+
+/**
+ * Returns the amount of buckets of the map (at most RHD_ENTROPY_BUCKETS, fewer for files
+ * shorter than that), or 0 if no scan was started.
+ */
+size_t entropy_buckets(void);
+
+/**
+ * Returns the index of the bucket containing the byte at "pos" (clamped to the map).
+ */
+size_t entropy_bucket_of(const off_t pos);
+
+/**
+ * Stores in "bucket" the bucket "i" of the map (can be called while the scan is running).
+ * If successful returns 0, else 1 ("i" is not a bucket of the map).
+ */
+int entropy_bucket(const size_t i, entropy_bucket_t* bucket);
+
+/**
+ * Stops the background scan (if running), waiting for it, and frees the map.
+ * If successful returns 0, else 1.
+ */
+int entropy_stop(void);
+
+
+#endif  /* RHD_ENTROPY_INCLUDE */
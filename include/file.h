@@ -32,49 +32,241 @@
 #include <errno.h>
 #include <stddef.h>
 
+/* POSIX standard */
+#include <sys/stat.h>
+#include <sys/types.h>  /* off_t is 64 bits wide, as _FILE_OFFSET_BITS is set to 64 (see Makefile) */
+
 #include "abuf.h"
 
 
+/* Filename that makes file_open() use the standard input */
+#define RHD_FILE_STDIN "-"
+
+/* Max length of the path of a sidecar file (see file_sidecar_path()) */
+#define RHD_FILE_PATH_MAX 4096
+
+
+/**
+ * Opaque type of an open file (each one has its own file position indicator, and page cache).
+ * All the file_* functions taking one are meant to be called from the same thread, except
+ * file_read_at().
+ */
+typedef struct rhd_file_tag rhd_file_t;
+
+/**
+ * Struct containing a range of bytes of a file (see file_read_ranges())
+ */
+typedef struct rhd_range_tag {
+    off_t offset;
+    off_t length;
+} rhd_range_t;
+
+
 /**
- * Opens given "filename" file with given "modes".
+ * Opens given "filename" file with given "modes" (if "filename" is RHD_FILE_STDIN
+ * the standard input is used instead), setting "file" to it (NULL on failure).
  * If successful returns 0, else:
- *  - -1 = file already open
  *  -  1 = error while opening given file
  *  -  2 = error in file position indicator
+ *  -  3 = error while watching the followed file (see file_follow())
+ */
+int file_open(rhd_file_t** file, const char* filename, const char* modes);
+
+/**
+ * Like file_open(), but the file is always read as it is: it is never decompressed (see
+ * file_disable_decompress()), so no sidecar file is read or written for it either. Used by the
+ * library, whose handles must not depend on the options of the program, nor leave files behind.
+ */
+int file_open_plain(rhd_file_t** file, const char* filename, const char* modes);
+
+/**
+ * Makes the files still open at exit be closed then (with atexit(), that is never called
+ * otherwise), so that the streams get back their initial file status flags (see file_stream()).
+ */
+void file_close_at_exit(void);
+
+/**
+ * Makes the following file_open() calls never map files in memory (seekable files are then
+ * read with pread() through the page cache, like the files that can't be mapped).
+ */
+void file_disable_mmap(void);
+
+/**
+ * Makes the following file_open() calls show compressed files (gzip, if built with zlib) as they
+ * are. Else the regular files opened read-only that are compressed are shown decompressed: they
+ * are indexed once (the index is saved to a sidecar file, see file_sidecar_path(), if the file
+ * is big enough), then any offset is decompressed starting from the access point before it.
+ */
+void file_disable_decompress(void);
+
+/**
+ * Makes the following file_open() calls watch regular files for changes (with inotify), so that
+ * their length can be updated as they grow (see file_follow_pull()). Followed files are never
+ * mapped in memory.
+ */
+void file_follow(void);
+
+/**
+ * Returns 1 if file_follow() was called, else 0.
+ */
+int file_is_followed(void);
+
+/**
+ * Returns the file descriptor to poll for changes of the followed file (see file_follow()),
+ * or -1 if it is not watched.
+ */
+int file_follow_fd(rhd_file_t* f);
+
+/**
+ * Processes the changes of the followed file (see file_follow()), updating its length
+ * (without blocking).
+ * If successful returns 0, else 1.
+ */
+int file_follow_pull(rhd_file_t* f);
+
+/**
+ * Sets the amount of the last bytes of a stream kept by file_stream() (64 MiB by default).
+ */
+void file_stream_window(const off_t window);
+
+/**
+ * Makes the given opened stream (a file whose length is unknown, like a pipe) navigable: its bytes are
+ * read as they arrive (see file_stream_pull()), and its last ones are kept in a temporary file,
+ * used as a ring buffer. The file length is then the amount of bytes received so far.
+ * If successful returns 0, else 1.
+ */
+int file_stream(rhd_file_t* f);
+
+/**
+ * Returns 1 if the file is a stream made navigable by file_stream(), else 0.
+ */
+int file_is_stream(rhd_file_t* f);
+
+/**
+ * Returns the file descriptor to poll for new bytes of the stream (see file_stream()),
+ * or -1 if the file is not such a stream, or it was already received entirely.
+ */
+int file_stream_fd(rhd_file_t* f);
+
+/**
+ * Reads the bytes of the stream (see file_stream()) that are available, without blocking.
+ * If successful returns 0, else 1.
+ */
+int file_stream_pull(rhd_file_t* f);
+
+/**
+ * Returns the offset of the first byte still available (streams keep only their last bytes,
+ * see file_stream()), that is 0 for the other files.
+ */
+off_t file_first(rhd_file_t* f);
+
+/**
+ * Closes given opened file, and frees it (even if an error happens).
+ * If successful returns 0, else 1.
+ */
+int file_close(rhd_file_t* f);
+
+/**
+ * Sets "window" to a read-only view of (at most) "len" bytes read from the file,
+ * starting from the file position indicator, that is moved past them.
+ * Regular files are memory-mapped, so the view points directly inside the file content.
+ * The view stays valid until the next call to a file_* function on the same file.
+ * If successful returns the amount of bytes in the view, else 0.
+ */
+size_t file_read_window(rhd_file_t* f, const unsigned char** window, const size_t len);
+
+/**
+ * Sets "view" to a read-only view of (at most) "len" bytes of the file starting from "pos",
+ * without using (or moving) the file position indicator, so that it can be called from
+ * other threads while the file is open. Memory-mapped files are viewed directly, else the
+ * bytes are read into "buf", that must have room for "len" bytes.
+ * If successful returns the amount of bytes in the view (0 past the end of the file),
+ * else (size_t)-1.
+ */
+size_t file_read_at(rhd_file_t* f, const unsigned char** view, unsigned char* buf, const off_t pos, const size_t len);
+
+/**
+ * Sorts the "n" given "ranges" by offset, and merges the ones that overlap or are adjacent (the
+ * empty ones are dropped).
+ * Returns the amount of ranges left, at the start of "ranges".
  */
-int file_open(const char* filename, const char* modes);
+size_t file_ranges_coalesce(rhd_range_t* ranges, const size_t n);
 
 /**
- * Closes opened file.
+ * Reads the "n" given "ranges" of the file (ordered, not overlapping, and inside the file) into
+ * "buf", one after the other (it must have room for all their bytes), without using (or moving)
+ * the file position indicator. The ranges close to each other are read with a single system
+ * call (with preadv(), where available, if the file is not memory-mapped).
  * If successful returns 0, else 1.
  */
-int file_close(void);
+int file_read_ranges(rhd_file_t* f, const rhd_range_t* ranges, const size_t n, unsigned char* buf);
 
 /**
  * Appends to given "ab" the given "len" amount of bytes (chars), read from the file.
  * If successful returns the amount of bytes actually read, else 0.
  */
-size_t file_append_bytes(abuf_t* ab, const size_t len);
+size_t file_append_bytes(rhd_file_t* f, abuf_t* ab, const size_t len);
 
 /**
  * Appends to given "ab" the given "len" amount of bytes in hexadecimal form, with
  * a space in between the (like this: "xx xx xx"), read from the file.
  * If successful returns the amount of bytes actually read, else 0.
  */
-size_t file_append_formatted_hexs(abuf_t* ab, const size_t len);
+size_t file_append_formatted_hexs(rhd_file_t* f, abuf_t* ab, const size_t len);
 
 /**
  * Appends to given "ab" the given "len" amount of bytes in ASCII form, with
  * a space in between the (like this: " c  c  c"), read from the file.
  * If successful returns the amount of bytes actually read, else 0.
  */
-size_t file_append_formatted_chars(abuf_t* ab, const size_t len);
+size_t file_append_formatted_chars(rhd_file_t* f, abuf_t* ab, const size_t len);
 
 /**
  * Appends to given "ab" the given "len" amount of bytes in ASCII form read from the file.
  * If successful returns the amount of bytes actually read, else 0.
  */
-size_t file_append_chars(abuf_t* ab, const size_t len);
+size_t file_append_chars(rhd_file_t* f, abuf_t* ab, const size_t len);
+
+/**
+ * Returns 1 if the file can be changed with file_write() (it was opened for update, with "+" in
+ * its modes, and it is seekable), else 0.
+ */
+int file_is_writable(rhd_file_t* f);
+
+/**
+ * Changes the "len" bytes of the file starting from "pos" to given "bytes" (inside the file, that
+ * keeps its length). The changes are only kept in memory, as a piece table, until file_save():
+ * all the file_* functions reading the file show them, and they can be undone.
+ * If successful returns 0, else 1.
+ */
+int file_write(rhd_file_t* f, const off_t pos, const unsigned char* bytes, const size_t len);
+
+/**
+ * Undoes the last change of the file (see file_write()), setting "pos" to its offset (or to -1
+ * if there is none).
+ * If successful returns 0, else 1.
+ */
+int file_undo(rhd_file_t* f, off_t* pos);
+
+/**
+ * Redoes the last change of the file that was undone (see file_undo()), setting "pos" to its
+ * offset (or to -1 if there is none).
+ * If successful returns 0, else 1.
+ */
+int file_redo(rhd_file_t* f, off_t* pos);
+
+/**
+ * Returns 1 if the file has changes that were not saved yet (see file_write()), else 0.
+ */
+int file_is_modified(rhd_file_t* f);
+
+/**
+ * Writes the changes of the file (see file_write()) to it, with a pwrite() for each extent of
+ * changed bytes (the rest of the file is never rewritten), setting "n_extents" to their amount.
+ * The changes can't be undone anymore afterwards.
+ * If successful returns 0, else 1 (then the changes are kept, to try again).
+ */
+int file_save(rhd_file_t* f, size_t* n_extents);
 
 /**
  * Move file position indicator.
@@ -82,18 +274,59 @@ size_t file_append_chars(abuf_t* ab, const size_t len);
  * If the file position indicator would go out of the file (towards SEEK_END), it doesn't move.
  * If successful returns 0, else 1.
  */
-int file_move(const long int bytes);
+int file_move(rhd_file_t* f, const off_t bytes);
+
+/**
+ * Hints that the "len" bytes of the file starting from "pos" will likely be read soon, so that
+ * they get read ahead in background (mapped files are paged in by the kernel, else the pages
+ * are loaded in the page cache by a prefetching thread).
+ */
+void file_prefetch(rhd_file_t* f, const off_t pos, const off_t len);
+
+/**
+ * Returns 1 if an error happened while reading the file (and not just the end
+ * of the file was reached), else 0.
+ */
+int file_has_error(rhd_file_t* f);
+
+/**
+ * If file is open returns file length, else -1.
+ * Also returns -1 for streams (like pipes), since their length is unknown.
+ */
+off_t file_length(rhd_file_t* f);
+
+/**
+ * If file is open gets its status (see fstat()) into "st". For compressed files (see
+ * file_disable_decompress()) "st_size" is their decompressed length.
+ * If successful returns 0, else 1.
+ */
+int file_stat(rhd_file_t* f, struct stat* st);
+
+/**
+ * Returns the nanoseconds of the modification time in "st" (see fstat()), where the system has
+ * them (POSIX 2008), else 0. Sidecar files are keyed on them too, as a file can be rewritten
+ * (with the same length) within the second of "st_mtime".
+ */
+long file_mtime_nsec(const struct stat* st);
+
+/**
+ * Writes into "path" (that must have room for RHD_FILE_PATH_MAX chars) the path of the sidecar file
+ * called "name" (at most 64 chars), that is in "$XDG_CACHE_HOME/rawhexdump" (or in
+ * "$HOME/.cache/rawhexdump"), creating the directory if it doesn't exist yet.
+ * If successful returns 0, else 1.
+ */
+int file_sidecar_path(char* path, const char* name);
 
 /**
  * If file is open returns current file position, else -1
  */
-long int file_tell(void);
+off_t file_tell(rhd_file_t* f);
 
 /**
  * Move file position indicator relative from the beginning of the file.
  * If successful returns 0, else 1.
  */
-int file_seek_set(const long bytes);
+int file_seek_set(rhd_file_t* f, const off_t bytes);
 
 
 #endif
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file format.h */
+
+
+#ifndef RHD_FORMAT_INCLUDE
+#define RHD_FORMAT_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+#include "abuf.h"
+
+
+/**
+ * Enum type that describes the case of the hexadecimal letter digits
+ */
+typedef enum format_case_tag {
+    RHD_FORMAT_CASE_UPPER,
+    RHD_FORMAT_CASE_LOWER
+} format_case_t;
+
+
+/**
+ * Selects the fastest formatting kernels supported by the running CPU.
+ * Calling it is optional (kernels are selected on first use anyway), but it
+ * must happen before formatting from multiple threads.
+ */
+void format_init(void);
+
+/**
+ * Writes the "n" bytes of "src" in hexadecimal form (with the given "letter_case"),
+ * each followed by a space, into "dst" (like this: "XX XX XX ").
+ * "dst" must have room for "n" * 3 chars.
+ */
+void format_hexs(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case);
+
+/**
+ * Writes the "n" bytes of "src" in ASCII form (non printable bytes become '.'),
+ * each surrounded by spaces, into "dst" (like this: " c  c  c ").
+ * "dst" must have room for "n" * 3 chars.
+ */
+void format_formatted_chars(char* dst, const unsigned char* src, const size_t n);
+
+/**
+ * Writes the "n" bytes of "src" in ASCII form (non printable bytes become '.') into "dst".
+ * "dst" must have room for "n" chars.
+ */
+void format_chars(char* dst, const unsigned char* src, const size_t n);
+
+
+/**
+ * Appends to "ab" the "n" bytes of "src" in hexadecimal form (with the given "letter_case"),
+ * with a space in between them (like this: "XX XX XX"), formatting them directly inside "ab".
+ * If successful returns 0, else 1.
+ */
+int format_append_hexs(abuf_t* ab, const unsigned char* src, const size_t n, const format_case_t letter_case);
+
+/**
+ * Appends to "ab" the "n" bytes of "src" in ASCII form, with a space in between them
+ * (like this: " c  c  c"), formatting them directly inside "ab".
+ * If successful returns 0, else 1.
+ */
+int format_append_formatted_chars(abuf_t* ab, const unsigned char* src, const size_t n);
+
+/**
+ * Appends to "ab" the "n" bytes of "src" in ASCII form, formatting them directly inside "ab".
+ * If successful returns 0, else 1.
+ */
+int format_append_chars(abuf_t* ab, const unsigned char* src, const size_t n);
+
+
+#endif  /* RHD_FORMAT_INCLUDE */
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file gzindex.h */
+
+
+#ifndef RHD_GZINDEX_INCLUDE
+#define RHD_GZINDEX_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/stat.h>
+#include <sys/types.h>
+
+
+/**
+ * Opaque type of the index of a gzip file, that allows reading its decompressed content from any
+ * offset, decompressing only from the nearest access point (there is one every MiB of decompressed
+ * bytes, holding the 32 KiB of content before it, that the decompression needs). Reading doesn't
+ * change the index, so it can be done by multiple threads.
+ * The index exists only if rawhexdump is built with zlib ("make ZLIB=1").
+ */
+typedef struct gzindex_tag gzindex_t;
+
+
+/**
+ * Sets "index" to the index of the gzip file "fd" (of status "st"). It is loaded from the
+ * "sidecar" file if it holds the index of this file, else it is built (decompressing the whole
+ * file once) and saved to it. "sidecar" can be NULL, then the index is just built.
+ * The descriptor is only read with pread(), and must stay open until gzindex_close().
+ * If successful returns 0, else:
+ * - 1 = not a gzip file (or rawhexdump is built without zlib)
+ * - 2 = invalid gzip file, or error while reading it
+ */
+int gzindex_open(gzindex_t** index, const int fd, const struct stat* st, const char* sidecar);
+
+/**
+ * Frees the given index (the descriptor of the file is left open).
+ */
+void gzindex_close(gzindex_t* index);
+
+/**
+ * Returns the decompressed length of the file.
+ */
+off_t gzindex_length(gzindex_t* index);
+
+/**
+ * Decompresses into "dst" (at most) "len" bytes of the content of the file starting from "pos".
+ * If successful returns the amount of bytes decompressed (0 past the end of the content),
+ * else (size_t)-1.
+ */
+size_t gzindex_read(gzindex_t* index, unsigned char* dst, const off_t pos, const size_t len);
+
+
+#endif  /* RHD_GZINDEX_INCLUDE */
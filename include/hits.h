@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file hits.h */
+
+
+#ifndef RHD_HITS_INCLUDE
+#define RHD_HITS_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+#include <stdio.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+
+/* Amount of hits in each block of the index (only the first one is stored as a whole offset) */
+#define RHD_HITS_BLOCK_LEN 64
+
+#define HITS_INIT {0, 0, NULL, NULL, 0, NULL, 0, 0, 0}
+
+
+/**
+ * Struct containing an ordered list of offsets (the hits of a search), delta-encoded: the hits
+ * are split in blocks of RHD_HITS_BLOCK_LEN, each one made of its first offset (in "bases"), and
+ * of the distances between the following ones, as variable length integers (7 bits per byte,
+ * starting at "data[starts[block]]"). So most hits take one or two bytes, and finding one is a
+ * binary search over "bases" plus the decoding of at most one block.
+ */
+typedef struct hits_tag {
+    size_t         n_hits;
+    size_t         n_blocks;
+    off_t*         bases;
+    size_t*        starts;
+    size_t         blocks_cap;
+    unsigned char* data;
+    size_t         data_len;
+    size_t         data_cap;
+    off_t          last;      /* Last appended hit */
+} hits_t;
+
+
+/**
+ * Appends "hit" to "hits" (hits must be appended in increasing order).
+ * If successful returns 0, else 1.
+ */
+int hits_append(hits_t* hits, const off_t hit);
+
+/**
+ * Returns the hit of index "i" (that must be less than "hits->n_hits").
+ */
+off_t hits_get(const hits_t* hits, const size_t i);
+
+/**
+ * Returns the index of the first hit greater than or equal to "from" (or greater than "from",
+ * if "is_strict"), or "hits->n_hits" if there is none.
+ */
+size_t hits_lower_bound(const hits_t* hits, const off_t from, const int is_strict);
+
+/**
+ * Writes "hits" to "f".
+ * If successful returns 0, else 1.
+ */
+int hits_save(const hits_t* hits, FILE* f);
+
+/**
+ * Reads into (empty) "hits" the hits written to "f" by hits_save().
+ * If successful returns 0, else 1 (then "hits" must still be freed).
+ */
+int hits_load(hits_t* hits, FILE* f);
+
+/**
+ * Frees "hits" (that can then be reused, empty)
+ */
+void hits_free(hits_t* hits);
+
+
+#endif  /* RHD_HITS_INCLUDE */
@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file inspect.h */
+
+
+#ifndef RHD_INSPECT_INCLUDE
+#define RHD_INSPECT_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+
+/* Bytes decoded by inspect_decode() (the widest values are 8 bytes long) */
+#define RHD_INSPECT_BYTES 8
+
+/* Amount of lines written by inspect_decode(), and max length of each of them ('\0' included) */
+#define RHD_INSPECT_LINES    13
+#define RHD_INSPECT_LINE_MAX 48
+
+/* Max length of a value written by inspect_format_int(), inspect_format_hex() and
+   inspect_format_time() ('\0' included) */
+#define RHD_INSPECT_VALUE_MAX 32
+
+
+/**
+ * Writes into "lines" the position "pos" (with the byte order), and the values that start
+ * with the "n" bytes of "bytes" (at most RHD_INSPECT_BYTES) read at "pos": u8/i8, u16/i16,
+ * u32/i32, u64/i64, float, double, and 32/64 bits UNIX timestamps, read with the given byte
+ * order. The values that need more than "n" bytes are shown as "-".
+ */
+void inspect_decode(char lines[RHD_INSPECT_LINES][RHD_INSPECT_LINE_MAX], const off_t pos,
+                    const unsigned char* bytes, const size_t n, const int is_big_endian);
+
+/**
+ * Writes into "dst" the integer made of the "n" bytes of "bytes" (from 1 to 8), read with the
+ * given byte order, in decimal form (as a two's complement number if "is_signed").
+ */
+void inspect_format_int(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian, const int is_signed);
+
+/**
+ * Writes into "dst" the unsigned integer made of the "n" bytes of "bytes" (from 1 to 8), read
+ * with the given byte order, in hexadecimal form (like this: "0x1F").
+ */
+void inspect_format_hex(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian);
+
+/**
+ * Writes into "dst" the UNIX timestamp (seconds since 1970, in UTC) made of the "n" bytes of
+ * "bytes" (4 unsigned, or 8 signed), read with the given byte order (like this:
+ * "2026-10-14 09:30:00"), or "-" if it can't be represented.
+ */
+void inspect_format_time(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian);
+
+
+#endif  /* RHD_INSPECT_INCLUDE */
@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file offset.h */
+
+
+#ifndef RHD_OFFSET_INCLUDE
+#define RHD_OFFSET_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+
+/**
+ * Parses given "str" as a non negative file offset, written in decimal or in
+ * hexadecimal (with the "0x" or "0X" prefix), and stores it in "offset".
+ * If successful returns 0, else 1 (invalid string or overflow).
+ */
+int offset_parse(const char* str, off_t* offset);
+
+/**
+ * Returns the amount of hexadecimal digits needed to write the non negative "offset" (at least 1).
+ */
+size_t offset_hex_digits(off_t offset);
+
+/**
+ * Writes the non negative "offset" into "dst" as "n_digits" uppercase hexadecimal digits,
+ * padded with zeros (no terminator is written). Only the lowest "n_digits" digits are
+ * written, so "n_digits" should be at least offset_hex_digits("offset").
+ */
+void offset_format_hex(char* dst, off_t offset, const size_t n_digits);
+
+/**
+ * Adds the non negative "value" to the offset written in "digits" by offset_format_hex(),
+ * touching only the digits that change (usually the lowest two or three), so that the
+ * offsets of consecutive rows cost almost nothing.
+ * If the sum fits in "n_digits" digits returns 0, else 1 (and "digits" are left wrapped).
+ */
+int offset_add_hex(char* digits, const size_t n_digits, off_t value);
+
+
+#endif  /* RHD_OFFSET_INCLUDE */
@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file pool.h */
+
+
+#ifndef RHD_POOL_INCLUDE
+#define RHD_POOL_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <pthread.h>
+
+
+/* Max amount of worker threads of a pool */
+#define RHD_POOL_THREADS_MAX 64
+
+
+/**
+ * Function pointer type of the tasks: "task" is the index of the task (tasks are started in
+ * increasing order), "worker" is the index of the thread running it (less than the amount of threads)
+ */
+typedef void (*pool_task_t)(void* ctx, const size_t task, const size_t worker);
+
+/**
+ * Struct containing a worker thread of a pool
+ */
+typedef struct pool_worker_tag {
+    pthread_t        thread;
+    struct pool_tag* pool;
+    size_t           index;
+} pool_worker_t;
+
+/**
+ * Struct containing a pool of worker threads, that run "n_tasks" tasks
+ */
+typedef struct pool_tag {
+    pool_worker_t   workers[RHD_POOL_THREADS_MAX];
+    size_t          n_threads;
+    size_t          n_tasks;
+    pool_task_t     task;
+    void*           ctx;
+    pthread_mutex_t lock;          /* Protects "next_task" and "is_cancelled" */
+    size_t          next_task;
+    int             is_cancelled;
+} pool_t;
+
+
+/**
+ * Returns the amount of worker threads to use: one for each online CPU
+ * (at most RHD_POOL_THREADS_MAX).
+ */
+size_t pool_threads(void);
+
+/**
+ * Starts (at most) "n_threads" worker threads, that run the "n_tasks" tasks "task" (each one
+ * gets "ctx") until there are none left.
+ * If successful returns 0 (then pool_join() must be called), else 1.
+ */
+int pool_start(pool_t* pool, const size_t n_threads, const size_t n_tasks, pool_task_t task, void* ctx);
+
+/**
+ * Makes the worker threads skip the tasks not started yet (without waiting for them).
+ */
+void pool_cancel(pool_t* pool);
+
+/**
+ * Waits for all worker threads to end.
+ */
+void pool_join(pool_t* pool);
+
+
+#endif  /* RHD_POOL_INCLUDE */
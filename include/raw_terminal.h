@@ -28,18 +28,56 @@
 #define RHD_RAW_TERMINAL_INCLUDE
 
 
+#include <stddef.h>
+
+
+/* Max amount of files shown side by side */
+#define RHD_TERM_PANES_MAX 4
+
+
+/**
+ * Makes the following term_init() show a diff view of its two files: they scroll together,
+ * the bytes that differ are highlighted, and the blocks that differ are found in the background
+ * (to jump between the differences).
+ */
+void term_diff(void);
+
+/**
+ * Makes the following term_init() show "bytes" bytes per row (in every view, and whatever the
+ * size of the terminal, as long as they fit), instead of as many as fit in the terminal.
+ */
+void term_row_width(const size_t bytes);
+
 /**
- * Initialize terminal data, assigns SIGWINCH signal handler and enables raw mode.
+ * Makes the following term_init() open the files for update, so that their bytes can be changed
+ * in the edit mode (the changes are kept in memory until they are saved, and can be undone).
+ */
+void term_edit(void);
+
+/**
+ * Makes the following term_init() and term_loop() run without a terminal (like in the tests):
+ * the keys are read from "keys_fd" (as a terminal sends them), the frames are written to
+ * "frames_fd", and the window is "rows" by "cols" (until the keys hold the xterm sequence
+ * "ESC [ 8 ; <rows> ; <cols> t", that resizes it as a SIGWINCH would). Each frame is rendered
+ * before reading the next key, and held keys are not accelerated, so that the frames don't
+ * depend on how fast the keys arrive.
+ */
+void term_headless(const int keys_fd, const int frames_fd, const unsigned int rows, const unsigned int cols);
+
+/**
+ * Initialize terminal data (showing the "n_files" given files side by side, from 1
+ * to RHD_TERM_PANES_MAX), assigns SIGWINCH signal handler and enables raw mode.
  * If successful returns 0, else:
- * - 1 = couldn't open given file
+ * - 1 = couldn't open one of the given files (or it can't be seeked)
  * - 2 = couldn't set exit handler
  * - 3 = couldn't set sigaction for SIGWINCH
- * - 4 = couldn't raise SIGWINCH
+ * - 4 = couldn't create pipe for SIGWINCH
  * - 5 = error while handling SIGWINCH
  * - 6 = couldn't get terminal initial state
  * - 7 = couldn't set terminal raw state
+ * - 8 = couldn't start comparing the files (in the diff view)
  */
-int term_init(const char* filename);
+int term_init(const char* const* filenames, const size_t n_files);
 
 /**
  * Disable raw mode for terminal, returning to initial state.
@@ -49,6 +87,15 @@ int term_init(const char* filename);
  */
 int term_disable_raw_mode(void);
 
+/**
+ * Resets the state of the viewer (the options given with term_diff(), term_row_width(), term_edit()
+ * and term_headless() included) to the one it starts with, so that another session can start with
+ * term_init() in the same process (like in the fuzz harness). It must be called once the terminal
+ * is not initialized anymore (see term_disable_raw_mode()), else it does nothing. The files that a
+ * term_init() that failed left open are closed.
+ */
+void term_reset(void);
+
 /**
  * Enter in terminal loop.
  * If successfull (exits when "quit input" received) returns 0, else:
@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file rawhexdump.h */
+
+
+#ifndef RHD_RAWHEXDUMP_INCLUDE
+#define RHD_RAWHEXDUMP_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>  /* off_t must be 64 bits wide, like in the library: define _FILE_OFFSET_BITS as 64 */
+
+
+/* The functions of this header are the only ones exported by librawhexdump.so */
+#if defined(__GNUC__)
+#define RHD_API __attribute__((visibility("default")))
+#else
+#define RHD_API
+#endif
+
+
+/**
+ * Opaque type of a file open for dumping (see rhd_dump_open()).
+ * All the rhd_* functions can be called from multiple threads at the same time, even with
+ * the same handle (except rhd_dump_close(), that must be the last call on it). Nothing is
+ * written to the standard streams, and nothing is registered with atexit().
+ */
+typedef struct rhd_dump_tag rhd_dump_t;
+
+
+/**
+ * Opens the seekable file "filename" for dumping, setting "dump" to its handle (NULL on failure).
+ * If successful returns 0, else:
+ * - 1 = error while opening the file (see errno)
+ * - 2 = the file is not seekable (like a pipe)
+ */
+RHD_API int rhd_dump_open(rhd_dump_t** dump, const char* filename);
+
+/**
+ * Closes the file of the handle, and frees it (even if an error happens).
+ * If successful returns 0, else 1.
+ */
+RHD_API int rhd_dump_close(rhd_dump_t* dump);
+
+/**
+ * Returns the length of the file of the handle.
+ */
+RHD_API off_t rhd_dump_length(rhd_dump_t* dump);
+
+/**
+ * Returns the upper bound of the chars of the dump of "length" bytes, that is the size of the
+ * output buffer that rhd_dump_format() and rhd_format() must be given.
+ */
+RHD_API size_t rhd_dump_bound(const size_t length);
+
+/**
+ * Writes into "out" (of "out_len" chars, not NUL-terminated) "length" bytes of the file of the
+ * handle starting from "offset", in the same format as "hexdump -C" (and as "rawhexdump -d -s
+ * <offset> -n <length>"), setting "n_chars" to the amount of chars written. If "length" is -1,
+ * or goes past the end of the file, the file is dumped until its end. If "offset" is past the end
+ * of the file, only the row with the offset of the end of the file is written.
+ * If successful returns 0, else:
+ * - 1 = "out_len" is less than rhd_dump_bound() of the bytes to dump (nothing is written)
+ * - 2 = invalid "offset" (negative)
+ * - 3 = error while reading the file
+ */
+RHD_API int rhd_dump_format(rhd_dump_t* dump, const off_t offset, const off_t length, char* out, const size_t out_len, size_t* n_chars);
+
+/**
+ * Writes into "out" (of "out_len" chars, not NUL-terminated) the "n" bytes of "data" like
+ * rhd_dump_format() would, as if they were found at "offset" (to dump buffers already in memory),
+ * setting "n_chars" to the amount of chars written.
+ * If successful returns 0, else:
+ * - 1 = "out_len" is less than rhd_dump_bound() of "n" (nothing is written)
+ * - 2 = invalid "offset" (negative)
+ */
+RHD_API int rhd_format(const unsigned char* data, const size_t n, const off_t offset, char* out, const size_t out_len, size_t* n_chars);
+
+
+#endif  /* RHD_RAWHEXDUMP_INCLUDE */
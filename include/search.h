@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file search.h */
+
+
+#ifndef RHD_SEARCH_INCLUDE
+#define RHD_SEARCH_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "file.h"
+
+
+/* Max length (in bytes) of a search pattern */
+#define RHD_SEARCH_NEEDLE_MAX 256
+
+
+/**
+ * Enum type that describes the direction of a search
+ */
+typedef enum search_dir_tag {
+    RHD_SEARCH_DIR_FORWARD,
+    RHD_SEARCH_DIR_BACKWARD
+} search_dir_t;
+
+/**
+ * Enum type that describes the state of the background search
+ */
+typedef enum search_state_tag {
+    RHD_SEARCH_STATE_IDLE,
+    RHD_SEARCH_STATE_RUNNING,
+    RHD_SEARCH_STATE_DONE,       /* The whole file was searched */
+    RHD_SEARCH_STATE_CANCELLED,
+    RHD_SEARCH_STATE_ERROR
+} search_state_t;
+
+/**
+ * Enum type that describes the result of a lookup of the hits
+ */
+typedef enum search_result_tag {
+    RHD_SEARCH_RESULT_FOUND,
+    RHD_SEARCH_RESULT_NOT_FOUND,
+    RHD_SEARCH_RESULT_PENDING    /* The part of the file that could contain the hit is not searched yet */
+} search_result_t;
+
+
+/**
+ * Parses given "str" into a search pattern, stored in "needle" (that must have room for
+ * RHD_SEARCH_NEEDLE_MAX bytes), and its length in "len".
+ * If "str" contains only pairs of hexadecimal digits (spaces between them are ignored, like
+ * in "7F 45 4C 46") it is a hexadecimal pattern, else it is an ASCII string. A leading '"'
+ * forces an ASCII string (a trailing '"' is then dropped).
+ * If successful returns 0, else 1 (empty or too long pattern).
+ */
+int search_parse(const char* str, unsigned char* needle, size_t* len);
+
+/**
+ * Returns a pointer to the first occurrence of "needle" (of "needle_len" bytes) inside
+ * "hay" (of "hay_len" bytes), or NULL if not found.
+ */
+const unsigned char* search_memmem(const unsigned char* hay, const size_t hay_len,
+                                   const unsigned char* needle, const size_t needle_len);
+
+/**
+ * Starts searching the whole opened file "f" for all hits of "needle" (of "len" bytes), splitting
+ * it in chunks searched by a pool of background threads (chunks starting from the one
+ * containing offset "from" are searched first). A search already running is stopped.
+ * The hits of long files are saved to a sidecar file (in "$XDG_CACHE_HOME/rawhexdump"), keyed
+ * by the identity, size and modification time of the file and by "needle": searching the same
+ * needle in the same file again just reloads them.
+ * Progress is notified by making search_fd() readable.
+ * If successful returns 0, else 1.
+ */
+int search_start(rhd_file_t* f, const unsigned char* needle, const size_t len, const off_t from);
+
+/**
+ * Returns a file descriptor that becomes readable when the background search makes
+ * progress or ends (to be used with poll()), or -1 if no search was ever started.
+ */
+int search_fd(void);
+
+/**
+ * Returns the state of the background search. If "total" is not NULL, it gets the amount of
+ * bytes to search, and "scanned" those already searched. Ended searches are joined.
+ */
+search_state_t search_poll(off_t* scanned, off_t* total);
+
+/**
+ * Looks up the first hit starting at or after "from" (RHD_SEARCH_DIR_FORWARD), or the last
+ * hit starting at or before "from" (RHD_SEARCH_DIR_BACKWARD), and stores it in "hit".
+ * Can be called while the search is running.
+ */
+search_result_t search_find(const off_t from, const search_dir_t dir, off_t* hit);
+
+/**
+ * Returns the amount of hits, or (size_t)-1 if the search is not done.
+ */
+size_t search_count(void);
+
+/**
+ * Returns the index of "hit" among all hits (starting from 0), or (size_t)-1 if the search
+ * is not done (or "hit" is not a hit).
+ */
+size_t search_index(const off_t hit);
+
+/**
+ * Asks the background search to stop (without waiting for it).
+ */
+void search_cancel(void);
+
+/**
+ * Stops the background search (if running), waiting for it, and frees its resources.
+ * If successful returns 0, else 1.
+ */
+int search_stop(void);
+
+
+#endif  /* RHD_SEARCH_INCLUDE */
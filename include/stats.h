@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file stats.h */
+
+
+#ifndef RHD_STATS_INCLUDE
+#define RHD_STATS_INCLUDE
+
+
+#include <stdio.h>
+
+
+/**
+ * Enum type that describes the counters of the hot paths
+ */
+typedef enum stats_counter_tag {
+    RHD_STATS_ALLOCS,        /* Buffers allocated (or enlarged) by abuf.c and file.c */
+    RHD_STATS_READS,         /* Calls to read(), pread() and fread() reading a file */
+    RHD_STATS_SEEKS,         /* Calls to lseek() and fseeko() */
+    RHD_STATS_CACHE_HITS,    /* Pages found in the page cache */
+    RHD_STATS_CACHE_MISSES,  /* Pages loaded into the page cache */
+    RHD_STATS_WRITES,        /* Calls to write() writing to stdout (the frames, or the dump) */
+    RHD_STATS_WRITTEN,       /* Bytes written by those calls */
+    RHD_STATS_FRAMES,        /* Screen refreshes that wrote something */
+    RHD_STATS_RENDER_NS,     /* Nanoseconds spent preparing and writing the frames */
+    RHD_STATS_COUNTERS
+} stats_counter_t;
+
+
+/**
+ * Adds "n" to "counter" (can be called from any thread).
+ */
+void stats_add(const stats_counter_t counter, const unsigned long n);
+
+/**
+ * Returns the current value of "counter".
+ */
+unsigned long stats_get(const stats_counter_t counter);
+
+/**
+ * Writes to "stream" a report of all counters (with the averages per frame, and the
+ * cache hit rate).
+ */
+void stats_print(FILE* stream);
+
+
+#endif  /* RHD_STATS_INCLUDE */
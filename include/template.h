@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file template.h */
+
+
+#ifndef RHD_TEMPLATE_INCLUDE
+#define RHD_TEMPLATE_INCLUDE
+
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "file.h"
+#include "inspect.h"
+
+
+/* Max length of a name written by template_field_name() ('\0' included) */
+#define RHD_TEMPLATE_NAME_MAX 48
+
+/* Max length of a value written by template_field_value() ('\0' included) */
+#define RHD_TEMPLATE_VALUE_MAX (RHD_INSPECT_VALUE_MAX + 32)
+
+
+/**
+ * Enum type that describes how the bytes of a field are shown
+ */
+typedef enum template_kind_tag {
+    RHD_TEMPLATE_KIND_DEC,     /* Unsigned integer, in decimal form */
+    RHD_TEMPLATE_KIND_HEX,     /* Unsigned integer, in hexadecimal form (offsets, addresses and flags) */
+    RHD_TEMPLATE_KIND_TEXT,    /* Chars (like a magic number, or a name) */
+    RHD_TEMPLATE_KIND_TIME,    /* UNIX timestamp */
+    RHD_TEMPLATE_KIND_STRTAB,  /* Unsigned integer, that is the offset of a name in the ELF section names */
+    RHD_TEMPLATE_KIND_BLOB     /* Bytes that are not decoded (only their length is shown) */
+} template_kind_t;
+
+/**
+ * Struct type that describes a field of the file, found by a template
+ */
+typedef struct template_field_tag {
+    off_t           pos;
+    off_t           len;
+    const char*     group;  /* Table the field belongs to (NULL for the fields of the headers) */
+    size_t          index;  /* Index of the entry of "group" the field belongs to */
+    const char*     name;
+    template_kind_t kind;
+} template_field_t;
+
+/**
+ * Opaque type of a template: the layout of the headers of a known file format (ELF, PE or PNG),
+ * read from an opened file
+ */
+typedef struct rhd_template_tag rhd_template_t;
+
+
+/**
+ * Recognizes the format of the opened file "f" from its first bytes, and reads the layout of
+ * its headers, setting "template" to it (NULL if the format is not known). The tables of the
+ * headers are not read: their fields are found only when asked (see template_fields()).
+ * If successful returns 0, else 1.
+ */
+int template_open(rhd_template_t** template, rhd_file_t* f);
+
+/**
+ * Returns the name of the format of "template" (like "ELF64 little endian").
+ */
+const char* template_format(const rhd_template_t* template);
+
+/**
+ * Finds the fields of "template" that overlap the bytes in [from, to), and stores (at most
+ * "max" of) them in "fields", sorted by their position. Only the entries of the tables that
+ * overlap the range are looked at (the chunks of a PNG file are walked once, and remembered).
+ * If successful returns the amount of fields found, else (size_t)-1.
+ */
+size_t template_fields(rhd_template_t* template, const off_t from, const off_t to,
+                       template_field_t* fields, const size_t max);
+
+/**
+ * Writes into "dst" (that must have room for RHD_TEMPLATE_NAME_MAX chars) the name of "field"
+ * (like "e_shoff", or "shdr[3].sh_offset" for the fields of the entries of a table).
+ */
+void template_field_name(const template_field_t* field, char* dst);
+
+/**
+ * Writes into "dst" (that must have room for RHD_TEMPLATE_VALUE_MAX chars) the value of "field",
+ * read from the file of "template".
+ * If successful returns 0, else 1.
+ */
+int template_field_value(rhd_template_t* template, const template_field_t* field, char* dst);
+
+/**
+ * Frees "template" (the file is not closed).
+ */
+void template_close(rhd_template_t* template);
+
+
+#endif  /* RHD_TEMPLATE_INCLUDE */
@@ -28,24 +28,71 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "stats.h"
+
 #include "abuf.h"
 
 
+/* Minimum capacity allocated by ab_extend() */
+#define ABUF_MIN_CAP 64
+
+
 /* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
 
 int ab_append(abuf_t* ab, const char* s, const size_t len) {
+    char* room;
+
+    if ((room = ab_extend(ab, len)) == NULL)
+        return 1;
+
+    memcpy(room, s, len);
+    ab->len += len;
+    return 0;
+}
+
+
+char* ab_extend(abuf_t* ab, const size_t len) {
+    size_t new_cap;
+
+    /* If "len" bytes don't fit, grow geometrically (at least doubling the capacity) */
+    if (ab->len + len > ab->cap) {
+        if (ab->len + len < ab->len)
+            return NULL;
+        new_cap = ab->cap * 2 > ABUF_MIN_CAP ? ab->cap * 2 : ABUF_MIN_CAP;
+        if (new_cap < ab->len + len)
+            new_cap = ab->len + len;
+        if (ab_reserve(ab, new_cap) != 0)
+            return NULL;
+    }
+
+    return &ab->b[ab->len];
+}
+
+
+int ab_reserve(abuf_t* ab, const size_t cap) {
     char* new_b;
 
-    if ((new_b = realloc(ab->b, ab->len + len)) == NULL)
+    if (cap <= ab->cap)
+        return 0;
+
+    if ((new_b = realloc(ab->b, cap)) == NULL)
         return 1;
+    stats_add(RHD_STATS_ALLOCS, 1);
 
-    memcpy(&new_b[ab->len], s, len);
     ab->b = new_b;
-    ab->len += len;
+    ab->cap = cap;
     return 0;
 }
 
 
+void ab_reset(abuf_t* ab) {
+    ab->len = 0;
+}
+
+
 void ab_free(abuf_t* ab) {
     free(ab->b);
+    ab->b   = NULL;
+    ab->len = 0;
+    ab->cap = 0;
 }
@@ -0,0 +1,437 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file diff.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for pthreads, pipe and fcntl) */
+
+/* C89 standard */
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "pool.h"
+
+#include "diff.h"
+
+
+/* Bytes compared at once with memcmp() (before scanning them byte by byte) */
+#define RHD_DIFF_LANE_LEN 64
+
+/* Bytes read at once from each file (the read buffers of each thread are this long) */
+#define RHD_DIFF_READ_LEN ((size_t)1 << 16)
+
+/* Blocks compared between two progress notifications */
+#define RHD_DIFF_PROGRESS_BLOCKS 64
+
+/* Get and set the bit of block "i" inside the bitmap "bits" */
+#define RHD_DIFF_BIT_GET(bits, i) (((bits)[(i) / 8] >> ((i) % 8)) & 1)
+#define RHD_DIFF_BIT_SET(bits, i) ((bits)[(i) / 8] |= (unsigned char)(1 << ((i) % 8)))
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Task comparing a block of the files (run by the pool)
+ */
+static void diff_block(void* ctx, const size_t task, const size_t worker);
+
+/**
+ * Compares the bytes [start, end) of the files (inside both of them), reading them into "bufs"
+ * (of 2 * RHD_DIFF_READ_LEN bytes, used when the files are not memory-mapped), and stores in "hit"
+ * the first byte that differs (or the last one, depending on "dir").
+ * Returns RHD_DIFF_RESULT_FOUND, RHD_DIFF_RESULT_NOT_FOUND, or RHD_DIFF_RESULT_ERROR.
+ */
+static diff_result_t diff_range(unsigned char* bufs, const off_t start, const off_t end,
+                                const diff_dir_t dir, off_t* hit);
+
+/**
+ * Makes diff_fd() readable
+ */
+static void diff_notify(void);
+
+/**
+ * Stops the background comparison (if any), waits for it, and frees its bitmaps
+ */
+static void diff_join(void);
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Mutex protecting the fields of "diff" shared with the background threads
+ */
+static pthread_mutex_t diff_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Struct containing the background comparison
+ */
+static struct diff_tag {
+    pool_t         pool;
+    int            is_running;    /* 1 if "pool" was started and not joined yet */
+    int            is_pipe_open;
+    int            pipe_fds[2];   /* The background threads write to [1], diff_fd() is [0] */
+    rhd_file_t*    files[2];      /* Files being compared */
+    off_t          min_len;       /* Length of the shorter file */
+    off_t          max_len;       /* Length of the longer file */
+    size_t         n_blocks;
+    size_t         first_block;   /* Block compared first (the tasks of the pool wrap around from it) */
+    unsigned char* bufs;          /* Read buffers of each thread (used when the files are not memory-mapped) */
+    unsigned char* find_bufs;     /* Read buffers of diff_find() */
+
+    /* Shared with the background threads (protected by "diff_lock") */
+    diff_state_t   state;
+    unsigned char* is_done;       /* Bitmap of the blocks already compared */
+    unsigned char* is_different;  /* Bitmap of the blocks that differ */
+    size_t         n_done;
+    size_t         n_different;
+    size_t         notified;      /* Value of "n_done" at the last progress notification */
+} diff;
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+size_t diff_first(const unsigned char* a, const unsigned char* b, const size_t len) {
+    size_t i;
+
+    /* Skip the lanes that are equal (memcmp() is vectorized by the C library) */
+    for (i = 0; i + RHD_DIFF_LANE_LEN <= len && memcmp(&a[i], &b[i], RHD_DIFF_LANE_LEN) == 0; i += RHD_DIFF_LANE_LEN)
+        ;
+
+    /* Then find the byte that differs inside the lane (or inside the last bytes) */
+    for (; i < len && a[i] == b[i]; i++)
+        ;
+
+    return i;
+}
+
+
+size_t diff_last(const unsigned char* a, const unsigned char* b, const size_t len) {
+    size_t i;
+
+    /* Skip the lanes that are equal, from the end */
+    for (i = len; i >= RHD_DIFF_LANE_LEN && memcmp(&a[i - RHD_DIFF_LANE_LEN], &b[i - RHD_DIFF_LANE_LEN], RHD_DIFF_LANE_LEN) == 0;
+         i -= RHD_DIFF_LANE_LEN)
+        ;
+
+    /* Then find the byte that differs inside the lane (or inside the first bytes) */
+    for (; i > 0 && a[i - 1] == b[i - 1]; i--)
+        ;
+
+    return i == 0 ? len : i - 1;
+}
+
+
+int diff_start(rhd_file_t* a, rhd_file_t* b, const off_t from) {
+    size_t n_threads;
+    size_t n_bytes;
+    off_t  lens[2];
+    int    i;
+
+    if ((lens[0] = file_length(a)) < 0 || (lens[1] = file_length(b)) < 0)
+        return 1;
+
+    /* Stop previous comparison (its threads still read the files it was comparing) */
+    diff_join();
+    diff.files[0] = a;
+    diff.files[1] = b;
+    diff.min_len  = lens[0] < lens[1] ? lens[0] : lens[1];
+    diff.max_len  = lens[0] < lens[1] ? lens[1] : lens[0];
+
+    /* Open notification pipe (reused by following comparisons). Both ends of the pipe
+       are non blocking, so that notifying never blocks the background threads */
+    if (!diff.is_pipe_open) {
+        if (pipe(diff.pipe_fds) == -1)
+            return 1;
+        diff.is_pipe_open = 1;
+        for (i = 0; i < 2; i++) {
+            if (fcntl(diff.pipe_fds[i], F_SETFL, fcntl(diff.pipe_fds[i], F_GETFL) | O_NONBLOCK) == -1 ||
+                fcntl(diff.pipe_fds[i], F_SETFD, FD_CLOEXEC) == -1)
+                return 1;
+        }
+    }
+
+    /* Allocate bitmaps, and the read buffers (reused by following comparisons) */
+    n_threads     = pool_threads();
+    diff.n_blocks = (size_t)((diff.max_len + RHD_DIFF_BLOCK_LEN - 1) / RHD_DIFF_BLOCK_LEN);
+    n_bytes       = diff.n_blocks / 8 + 1;
+    if ((diff.is_done = calloc(n_bytes, 1)) == NULL || (diff.is_different = calloc(n_bytes, 1)) == NULL)
+        return 1;
+    if (diff.bufs == NULL && (diff.bufs = malloc((n_threads + 1) * 2 * RHD_DIFF_READ_LEN)) == NULL)
+        return 1;
+    diff.find_bufs = &diff.bufs[n_threads * 2 * RHD_DIFF_READ_LEN];
+
+    diff.first_block = from > 0 && from < diff.max_len ? (size_t)(from / RHD_DIFF_BLOCK_LEN) : 0;
+    diff.n_done      = 0;
+    diff.n_different = 0;
+    diff.notified    = 0;
+    diff.state       = RHD_DIFF_STATE_RUNNING;
+
+    /* Empty files are equal */
+    if (diff.n_blocks == 0) {
+        diff.state = RHD_DIFF_STATE_DONE;
+        diff_notify();
+        return 0;
+    }
+
+    if (pool_start(&diff.pool, n_threads, diff.n_blocks, diff_block, NULL) != 0) {
+        diff.state = RHD_DIFF_STATE_IDLE;
+        return 1;
+    }
+    diff.is_running = 1;
+
+    return 0;
+}
+
+
+int diff_fd(void) {
+    return diff.is_pipe_open ? diff.pipe_fds[0] : -1;
+}
+
+
+diff_state_t diff_poll(size_t* compared, size_t* different, size_t* total) {
+    char         buf[64];
+    diff_state_t state;
+
+    /* Empty notification pipe */
+    if (diff.is_pipe_open) {
+        while (read(diff.pipe_fds[0], buf, sizeof(buf)) > 0)
+            ;
+    }
+
+    pthread_mutex_lock(&diff_lock);
+    state = diff.state;
+    if (total != NULL) {
+        *compared  = diff.n_done;
+        *different = diff.n_different;
+        *total     = diff.n_blocks;
+    }
+    pthread_mutex_unlock(&diff_lock);
+
+    /* Join ended background threads */
+    if (state != RHD_DIFF_STATE_RUNNING && diff.is_running) {
+        pool_join(&diff.pool);
+        diff.is_running = 0;
+    }
+
+    return state;
+}
+
+
+diff_result_t diff_find(const off_t from, const diff_dir_t dir, off_t* hit) {
+    diff_result_t ret;
+    off_t         pos;
+    off_t         start;
+    off_t         end;
+    size_t        b;
+    int           is_done;
+    int           is_different;
+
+    if (from < 0 || from >= diff.max_len || diff.state == RHD_DIFF_STATE_IDLE)
+        return RHD_DIFF_RESULT_NOT_FOUND;
+
+    /* Walk the blocks from the one containing "from", skipping those that are equal */
+    pos = from;
+    b   = (size_t)(from / RHD_DIFF_BLOCK_LEN);
+    for (;;) {
+        pthread_mutex_lock(&diff_lock);
+        is_done      = RHD_DIFF_BIT_GET(diff.is_done, b);
+        is_different = RHD_DIFF_BIT_GET(diff.is_different, b);
+        pthread_mutex_unlock(&diff_lock);
+        if (!is_done)
+            return RHD_DIFF_RESULT_PENDING;
+
+        /* Only the blocks that differ are read (the bytes past the end of the shorter file all differ) */
+        if (is_different) {
+            start = (off_t)b * RHD_DIFF_BLOCK_LEN;
+            end   = diff.max_len - start > RHD_DIFF_BLOCK_LEN ? start + RHD_DIFF_BLOCK_LEN : diff.max_len;
+            if (pos >= diff.min_len) {
+                *hit = pos;
+                return RHD_DIFF_RESULT_FOUND;
+            }
+            if (dir == RHD_DIFF_DIR_FORWARD)
+                ret = diff_range(diff.find_bufs, pos, end < diff.min_len ? end : diff.min_len, dir, hit);
+            else
+                ret = diff_range(diff.find_bufs, start, pos + 1, dir, hit);
+            if (ret != RHD_DIFF_RESULT_NOT_FOUND)
+                return ret;
+            if (dir == RHD_DIFF_DIR_FORWARD && end > diff.min_len) {
+                *hit = diff.min_len;
+                return RHD_DIFF_RESULT_FOUND;
+            }
+        }
+
+        /* Next (or previous) block */
+        if (dir == RHD_DIFF_DIR_FORWARD) {
+            if (++b >= diff.n_blocks)
+                return RHD_DIFF_RESULT_NOT_FOUND;
+            pos = (off_t)b * RHD_DIFF_BLOCK_LEN;
+        } else {
+            if (b-- == 0)
+                return RHD_DIFF_RESULT_NOT_FOUND;
+            pos = (off_t)(b + 1) * RHD_DIFF_BLOCK_LEN - 1;
+        }
+    }
+}
+
+
+int diff_stop(void) {
+    int ret;
+
+    diff_join();
+
+    /* Free read buffers, and close notification pipe */
+    free(diff.bufs);
+    diff.bufs      = NULL;
+    diff.find_bufs = NULL;
+    ret = 0;
+    if (diff.is_pipe_open) {
+        if (close(diff.pipe_fds[0]) == -1)
+            ret = 1;
+        if (close(diff.pipe_fds[1]) == -1)
+            ret = 1;
+        diff.is_pipe_open = 0;
+    }
+
+    return ret;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static void diff_block(void* ctx, const size_t task, const size_t worker) {
+    diff_result_t result;
+    off_t         start;
+    off_t         end;
+    off_t         hit;
+    size_t        b;
+    int           is_due;
+
+    (void)ctx;
+
+    /* Block [start, end) (it differs if it goes past the end of the shorter file) */
+    b     = (diff.first_block + task) % diff.n_blocks;
+    start = (off_t)b * RHD_DIFF_BLOCK_LEN;
+    end   = diff.max_len - start > RHD_DIFF_BLOCK_LEN ? start + RHD_DIFF_BLOCK_LEN : diff.max_len;
+    if (end > diff.min_len)
+        result = RHD_DIFF_RESULT_FOUND;
+    else
+        result = diff_range(&diff.bufs[worker * 2 * RHD_DIFF_READ_LEN], start, end, RHD_DIFF_DIR_FORWARD, &hit);
+
+    /* Publish the result (or the failure, that stops the whole comparison) */
+    pthread_mutex_lock(&diff_lock);
+    if (result == RHD_DIFF_RESULT_ERROR) {
+        diff.state = RHD_DIFF_STATE_ERROR;
+        is_due     = 1;
+    } else {
+        RHD_DIFF_BIT_SET(diff.is_done, b);
+        if (result == RHD_DIFF_RESULT_FOUND) {
+            RHD_DIFF_BIT_SET(diff.is_different, b);
+            diff.n_different++;
+        }
+        diff.n_done++;
+        if ((is_due = diff.n_done - diff.notified >= RHD_DIFF_PROGRESS_BLOCKS))
+            diff.notified = diff.n_done;
+        if (diff.n_done == diff.n_blocks && diff.state == RHD_DIFF_STATE_RUNNING) {
+            diff.state = RHD_DIFF_STATE_DONE;
+            is_due     = 1;
+        }
+    }
+    pthread_mutex_unlock(&diff_lock);
+
+    if (result == RHD_DIFF_RESULT_ERROR)
+        pool_cancel(&diff.pool);
+    if (is_due)
+        diff_notify();
+}
+
+
+static diff_result_t diff_range(unsigned char* bufs, const off_t start, const off_t end,
+                                const diff_dir_t dir, off_t* hit) {
+    const unsigned char* views[2];
+    off_t                pos;
+    size_t               n;
+    size_t               i;
+    int                  f;
+
+    /* Read both files "RHD_DIFF_READ_LEN" bytes at a time, from "start" (or backward from "end") */
+    pos = dir == RHD_DIFF_DIR_FORWARD ? start : end;
+    while (dir == RHD_DIFF_DIR_FORWARD ? pos < end : pos > start) {
+        if (dir == RHD_DIFF_DIR_FORWARD)
+            n = end - pos > (off_t)RHD_DIFF_READ_LEN ? RHD_DIFF_READ_LEN : (size_t)(end - pos);
+        else
+            n = pos - start > (off_t)RHD_DIFF_READ_LEN ? RHD_DIFF_READ_LEN : (size_t)(pos - start);
+        if (dir == RHD_DIFF_DIR_BACKWARD)
+            pos -= (off_t)n;
+
+        for (f = 0; f < 2; f++) {
+            if (file_read_at(diff.files[f], &views[f], &bufs[f * RHD_DIFF_READ_LEN], pos, n) != n)
+                return RHD_DIFF_RESULT_ERROR;
+        }
+
+        i = dir == RHD_DIFF_DIR_FORWARD ? diff_first(views[0], views[1], n) : diff_last(views[0], views[1], n);
+        if (i < n) {
+            *hit = pos + (off_t)i;
+            return RHD_DIFF_RESULT_FOUND;
+        }
+        if (dir == RHD_DIFF_DIR_FORWARD)
+            pos += (off_t)n;
+    }
+
+    return RHD_DIFF_RESULT_NOT_FOUND;
+}
+
+
+static void diff_notify(void) {
+    ssize_t ret;
+
+    /* If the pipe is full, a notification is already pending */
+    do {
+        ret = write(diff.pipe_fds[1], "", 1);
+    } while (ret == -1 && errno == EINTR);
+}
+
+
+static void diff_join(void) {
+    if (diff.is_running) {
+        pool_cancel(&diff.pool);
+        pool_join(&diff.pool);
+        diff.is_running = 0;
+    }
+
+    /* Free bitmaps */
+    free(diff.is_done);
+    free(diff.is_different);
+    diff.is_done      = NULL;
+    diff.is_different = NULL;
+    diff.state        = RHD_DIFF_STATE_IDLE;
+}
@@ -0,0 +1,651 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file dump.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for ssize_t, write and pthreads) */
+
+/* C89 standard */
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <pthread.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "abuf.h"
+#include "errors.h"
+#include "file.h"
+#include "format.h"
+#include "offset.h"
+#include "pool.h"
+#include "stats.h"
+
+#include "dump.h"
+
+
+/* Amount of bytes requested to the file layer at once (must be a multiple of RHD_DUMP_ROW_LEN) */
+#define RHD_DUMP_WINDOW_LEN (RHD_DUMP_ROW_LEN * 4096)
+
+/* Size of the output buffer, that is written to stdout only when (almost) full */
+#define RHD_DUMP_BUFFER_LEN (1024 * 1024)
+
+/* Minimum amount of hexadecimal digits of the offset column */
+#define RHD_DUMP_OFFSET_DIGITS 8
+
+/* Column where the hexadecimal bytes start, relative to the end of the offset */
+#define RHD_DUMP_HEXS_COL 2
+
+/* Column where the chars start (after the '|'), relative to the end of the offset */
+#define RHD_DUMP_CHARS_COL (RHD_DUMP_HEXS_COL + RHD_DUMP_ROW_LEN * 3 + 3)
+
+/* Amount of bytes formatted by each task of the pool (must be a multiple of RHD_DUMP_ROW_LEN) */
+#define RHD_DUMP_REGION_LEN (RHD_DUMP_WINDOW_LEN * 16)
+
+/* Dumps shorter than this are not worth starting threads */
+#define RHD_DUMP_PARALLEL_MIN ((off_t)RHD_DUMP_REGION_LEN * 4)
+
+/* Max amount of ranges read at once by dump_ranges() (that read at most RHD_DUMP_WINDOW_LEN bytes) */
+#define RHD_DUMP_BATCH_RANGES 256
+
+/* Max length of a line of the list of ranges (see dump_ranges_file()) */
+#define RHD_DUMP_LINE_MAX 256
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Enum type that describes the state of a slot of the parallel dump
+ */
+typedef enum dump_slot_state_tag {
+    RHD_DUMP_SLOT_FREE,
+    RHD_DUMP_SLOT_BUSY,   /* A thread is formatting a region inside it */
+    RHD_DUMP_SLOT_READY   /* The formatted region is waiting to be written */
+} dump_slot_state_t;
+
+/**
+ * Struct containing the output buffer of a region of the parallel dump
+ */
+typedef struct dump_slot_tag {
+    abuf_t            out;
+    size_t            region;
+    dump_slot_state_t state;
+} dump_slot_t;
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Output buffer
+ */
+static abuf_t output = ABUF_INIT;
+
+/**
+ * Struct containing the parallel dump: regions are formatted by a pool of threads into
+ * "slots" (region "i" uses slot "i % n_slots"), that are written to stdout in order
+ */
+static struct dump_parallel_tag {
+    pthread_mutex_t lock;       /* Protects the states of the slots and "is_failed" */
+    pthread_cond_t  cond;       /* Signaled when the state of a slot (or "is_failed") changes */
+    dump_slot_t     slots[RHD_POOL_THREADS_MAX * 2];
+    size_t          n_slots;
+    unsigned char*  bufs;       /* Region buffer of each thread (used when the file is not memory-mapped) */
+    rhd_file_t*     file;
+    off_t           offset;
+    off_t           end;
+    int             is_failed;  /* 1 if a region couldn't be read, or written */
+} parallel;
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Writes the row of "n" bytes (at most RHD_DUMP_ROW_LEN) found at "offset" into "dst".
+ * Returns the amount of chars written.
+ */
+static size_t dump_format_row(char* dst, const off_t offset, const unsigned char* row, const size_t n);
+
+/**
+ * Dumps the bytes in [offset, end) of the seekable file "f", using a pool of threads.
+ * If successful returns 0, else the same codes of dump_file().
+ */
+static int dump_parallel(rhd_file_t* f, const off_t offset, const off_t end, const size_t n_threads);
+
+/**
+ * Task formatting a region of the parallel dump (run by the pool)
+ */
+static void dump_region(void* ctx, const size_t task, const size_t worker);
+
+/**
+ * Writes the whole buffer "ab" to stdout, and empties it.
+ * If successful returns 0, else 1.
+ */
+static int dump_flush(abuf_t* ab);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int dump_file(rhd_file_t* f, const off_t offset, const off_t length) {
+    const unsigned char* window;
+    dump_squeeze_t       squeeze;
+    off_t                pos;
+    off_t                start;
+    off_t                skip;
+    off_t                end;
+    size_t               len;
+    size_t               n_bytes_read;
+    size_t               n_threads;
+    int                  ret;
+
+    /* Long dumps of seekable files are formatted in parallel */
+    n_threads = pool_threads();
+    if (file_length(f) >= 0 && n_threads > 1) {
+        end = length >= 0 && length < file_length(f) - offset ? offset + length : file_length(f);
+        if (end - offset >= RHD_DUMP_PARALLEL_MIN)
+            return dump_parallel(f, offset, end, n_threads);
+    }
+
+    /* Allocate output buffer */
+    if (ab_reserve(&output, RHD_DUMP_BUFFER_LEN) != 0) {
+        error_queue("ERROR: Couldn't allocate output buffer!");
+        return 1;
+    }
+    ab_reset(&output);
+
+    /* Move to "offset", or to the end of the file if it is past it (streams can't be seeked, so the
+       bytes before "offset" are read and discarded, and "start" is where they ran out, if they did) */
+    if (file_length(f) >= 0) {
+        start = offset < file_length(f) ? offset : file_length(f);
+        if (file_seek_set(f, start) != 0) {
+            error_queue("ERROR: Couldn't move file position indicator!");
+            ab_free(&output);
+            return 2;
+        }
+    } else {
+        for (skip = offset; skip > 0; skip -= (off_t)n_bytes_read) {
+            len = skip < RHD_DUMP_WINDOW_LEN ? (size_t)skip : RHD_DUMP_WINDOW_LEN;
+            if ((n_bytes_read = file_read_window(f, &window, len)) == 0)
+                break;
+        }
+        start = offset - skip;
+    }
+
+    /* Dump rows, squeezing runs of identical rows into a single "*" row (like "hexdump -C") */
+    ret                  = 0;
+    pos                  = start;
+    squeeze.has_prev     = 0;
+    squeeze.is_squeezing = 0;
+    while (length < 0 || pos - start < length) {
+        /* Get next window. Windows are always a multiple of RHD_DUMP_ROW_LEN,
+           except for the last one (at the end of the file or of the given "length") */
+        len = RHD_DUMP_WINDOW_LEN;
+        if (length >= 0 && length - (pos - start) < RHD_DUMP_WINDOW_LEN)
+            len = (size_t)(length - (pos - start));
+        if ((n_bytes_read = file_read_window(f, &window, len)) == 0)
+            break;
+
+        /* Make sure that the output buffer can contain the whole window */
+        if (RHD_DUMP_BUFFER_LEN - output.len < RHD_DUMP_ROWS_MAX(n_bytes_read) && dump_flush(&output) != 0) {
+            ret = 4;
+            break;
+        }
+        output.len += dump_format_rows(&output.b[output.len], pos, window, n_bytes_read, &squeeze);
+
+        pos += (off_t)n_bytes_read;
+    }
+
+    /* An error while reading is different from reaching the end of the file */
+    if (ret == 0 && file_has_error(f)) {
+        error_queue("ERROR: Couldn't read file!");
+        ret = 3;
+    }
+
+    /* The last row only contains the offset of the end of the dump (like "hexdump -C", that shows
+       it also when nothing was dumped, unless it is 0) */
+    if (ret == 0 && pos > 0) {
+        output.len += dump_format_offset(&output.b[output.len], pos);
+        output.b[output.len++] = '\n';
+    }
+
+    if (ret == 0 && dump_flush(&output) != 0)
+        ret = 4;
+
+    ab_free(&output);
+
+    return ret;
+}
+
+
+int dump_ranges(rhd_file_t* f, rhd_range_t* ranges, const size_t n) {
+    rhd_range_t    batch[RHD_DUMP_BATCH_RANGES];
+    dump_squeeze_t squeeze;
+    unsigned char* buf;
+    unsigned char* bytes;
+    off_t          file_len;
+    off_t          done;
+    off_t          len;
+    size_t         batch_len;
+    size_t         n_batch;
+    size_t         n_ranges;
+    size_t         i;
+    size_t         k;
+    int            ret;
+
+    if ((file_len = file_length(f)) < 0) {
+        error_queue("ERROR: Ranges can be dumped only from seekable files!");
+        return 2;
+    }
+
+    /* Clamp the ranges to the end of the file, then sort and merge them */
+    for (i = 0; i < n; i++) {
+        if (ranges[i].offset >= file_len)
+            ranges[i].length = 0;
+        else if (ranges[i].length > file_len - ranges[i].offset)
+            ranges[i].length = file_len - ranges[i].offset;
+    }
+    n_ranges = file_ranges_coalesce(ranges, n);
+
+    /* Allocate output buffer, and the buffer of the batches */
+    if (ab_reserve(&output, RHD_DUMP_BUFFER_LEN) != 0 || (buf = malloc(RHD_DUMP_WINDOW_LEN)) == NULL) {
+        error_queue("ERROR: Couldn't allocate output buffer!");
+        ab_free(&output);
+        return 1;
+    }
+    ab_reset(&output);
+
+    ret  = 0;
+    done = 0;
+    for (i = 0; ret == 0 && i < n_ranges; ) {
+        /* The next batch is made of the next ranges, up to RHD_DUMP_WINDOW_LEN bytes (a range is
+           split only at the end of one of its rows, that start from the start of the range) */
+        batch_len = 0;
+        len       = done;
+        for (n_batch = 0, k = i; k < n_ranges && n_batch < RHD_DUMP_BATCH_RANGES; n_batch++) {
+            batch[n_batch].offset = ranges[k].offset + len;
+            batch[n_batch].length = ranges[k].length - len;
+            if (batch[n_batch].length > (off_t)(RHD_DUMP_WINDOW_LEN - batch_len))
+                batch[n_batch].length = (off_t)((RHD_DUMP_WINDOW_LEN - batch_len) / RHD_DUMP_ROW_LEN * RHD_DUMP_ROW_LEN);
+            if (batch[n_batch].length == 0)
+                break;
+            batch_len += (size_t)batch[n_batch].length;
+            len       += batch[n_batch].length;
+            if (len < ranges[k].length) {
+                n_batch++;
+                break;
+            }
+            len = 0;
+            k++;
+        }
+
+        if (file_read_ranges(f, batch, n_batch, buf) != 0) {
+            error_queue("ERROR: Couldn't read file!");
+            ret = 3;
+            break;
+        }
+
+        /* Make sure that the output buffer can contain the whole batch (with the last row of
+           each range) */
+        if (RHD_DUMP_BUFFER_LEN - output.len < RHD_DUMP_ROWS_MAX(batch_len) + n_batch * 2 * RHD_DUMP_ROW_MAX &&
+            dump_flush(&output) != 0) {
+            ret = 4;
+            break;
+        }
+
+        /* Dump the rows of each range (squeezed like dump_file() does), then its last row */
+        for (bytes = buf, k = 0; k < n_batch; bytes += batch[k++].length) {
+            if (done == 0) {
+                squeeze.has_prev     = 0;
+                squeeze.is_squeezing = 0;
+            }
+            output.len += dump_format_rows(&output.b[output.len], batch[k].offset, bytes, (size_t)batch[k].length, &squeeze);
+            done       += batch[k].length;
+            if (done == ranges[i].length) {
+                output.len += dump_format_offset(&output.b[output.len], ranges[i].offset + done);
+                output.b[output.len++] = '\n';
+                done = 0;
+                i++;
+            }
+        }
+    }
+
+    if (ret == 0 && dump_flush(&output) != 0)
+        ret = 4;
+
+    free(buf);
+    ab_free(&output);
+
+    return ret;
+}
+
+
+int dump_ranges_file(rhd_file_t* f, const char* path) {
+    char          line[RHD_DUMP_LINE_MAX];
+    char          number[32];
+    rhd_range_t   range;
+    rhd_range_t*  ranges;
+    rhd_range_t*  new_ranges;
+    FILE*         list;
+    char*         offset;
+    char*         length;
+    char*         comment;
+    unsigned long n_line;
+    size_t        n;
+    size_t        cap;
+    int           ret;
+
+    if ((list = strcmp(path, RHD_FILE_STDIN) == 0 ? stdin : fopen(path, "r")) == NULL) {
+        error_queue("ERROR: Couldn't open the list of ranges!");
+        return 5;
+    }
+
+    /* Read the ranges, one per line */
+    ret    = 0;
+    ranges = NULL;
+    n      = 0;
+    cap    = 0;
+    for (n_line = 1; ret == 0 && fgets(line, sizeof(line), list) != NULL; n_line++) {
+        if ((comment = strchr(line, '#')) != NULL)
+            *comment = '\0';
+        if ((offset = strtok(line, " \t\r\n")) == NULL)
+            continue;
+        if ((length = strtok(NULL, " \t\r\n")) == NULL || strtok(NULL, " \t\r\n") != NULL ||
+            offset_parse(offset, &range.offset) != 0 || offset_parse(length, &range.length) != 0) {
+            sprintf(number, "%lu", n_line);
+            error_queue("ERROR: Invalid range at line %s of the list of ranges!", number, (const char*)NULL);
+            ret = 5;
+            break;
+        }
+        if (n == cap) {
+            cap = cap == 0 ? 64 : cap * 2;
+            if ((new_ranges = realloc(ranges, cap * sizeof(*ranges))) == NULL) {
+                error_queue("ERROR: Couldn't allocate the list of ranges!");
+                ret = 1;
+                break;
+            }
+            ranges = new_ranges;
+        }
+        ranges[n++] = range;
+    }
+    if (ret == 0 && ferror(list)) {
+        error_queue("ERROR: Couldn't read the list of ranges!");
+        ret = 5;
+    }
+    if (list != stdin)
+        fclose(list);
+
+    if (ret == 0)
+        ret = dump_ranges(f, ranges, n);
+    free(ranges);
+
+    return ret;
+}
+
+
+size_t dump_format_offset(char* dst, off_t offset) {
+    const char* digits = "0123456789abcdef";
+    char        temp[sizeof(off_t) * 2];
+    size_t      n_digits;
+    size_t      i;
+
+    /* Get digits (from the least significant one) */
+    n_digits = 0;
+    do {
+        temp[n_digits++] = digits[offset & 0x0F];
+        offset >>= 4;
+    } while (offset > 0);
+
+    /* Pad with zeros, then copy digits in the correct order */
+    for (i = 0; n_digits + i < RHD_DUMP_OFFSET_DIGITS; i++)
+        dst[i] = '0';
+    while (n_digits > 0)
+        dst[i++] = temp[--n_digits];
+
+    return i;
+}
+
+
+size_t dump_format_rows(char* dst, const off_t pos, const unsigned char* data, const size_t n, dump_squeeze_t* squeeze) {
+    size_t len;
+    size_t row_len;
+    size_t i;
+
+    for (len = 0, i = 0; i < n; i += row_len) {
+        row_len = n - i < RHD_DUMP_ROW_LEN ? n - i : RHD_DUMP_ROW_LEN;
+
+        if (row_len == RHD_DUMP_ROW_LEN && squeeze->has_prev && memcmp(squeeze->prev, &data[i], RHD_DUMP_ROW_LEN) == 0) {
+            if (!squeeze->is_squeezing) {
+                dst[len++] = '*';
+                dst[len++] = '\n';
+                squeeze->is_squeezing = 1;
+            }
+        } else {
+            len += dump_format_row(&dst[len], pos + (off_t)i, &data[i], row_len);
+            squeeze->is_squeezing = 0;
+        }
+
+        memcpy(squeeze->prev, &data[i], row_len);
+        squeeze->has_prev = 1;
+    }
+
+    return len;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static size_t dump_format_row(char* dst, const off_t offset, const unsigned char* row, const size_t n) {
+    char*  hexs;
+    char*  chars;
+    size_t offset_len;
+
+    offset_len = dump_format_offset(dst, offset);
+    hexs       = &dst[offset_len + RHD_DUMP_HEXS_COL];
+    chars      = &dst[offset_len + RHD_DUMP_CHARS_COL];
+
+    /* Columns not written below (missing bytes of short rows and separators) are spaces */
+    memset(&dst[offset_len], ' ', RHD_DUMP_CHARS_COL - 1);
+
+    /* Hexadecimal bytes are written all at once ("xx xx ... xx "), and then the second
+       half of the row is moved one column to the right, to separate the two halves */
+    format_hexs(hexs, row, n, RHD_FORMAT_CASE_LOWER);
+    if (n > RHD_DUMP_ROW_LEN / 2) {
+        memmove(&hexs[RHD_DUMP_ROW_LEN / 2 * 3 + 1], &hexs[RHD_DUMP_ROW_LEN / 2 * 3], (n - RHD_DUMP_ROW_LEN / 2) * 3);
+        hexs[RHD_DUMP_ROW_LEN / 2 * 3] = ' ';
+    }
+
+    /* Chars are surrounded by '|' */
+    chars[-1] = '|';
+    format_chars(chars, row, n);
+    chars[n]     = '|';
+    chars[n + 1] = '\n';
+
+    return offset_len + RHD_DUMP_CHARS_COL + n + 2;
+}
+
+
+static int dump_parallel(rhd_file_t* f, const off_t offset, const off_t end, const size_t n_threads) {
+    pool_t       pool;
+    dump_slot_t* slot;
+    size_t       n_regions;
+    size_t       i;
+    int          is_started;
+    int          ret;
+
+    /* Allocate output buffer (for the last row), and the region buffers */
+    if (ab_reserve(&output, RHD_DUMP_ROW_MAX) != 0 ||
+        (parallel.bufs = malloc(n_threads * (RHD_DUMP_REGION_LEN + 2 * RHD_DUMP_ROW_LEN))) == NULL) {
+        error_queue("ERROR: Couldn't allocate output buffer!");
+        ab_free(&output);
+        return 1;
+    }
+    ab_reset(&output);
+
+    /* The kernels must be selected before multiple threads can use them */
+    format_init();
+
+    parallel.file      = f;
+    parallel.offset    = offset;
+    parallel.end       = end;
+    parallel.is_failed = 0;
+    parallel.n_slots   = n_threads * 2;
+    for (i = 0; i < parallel.n_slots; i++)
+        parallel.slots[i].state = RHD_DUMP_SLOT_FREE;
+    pthread_mutex_init(&parallel.lock, NULL);
+    pthread_cond_init(&parallel.cond, NULL);
+
+    /* Format the regions in parallel, and write them in order as soon as they are ready */
+    ret       = 0;
+    n_regions = (size_t)((end - offset + RHD_DUMP_REGION_LEN - 1) / RHD_DUMP_REGION_LEN);
+    if (!(is_started = pool_start(&pool, n_threads, n_regions, dump_region, NULL) == 0)) {
+        error_queue("ERROR: Couldn't start threads!");
+        ret = 1;
+    }
+    for (i = 0; ret == 0 && i < n_regions; i++) {
+        slot = &parallel.slots[i % parallel.n_slots];
+
+        pthread_mutex_lock(&parallel.lock);
+        while (!parallel.is_failed && !(slot->state == RHD_DUMP_SLOT_READY && slot->region == i))
+            pthread_cond_wait(&parallel.cond, &parallel.lock);
+        pthread_mutex_unlock(&parallel.lock);
+        if (parallel.is_failed) {
+            error_queue("ERROR: Couldn't read file!");
+            ret = 3;
+            break;
+        }
+
+        if (dump_flush(&slot->out) != 0)
+            ret = 4;
+
+        pthread_mutex_lock(&parallel.lock);
+        slot->state = RHD_DUMP_SLOT_FREE;
+        if (ret != 0)
+            parallel.is_failed = 1;
+        pthread_cond_broadcast(&parallel.cond);
+        pthread_mutex_unlock(&parallel.lock);
+    }
+    if (is_started) {
+        pool_cancel(&pool);
+        pool_join(&pool);
+    }
+
+    /* The last row only contains the offset of the end of the dump */
+    if (ret == 0) {
+        output.len += dump_format_offset(&output.b[output.len], end);
+        output.b[output.len++] = '\n';
+        if (dump_flush(&output) != 0)
+            ret = 4;
+    }
+
+    for (i = 0; i < parallel.n_slots; i++)
+        ab_free(&parallel.slots[i].out);
+    free(parallel.bufs);
+    parallel.bufs = NULL;
+    pthread_cond_destroy(&parallel.cond);
+    pthread_mutex_destroy(&parallel.lock);
+    ab_free(&output);
+
+    return ret;
+}
+
+
+static void dump_region(void* ctx, const size_t task, const size_t worker) {
+    const unsigned char* view;
+    dump_squeeze_t       squeeze;
+    dump_slot_t*         slot;
+    off_t                start;
+    size_t               back;
+    size_t               len;
+    size_t               n;
+    int                  is_failed;
+
+    (void)ctx;
+
+    /* Wait for the slot of the region to be written */
+    slot = &parallel.slots[task % parallel.n_slots];
+    pthread_mutex_lock(&parallel.lock);
+    while (!parallel.is_failed && slot->state != RHD_DUMP_SLOT_FREE)
+        pthread_cond_wait(&parallel.cond, &parallel.lock);
+    if (parallel.is_failed) {
+        pthread_mutex_unlock(&parallel.lock);
+        return;
+    }
+    slot->state = RHD_DUMP_SLOT_BUSY;
+    pthread_mutex_unlock(&parallel.lock);
+
+    /* Read the region, together with the two rows before it (if dumped), that give the
+       squeezing state where the region starts */
+    start = parallel.offset + (off_t)task * RHD_DUMP_REGION_LEN;
+    len   = parallel.end - start < RHD_DUMP_REGION_LEN ? (size_t)(parallel.end - start) : RHD_DUMP_REGION_LEN;
+    back  = start > parallel.offset ? 2 * RHD_DUMP_ROW_LEN : 0;
+    n     = file_read_at(parallel.file, &view, &parallel.bufs[worker * (RHD_DUMP_REGION_LEN + 2 * RHD_DUMP_ROW_LEN)],
+                         start - (off_t)back, back + len);
+
+    /* Format the region */
+    is_failed = n != back + len || ab_reserve(&slot->out, RHD_DUMP_ROWS_MAX(len)) != 0;
+    if (!is_failed) {
+        squeeze.has_prev     = back > 0;
+        squeeze.is_squeezing = back > 0 && memcmp(view, &view[RHD_DUMP_ROW_LEN], RHD_DUMP_ROW_LEN) == 0;
+        if (back > 0)
+            memcpy(squeeze.prev, &view[RHD_DUMP_ROW_LEN], RHD_DUMP_ROW_LEN);
+        ab_reset(&slot->out);
+        slot->out.len = dump_format_rows(slot->out.b, start, &view[back], len, &squeeze);
+    }
+
+    pthread_mutex_lock(&parallel.lock);
+    if (is_failed) {
+        parallel.is_failed = 1;
+    } else {
+        slot->region = task;
+        slot->state  = RHD_DUMP_SLOT_READY;
+    }
+    pthread_cond_broadcast(&parallel.cond);
+    pthread_mutex_unlock(&parallel.lock);
+}
+
+
+static int dump_flush(abuf_t* ab) {
+    ssize_t n_bytes_written;
+    size_t  i;
+
+    /* Write the whole buffer, even if write() writes it in multiple parts */
+    for (i = 0; i < ab->len; i += (size_t)n_bytes_written) {
+        if ((n_bytes_written = write(STDOUT_FILENO, &ab->b[i], ab->len - i)) == -1) {
+            if (errno == EINTR) {
+                n_bytes_written = 0;
+                continue;
+            }
+            error_queue("ERROR: Function write() failed!");
+            return 1;
+        }
+        stats_add(RHD_STATS_WRITES, 1);
+        stats_add(RHD_STATS_WRITTEN, (unsigned long)n_bytes_written);
+    }
+
+    ab_reset(ab);
+    return 0;
+}
@@ -0,0 +1,344 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file edits.c */
+
+
+/* C89 standard */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "edits.h"
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Makes room for (at least) "n" pieces in the "pieces" array of capacity "cap".
+ * If successful returns 0, else 1.
+ */
+static int edits_reserve(edits_piece_t** pieces, size_t* cap, const size_t n);
+
+/**
+ * Returns the index of the first piece ending after "pos", or "edits->n_pieces" if there is none.
+ */
+static size_t edits_find(const edits_t* edits, const off_t pos);
+
+/**
+ * Removes the "len" bytes starting from "pos" from the pieces (trimming, or splitting, the ones
+ * only partly inside them), appending the parts removed to "replaced" if "is_kept".
+ * There must be room for one more piece (for the split).
+ * If successful returns 0, else 1 (then the pieces are left untouched).
+ */
+static int edits_clip(edits_t* edits, const off_t pos, const size_t len, const int is_kept);
+
+/**
+ * Inserts the piece of "len" bytes starting from "pos" (that must not be part of any piece), of the
+ * bytes of "added" starting from "add", merging it with its neighbours when they are contiguous.
+ * There must be room for one more piece.
+ */
+static void edits_insert(edits_t* edits, const off_t pos, const size_t len, const size_t add);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int edits_write(edits_t* edits, const off_t pos, const unsigned char* bytes, const size_t len) {
+    edits_change_t* new_changes;
+    unsigned char*  new_added;
+    edits_change_t  change;
+    size_t          new_cap;
+
+    if (len == 0)
+        return 0;
+
+    /* Make room for the change, its bytes, and its pieces (the change may split a piece in two) */
+    if (edits->n_applied == edits->changes_cap) {
+        new_cap = edits->changes_cap == 0 ? 64 : edits->changes_cap * 2;
+        if ((new_changes = realloc(edits->changes, new_cap * sizeof(*edits->changes))) == NULL)
+            return 1;
+        edits->changes     = new_changes;
+        edits->changes_cap = new_cap;
+    }
+    if (edits->added_cap - edits->added_len < len) {
+        for (new_cap = edits->added_cap == 0 ? 4096 : edits->added_cap; new_cap - edits->added_len < len; new_cap *= 2)
+            ;
+        if ((new_added = realloc(edits->added, new_cap)) == NULL)
+            return 1;
+        edits->added     = new_added;
+        edits->added_cap = new_cap;
+    }
+    if (edits_reserve(&edits->pieces, &edits->pieces_cap, edits->n_pieces + 2) != 0)
+        return 1;
+
+    /* The changes undone can't be redone anymore (as the pieces they replaced may change) */
+    if (edits->n_applied < edits->n_changes) {
+        edits->n_replaced = edits->changes[edits->n_applied].replaced_first;
+        edits->n_changes  = edits->n_applied;
+    }
+
+    /* The bytes are appended, and replace the pieces in their range (that are kept, to undo it) */
+    change.pos            = pos;
+    change.len            = len;
+    change.add            = edits->added_len;
+    change.replaced_first = edits->n_replaced;
+    if (edits_clip(edits, pos, len, 1) != 0) {
+        edits->n_replaced = change.replaced_first;
+        return 1;
+    }
+    change.n_replaced = edits->n_replaced - change.replaced_first;
+    memcpy(&edits->added[edits->added_len], bytes, len);
+    edits->added_len += len;
+    edits_insert(edits, pos, len, change.add);
+
+    edits->changes[edits->n_changes++] = change;
+    edits->n_applied                   = edits->n_changes;
+
+    return 0;
+}
+
+
+int edits_undo(edits_t* edits, off_t* pos) {
+    const edits_change_t* change;
+    size_t                i;
+
+    *pos = -1;
+    if (edits->n_applied == 0)
+        return 0;
+    change = &edits->changes[edits->n_applied - 1];
+
+    /* The piece of the change is replaced by the pieces it replaced (removing it may split the
+       piece it was merged into) */
+    if (edits_reserve(&edits->pieces, &edits->pieces_cap, edits->n_pieces + change->n_replaced + 1) != 0)
+        return 1;
+    edits_clip(edits, change->pos, change->len, 0);
+    for (i = 0; i < change->n_replaced; i++)
+        edits_insert(edits, edits->replaced[change->replaced_first + i].pos, edits->replaced[change->replaced_first + i].len,
+                     edits->replaced[change->replaced_first + i].add);
+
+    edits->n_applied--;
+    *pos = change->pos;
+
+    return 0;
+}
+
+
+int edits_redo(edits_t* edits, off_t* pos) {
+    const edits_change_t* change;
+
+    *pos = -1;
+    if (edits->n_applied == edits->n_changes)
+        return 0;
+    change = &edits->changes[edits->n_applied];
+
+    /* (the pieces it replaced are still the ones kept when it was written) */
+    if (edits_reserve(&edits->pieces, &edits->pieces_cap, edits->n_pieces + 2) != 0)
+        return 1;
+    edits_clip(edits, change->pos, change->len, 0);
+    edits_insert(edits, change->pos, change->len, change->add);
+
+    edits->n_applied++;
+    *pos = change->pos;
+
+    return 0;
+}
+
+
+int edits_is_changed(const edits_t* edits, const off_t pos, const size_t len) {
+    size_t i;
+
+    i = edits_find(edits, pos);
+    return i < edits->n_pieces && edits->pieces[i].pos < pos + (off_t)len;
+}
+
+
+void edits_apply(const edits_t* edits, unsigned char* dst, const off_t pos, const size_t len) {
+    const edits_piece_t* piece;
+    off_t                end;
+    off_t                from;
+    off_t                to;
+    size_t               i;
+
+    end = pos + (off_t)len;
+    for (i = edits_find(edits, pos); i < edits->n_pieces && edits->pieces[i].pos < end; i++) {
+        piece = &edits->pieces[i];
+        from  = piece->pos > pos ? piece->pos : pos;
+        to    = piece->pos + (off_t)piece->len < end ? piece->pos + (off_t)piece->len : end;
+        memcpy(&dst[from - pos], &edits->added[piece->add + (size_t)(from - piece->pos)], (size_t)(to - from));
+    }
+}
+
+
+void edits_free(edits_t* edits) {
+    free(edits->pieces);
+    free(edits->added);
+    free(edits->changes);
+    free(edits->replaced);
+    edits->pieces       = NULL;
+    edits->n_pieces     = 0;
+    edits->pieces_cap   = 0;
+    edits->added        = NULL;
+    edits->added_len    = 0;
+    edits->added_cap    = 0;
+    edits->changes      = NULL;
+    edits->n_changes    = 0;
+    edits->n_applied    = 0;
+    edits->changes_cap  = 0;
+    edits->replaced     = NULL;
+    edits->n_replaced   = 0;
+    edits->replaced_cap = 0;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static int edits_reserve(edits_piece_t** pieces, size_t* cap, const size_t n) {
+    edits_piece_t* new_pieces;
+    size_t         new_cap;
+
+    if (n <= *cap)
+        return 0;
+    for (new_cap = *cap == 0 ? 16 : *cap; new_cap < n; new_cap *= 2)
+        ;
+    if ((new_pieces = realloc(*pieces, new_cap * sizeof(**pieces))) == NULL)
+        return 1;
+    *pieces = new_pieces;
+    *cap    = new_cap;
+
+    return 0;
+}
+
+
+static size_t edits_find(const edits_t* edits, const off_t pos) {
+    size_t lo;
+    size_t hi;
+    size_t mid;
+
+    lo = 0;
+    hi = edits->n_pieces;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (edits->pieces[mid].pos + (off_t)edits->pieces[mid].len <= pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+
+static int edits_clip(edits_t* edits, const off_t pos, const size_t len, const int is_kept) {
+    edits_piece_t* piece;
+    off_t          end;
+    off_t          from;
+    off_t          to;
+    size_t         first;
+    size_t         last;
+
+    /* Keep the parts of the pieces inside the range (before touching them) */
+    end   = pos + (off_t)len;
+    first = edits_find(edits, pos);
+    for (last = first; last < edits->n_pieces && edits->pieces[last].pos < end; last++) {
+        if (!is_kept)
+            continue;
+        if (edits_reserve(&edits->replaced, &edits->replaced_cap, edits->n_replaced + 1) != 0)
+            return 1;
+        piece = &edits->pieces[last];
+        from  = piece->pos > pos ? piece->pos : pos;
+        to    = piece->pos + (off_t)piece->len < end ? piece->pos + (off_t)piece->len : end;
+        edits->replaced[edits->n_replaced].pos = from;
+        edits->replaced[edits->n_replaced].len = (size_t)(to - from);
+        edits->replaced[edits->n_replaced].add = piece->add + (size_t)(from - piece->pos);
+        edits->n_replaced++;
+    }
+    if (first == last)
+        return 0;
+
+    /* A piece around the whole range is split in two */
+    piece = &edits->pieces[first];
+    if (last - first == 1 && piece->pos < pos && piece->pos + (off_t)piece->len > end) {
+        memmove(&edits->pieces[first + 2], &edits->pieces[first + 1], (edits->n_pieces - first - 1) * sizeof(*edits->pieces));
+        edits->pieces[first + 1].pos = end;
+        edits->pieces[first + 1].len = (size_t)(piece->pos + (off_t)piece->len - end);
+        edits->pieces[first + 1].add = piece->add + (size_t)(end - piece->pos);
+        piece->len                   = (size_t)(pos - piece->pos);
+        edits->n_pieces++;
+        return 0;
+    }
+
+    /* Else the first piece may start before the range, the last may end after it, and the ones
+       in between are removed */
+    if (piece->pos < pos) {
+        piece->len = (size_t)(pos - piece->pos);
+        first++;
+    }
+    piece = &edits->pieces[last - 1];
+    if (first < last && piece->pos + (off_t)piece->len > end) {
+        piece->add += (size_t)(end - piece->pos);
+        piece->len -= (size_t)(end - piece->pos);
+        piece->pos  = end;
+        last--;
+    }
+    memmove(&edits->pieces[first], &edits->pieces[last], (edits->n_pieces - last) * sizeof(*edits->pieces));
+    edits->n_pieces -= last - first;
+
+    return 0;
+}
+
+
+static void edits_insert(edits_t* edits, const off_t pos, const size_t len, const size_t add) {
+    edits_piece_t* prev;
+    edits_piece_t* next;
+    size_t         i;
+
+    i    = edits_find(edits, pos);
+    prev = i > 0 ? &edits->pieces[i - 1] : NULL;
+    next = i < edits->n_pieces ? &edits->pieces[i] : NULL;
+
+    /* Bytes written one after the other are contiguous in "added" too, so they make a single piece */
+    if (prev != NULL && prev->pos + (off_t)prev->len == pos && prev->add + prev->len == add) {
+        prev->len += len;
+        if (next != NULL && next->pos == pos + (off_t)len && next->add == add + len) {
+            prev->len += next->len;
+            memmove(next, next + 1, (edits->n_pieces - i - 1) * sizeof(*edits->pieces));
+            edits->n_pieces--;
+        }
+        return;
+    }
+    if (next != NULL && next->pos == pos + (off_t)len && next->add == add + len) {
+        next->pos  = pos;
+        next->len += len;
+        next->add  = add;
+        return;
+    }
+
+    memmove(&edits->pieces[i + 1], &edits->pieces[i], (edits->n_pieces - i) * sizeof(*edits->pieces));
+    edits->pieces[i].pos = pos;
+    edits->pieces[i].len = len;
+    edits->pieces[i].add = add;
+    edits->n_pieces++;
+}
@@ -0,0 +1,412 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file entropy.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for pthreads, pipe and fcntl) */
+
+/* C89 standard */
+#include <errno.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/* POSIX standard */
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "pool.h"
+
+#include "entropy.h"
+
+
+/* Bytes read at once from the file (the read buffer of each thread is this long) */
+#define RHD_ENTROPY_READ_LEN ((size_t)1 << 16)
+
+/* Buckets scanned between two progress notifications */
+#define RHD_ENTROPY_PROGRESS_BUCKETS 16
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Task scanning a bucket of the file (run by the pool)
+ */
+static void entropy_scan(void* ctx, const size_t task, const size_t worker);
+
+/**
+ * Adds to "counts" the "n" bytes of "bytes", counting them into four interleaved histograms
+ * (then summed into "counts")
+ */
+static void entropy_count(unsigned long* counts, const unsigned char* bytes, const size_t n);
+
+/**
+ * Returns the entropy (in hundredths of a bit per byte) of the "n" bytes counted in "counts"
+ */
+static unsigned int entropy_from_counts(const unsigned long* counts, const unsigned long n);
+
+/**
+ * Makes entropy_fd() readable
+ */
+static void entropy_notify(void);
+
+/**
+ * Stops the background scan (if any), waits for it, and frees the map
+ */
+static void entropy_join(void);
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Mutex protecting the fields of "entropy" shared with the background threads
+ */
+static pthread_mutex_t entropy_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Struct containing the background scan, and the map it builds
+ */
+static struct entropy_tag {
+    pool_t            pool;
+    int               is_running;    /* 1 if "pool" was started and not joined yet */
+    int               is_pipe_open;
+    int               pipe_fds[2];   /* The background threads write to [1], entropy_fd() is [0] */
+    rhd_file_t*       file;          /* File being scanned */
+    off_t             len;           /* Length of the file when the scan started */
+    off_t             bucket_len;    /* Length of each bucket (except the last one, that can be shorter) */
+    size_t            n_buckets;
+    size_t            first_bucket;  /* Bucket scanned first (the tasks of the pool wrap around from it) */
+    unsigned char*    bufs;          /* Read buffers of each thread (used when the file is not memory-mapped) */
+
+    /* Shared with the background threads (protected by "entropy_lock") */
+    entropy_state_t   state;
+    entropy_bucket_t* buckets;
+    size_t            n_done;
+    size_t            notified;      /* Value of "n_done" at the last progress notification */
+} entropy;
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+unsigned int entropy_of(const unsigned char* bytes, const size_t n) {
+    unsigned long counts[256];
+    size_t        c;
+
+    for (c = 0; c < 256; c++)
+        counts[c] = 0;
+    entropy_count(counts, bytes, n);
+
+    return entropy_from_counts(counts, (unsigned long)n);
+}
+
+
+int entropy_start(rhd_file_t* f, const off_t from) {
+    size_t n_threads;
+    size_t b;
+    off_t  len;
+    int    i;
+
+    if ((len = file_length(f)) < 0)
+        return 1;
+
+    /* Stop previous scan (its threads still read the file it was scanning) */
+    entropy_join();
+    entropy.file = f;
+    entropy.len  = len;
+
+    /* Open notification pipe (reused by following scans). Both ends of the pipe
+       are non blocking, so that notifying never blocks the background threads */
+    if (!entropy.is_pipe_open) {
+        if (pipe(entropy.pipe_fds) == -1)
+            return 1;
+        entropy.is_pipe_open = 1;
+        for (i = 0; i < 2; i++) {
+            if (fcntl(entropy.pipe_fds[i], F_SETFL, fcntl(entropy.pipe_fds[i], F_GETFL) | O_NONBLOCK) == -1 ||
+                fcntl(entropy.pipe_fds[i], F_SETFD, FD_CLOEXEC) == -1)
+                return 1;
+        }
+    }
+
+    /* Split the file in (at most) RHD_ENTROPY_BUCKETS buckets, and allocate the map, and the read
+       buffers (reused by following scans) */
+    n_threads          = pool_threads();
+    entropy.bucket_len = len > 0 ? (len + RHD_ENTROPY_BUCKETS - 1) / RHD_ENTROPY_BUCKETS : 1;
+    entropy.n_buckets  = (size_t)((len + entropy.bucket_len - 1) / entropy.bucket_len);
+    if ((entropy.buckets = calloc(entropy.n_buckets + 1, sizeof(entropy_bucket_t))) == NULL)
+        return 1;
+    if (entropy.bufs == NULL && (entropy.bufs = malloc(n_threads * RHD_ENTROPY_READ_LEN)) == NULL)
+        return 1;
+    for (b = 0; b < entropy.n_buckets; b++) {
+        entropy.buckets[b].start = (off_t)b * entropy.bucket_len;
+        entropy.buckets[b].len   = len - entropy.buckets[b].start < entropy.bucket_len ? len - entropy.buckets[b].start
+                                                                                       : entropy.bucket_len;
+    }
+
+    entropy.first_bucket = from > 0 && from < len ? (size_t)(from / entropy.bucket_len) : 0;
+    entropy.n_done       = 0;
+    entropy.notified     = 0;
+    entropy.state        = RHD_ENTROPY_STATE_RUNNING;
+
+    /* Empty files have nothing to scan */
+    if (entropy.n_buckets == 0) {
+        entropy.state = RHD_ENTROPY_STATE_DONE;
+        entropy_notify();
+        return 0;
+    }
+
+    if (pool_start(&entropy.pool, n_threads, entropy.n_buckets, entropy_scan, NULL) != 0) {
+        entropy.state = RHD_ENTROPY_STATE_IDLE;
+        return 1;
+    }
+    entropy.is_running = 1;
+
+    return 0;
+}
+
+
+int entropy_fd(void) {
+    return entropy.is_pipe_open ? entropy.pipe_fds[0] : -1;
+}
+
+
+entropy_state_t entropy_poll(size_t* scanned, size_t* total) {
+    char            buf[64];
+    entropy_state_t state;
+
+    /* Empty notification pipe */
+    if (entropy.is_pipe_open) {
+        while (read(entropy.pipe_fds[0], buf, sizeof(buf)) > 0)
+            ;
+    }
+
+    pthread_mutex_lock(&entropy_lock);
+    state = entropy.state;
+    if (total != NULL) {
+        *scanned = entropy.n_done;
+        *total   = entropy.n_buckets;
+    }
+    pthread_mutex_unlock(&entropy_lock);
+
+    /* Join ended background threads */
+    if (state != RHD_ENTROPY_STATE_RUNNING && entropy.is_running) {
+        pool_join(&entropy.pool);
+        entropy.is_running = 0;
+    }
+
+    return state;
+}
+
+
+size_t entropy_buckets(void) {
+    return entropy.buckets != NULL ? entropy.n_buckets : 0;
+}
+
+
+size_t entropy_bucket_of(const off_t pos) {
+    size_t b;
+
+    if (entropy.n_buckets == 0 || pos <= 0)
+        return 0;
+    b = (size_t)(pos / entropy.bucket_len);
+
+    return b < entropy.n_buckets ? b : entropy.n_buckets - 1;
+}
+
+
+int entropy_bucket(const size_t i, entropy_bucket_t* bucket) {
+    if (entropy.buckets == NULL || i >= entropy.n_buckets)
+        return 1;
+
+    pthread_mutex_lock(&entropy_lock);
+    *bucket = entropy.buckets[i];
+    pthread_mutex_unlock(&entropy_lock);
+
+    return 0;
+}
+
+
+int entropy_stop(void) {
+    int ret;
+
+    entropy_join();
+
+    /* Free read buffers, and close notification pipe */
+    free(entropy.bufs);
+    entropy.bufs = NULL;
+    ret = 0;
+    if (entropy.is_pipe_open) {
+        if (close(entropy.pipe_fds[0]) == -1)
+            ret = 1;
+        if (close(entropy.pipe_fds[1]) == -1)
+            ret = 1;
+        entropy.is_pipe_open = 0;
+    }
+
+    return ret;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static void entropy_scan(void* ctx, const size_t task, const size_t worker) {
+    unsigned long        counts[256];
+    unsigned char*       buf;
+    const unsigned char* view;
+    entropy_bucket_t*    bucket;
+    off_t                chunk_len;
+    off_t                pos;
+    off_t                end;
+    unsigned long        n_counted;
+    size_t               n;
+    size_t               k;
+    size_t               n_chunks;
+    size_t               c;
+    int                  is_failed;
+    int                  is_due;
+
+    (void)ctx;
+
+    /* Sample the bucket: all of it if short enough, else some chunks spread evenly over it */
+    bucket    = &entropy.buckets[(entropy.first_bucket + task) % entropy.n_buckets];
+    buf       = &entropy.bufs[worker * RHD_ENTROPY_READ_LEN];
+    n_chunks  = bucket->len > (off_t)RHD_ENTROPY_SAMPLE_LEN ? RHD_ENTROPY_SAMPLE_CHUNKS : 1;
+    chunk_len = n_chunks > 1 ? (off_t)(RHD_ENTROPY_SAMPLE_LEN / RHD_ENTROPY_SAMPLE_CHUNKS) : bucket->len;
+    for (c = 0; c < 256; c++)
+        counts[c] = 0;
+    n_counted = 0;
+    is_failed = 0;
+    for (k = 0; k < n_chunks && !is_failed; k++) {
+        pos = bucket->start + (n_chunks > 1 ? (bucket->len - chunk_len) / (off_t)(n_chunks - 1) * (off_t)k : 0);
+        end = pos + chunk_len;
+        for (; pos < end; pos += (off_t)n) {
+            n = end - pos > (off_t)RHD_ENTROPY_READ_LEN ? RHD_ENTROPY_READ_LEN : (size_t)(end - pos);
+            if (file_read_at(entropy.file, &view, buf, pos, n) != n) {
+                is_failed = 1;
+                break;
+            }
+            entropy_count(counts, view, n);
+            n_counted += (unsigned long)n;
+        }
+    }
+
+    /* Publish the result (or the failure, that stops the whole scan) */
+    pthread_mutex_lock(&entropy_lock);
+    if (is_failed) {
+        entropy.state = RHD_ENTROPY_STATE_ERROR;
+        is_due        = 1;
+    } else {
+        bucket->is_done = 1;
+        bucket->is_zero = counts[0] == n_counted;
+        bucket->entropy = entropy_from_counts(counts, n_counted);
+        entropy.n_done++;
+        if ((is_due = entropy.n_done - entropy.notified >= RHD_ENTROPY_PROGRESS_BUCKETS))
+            entropy.notified = entropy.n_done;
+        if (entropy.n_done == entropy.n_buckets && entropy.state == RHD_ENTROPY_STATE_RUNNING) {
+            entropy.state = RHD_ENTROPY_STATE_DONE;
+            is_due        = 1;
+        }
+    }
+    pthread_mutex_unlock(&entropy_lock);
+
+    if (is_failed)
+        pool_cancel(&entropy.pool);
+    if (is_due)
+        entropy_notify();
+}
+
+
+static void entropy_count(unsigned long* counts, const unsigned char* bytes, const size_t n) {
+    unsigned long lanes[4][256];
+    size_t        i;
+    size_t        c;
+
+    for (c = 0; c < 256; c++)
+        lanes[0][c] = lanes[1][c] = lanes[2][c] = lanes[3][c] = 0;
+
+    /* Four bytes per step, each one into its own histogram: runs of equal bytes (like zero fills)
+       don't serialize on incrementing the same counter */
+    for (i = 0; i + 4 <= n; i += 4) {
+        lanes[0][bytes[i]]++;
+        lanes[1][bytes[i + 1]]++;
+        lanes[2][bytes[i + 2]]++;
+        lanes[3][bytes[i + 3]]++;
+    }
+    for (; i < n; i++)
+        lanes[0][bytes[i]]++;
+
+    for (c = 0; c < 256; c++)
+        counts[c] += lanes[0][c] + lanes[1][c] + lanes[2][c] + lanes[3][c];
+}
+
+
+static unsigned int entropy_from_counts(const unsigned long* counts, const unsigned long n) {
+    double bits;
+    double p;
+    size_t c;
+
+    if (n == 0)
+        return 0;
+
+    /* H = -sum(p * log2(p)), over the byte values that appear */
+    bits = 0.0;
+    for (c = 0; c < 256; c++) {
+        if (counts[c] > 0) {
+            p     = (double)counts[c] / (double)n;
+            bits -= p * log(p);
+        }
+    }
+    bits = bits / log(2.0) * 100.0 + 0.5;
+
+    return bits < RHD_ENTROPY_MAX ? (unsigned int)bits : RHD_ENTROPY_MAX;
+}
+
+
+static void entropy_notify(void) {
+    ssize_t ret;
+
+    /* If the pipe is full, a notification is already pending */
+    do {
+        ret = write(entropy.pipe_fds[1], "", 1);
+    } while (ret == -1 && errno == EINTR);
+}
+
+
+static void entropy_join(void) {
+    if (entropy.is_running) {
+        pool_cancel(&entropy.pool);
+        pool_join(&entropy.pool);
+        entropy.is_running = 0;
+    }
+
+    /* Free map */
+    pthread_mutex_lock(&entropy_lock);
+    free(entropy.buckets);
+    entropy.buckets   = NULL;
+    entropy.n_buckets = 0;
+    entropy.state     = RHD_ENTROPY_STATE_IDLE;
+    pthread_mutex_unlock(&entropy_lock);
+}
@@ -24,23 +24,68 @@
 /** @file file.c */
 
 
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for fileno, fseeko, ftello, mmap, fstat, pread,
+                              posix_fadvise, posix_madvise and pthreads) */
+
+/* Linux also has preadv() (see file_read_ranges()) */
+#ifdef __linux__
+#define _DEFAULT_SOURCE
+#define RHD_FILE_PREADV
+#endif
+
 /* C89 standard */
-#include <ctype.h>
+#include <errno.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* POSIX standard */
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Linux */
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/uio.h>
+#endif
+
 #include "abuf.h"
+#include "edits.h"
+#include "format.h"
+#include "gzindex.h"
+#include "stats.h"
 
 #include "file.h"
 
 
-/* Macros to convert char to hex */
-#define CHAR_TO_HEX_UPPER(c) ((((c) & 0xF0) >> 4) < '\xA' ? ((((c) & 0xF0) >> 4) + '0') : ((((c) & 0xF0) >> 4) + 'A' - '\xA'))
-#define CHAR_TO_HEX_LOWER(c) (((c) & 0x0F) < '\xA' ? (((c) & 0x0F) + '0') : (((c) & 0x0F) + 'A' - '\xA'))
+#define RHD_FILE_OPTIONS_INIT {0, 0, 0, RHD_FILE_STREAM_WINDOW}
+
+/* Default amount of the last bytes of a stream that are kept (see file_stream()) */
+#define RHD_FILE_STREAM_WINDOW ((off_t)1 << 26)
+
+/* Max amount of bytes read from a stream by each file_stream_pull() call, and by each read() */
+#define RHD_FILE_STREAM_PULL_MAX ((size_t)1 << 20)
+#define RHD_FILE_STREAM_READ_LEN ((size_t)1 << 16)
+
+/* Length of the pages of the page cache (RHD_FILE_BACKEND_CACHE only), and amount of pages */
+#define RHD_FILE_PAGE_LEN    ((size_t)1 << 16)
+#define RHD_FILE_CACHE_PAGES 64
 
-#define RHD_FILE_INIT {RHD_FILE_STATE_CLOSE, 0, NULL}
+/* Max amount of pages waiting to be prefetched (older requests are dropped) */
+#define RHD_FILE_PREFETCH_MAX (RHD_FILE_CACHE_PAGES / 2)
+
+/* Max gap between two ranges read by the same preadv() (the bytes in between are read too, and
+   discarded), and max amount of ranges read by each preadv() (see file_read_ranges()) */
+#define RHD_FILE_GAP_MAX    ((size_t)1 << 12)
+#define RHD_FILE_VECTOR_MAX 32
+
+/* Max length of the contiguous changes written by each pwrite() of file_save() */
+#define RHD_FILE_SAVE_LEN ((size_t)1 << 16)
 
 
 /* ------------------------------- TYPEDEFS -------------------------------- */
@@ -53,276 +98,1513 @@ typedef enum file_state_tag {
     RHD_FILE_STATE_OPEN
 } file_state_t;
 
+/**
+ * Enum that describes how the file content is accessed
+ */
+typedef enum file_backend_tag {
+    RHD_FILE_BACKEND_STDIO,  /* Streams, like pipes (uses fread()) */
+    RHD_FILE_BACKEND_MMAP,   /* Regular files (the whole file is mapped read-only in memory) */
+    RHD_FILE_BACKEND_CACHE,  /* Other seekable files (uses pread() through the page cache) */
+    RHD_FILE_BACKEND_STREAM  /* Streams navigated with file_stream() (their last bytes are kept in a
+                                spill file, used as a ring buffer) */
+} file_backend_t;
+
+/**
+ * Enum that describes the state of a page of the page cache
+ */
+typedef enum file_page_state_tag {
+    RHD_FILE_PAGE_EMPTY,
+    RHD_FILE_PAGE_LOADING,   /* A thread is reading it (without holding the lock) */
+    RHD_FILE_PAGE_READY
+} file_page_state_t;
+
+/**
+ * Struct containing a page of the page cache
+ */
+typedef struct file_page_tag {
+    file_page_state_t state;
+    off_t             index;   /* Offset of the page / RHD_FILE_PAGE_LEN */
+    size_t            len;     /* Less than RHD_FILE_PAGE_LEN only for the last page of the file */
+    unsigned long     stamp;   /* Time of the last use (for LRU eviction) */
+    unsigned char*    data;
+} file_page_t;
+
+
+/**
+ * Struct containing the LRU page cache (RHD_FILE_BACKEND_CACHE only), and its prefetching thread,
+ * that loads the pages requested by file_prefetch() into it
+ */
+typedef struct file_cache_tag {
+    file_page_t     pages[RHD_FILE_CACHE_PAGES];
+    unsigned long   clock;
+    pthread_t       thread;
+    int             is_thread_started;
+    int             is_quitting;
+    off_t           requests[RHD_FILE_PREFETCH_MAX];  /* Pages to prefetch (in order) */
+    size_t          n_requests;
+} file_cache_t;
+
+/**
+ * Struct containing informations about an open file
+ */
+struct rhd_file_tag {
+    file_state_t         state;
+    file_backend_t       backend;
+    off_t                len;
+    off_t                pos;          /* File position indicator (not RHD_FILE_BACKEND_STDIO) */
+    FILE*                h;
+    const unsigned char* map;          /* Mapped file content (RHD_FILE_BACKEND_MMAP only) */
+    gzindex_t*           gz;           /* Index of the compressed file, whose decompressed content
+                                          is read (RHD_FILE_BACKEND_CACHE only, else NULL) */
+    unsigned char*       buf;          /* Window buffer (not RHD_FILE_BACKEND_MMAP) */
+    size_t               buf_len;
+    int                  has_error;
+    FILE*                spill;        /* Ring buffer of the stream (RHD_FILE_BACKEND_STREAM only) */
+    off_t                window;       /* Length of the ring buffer */
+    int                  is_eof;       /* The whole stream was received */
+    int                  stream_flags; /* Initial file status flags of the stream */
+    int                  watch_fd;     /* Notified of changes of the file (-1 if not watched) */
+    int                  is_writable;  /* Opened for update, and seekable (see file_write()) */
+    edits_t              edits;        /* Changes not saved yet (see file_write()) */
+    pthread_mutex_t      edits_lock;   /* Protects "edits" from file_read_at() (as they are changed
+                                          only by the thread calling the other functions) */
+    file_cache_t         cache;
+    pthread_mutex_t      cache_lock;   /* Protects "cache" */
+    pthread_cond_t       cache_cond;   /* Signaled when a page is loaded, or a prefetch is requested */
+    rhd_file_t*          next;         /* Next open file (see open_files) */
+};
+
 
 /* --------------------------- STATIC VARIABLES ---------------------------- */
 
 /**
- * Struct containing informations about the file
+ * Struct containing the options used by the following file_open() calls
+ */
+static struct file_options_tag {
+    int   is_mmap_disabled;
+    int   is_decompress_disabled;
+    int   is_followed;   /* Regular files are watched for changes (see file_follow()) */
+    off_t window;        /* See file_stream_window() */
+} options = RHD_FILE_OPTIONS_INIT;
+
+/**
+ * List of the open files (closed by at_exit_callback(), if still open at exit)
  */
-static struct file_tag {
-    file_state_t state;
-    long int     len;
-    FILE*        h;
-} file = RHD_FILE_INIT;
+static rhd_file_t* open_files = NULL;
+
+/**
+ * Protects "open_files" (files can be opened and closed by different threads)
+ */
+static pthread_mutex_t open_files_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Set to 1 once at_exit_callback() is registered with atexit() (see file_close_at_exit())
+ */
+static int is_at_exit_registered = 0;
 
 
 /* --------------------------- STATIC PROTOTYPES --------------------------- */
 
 /**
- * Callback function registered with atexit() that handles open files
+ * Callback function registered with atexit() that closes the files still open
  */
 static void at_exit_callback(void);
 
+/**
+ * Allocates the file, and opens given "filename" file with given "modes" into it (see file_open(),
+ * and file_open_plain() if "is_plain" is 1).
+ * If successful returns 0, else the error code returned by file_open().
+ */
+static int file_open_new(rhd_file_t** file, const char* filename, const char* modes, const int is_plain);
+
+/**
+ * Opens given "filename" file with given "modes" into the allocated "f" (see file_open_new()).
+ * If successful returns 0, else the error code returned by file_open().
+ */
+static int file_open_handle(rhd_file_t* f, const char* filename, const char* modes, const int is_plain);
+
+/**
+ * Tries to map the whole opened file in memory (only for read-only regular files).
+ * If successful sets f->backend to RHD_FILE_BACKEND_MMAP, else leaves it untouched.
+ */
+static void file_try_mmap(rhd_file_t* f, const char* modes);
+
+/**
+ * Tries to index the opened file as a compressed one (only for read-only regular files), loading
+ * the index from its sidecar file if it is still valid.
+ * If successful sets f->gz, else leaves it NULL.
+ */
+static void file_try_gzip(rhd_file_t* f, const char* modes);
+
+/**
+ * Copies into "dst" (at most) "len" bytes of the stream starting from "pos", from its ring buffer
+ * ("pos" must still be in the ring buffer).
+ * If successful returns the amount of bytes copied, else (size_t)-1.
+ */
+static size_t file_stream_read(rhd_file_t* f, unsigned char* dst, const off_t pos, const size_t len);
+
+/**
+ * Copies into "dst" (at most) "len" bytes of the file starting from "pos", through the page cache.
+ * If successful returns the amount of bytes copied, else (size_t)-1.
+ */
+static size_t file_cache_read(rhd_file_t* f, unsigned char* dst, const off_t pos, const size_t len);
+
+/**
+ * Makes the page "index" ready in the page cache (loading it, or waiting for it to be loaded),
+ * and marks it as used. Must be called holding "cache_lock".
+ * If successful returns the page, else NULL.
+ */
+static file_page_t* file_cache_get(rhd_file_t* f, const off_t index);
+
+/**
+ * Returns the page "index" if it is in the page cache (ready or loading), else NULL.
+ * Must be called holding "cache_lock".
+ */
+static file_page_t* file_cache_find(rhd_file_t* f, const off_t index);
+
+/**
+ * Reads the page "index" into the least recently used page that is not loading (releasing
+ * "cache_lock" while reading). Must be called holding "cache_lock".
+ * If successful returns the page, else NULL.
+ */
+static file_page_t* file_cache_load(rhd_file_t* f, const off_t index);
+
+/**
+ * Empties all the pages of the page cache after "pos", and the one containing it
+ * (waiting for the ones being loaded).
+ */
+static void file_cache_drop(rhd_file_t* f, const off_t pos);
+
+/**
+ * Starts watching the opened file for changes (see file_follow()).
+ * If successful returns 0, else 1.
+ */
+static int file_watch(rhd_file_t* f, const char* filename);
+
+/**
+ * Body of the prefetching thread (of the file "arg")
+ */
+static void* file_prefetcher(void* arg);
+
+/**
+ * Stops the prefetching thread (if started), and frees the page cache
+ */
+static void file_cache_free(rhd_file_t* f);
+
+/**
+ * Compares the offsets of the ranges "a" and "b" (for qsort())
+ */
+static int file_ranges_compare(const void* a, const void* b);
+
+#ifdef RHD_FILE_PREADV
+/**
+ * Reads into "buf" the first ones of the "n" given "ranges" (see file_read_ranges()) that are
+ * close to each other (at least one), with a single preadv() (continuing after short reads).
+ * If successful returns the amount of ranges read, else 0.
+ */
+static size_t file_read_vector(rhd_file_t* f, const rhd_range_t* ranges, const size_t n, unsigned char* buf);
+#endif
+
+/**
+ * Makes the window buffer (at least) "len" bytes long.
+ * If successful returns 0, else 1.
+ */
+static int file_buf_reserve(rhd_file_t* f, const size_t len);
+
+/**
+ * If any of the "len" bytes of the "view" of the file starting from "pos" was changed (see
+ * file_write()), copies them into "buf" (if "view" doesn't point to it already) with the changes
+ * applied, and points "view" to it.
+ */
+static void file_edits_apply(rhd_file_t* f, const unsigned char** view, unsigned char* buf, const off_t pos, const size_t len);
+
 
 /* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
 
 
 /* OPEN / CLOSE */
 
-int file_open(const char* filename, const char* modes) {
-    /* If file is already open, return */
-    if (file.state == RHD_FILE_STATE_OPEN)
+int file_open(rhd_file_t** file, const char* filename, const char* modes) {
+    return file_open_new(file, filename, modes, 0);
+}
+
+
+int file_open_plain(rhd_file_t** file, const char* filename, const char* modes) {
+    return file_open_new(file, filename, modes, 1);
+}
+
+
+void file_close_at_exit(void) {
+    /* Register at_exit_callback() (only once) */
+    if (!is_at_exit_registered && atexit(at_exit_callback) == 0)
+        is_at_exit_registered = 1;
+}
+
+
+void file_disable_mmap(void) {
+    options.is_mmap_disabled = 1;
+}
+
+
+void file_disable_decompress(void) {
+    options.is_decompress_disabled = 1;
+}
+
+
+void file_follow(void) {
+    options.is_followed = 1;
+}
+
+
+int file_is_followed(void) {
+    return options.is_followed;
+}
+
+
+int file_follow_fd(rhd_file_t* f) {
+    return f->watch_fd;
+}
+
+
+int file_follow_pull(rhd_file_t* f) {
+    char        events[4096];
+    struct stat st;
+    ssize_t     n;
+
+    if (f->watch_fd == -1)
+        return 0;
+
+    /* Drain the events (only the new length matters) */
+    while ((n = read(f->watch_fd, events, sizeof(events))) > 0)
+        ;
+    if (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        f->has_error = 1;
+        return 1;
+    }
+
+    if (fstat(fileno(f->h), &st) == -1) {
+        f->has_error = 1;
+        return 1;
+    }
+    if (st.st_size == f->len)
         return 0;
 
-    /* Open file */
-    file.h = fopen(filename, modes);
-    if (file.h == NULL)
+    /* The last page is now stale (it may have been partial), and so are all the pages
+       if the file was truncated */
+    file_cache_drop(f, st.st_size < f->len ? 0 : f->len);
+    f->len = st.st_size;
+
+    return 0;
+}
+
+
+void file_stream_window(const off_t window) {
+    options.window = window;
+}
+
+
+int file_stream(rhd_file_t* f) {
+    int flags;
+
+    if (f->state == RHD_FILE_STATE_CLOSE || f->backend != RHD_FILE_BACKEND_STDIO || f->len != -1)
         return 1;
-    file.state = RHD_FILE_STATE_OPEN;
 
-    /* Register at_exit_callback() */
-    atexit(at_exit_callback);
+    /* The ring buffer is an anonymous temporary file (so the stream is never held in memory) */
+    if ((f->spill = tmpfile()) == NULL)
+        return 1;
 
-    /* Get file length */
-    if (fseek(file.h, 0, SEEK_END) == -1)
-        return 2;
-    if ((file.len = file_tell()) == -1)
-        return 2;
-    if (fseek(file.h, 0, SEEK_SET) == -1)
-        return 2;
+    /* The stream is read only when data is available (see file_stream_fd()) */
+    if ((flags = fcntl(fileno(f->h), F_GETFL)) == -1 ||
+        fcntl(fileno(f->h), F_SETFL, flags | O_NONBLOCK) == -1) {
+        fclose(f->spill);
+        f->spill = NULL;
+        return 1;
+    }
+
+    f->stream_flags = flags;
+    f->window       = options.window;
+    f->backend      = RHD_FILE_BACKEND_STREAM;
+    f->len          = 0;
+    f->pos          = 0;
+    f->is_eof       = 0;
+    f->has_error    = 0;
 
     return 0;
 }
 
 
-int file_close(void) {
-    /* If file is already close, return */
-    if (file.state == RHD_FILE_STATE_CLOSE)
+int file_is_stream(rhd_file_t* f) {
+    return f->backend == RHD_FILE_BACKEND_STREAM;
+}
+
+
+int file_stream_fd(rhd_file_t* f) {
+    if (f->backend != RHD_FILE_BACKEND_STREAM || f->is_eof)
+        return -1;
+    return fileno(f->h);
+}
+
+
+int file_stream_pull(rhd_file_t* f) {
+    unsigned char chunk[RHD_FILE_STREAM_READ_LEN];
+    ssize_t       n;
+    size_t        n_pulled;
+    size_t        n_written;
+    size_t        len;
+    off_t         ring_pos;
+
+    if (f->backend != RHD_FILE_BACKEND_STREAM || f->is_eof)
         return 0;
 
-    /* Close file */
-    if (fclose(file.h) == EOF)
-        return 1;
-    file.state = RHD_FILE_STATE_CLOSE;
+    for (n_pulled = 0; n_pulled < RHD_FILE_STREAM_PULL_MAX; n_pulled += (size_t)n) {
+        /* Read what is available, without blocking */
+        stats_add(RHD_STATS_READS, 1);
+        if ((n = read(fileno(f->h), chunk, sizeof(chunk))) == -1) {
+            if (errno == EINTR) {
+                n = 0;
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            f->has_error = 1;
+            return 1;
+        }
+        if (n == 0) {
+            f->is_eof = 1;
+            return 0;
+        }
+
+        /* Append it to the ring buffer (wrapping around, and overwriting the oldest bytes) */
+        for (n_written = 0; n_written < (size_t)n; n_written += len) {
+            ring_pos = (f->len + (off_t)n_written) % f->window;
+            len      = (size_t)n - n_written;
+            if ((off_t)len > f->window - ring_pos)
+                len = (size_t)(f->window - ring_pos);
+            if (pwrite(fileno(f->spill), &chunk[n_written], len, ring_pos) != (ssize_t)len) {
+                f->has_error = 1;
+                return 1;
+            }
+        }
+        f->len += (off_t)n;
+    }
 
     return 0;
 }
 
 
+off_t file_first(rhd_file_t* f) {
+    if (f->backend != RHD_FILE_BACKEND_STREAM || f->len <= f->window)
+        return 0;
+    return f->len - f->window;
+}
+
+
+int file_close(rhd_file_t* f) {
+    rhd_file_t** link;
+    int          ret;
+
+    if (f == NULL)
+        return 0;
+    ret = 0;
+
+    if (f->state == RHD_FILE_STATE_OPEN) {
+        /* Stop watching the file */
+        if (f->watch_fd != -1) {
+            close(f->watch_fd);
+            f->watch_fd = -1;
+        }
+
+        /* Unmap file content (or free the page cache, or the ring buffer) */
+        if (f->backend == RHD_FILE_BACKEND_STREAM) {
+            fcntl(fileno(f->h), F_SETFL, f->stream_flags);
+            if (fclose(f->spill) == EOF)
+                ret = 1;
+        }
+        if (f->backend == RHD_FILE_BACKEND_CACHE)
+            file_cache_free(f);
+        if (f->gz != NULL) {
+            gzindex_close(f->gz);
+            f->gz = NULL;
+        }
+        if (f->backend == RHD_FILE_BACKEND_MMAP && munmap((void*)f->map, (size_t)f->len) == -1)
+            ret = 1;
+
+        /* Close file */
+        if (fclose(f->h) == EOF)
+            ret = 1;
+        f->state = RHD_FILE_STATE_CLOSE;
+    }
+
+    /* Remove it from the open files, and free it (with its window buffer) */
+    pthread_mutex_lock(&open_files_lock);
+    for (link = &open_files; *link != NULL; link = &(*link)->next) {
+        if (*link == f) {
+            *link = f->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&open_files_lock);
+    edits_free(&f->edits);
+    pthread_mutex_destroy(&f->edits_lock);
+    pthread_cond_destroy(&f->cache_cond);
+    pthread_mutex_destroy(&f->cache_lock);
+    free(f->buf);
+    free(f);
+
+    return ret;
+}
+
+
 /* READ */
 
-size_t file_append_bytes(abuf_t* ab, const size_t len) {
-    char*  temp;
+size_t file_read_window(rhd_file_t* f, const unsigned char** window, const size_t len) {
     size_t n_bytes_read;
 
     /* If given "len" is 0, return error */
     if (len == 0)
         return 0;
 
-    /* Allocate "len" bytes to "temp" */
-    if ((temp = malloc(len)) == NULL)
-        return 0;
+    /* With the mmap backend the window points directly inside the mapped file (unless some of
+       its bytes were changed, see file_edits_apply()) */
+    if (f->backend == RHD_FILE_BACKEND_MMAP) {
+        if (f->pos >= f->len)
+            return 0;
+        n_bytes_read = (size_t)(f->len - f->pos) < len ? (size_t)(f->len - f->pos) : len;
+        *window = &f->map[f->pos];
+        if (f->is_writable && f->edits.n_pieces > 0) {
+            if (file_buf_reserve(f, n_bytes_read) != 0)
+                return 0;
+            file_edits_apply(f, window, f->buf, f->pos, n_bytes_read);
+        }
+        f->pos += (off_t)n_bytes_read;
+        return n_bytes_read;
+    }
 
-    /* Try to read "len" bytes and write them into "temp", and get actual "n_bytes_read" */
-    if ((n_bytes_read = fread(temp, 1, len, file.h)) < len && !feof(file.h)) {
-        free(temp);
+    /* With the other backends the window is a buffer reused between calls */
+    if (file_buf_reserve(f, len) != 0)
         return 0;
+
+    /* Seekable files are copied from the page cache, and navigated streams from the ring buffer */
+    if (f->backend == RHD_FILE_BACKEND_CACHE || f->backend == RHD_FILE_BACKEND_STREAM) {
+        if (f->backend == RHD_FILE_BACKEND_STREAM)
+            n_bytes_read = file_stream_read(f, f->buf, f->pos, len);
+        else
+            n_bytes_read = file_cache_read(f, f->buf, f->pos, len);
+        if (n_bytes_read == (size_t)-1) {
+            f->has_error = 1;
+            return 0;
+        }
+        *window = f->buf;
+        if (f->is_writable)
+            file_edits_apply(f, window, f->buf, f->pos, n_bytes_read);
+        f->pos += (off_t)n_bytes_read;
+        return n_bytes_read;
     }
 
-    /* Append read bytes (from "temp") to given "ab" */
-    if (ab_append(ab, temp, n_bytes_read)) {
-        free(temp);
+    /* Try to read "len" bytes and write them into the buffer, and get actual "n_bytes_read" */
+    stats_add(RHD_STATS_READS, 1);
+    if ((n_bytes_read = fread(f->buf, 1, len, f->h)) < len && !feof(f->h))
         return 0;
+
+    *window = f->buf;
+    return n_bytes_read;
+}
+
+
+size_t file_read_at(rhd_file_t* f, const unsigned char** view, unsigned char* buf, const off_t pos, const size_t len) {
+    ssize_t n;
+    size_t  n_bytes_read;
+
+    if (pos < 0)
+        return (size_t)-1;
+
+    /* With the mmap backend the view points directly inside the mapped file (unless some of
+       its bytes were changed) */
+    if (f->backend == RHD_FILE_BACKEND_MMAP) {
+        if (pos >= f->len)
+            return 0;
+        *view        = &f->map[pos];
+        n_bytes_read = (size_t)(f->len - pos) < len ? (size_t)(f->len - pos) : len;
+        if (f->is_writable)
+            file_edits_apply(f, view, buf, pos, n_bytes_read);
+        return n_bytes_read;
+    }
+
+    /* Navigated streams are read from the ring buffer */
+    if (f->backend == RHD_FILE_BACKEND_STREAM) {
+        *view = buf;
+        return file_stream_read(f, buf, pos, len);
     }
 
-    free(temp);
+    /* Compressed files are decompressed through the page cache (as decompressing starts from
+       the access point before "pos", that can be far from it) */
+    if (f->gz != NULL) {
+        *view = buf;
+        return file_cache_read(f, buf, pos, len);
+    }
+
+    /* With the other backends pread() reads at "pos" without touching the shared file offset
+       (the stream buffer is bypassed, which is fine as the file is written only by pwrite(),
+       see file_save()) */
+    for (n_bytes_read = 0; n_bytes_read < len; n_bytes_read += (size_t)n) {
+        stats_add(RHD_STATS_READS, 1);
+        if ((n = pread(fileno(f->h), &buf[n_bytes_read], len - n_bytes_read, pos + (off_t)n_bytes_read)) == -1) {
+            if (errno == EINTR) {
+                n = 0;
+                continue;
+            }
+            return (size_t)-1;
+        }
+        if (n == 0)
+            break;
+    }
 
+    *view = buf;
+    if (f->is_writable)
+        file_edits_apply(f, view, buf, pos, n_bytes_read);
     return n_bytes_read;
 }
 
 
-size_t file_append_formatted_hexs(abuf_t* ab, const size_t len) {
-    size_t n_bytes_read;
-    abuf_t temp = ABUF_INIT;
-    char*  temp_long;
+size_t file_ranges_coalesce(rhd_range_t* ranges, const size_t n) {
+    off_t  end;
+    size_t n_left;
     size_t i;
 
-    /* If given "len" is 0, return error */
-    if (len == 0)
-        return 0;
+    qsort(ranges, n, sizeof(*ranges), file_ranges_compare);
+
+    /* Each range is merged into the previous one, if it starts before (or where) that ends */
+    for (n_left = 0, i = 0; i < n; i++) {
+        if (ranges[i].length <= 0)
+            continue;
+        if (n_left > 0 && ranges[i].offset <= ranges[n_left - 1].offset + ranges[n_left - 1].length) {
+            end = ranges[i].offset + ranges[i].length;
+            if (end > ranges[n_left - 1].offset + ranges[n_left - 1].length)
+                ranges[n_left - 1].length = end - ranges[n_left - 1].offset;
+            continue;
+        }
+        ranges[n_left++] = ranges[i];
+    }
 
-    /* Read "len" bytes and append them to "temp", and get actual "n_bytes_read" */
-    if ((n_bytes_read = file_append_bytes(&temp, len)) == 0) {
-        ab_free(&temp);
-        return 0;
+    return n_left;
+}
+
+
+int file_read_ranges(rhd_file_t* f, const rhd_range_t* ranges, const size_t n, unsigned char* buf) {
+    const unsigned char* view;
+    size_t               n_read;
+    size_t               len;
+    size_t               i;
+
+    for (i = 0; i < n; i++) {
+        if (ranges[i].offset < 0 || ranges[i].length < 0 || ranges[i].offset > f->len - ranges[i].length)
+            return 1;
     }
 
-    /* To read the bytes and convert them in hexadecimal form with spaces in-between,
-       we need 3 times the amount of space, minus 1, because we don't need the last space.
-       This is done in order to get the following: "bbb" = "xx xx xx" (b = byte, h = hex).
-       We allocate this required space in "temp_long". */
-    if ((temp_long = malloc(n_bytes_read * 3 - 1)) == NULL)
+#ifdef RHD_FILE_PREADV
+    /* Files that are not mapped are read with a preadv() for each group of ranges close to each
+       other, as a system call costs more than the few bytes in between */
+    if (f->backend == RHD_FILE_BACKEND_CACHE && f->gz == NULL) {
+        for (i = 0; i < n; ) {
+            if ((n_read = file_read_vector(f, &ranges[i], n - i, buf)) == 0)
+                return 1;
+            for (; n_read > 0; n_read--)
+                buf += ranges[i++].length;
+        }
         return 0;
+    }
+#endif
 
-    /* Convert all bytes to hexadecimal, with a space in-between */
-    for (i = 0; i < n_bytes_read; i++) {
-        temp_long[i * 3] = CHAR_TO_HEX_UPPER(temp.b[i]);
-        temp_long[i * 3 + 1] = CHAR_TO_HEX_LOWER(temp.b[i]);
-        if (i < n_bytes_read - 1)
-            temp_long[i * 3 + 2] = ' ';
+    /* Else each range is read on its own (mapped files are just copied) */
+    for (i = 0; i < n; i++) {
+        len = (size_t)ranges[i].length;
+        if ((n_read = file_read_at(f, &view, buf, ranges[i].offset, len)) != len)
+            return 1;
+        if (view != buf)
+            memcpy(buf, view, len);
+        buf += len;
     }
 
-    ab_free(&temp);
+    return 0;
+}
+
+
+size_t file_append_bytes(rhd_file_t* f, abuf_t* ab, const size_t len) {
+    const unsigned char* window;
+    size_t               n_bytes_read;
 
-    /* Append final hexadecimal string (from "temp_long") to given "ab" */
-    if (ab_append(ab, temp_long, n_bytes_read * 3 - 1) == 1) {
-        free(temp_long);
+    /* Get a window of (at most) "len" bytes, and get actual "n_bytes_read" */
+    if ((n_bytes_read = file_read_window(f, &window, len)) == 0)
         return 0;
-    }
 
-    free(temp_long);
+    /* Append read bytes (from "window") to given "ab" */
+    if (ab_append(ab, (const char*)window, n_bytes_read))
+        return 0;
 
     return n_bytes_read;
 }
 
 
-size_t file_append_formatted_chars(abuf_t* ab, const size_t len) {
-    size_t n_bytes_read;
-    abuf_t temp = ABUF_INIT;
-    char*  temp_long;
-    size_t i;
+size_t file_append_formatted_hexs(rhd_file_t* f, abuf_t* ab, const size_t len) {
+    const unsigned char* window;
+    size_t               n_bytes_read;
 
-    /* If given "len" is 0, return error */
-    if (len == 0)
+    /* Get a window of (at most) "len" bytes, and get actual "n_bytes_read" */
+    if ((n_bytes_read = file_read_window(f, &window, len)) == 0)
         return 0;
 
-    /* Read "len" bytes and append them to "temp", and get actual "n_bytes_read" */
-    if ((n_bytes_read = file_append_bytes(&temp, len)) == 0) {
-        ab_free(&temp);
+    /* Convert all bytes to hexadecimal, with a space in-between, directly inside "ab".
+       This is done in order to get the following: "bbb" = "xx xx xx" (b = byte, h = hex). */
+    if (format_append_hexs(ab, window, n_bytes_read, RHD_FORMAT_CASE_UPPER) != 0)
         return 0;
-    }
 
-    /* To read the bytes and convert them in ASCII form with spaces in-between,
-       we need 3 times the amount of space, minus 1, because we don't need the last space.
-       This is done in order to get the following: "bbb" = " c  c  c" (b = byte, c = char).
-       We allocate this required space in "temp_long". */
-    if ((temp_long = malloc(n_bytes_read * 3 - 1)) == NULL)
-        return 0;
+    return n_bytes_read;
+}
 
-    /* Convert all bytes to ASCII (when readable), with a space in-between */
-    for (i = 0; i < n_bytes_read; i++) {
-        temp_long[i * 3] = ' ';
-        if (isprint(temp.b[i]) == 0)
-            temp_long[i * 3 + 1] = '.';
-        else
-            temp_long[i * 3 + 1] = temp.b[i];
-        if (i < n_bytes_read - 1)
-            temp_long[i * 3 + 2] = ' ';
-    }
 
-    ab_free(&temp);
+size_t file_append_formatted_chars(rhd_file_t* f, abuf_t* ab, const size_t len) {
+    const unsigned char* window;
+    size_t               n_bytes_read;
 
-    /* Append final ASCII string (from "temp_long") to given "ab" */
-    if (ab_append(ab, temp_long, n_bytes_read * 3 - 1)) {
-        free(temp_long);
+    /* Get a window of (at most) "len" bytes, and get actual "n_bytes_read" */
+    if ((n_bytes_read = file_read_window(f, &window, len)) == 0)
         return 0;
-    }
 
-    free(temp_long);
+    /* Convert all bytes to ASCII (when readable), with a space in-between, directly inside "ab".
+       This is done in order to get the following: "bbb" = " c  c  c" (b = byte, c = char). */
+    if (format_append_formatted_chars(ab, window, n_bytes_read) != 0)
+        return 0;
 
     return n_bytes_read;
 }
 
 
-size_t file_append_chars(abuf_t* ab, const size_t len) {
-    size_t n_bytes_read;
-    abuf_t temp = ABUF_INIT;
-    size_t i;
+size_t file_append_chars(rhd_file_t* f, abuf_t* ab, const size_t len) {
+    const unsigned char* window;
+    size_t               n_bytes_read;
 
-    /* If given "len" is 0, return error */
-    if (len == 0)
+    /* Get a window of (at most) "len" bytes, and get actual "n_bytes_read" */
+    if ((n_bytes_read = file_read_window(f, &window, len)) == 0)
         return 0;
 
-    /* Read "len" bytes and append them to "temp", and get actual "n_bytes_read" */
-    if ((n_bytes_read = file_append_bytes(&temp, len)) == 0) {
-        ab_free(&temp);
+    /* Convert all bytes to ASCII (when readable) directly inside "ab" */
+    if (format_append_chars(ab, window, n_bytes_read) != 0)
         return 0;
-    }
 
-    /* Read the bytes and convert them in ASCII form */
-    for (i = 0; i < n_bytes_read; i++) {
-        if (isprint(temp.b[i]) == 0)
-            temp.b[i] = '.';
-    }
+    return n_bytes_read;
+}
+
+
+/* EDIT */
+
+int file_is_writable(rhd_file_t* f) {
+    return f->is_writable;
+}
+
+
+int file_write(rhd_file_t* f, const off_t pos, const unsigned char* bytes, const size_t len) {
+    int ret;
+
+    /* The changes can't make the file longer */
+    if (!f->is_writable || pos < 0 || pos > f->len || (off_t)len > f->len - pos)
+        return 1;
+
+    pthread_mutex_lock(&f->edits_lock);
+    ret = edits_write(&f->edits, pos, bytes, len);
+    pthread_mutex_unlock(&f->edits_lock);
+
+    return ret;
+}
+
+
+int file_undo(rhd_file_t* f, off_t* pos) {
+    int ret;
+
+    pthread_mutex_lock(&f->edits_lock);
+    ret = edits_undo(&f->edits, pos);
+    pthread_mutex_unlock(&f->edits_lock);
+
+    return ret;
+}
+
+
+int file_redo(rhd_file_t* f, off_t* pos) {
+    int ret;
+
+    pthread_mutex_lock(&f->edits_lock);
+    ret = edits_redo(&f->edits, pos);
+    pthread_mutex_unlock(&f->edits_lock);
+
+    return ret;
+}
+
+
+int file_is_modified(rhd_file_t* f) {
+    return f->edits.n_pieces > 0;
+}
+
 
-    /* Append final ASCII string (from "temp") to given "ab" */
-    if (ab_append(ab, temp.b, n_bytes_read)) {
-        ab_free(&temp);
+int file_save(rhd_file_t* f, size_t* n_extents) {
+    const edits_piece_t* pieces;
+    const unsigned char* bytes;
+    unsigned char*       run;
+    ssize_t              n;
+    size_t               n_pieces;
+    size_t               len;
+    size_t               done;
+    size_t               i;
+    size_t               j;
+
+    *n_extents = 0;
+    if (f->edits.n_pieces == 0)
         return 0;
+    if ((run = malloc(RHD_FILE_SAVE_LEN)) == NULL)
+        return 1;
+
+    /* Only the extents of the changed bytes are written (the pieces that follow each other are
+       joined, up to RHD_FILE_SAVE_LEN bytes, as changing each byte makes its own piece) */
+    pieces   = f->edits.pieces;
+    n_pieces = f->edits.n_pieces;
+    for (i = 0; i < n_pieces; i = j) {
+        bytes = &f->edits.added[pieces[i].add];
+        len   = pieces[i].len;
+        for (j = i + 1; j < n_pieces && pieces[j].pos == pieces[j - 1].pos + (off_t)pieces[j - 1].len &&
+                        len + pieces[j].len <= RHD_FILE_SAVE_LEN; j++) {
+            if (j == i + 1) {
+                memcpy(run, bytes, len);
+                bytes = run;
+            }
+            memcpy(&run[len], &f->edits.added[pieces[j].add], pieces[j].len);
+            len += pieces[j].len;
+        }
+
+        for (done = 0; done < len; done += (size_t)n) {
+            if ((n = pwrite(fileno(f->h), &bytes[done], len - done, pieces[i].pos + (off_t)done)) == -1) {
+                if (errno == EINTR) {
+                    n = 0;
+                    continue;
+                }
+                free(run);
+                return 1;
+            }
+        }
+        (*n_extents)++;
     }
+    free(run);
+    if (fsync(fileno(f->h)) == -1)
+        return 1;
 
-    ab_free(&temp);
+    /* The file now has the changes (the mapping shows them, as it is shared, but the pages in
+       the page cache are stale), so they can't be undone anymore */
+    if (f->backend == RHD_FILE_BACKEND_CACHE)
+        file_cache_drop(f, 0);
+    pthread_mutex_lock(&f->edits_lock);
+    edits_free(&f->edits);
+    pthread_mutex_unlock(&f->edits_lock);
 
-    return n_bytes_read;
+    return 0;
 }
 
 
 /* MOVE */
 
-int file_move(const long int bytes) {
-    long int pos;
+int file_move(rhd_file_t* f, const off_t bytes) {
+    off_t pos;
 
     /* If the movement would cause the file position indicator
         to end up out of the file, do no move instead */
-    if ((pos = file_tell()) == -1)
+    if ((pos = file_tell(f)) == -1)
         return 1;
-    if (pos + bytes >= file.len)
+    if (pos + bytes >= f->len)
         return 0;
 
+    /* With the other backends moving is just arithmetic */
+    if (f->backend != RHD_FILE_BACKEND_STDIO) {
+        f->pos = pos + bytes < file_first(f) ? file_first(f) : pos + bytes;
+        return 0;
+    }
+
     /* Move the file position indicator */
-    if (fseek(file.h, bytes, SEEK_CUR) == -1) {
+    stats_add(RHD_STATS_SEEKS, 1);
+    if (fseeko(f->h, bytes, SEEK_CUR) == -1) {
         /* If an error happens, try to move to the start of the file */
-        if (fseek(file.h, 0, SEEK_SET) == -1)
+        if (fseeko(f->h, 0, SEEK_SET) == -1)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+int file_has_error(rhd_file_t* f) {
+    if (f->state == RHD_FILE_STATE_CLOSE || f->backend == RHD_FILE_BACKEND_MMAP)
+        return 0;
+    if (f->backend == RHD_FILE_BACKEND_CACHE || f->backend == RHD_FILE_BACKEND_STREAM)
+        return f->has_error;
+    return ferror(f->h) != 0;
+}
+
+
+off_t file_length(rhd_file_t* f) {
+    if (f->state == RHD_FILE_STATE_CLOSE)
+        return -1;
+    return f->len;
+}
+
+
+int file_stat(rhd_file_t* f, struct stat* st) {
+    if (f->state == RHD_FILE_STATE_CLOSE || fstat(fileno(f->h), st) == -1)
+        return 1;
+    if (f->gz != NULL)
+        st->st_size = f->len;
+    return 0;
+}
+
+
+long file_mtime_nsec(const struct stat* st) {
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L
+    return (long)st->st_mtim.tv_nsec;
+#else
+    (void)st;
+    return 0;
+#endif
+}
+
+
+int file_sidecar_path(char* path, const char* name) {
+    const char* dir;
+
+    /* Directory: "$XDG_CACHE_HOME/rawhexdump", or "$HOME/.cache/rawhexdump" */
+    if ((dir = getenv("XDG_CACHE_HOME")) != NULL && dir[0] != '\0') {
+        if (strlen(dir) + 128 > RHD_FILE_PATH_MAX || (mkdir(dir, 0700) == -1 && errno != EEXIST))
+            return 1;
+        sprintf(path, "%s/rawhexdump", dir);
+    } else {
+        if ((dir = getenv("HOME")) == NULL || dir[0] == '\0' || strlen(dir) + 128 > RHD_FILE_PATH_MAX)
+            return 1;
+        sprintf(path, "%s/.cache", dir);
+        if (mkdir(path, 0700) == -1 && errno != EEXIST)
             return 1;
+        sprintf(path, "%s/.cache/rawhexdump", dir);
     }
+    if (mkdir(path, 0700) == -1 && errno != EEXIST)
+        return 1;
+
+    sprintf(&path[strlen(path)], "/%.64s", name);
 
     return 0;
 }
 
 
-long int file_tell(void) {
-    long int pos;
-    if ((pos = ftell(file.h)) < 0)
+off_t file_tell(rhd_file_t* f) {
+    off_t pos;
+    if (f->backend != RHD_FILE_BACKEND_STDIO)
+        return f->pos;
+    if ((pos = ftello(f->h)) < 0)
         return -1;
     return pos;
 }
 
 
-int file_seek_set(const long bytes) {
-    if (fseek(file.h, bytes, SEEK_SET) == -1)
+int file_seek_set(rhd_file_t* f, const off_t bytes) {
+    if (f->backend != RHD_FILE_BACKEND_STDIO) {
+        if (bytes < file_first(f))
+            return 1;
+        f->pos = bytes;
+        return 0;
+    }
+    stats_add(RHD_STATS_SEEKS, 1);
+    if (fseeko(f->h, bytes, SEEK_SET) == -1)
         return 1;
     return 0;
 }
 
 
+void file_prefetch(rhd_file_t* f, const off_t pos, const off_t len) {
+    off_t  start;
+    off_t  end;
+    off_t  first;
+    off_t  last;
+    off_t  index;
+    size_t n;
+
+    if (f->state == RHD_FILE_STATE_CLOSE || f->backend == RHD_FILE_BACKEND_STDIO ||
+        f->backend == RHD_FILE_BACKEND_STREAM)
+        return;
+
+    /* Clamp the range inside the file */
+    start = pos < 0 ? 0 : pos;
+    end   = pos + len > f->len ? f->len : pos + len;
+    if (start >= end)
+        return;
+
+    /* The mapping is paged in by the kernel (the range must start at a page boundary) */
+    if (f->backend == RHD_FILE_BACKEND_MMAP) {
+        start -= start % sysconf(_SC_PAGESIZE);
+        posix_madvise((void*)&f->map[start], (size_t)(end - start), POSIX_MADV_WILLNEED);
+        return;
+    }
+
+    /* Else the kernel starts reading ahead (not for compressed files, whose offsets are not the
+       ones in the file), while the prefetching thread loads the pages into the page cache
+       (starting it on first use) */
+    if (f->gz == NULL)
+        posix_fadvise(fileno(f->h), start, end - start, POSIX_FADV_WILLNEED);
+
+    pthread_mutex_lock(&f->cache_lock);
+    if (!f->cache.is_thread_started) {
+        f->cache.is_quitting = 0;
+        if (pthread_create(&f->cache.thread, NULL, file_prefetcher, f) != 0) {
+            pthread_mutex_unlock(&f->cache_lock);
+            return;
+        }
+        f->cache.is_thread_started = 1;
+    }
+
+    /* New requests replace the old ones (the direction of scrolling may have changed), and are
+       ordered from the page nearest to the file position indicator */
+    f->cache.n_requests = 0;
+    first = start / (off_t)RHD_FILE_PAGE_LEN;
+    last  = (end - 1) / (off_t)RHD_FILE_PAGE_LEN;
+    for (n = 0; n <= (size_t)(last - first) && n < RHD_FILE_PREFETCH_MAX; n++) {
+        index = end <= f->pos ? last - (off_t)n : first + (off_t)n;
+        if (file_cache_find(f, index) == NULL)
+            f->cache.requests[f->cache.n_requests++] = index;
+    }
+    pthread_cond_broadcast(&f->cache_cond);
+    pthread_mutex_unlock(&f->cache_lock);
+}
+
+
 /* --------------------------- STATIC FUNCTIONS ---------------------------- */
 
+static int file_open_new(rhd_file_t** file, const char* filename, const char* modes, const int is_plain) {
+    rhd_file_t* f;
+    int         ret;
+    int         errno_saved;
+
+    /* Allocate the file, and add it to the open files */
+    *file = NULL;
+    if ((f = calloc(1, sizeof(*f))) == NULL)
+        return 1;
+    if (pthread_mutex_init(&f->cache_lock, NULL) != 0) {
+        free(f);
+        return 1;
+    }
+    if (pthread_cond_init(&f->cache_cond, NULL) != 0) {
+        pthread_mutex_destroy(&f->cache_lock);
+        free(f);
+        return 1;
+    }
+    if (pthread_mutex_init(&f->edits_lock, NULL) != 0) {
+        pthread_cond_destroy(&f->cache_cond);
+        pthread_mutex_destroy(&f->cache_lock);
+        free(f);
+        return 1;
+    }
+    f->state    = RHD_FILE_STATE_CLOSE;
+    f->backend  = RHD_FILE_BACKEND_STDIO;
+    f->watch_fd = -1;
+    pthread_mutex_lock(&open_files_lock);
+    f->next    = open_files;
+    open_files = f;
+    pthread_mutex_unlock(&open_files_lock);
+
+    /* Open it (undoing everything if anything fails) */
+    if ((ret = file_open_handle(f, filename, modes, is_plain)) != 0) {
+        errno_saved = errno;
+        file_close(f);
+        errno = errno_saved;
+        return ret;
+    }
+
+    *file = f;
+    return 0;
+}
+
+
+static int file_open_handle(rhd_file_t* f, const char* filename, const char* modes, const int is_plain) {
+    struct stat st;
+
+    /* Open file ("-" means standard input) */
+    if (strcmp(filename, RHD_FILE_STDIN) == 0)
+        f->h = stdin;
+    else
+        f->h = fopen(filename, modes);
+    if (f->h == NULL)
+        return 1;
+    f->state = RHD_FILE_STATE_OPEN;
+
+    /* Use the mmap backend if possible (the file length is then already known),
+       except for followed files (whose length can change) */
+    f->backend = RHD_FILE_BACKEND_STDIO;
+    if (!options.is_followed && !is_plain)
+        file_try_gzip(f, modes);
+    if (f->gz != NULL) {
+        /* Compressed files are decompressed through the page cache, and can't be changed */
+        f->len         = gzindex_length(f->gz);
+        f->backend     = RHD_FILE_BACKEND_CACHE;
+        f->pos         = 0;
+        f->has_error   = 0;
+        f->is_writable = 0;
+        return 0;
+    }
+    if (!options.is_followed)
+        file_try_mmap(f, modes);
+    if (f->backend == RHD_FILE_BACKEND_MMAP) {
+        f->is_writable = strchr(modes, '+') != NULL && f->h != stdin;
+        return 0;
+    }
+
+    /* Character devices (like terminals or /dev/urandom) are streams, even if they can be seeked */
+    if (fstat(fileno(f->h), &st) == -1)
+        return 2;
+    if (S_ISCHR(st.st_mode)) {
+        f->len = -1;
+        return 0;
+    }
+
+    /* Get file length (streams, like pipes, can't be seeked, so their length is unknown, and
+       neither can most files in /proc). The descriptor is used, as fseeko() trusts fstat(),
+       that tells that files in /proc are empty. */
+    if ((f->len = lseek(fileno(f->h), 0, SEEK_END)) == -1) {
+        if (errno != ESPIPE && errno != EINVAL)
+            return 2;
+        return 0;
+    }
+    if (lseek(fileno(f->h), 0, SEEK_SET) == -1)
+        return 2;
+
+    /* Seekable files are read through the page cache */
+    f->backend   = RHD_FILE_BACKEND_CACHE;
+    f->pos       = 0;
+    f->has_error = 0;
+
+    /* Followed files are watched, to update their length when they change */
+    if (options.is_followed && S_ISREG(st.st_mode) && file_watch(f, filename) != 0)
+        return 3;
+
+    /* (only seekable files opened for update can be changed, and the standard input never is) */
+    f->is_writable = strchr(modes, '+') != NULL && f->h != stdin;
+
+    return 0;
+}
+
+
+static void file_try_mmap(rhd_file_t* f, const char* modes) {
+    struct stat st;
+    void*       map;
+
+    /* Only the modes that don't truncate the file can be served by a read-only mapping */
+    if (options.is_mmap_disabled || strchr(modes, 'w') != NULL || strchr(modes, 'a') != NULL)
+        return;
+
+    /* Only non-empty regular files can be mapped (pipes and special files use stdio),
+       and only if their whole length fits inside the address space */
+    if (fstat(fileno(f->h), &st) == -1 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return;
+    if ((off_t)(size_t)st.st_size != st.st_size)
+        return;
+
+    /* Map the whole file (shared if it is opened for update, so that the mapping shows the changes
+       written by file_save()) */
+    if ((map = mmap(NULL, (size_t)st.st_size, PROT_READ, strchr(modes, '+') != NULL ? MAP_SHARED : MAP_PRIVATE,
+                    fileno(f->h), 0)) == MAP_FAILED)
+        return;
+
+    f->map     = (const unsigned char*)map;
+    f->len     = st.st_size;
+    f->pos     = 0;
+    f->backend = RHD_FILE_BACKEND_MMAP;
+}
+
+
+static void file_try_gzip(rhd_file_t* f, const char* modes) {
+    struct stat   st;
+    char          name[64];
+    char          path[RHD_FILE_PATH_MAX];
+    unsigned long hash;
+
+    /* Only regular files opened read-only are decompressed (the ones opened for update are shown
+       as they are, to be changed) */
+    if (options.is_decompress_disabled || strchr(modes, '+') != NULL || strchr(modes, 'w') != NULL ||
+        strchr(modes, 'a') != NULL || f->h == stdin)
+        return;
+    if (fstat(fileno(f->h), &st) == -1 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return;
+
+    /* Name of the sidecar file: FNV-1a hash of the identity of the file (the sidecar file holds
+       the whole key, so that collisions are detected) */
+    hash = 2166136261UL;
+    hash = ((hash ^ (unsigned long)st.st_dev) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)st.st_ino) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)st.st_size) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)st.st_mtime) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)file_mtime_nsec(&st)) * 16777619UL) & 0xFFFFFFFFUL;
+    sprintf(name, "%08lx.gzi", hash);
+
+    /* (files that aren't compressed, or whose index can't be built, are read as they are) */
+    if (gzindex_open(&f->gz, fileno(f->h), &st, file_sidecar_path(path, name) == 0 ? path : NULL) != 0)
+        f->gz = NULL;
+}
+
+
+static size_t file_stream_read(rhd_file_t* f, unsigned char* dst, const off_t pos, const size_t len) {
+    ssize_t n;
+    size_t  n_bytes_read;
+    size_t  n_bytes;
+    off_t   ring_pos;
+
+    if (pos < file_first(f))
+        return (size_t)-1;
+
+    /* Read the bytes received so far, in (at most) two runs, as the ring buffer wraps around */
+    for (n_bytes_read = 0; n_bytes_read < len && pos + (off_t)n_bytes_read < f->len; n_bytes_read += (size_t)n) {
+        ring_pos = (pos + (off_t)n_bytes_read) % f->window;
+        n_bytes  = len - n_bytes_read;
+        if ((off_t)n_bytes > f->len - (pos + (off_t)n_bytes_read))
+            n_bytes = (size_t)(f->len - (pos + (off_t)n_bytes_read));
+        if ((off_t)n_bytes > f->window - ring_pos)
+            n_bytes = (size_t)(f->window - ring_pos);
+        stats_add(RHD_STATS_READS, 1);
+        if ((n = pread(fileno(f->spill), &dst[n_bytes_read], n_bytes, ring_pos)) == -1) {
+            if (errno == EINTR) {
+                n = 0;
+                continue;
+            }
+            return (size_t)-1;
+        }
+        if (n == 0)
+            return (size_t)-1;
+    }
+
+    return n_bytes_read;
+}
+
+
+static size_t file_cache_read(rhd_file_t* f, unsigned char* dst, const off_t pos, const size_t len) {
+    file_page_t* page;
+    off_t        index;
+    size_t       skip;
+    size_t       n;
+    size_t       i;
+
+    pthread_mutex_lock(&f->cache_lock);
+
+    /* Copy the requested bytes page by page */
+    for (i = 0; i < len && pos + (off_t)i < f->len; i += n) {
+        index = (pos + (off_t)i) / (off_t)RHD_FILE_PAGE_LEN;
+        skip  = (size_t)((pos + (off_t)i) % (off_t)RHD_FILE_PAGE_LEN);
+        if ((page = file_cache_get(f, index)) == NULL) {
+            pthread_mutex_unlock(&f->cache_lock);
+            return (size_t)-1;
+        }
+        if (skip >= page->len)
+            break;
+        n = page->len - skip < len - i ? page->len - skip : len - i;
+        memcpy(&dst[i], &page->data[skip], n);
+    }
+
+    pthread_mutex_unlock(&f->cache_lock);
+    return i;
+}
+
+
+static file_page_t* file_cache_get(rhd_file_t* f, const off_t index) {
+    file_page_t* page;
+
+    /* Wait for pages being loaded (by the prefetching thread) */
+    while ((page = file_cache_find(f, index)) != NULL && page->state == RHD_FILE_PAGE_LOADING)
+        pthread_cond_wait(&f->cache_cond, &f->cache_lock);
+
+    stats_add(page != NULL ? RHD_STATS_CACHE_HITS : RHD_STATS_CACHE_MISSES, 1);
+    if (page == NULL && (page = file_cache_load(f, index)) == NULL)
+        return NULL;
+
+    page->stamp = ++f->cache.clock;
+    return page;
+}
+
+
+static file_page_t* file_cache_find(rhd_file_t* f, const off_t index) {
+    size_t i;
+
+    for (i = 0; i < RHD_FILE_CACHE_PAGES; i++) {
+        if (f->cache.pages[i].state != RHD_FILE_PAGE_EMPTY && f->cache.pages[i].index == index)
+            return &f->cache.pages[i];
+    }
+
+    return NULL;
+}
+
+
+static file_page_t* file_cache_load(rhd_file_t* f, const off_t index) {
+    file_page_t* page;
+    ssize_t      n;
+    size_t       len;
+    size_t       i;
+
+    /* Choose the least recently used page (empty pages first) that is not loading */
+    page = NULL;
+    for (i = 0; i < RHD_FILE_CACHE_PAGES; i++) {
+        if (f->cache.pages[i].state == RHD_FILE_PAGE_LOADING)
+            continue;
+        if (page == NULL || f->cache.pages[i].state == RHD_FILE_PAGE_EMPTY ||
+            (page->state != RHD_FILE_PAGE_EMPTY && f->cache.pages[i].stamp < page->stamp))
+            page = &f->cache.pages[i];
+        if (page->state == RHD_FILE_PAGE_EMPTY)
+            break;
+    }
+    if (page == NULL)
+        return NULL;
+    if (page->data == NULL) {
+        if ((page->data = malloc(RHD_FILE_PAGE_LEN)) == NULL)
+            return NULL;
+        stats_add(RHD_STATS_ALLOCS, 1);
+    }
+
+    page->state = RHD_FILE_PAGE_LOADING;
+    page->index = index;
+    page->stamp = ++f->cache.clock;
+    pthread_mutex_unlock(&f->cache_lock);
+
+    /* Read the page without holding the lock (so that ready pages can still be copied), or
+       decompress it if the file is compressed */
+    if (f->gz != NULL) {
+        n   = (len = gzindex_read(f->gz, page->data, index * (off_t)RHD_FILE_PAGE_LEN, RHD_FILE_PAGE_LEN)) == (size_t)-1 ? -1 : 0;
+        len = n == -1 ? 0 : len;
+    } else {
+        for (len = 0; len < RHD_FILE_PAGE_LEN; len += (size_t)n) {
+            stats_add(RHD_STATS_READS, 1);
+            if ((n = pread(fileno(f->h), &page->data[len], RHD_FILE_PAGE_LEN - len,
+                           index * (off_t)RHD_FILE_PAGE_LEN + (off_t)len)) == -1) {
+                if (errno == EINTR) {
+                    n = 0;
+                    continue;
+                }
+                break;
+            }
+            if (n == 0)
+                break;
+        }
+    }
+
+    pthread_mutex_lock(&f->cache_lock);
+    page->state = n == -1 ? RHD_FILE_PAGE_EMPTY : RHD_FILE_PAGE_READY;
+    page->len   = len;
+    pthread_cond_broadcast(&f->cache_cond);
+
+    return page->state == RHD_FILE_PAGE_READY ? page : NULL;
+}
+
+
+static void file_cache_drop(rhd_file_t* f, const off_t pos) {
+    size_t i;
+
+    pthread_mutex_lock(&f->cache_lock);
+    for (i = 0; i < RHD_FILE_CACHE_PAGES; i++) {
+        if (f->cache.pages[i].state == RHD_FILE_PAGE_EMPTY ||
+            (f->cache.pages[i].index + 1) * (off_t)RHD_FILE_PAGE_LEN <= pos)
+            continue;
+        while (f->cache.pages[i].state == RHD_FILE_PAGE_LOADING)
+            pthread_cond_wait(&f->cache_cond, &f->cache_lock);
+        f->cache.pages[i].state = RHD_FILE_PAGE_EMPTY;
+    }
+    pthread_mutex_unlock(&f->cache_lock);
+}
+
+
+static int file_watch(rhd_file_t* f, const char* filename) {
+#ifdef __linux__
+    if ((f->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1)
+        return 1;
+    if (inotify_add_watch(f->watch_fd, filename, IN_MODIFY | IN_ATTRIB) == -1) {
+        close(f->watch_fd);
+        f->watch_fd = -1;
+        return 1;
+    }
+    return 0;
+#else
+    /* Only inotify is supported (kqueue could be used on the BSDs) */
+    (void)filename;
+    errno = ENOSYS;
+    return 1;
+#endif
+}
+
+
+static void* file_prefetcher(void* arg) {
+    rhd_file_t* f = arg;
+    off_t       index;
+    size_t      i;
+
+    pthread_mutex_lock(&f->cache_lock);
+    for (;;) {
+        while (!f->cache.is_quitting && f->cache.n_requests == 0)
+            pthread_cond_wait(&f->cache_cond, &f->cache_lock);
+        if (f->cache.is_quitting)
+            break;
+
+        /* Take the first request (the nearest page) */
+        index = f->cache.requests[0];
+        f->cache.n_requests--;
+        for (i = 0; i < f->cache.n_requests; i++)
+            f->cache.requests[i] = f->cache.requests[i + 1];
+
+        /* Prefetched pages are loaded without marking them as used */
+        if (file_cache_find(f, index) == NULL)
+            file_cache_load(f, index);
+    }
+    pthread_mutex_unlock(&f->cache_lock);
+
+    return NULL;
+}
+
+
+static void file_cache_free(rhd_file_t* f) {
+    size_t i;
+
+    pthread_mutex_lock(&f->cache_lock);
+    if (f->cache.is_thread_started) {
+        f->cache.is_quitting = 1;
+        pthread_cond_broadcast(&f->cache_cond);
+        pthread_mutex_unlock(&f->cache_lock);
+        pthread_join(f->cache.thread, NULL);
+        pthread_mutex_lock(&f->cache_lock);
+        f->cache.is_thread_started = 0;
+    }
+
+    for (i = 0; i < RHD_FILE_CACHE_PAGES; i++) {
+        free(f->cache.pages[i].data);
+        f->cache.pages[i].data  = NULL;
+        f->cache.pages[i].state = RHD_FILE_PAGE_EMPTY;
+    }
+    f->cache.n_requests = 0;
+    pthread_mutex_unlock(&f->cache_lock);
+}
+
+
 static void at_exit_callback(void) {
-    /* Close file if open */
-    if (file.state == RHD_FILE_STATE_OPEN) {
-        if (file_close() != 0) {
+    rhd_file_t* f;
+
+    /* Close the files still open */
+    for (;;) {
+        pthread_mutex_lock(&open_files_lock);
+        f = open_files;
+        pthread_mutex_unlock(&open_files_lock);
+        if (f == NULL)
+            break;
+        if (file_close(f) != 0) {
             fprintf(stderr, "ERROR: Could not close opened file!\n");
             fprintf(stderr, "    -> %s\n", strerror(errno));
         }
     }
 }
+
+
+static int file_buf_reserve(rhd_file_t* f, const size_t len) {
+    unsigned char* new_buf;
+
+    /* (enlarged only when a bigger window is requested) */
+    if (len <= f->buf_len)
+        return 0;
+    if ((new_buf = realloc(f->buf, len)) == NULL)
+        return 1;
+    stats_add(RHD_STATS_ALLOCS, 1);
+    f->buf     = new_buf;
+    f->buf_len = len;
+
+    return 0;
+}
+
+
+static void file_edits_apply(rhd_file_t* f, const unsigned char** view, unsigned char* buf, const off_t pos, const size_t len) {
+    pthread_mutex_lock(&f->edits_lock);
+    if (edits_is_changed(&f->edits, pos, len)) {
+        if (*view != buf)
+            memcpy(buf, *view, len);
+        edits_apply(&f->edits, buf, pos, len);
+        *view = buf;
+    }
+    pthread_mutex_unlock(&f->edits_lock);
+}
+
+
+static int file_ranges_compare(const void* a, const void* b) {
+    const rhd_range_t* range_a;
+    const rhd_range_t* range_b;
+
+    range_a = (const rhd_range_t*)a;
+    range_b = (const rhd_range_t*)b;
+    if (range_a->offset != range_b->offset)
+        return range_a->offset < range_b->offset ? -1 : 1;
+    return 0;
+}
+
+
+#ifdef RHD_FILE_PREADV
+static size_t file_read_vector(rhd_file_t* f, const rhd_range_t* ranges, const size_t n, unsigned char* buf) {
+    unsigned char        gap[RHD_FILE_GAP_MAX];
+    struct iovec         iovs[RHD_FILE_VECTOR_MAX * 2];
+    const unsigned char* view;
+    unsigned char*       dst;
+    off_t                end;
+    size_t               n_ranges;
+    size_t               n_iovs;
+    size_t               first;
+    size_t               total;
+    size_t               done;
+    size_t               left;
+    ssize_t              r;
+
+    /* Group the ranges close to each other (all the gaps between them are read into "gap") */
+    n_iovs = 0;
+    total  = 0;
+    dst    = buf;
+    for (n_ranges = 0; n_ranges < n && n_ranges < RHD_FILE_VECTOR_MAX; n_ranges++) {
+        if (n_ranges > 0) {
+            end = ranges[n_ranges - 1].offset + ranges[n_ranges - 1].length;
+            if (ranges[n_ranges].offset - end > (off_t)RHD_FILE_GAP_MAX)
+                break;
+            if (ranges[n_ranges].offset > end) {
+                iovs[n_iovs].iov_base = gap;
+                iovs[n_iovs].iov_len  = (size_t)(ranges[n_ranges].offset - end);
+                total += iovs[n_iovs++].iov_len;
+            }
+        }
+        iovs[n_iovs].iov_base = dst;
+        iovs[n_iovs].iov_len  = (size_t)ranges[n_ranges].length;
+        total += iovs[n_iovs++].iov_len;
+        dst   += ranges[n_ranges].length;
+    }
+
+    /* Read the group, skipping the buffers already filled after short reads */
+    first = 0;
+    for (done = 0; done < total; done += (size_t)r) {
+        stats_add(RHD_STATS_READS, 1);
+        if ((r = preadv(fileno(f->h), &iovs[first], (int)(n_iovs - first), ranges[0].offset + (off_t)done)) == -1) {
+            if (errno == EINTR) {
+                r = 0;
+                continue;
+            }
+            return 0;
+        }
+        if (r == 0)
+            return 0;
+        for (left = (size_t)r; left > 0 && left >= iovs[first].iov_len; first++)
+            left -= iovs[first].iov_len;
+        if (left > 0) {
+            iovs[first].iov_base = (unsigned char*)iovs[first].iov_base + left;
+            iovs[first].iov_len -= left;
+        }
+    }
+
+    /* (showing the changes not saved yet, see file_write()) */
+    for (dst = buf, first = 0; f->is_writable && first < n_ranges; dst += ranges[first++].length) {
+        view = dst;
+        file_edits_apply(f, &view, dst, ranges[first].offset, (size_t)ranges[first].length);
+    }
+
+    return n_ranges;
+}
+#endif
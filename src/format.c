@@ -0,0 +1,652 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file format.c */
+
+
+/* C89 standard */
+#include <stddef.h>
+#include <string.h>
+
+#include "abuf.h"
+
+#include "format.h"
+
+
+/* SIMD kernels are picked at runtime on x86 (GCC/Clang), and at compile time on ARM */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RHD_FORMAT_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RHD_FORMAT_NEON
+#include <arm_neon.h>
+#endif
+
+#define RHD_FORMAT_HEX_DIGITS_UPPER "0123456789ABCDEF"
+#define RHD_FORMAT_HEX_DIGITS_LOWER "0123456789abcdef"
+
+/* Distance between '9' + 1 and the first letter digit, for each letter case */
+#define RHD_FORMAT_LETTERS_OFFSET(letter_case) ((letter_case) == RHD_FORMAT_CASE_UPPER ? 'A' - '0' - 10 : 'a' - '0' - 10)
+
+/* Printable ASCII range (same as isprint() in the "C" locale) */
+#define RHD_FORMAT_IS_PRINT(c) ((c) >= 0x20 && (c) <= 0x7E)
+
+/* Widths (in bytes) with kernels specialized at compile time: the rows of the dump (16) and their
+   halves (8), a whole AVX2 step (32), and the rows of common terminals as the viewer lays them out
+   (with the offsets column of 8 digits and 2 spaces shown, each byte takes 3 columns in the
+   hexadecimal and formatted char views, and 1 in the char view): 23 and 70 bytes for 80 columns,
+   36 for 120 columns, 76 for 240 columns */
+#define RHD_FORMAT_FIXED_WIDTHS(X) X(8) X(16) X(23) X(32) X(36) X(70) X(76)
+
+/* Widest width of RHD_FORMAT_FIXED_WIDTHS */
+#define RHD_FORMAT_FIXED_MAX 76
+
+/* Inlines all the calls made by a function (kernels and their tail kernels) */
+#if defined(__GNUC__)
+#define RHD_FORMAT_FLATTEN __attribute__((flatten))
+#else
+#define RHD_FORMAT_FLATTEN
+#endif
+
+/* Defines "kernel"_"w", that formats exactly "w" bytes with "kernel" inlined: with a constant width
+   the SIMD steps become straight-line code, and the tails (and the tail kernels) never taken are dropped */
+#define RHD_FORMAT_FIXED_HEX_KERNEL(specifiers, kernel, w) \
+    RHD_FORMAT_FLATTEN specifiers void kernel##_##w(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) { \
+        (void)n; \
+        kernel(dst, src, w, letter_case); \
+    }
+#define RHD_FORMAT_FIXED_KERNEL(specifiers, kernel, w) \
+    RHD_FORMAT_FLATTEN specifiers void kernel##_##w(char* dst, const unsigned char* src, const size_t n) { \
+        (void)n; \
+        kernel(dst, src, w); \
+    }
+
+/* Uses "kernel"_"w" for the rows of "w" bytes, if "kernel" is the selected kernel of that "kind" */
+#define RHD_FORMAT_SELECT_FIXED(kind, kernel, w) \
+    if (format_kernels.kind == kernel) \
+        format_kernels.fixed_##kind[w] = kernel##_##w;
+
+/* Kernel that formats "n" bytes of the given "kind": the specialized one (if any), else the generic one */
+#define RHD_FORMAT_KERNEL(kind, n) \
+    ((n) <= RHD_FORMAT_FIXED_MAX && format_kernels.fixed_##kind[n] != NULL ? format_kernels.fixed_##kind[n] : format_kernels.kind)
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Function pointer type shared by all char formatting kernels
+ */
+typedef void (*format_kernel_t)(char*, const unsigned char*, const size_t);
+
+/**
+ * Function pointer type shared by all hexadecimal formatting kernels
+ */
+typedef void (*format_hex_kernel_t)(char*, const unsigned char*, const size_t, const format_case_t);
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Resolvers used before format_init() is called: they select the kernels and then format
+ */
+static void format_hexs_resolve(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case);
+static void format_formatted_chars_resolve(char* dst, const unsigned char* src, const size_t n);
+static void format_chars_resolve(char* dst, const unsigned char* src, const size_t n);
+
+/**
+ * Selects the specialized kernels (see RHD_FORMAT_FIXED_WIDTHS) of the kernels selected by format_init().
+ * The specialized kernels are generated at the end of the section of each instruction set.
+ */
+static void format_select_fixed(void);
+
+/**
+ * Table-driven scalar kernels (always available, used also for the tails of SIMD kernels)
+ */
+static void format_hexs_scalar(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case);
+static void format_formatted_chars_scalar(char* dst, const unsigned char* src, const size_t n);
+static void format_chars_scalar(char* dst, const unsigned char* src, const size_t n);
+
+#if defined(RHD_FORMAT_X86)
+/**
+ * SSE2 kernel (16 bytes per step): masks non printable bytes
+ */
+static void format_chars_sse2(char* dst, const unsigned char* src, const size_t n);
+
+/**
+ * SSSE3 kernels (16 bytes per step): PSHUFB interleaves the digits (or chars) with spaces
+ */
+static void format_hexs_ssse3(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case);
+static void format_formatted_chars_ssse3(char* dst, const unsigned char* src, const size_t n);
+
+/**
+ * AVX2 kernels (32 bytes per step): same as SSSE3, one 16 bytes block per 128 bits lane
+ */
+static void format_hexs_avx2(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case);
+static void format_formatted_chars_avx2(char* dst, const unsigned char* src, const size_t n);
+static void format_chars_avx2(char* dst, const unsigned char* src, const size_t n);
+#endif
+
+#if defined(RHD_FORMAT_NEON)
+/**
+ * NEON kernels (16 bytes per step): VST3 interleaves the digits (or chars) with spaces
+ */
+static void format_hexs_neon(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case);
+static void format_formatted_chars_neon(char* dst, const unsigned char* src, const size_t n);
+static void format_chars_neon(char* dst, const unsigned char* src, const size_t n);
+#endif
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Lookup tables: byte to "XX " (for each letter case) and byte to printable char
+ */
+static struct format_tables_tag {
+    char hexs[2][256][3];
+    char chars[256];
+} format_tables;
+
+/**
+ * Struct containing the selected kernels, and their specialized versions indexed by width
+ * (NULL for the widths without one, which are formatted by the generic kernels)
+ */
+static struct format_kernels_tag {
+    format_hex_kernel_t hexs;
+    format_kernel_t     formatted_chars;
+    format_kernel_t     chars;
+    format_hex_kernel_t fixed_hexs[RHD_FORMAT_FIXED_MAX + 1];
+    format_kernel_t     fixed_formatted_chars[RHD_FORMAT_FIXED_MAX + 1];
+    format_kernel_t     fixed_chars[RHD_FORMAT_FIXED_MAX + 1];
+} format_kernels = {format_hexs_resolve, format_formatted_chars_resolve, format_chars_resolve, {NULL}, {NULL}, {NULL}};
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+void format_init(void) {
+    const char* upper = RHD_FORMAT_HEX_DIGITS_UPPER;
+    const char* lower = RHD_FORMAT_HEX_DIGITS_LOWER;
+    size_t      c;
+
+    /* Fill lookup tables */
+    for (c = 0; c < 256; c++) {
+        format_tables.hexs[RHD_FORMAT_CASE_UPPER][c][0] = upper[c >> 4];
+        format_tables.hexs[RHD_FORMAT_CASE_UPPER][c][1] = upper[c & 0x0F];
+        format_tables.hexs[RHD_FORMAT_CASE_UPPER][c][2] = ' ';
+        format_tables.hexs[RHD_FORMAT_CASE_LOWER][c][0] = lower[c >> 4];
+        format_tables.hexs[RHD_FORMAT_CASE_LOWER][c][1] = lower[c & 0x0F];
+        format_tables.hexs[RHD_FORMAT_CASE_LOWER][c][2] = ' ';
+        format_tables.chars[c] = RHD_FORMAT_IS_PRINT(c) ? (char)c : '.';
+    }
+
+    /* Select kernels */
+    format_kernels.hexs            = format_hexs_scalar;
+    format_kernels.formatted_chars = format_formatted_chars_scalar;
+    format_kernels.chars           = format_chars_scalar;
+
+#if defined(RHD_FORMAT_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        format_kernels.chars = format_chars_sse2;
+    if (__builtin_cpu_supports("ssse3")) {
+        format_kernels.hexs            = format_hexs_ssse3;
+        format_kernels.formatted_chars = format_formatted_chars_ssse3;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        format_kernels.hexs            = format_hexs_avx2;
+        format_kernels.formatted_chars = format_formatted_chars_avx2;
+        format_kernels.chars           = format_chars_avx2;
+    }
+#elif defined(RHD_FORMAT_NEON)
+    format_kernels.hexs            = format_hexs_neon;
+    format_kernels.formatted_chars = format_formatted_chars_neon;
+    format_kernels.chars           = format_chars_neon;
+#endif
+
+    format_select_fixed();
+}
+
+
+void format_hexs(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    RHD_FORMAT_KERNEL(hexs, n)(dst, src, n, letter_case);
+}
+
+
+void format_formatted_chars(char* dst, const unsigned char* src, const size_t n) {
+    RHD_FORMAT_KERNEL(formatted_chars, n)(dst, src, n);
+}
+
+
+void format_chars(char* dst, const unsigned char* src, const size_t n) {
+    RHD_FORMAT_KERNEL(chars, n)(dst, src, n);
+}
+
+
+int format_append_hexs(abuf_t* ab, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    char* room;
+
+    if (n == 0)
+        return 0;
+
+    /* The kernel also writes the space after the last byte, which is then left out of "ab" */
+    if ((room = ab_extend(ab, n * 3)) == NULL)
+        return 1;
+    RHD_FORMAT_KERNEL(hexs, n)(room, src, n, letter_case);
+    ab->len += n * 3 - 1;
+
+    return 0;
+}
+
+
+int format_append_formatted_chars(abuf_t* ab, const unsigned char* src, const size_t n) {
+    char* room;
+
+    if (n == 0)
+        return 0;
+
+    /* The kernel also writes the space after the last char, which is then left out of "ab" */
+    if ((room = ab_extend(ab, n * 3)) == NULL)
+        return 1;
+    RHD_FORMAT_KERNEL(formatted_chars, n)(room, src, n);
+    ab->len += n * 3 - 1;
+
+    return 0;
+}
+
+
+int format_append_chars(abuf_t* ab, const unsigned char* src, const size_t n) {
+    char* room;
+
+    if ((room = ab_extend(ab, n)) == NULL)
+        return 1;
+    RHD_FORMAT_KERNEL(chars, n)(room, src, n);
+    ab->len += n;
+
+    return 0;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+/* RESOLVERS */
+
+static void format_hexs_resolve(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    format_init();
+    format_kernels.hexs(dst, src, n, letter_case);
+}
+
+
+static void format_formatted_chars_resolve(char* dst, const unsigned char* src, const size_t n) {
+    format_init();
+    format_kernels.formatted_chars(dst, src, n);
+}
+
+
+static void format_chars_resolve(char* dst, const unsigned char* src, const size_t n) {
+    format_init();
+    format_kernels.chars(dst, src, n);
+}
+
+
+/* SCALAR */
+
+static void format_hexs_scalar(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    size_t i;
+    for (i = 0; i < n; i++)
+        memcpy(&dst[i * 3], format_tables.hexs[letter_case][src[i]], 3);
+}
+
+
+static void format_formatted_chars_scalar(char* dst, const unsigned char* src, const size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        dst[i * 3]     = ' ';
+        dst[i * 3 + 1] = format_tables.chars[src[i]];
+        dst[i * 3 + 2] = ' ';
+    }
+}
+
+
+static void format_chars_scalar(char* dst, const unsigned char* src, const size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++)
+        dst[i] = format_tables.chars[src[i]];
+}
+
+
+#define RHD_FORMAT_FIXED_SCALAR(w) \
+    RHD_FORMAT_FIXED_HEX_KERNEL(static, format_hexs_scalar, w) \
+    RHD_FORMAT_FIXED_KERNEL(static, format_formatted_chars_scalar, w) \
+    RHD_FORMAT_FIXED_KERNEL(static, format_chars_scalar, w)
+RHD_FORMAT_FIXED_WIDTHS(RHD_FORMAT_FIXED_SCALAR)
+
+
+#if defined(RHD_FORMAT_X86)
+
+/* X86 */
+
+/* Shuffle masks used to spread 16 bytes over 48 chars (-1 = zeroed byte, later filled with a space) */
+#define RHD_FORMAT_HEXS_MASK_0  0, 1,-1, 2, 3,-1, 4, 5,-1, 6, 7,-1, 8, 9,-1,10
+#define RHD_FORMAT_HEXS_MASK_1A 11,-1,12,13,-1,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1
+#define RHD_FORMAT_HEXS_MASK_1B -1,-1,-1,-1,-1,-1,-1,-1, 0, 1,-1, 2, 3,-1, 4, 5
+#define RHD_FORMAT_HEXS_MASK_2  -1, 6, 7,-1, 8, 9,-1,10,11,-1,12,13,-1,14,15,-1
+#define RHD_FORMAT_CHARS_MASK_0 -1, 0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1
+#define RHD_FORMAT_CHARS_MASK_1  5,-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1,10
+#define RHD_FORMAT_CHARS_MASK_2 -1,-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15,-1
+
+/* Converts vector of nibbles "n" to their hexadecimal digits: n + '0' + (n > 9 ? letters : 0) */
+#define RHD_FORMAT_NIBBLES_TO_HEX_128(n, letters) \
+    _mm_add_epi8(_mm_add_epi8((n), _mm_set1_epi8('0')), _mm_and_si128(_mm_cmpgt_epi8((n), _mm_set1_epi8(9)), (letters)))
+#define RHD_FORMAT_NIBBLES_TO_HEX_256(n, letters) \
+    _mm256_add_epi8(_mm256_add_epi8((n), _mm256_set1_epi8('0')), _mm256_and_si256(_mm256_cmpgt_epi8((n), _mm256_set1_epi8(9)), (letters)))
+
+/* Replaces non printable bytes of vector "v" with '.': (v - 0x20) as unsigned must be <= 0x5E */
+#define RHD_FORMAT_MASK_CHARS_128(v, le) \
+    ((le) = _mm_sub_epi8((v), _mm_set1_epi8(0x20)), \
+     (le) = _mm_cmpeq_epi8(_mm_min_epu8((le), _mm_set1_epi8(0x5E)), (le)), \
+     _mm_or_si128(_mm_and_si128((le), (v)), _mm_andnot_si128((le), _mm_set1_epi8('.'))))
+#define RHD_FORMAT_MASK_CHARS_256(v, le) \
+    ((le) = _mm256_sub_epi8((v), _mm256_set1_epi8(0x20)), \
+     (le) = _mm256_cmpeq_epi8(_mm256_min_epu8((le), _mm256_set1_epi8(0x5E)), (le)), \
+     _mm256_or_si256(_mm256_and_si256((le), (v)), _mm256_andnot_si256((le), _mm256_set1_epi8('.'))))
+
+/* Spaces where "mask" has a zeroed byte (negative index) */
+#define RHD_FORMAT_SPACES_128(mask) _mm_and_si128(_mm_cmplt_epi8((mask), _mm_setzero_si128()), _mm_set1_epi8(' '))
+#define RHD_FORMAT_SPACES_256(mask) _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), (mask)), _mm256_set1_epi8(' '))
+
+
+__attribute__((target("sse2")))
+static void format_chars_sse2(char* dst, const unsigned char* src, const size_t n) {
+    __m128i v;
+    __m128i le;
+    size_t  i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        v = _mm_loadu_si128((const __m128i*)&src[i]);
+        _mm_storeu_si128((__m128i*)&dst[i], RHD_FORMAT_MASK_CHARS_128(v, le));
+    }
+
+    format_chars_scalar(&dst[i], &src[i], n - i);
+}
+
+
+__attribute__((target("ssse3")))
+static void format_hexs_ssse3(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    const __m128i letters = _mm_set1_epi8(RHD_FORMAT_LETTERS_OFFSET(letter_case));
+    const __m128i mask_0  = _mm_setr_epi8(RHD_FORMAT_HEXS_MASK_0);
+    const __m128i mask_1a = _mm_setr_epi8(RHD_FORMAT_HEXS_MASK_1A);
+    const __m128i mask_1b = _mm_setr_epi8(RHD_FORMAT_HEXS_MASK_1B);
+    const __m128i mask_2  = _mm_setr_epi8(RHD_FORMAT_HEXS_MASK_2);
+    const __m128i sp_0    = RHD_FORMAT_SPACES_128(mask_0);
+    const __m128i sp_1    = _mm_and_si128(RHD_FORMAT_SPACES_128(mask_1a), RHD_FORMAT_SPACES_128(mask_1b));
+    const __m128i sp_2    = RHD_FORMAT_SPACES_128(mask_2);
+    __m128i       v;
+    __m128i       hi;
+    __m128i       lo;
+    size_t        i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        v  = _mm_loadu_si128((const __m128i*)&src[i]);
+        hi = RHD_FORMAT_NIBBLES_TO_HEX_128(_mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)), letters);
+        lo = RHD_FORMAT_NIBBLES_TO_HEX_128(_mm_and_si128(v, _mm_set1_epi8(0x0F)), letters);
+
+        /* Pairs of digits ("Hh") of the first 8 bytes in "v", and of the last 8 bytes in "hi" */
+        v  = _mm_unpacklo_epi8(hi, lo);
+        hi = _mm_unpackhi_epi8(hi, lo);
+
+        _mm_storeu_si128((__m128i*)&dst[i * 3],      _mm_or_si128(_mm_shuffle_epi8(v, mask_0), sp_0));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 16], _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v, mask_1a),
+                                                                                _mm_shuffle_epi8(hi, mask_1b)), sp_1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 32], _mm_or_si128(_mm_shuffle_epi8(hi, mask_2), sp_2));
+    }
+
+    format_hexs_scalar(&dst[i * 3], &src[i], n - i, letter_case);
+}
+
+
+__attribute__((target("ssse3")))
+static void format_formatted_chars_ssse3(char* dst, const unsigned char* src, const size_t n) {
+    const __m128i mask_0 = _mm_setr_epi8(RHD_FORMAT_CHARS_MASK_0);
+    const __m128i mask_1 = _mm_setr_epi8(RHD_FORMAT_CHARS_MASK_1);
+    const __m128i mask_2 = _mm_setr_epi8(RHD_FORMAT_CHARS_MASK_2);
+    const __m128i sp_0   = RHD_FORMAT_SPACES_128(mask_0);
+    const __m128i sp_1   = RHD_FORMAT_SPACES_128(mask_1);
+    const __m128i sp_2   = RHD_FORMAT_SPACES_128(mask_2);
+    __m128i       v;
+    __m128i       le;
+    size_t        i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        v = _mm_loadu_si128((const __m128i*)&src[i]);
+        v = RHD_FORMAT_MASK_CHARS_128(v, le);
+
+        _mm_storeu_si128((__m128i*)&dst[i * 3],      _mm_or_si128(_mm_shuffle_epi8(v, mask_0), sp_0));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 16], _mm_or_si128(_mm_shuffle_epi8(v, mask_1), sp_1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 32], _mm_or_si128(_mm_shuffle_epi8(v, mask_2), sp_2));
+    }
+
+    format_formatted_chars_scalar(&dst[i * 3], &src[i], n - i);
+}
+
+
+__attribute__((target("avx2")))
+static void format_hexs_avx2(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    const __m256i letters = _mm256_set1_epi8(RHD_FORMAT_LETTERS_OFFSET(letter_case));
+    const __m256i mask_0  = _mm256_setr_epi8(RHD_FORMAT_HEXS_MASK_0 , RHD_FORMAT_HEXS_MASK_0 );
+    const __m256i mask_1a = _mm256_setr_epi8(RHD_FORMAT_HEXS_MASK_1A, RHD_FORMAT_HEXS_MASK_1A);
+    const __m256i mask_1b = _mm256_setr_epi8(RHD_FORMAT_HEXS_MASK_1B, RHD_FORMAT_HEXS_MASK_1B);
+    const __m256i mask_2  = _mm256_setr_epi8(RHD_FORMAT_HEXS_MASK_2 , RHD_FORMAT_HEXS_MASK_2 );
+    const __m256i sp_0    = RHD_FORMAT_SPACES_256(mask_0);
+    const __m256i sp_1    = _mm256_and_si256(RHD_FORMAT_SPACES_256(mask_1a), RHD_FORMAT_SPACES_256(mask_1b));
+    const __m256i sp_2    = RHD_FORMAT_SPACES_256(mask_2);
+    __m256i       v;
+    __m256i       hi;
+    __m256i       lo;
+    __m256i       c_0;
+    __m256i       c_1;
+    __m256i       c_2;
+    size_t        i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        v  = _mm256_loadu_si256((const __m256i*)&src[i]);
+        hi = RHD_FORMAT_NIBBLES_TO_HEX_256(_mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F)), letters);
+        lo = RHD_FORMAT_NIBBLES_TO_HEX_256(_mm256_and_si256(v, _mm256_set1_epi8(0x0F)), letters);
+
+        /* Unpacking and shuffling work inside each lane, so each lane holds one 16 bytes block */
+        v  = _mm256_unpacklo_epi8(hi, lo);
+        hi = _mm256_unpackhi_epi8(hi, lo);
+
+        c_0 = _mm256_or_si256(_mm256_shuffle_epi8(v, mask_0), sp_0);
+        c_1 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(v, mask_1a), _mm256_shuffle_epi8(hi, mask_1b)), sp_1);
+        c_2 = _mm256_or_si256(_mm256_shuffle_epi8(hi, mask_2), sp_2);
+
+        _mm_storeu_si128((__m128i*)&dst[i * 3],      _mm256_castsi256_si128(c_0));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 16], _mm256_castsi256_si128(c_1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 32], _mm256_castsi256_si128(c_2));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 48], _mm256_extracti128_si256(c_0, 1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 64], _mm256_extracti128_si256(c_1, 1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 80], _mm256_extracti128_si256(c_2, 1));
+    }
+
+    /* Clearing the upper halves avoids AVX to SSE transition penalties in the tail kernel */
+    _mm256_zeroupper();
+    format_hexs_ssse3(&dst[i * 3], &src[i], n - i, letter_case);
+}
+
+
+__attribute__((target("avx2")))
+static void format_formatted_chars_avx2(char* dst, const unsigned char* src, const size_t n) {
+    const __m256i mask_0 = _mm256_setr_epi8(RHD_FORMAT_CHARS_MASK_0, RHD_FORMAT_CHARS_MASK_0);
+    const __m256i mask_1 = _mm256_setr_epi8(RHD_FORMAT_CHARS_MASK_1, RHD_FORMAT_CHARS_MASK_1);
+    const __m256i mask_2 = _mm256_setr_epi8(RHD_FORMAT_CHARS_MASK_2, RHD_FORMAT_CHARS_MASK_2);
+    const __m256i sp_0   = RHD_FORMAT_SPACES_256(mask_0);
+    const __m256i sp_1   = RHD_FORMAT_SPACES_256(mask_1);
+    const __m256i sp_2   = RHD_FORMAT_SPACES_256(mask_2);
+    __m256i       v;
+    __m256i       le;
+    __m256i       c_0;
+    __m256i       c_1;
+    __m256i       c_2;
+    size_t        i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        v = _mm256_loadu_si256((const __m256i*)&src[i]);
+        v = RHD_FORMAT_MASK_CHARS_256(v, le);
+
+        c_0 = _mm256_or_si256(_mm256_shuffle_epi8(v, mask_0), sp_0);
+        c_1 = _mm256_or_si256(_mm256_shuffle_epi8(v, mask_1), sp_1);
+        c_2 = _mm256_or_si256(_mm256_shuffle_epi8(v, mask_2), sp_2);
+
+        _mm_storeu_si128((__m128i*)&dst[i * 3],      _mm256_castsi256_si128(c_0));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 16], _mm256_castsi256_si128(c_1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 32], _mm256_castsi256_si128(c_2));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 48], _mm256_extracti128_si256(c_0, 1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 64], _mm256_extracti128_si256(c_1, 1));
+        _mm_storeu_si128((__m128i*)&dst[i * 3 + 80], _mm256_extracti128_si256(c_2, 1));
+    }
+
+    /* Clearing the upper halves avoids AVX to SSE transition penalties in the tail kernel */
+    _mm256_zeroupper();
+    format_formatted_chars_ssse3(&dst[i * 3], &src[i], n - i);
+}
+
+
+__attribute__((target("avx2")))
+static void format_chars_avx2(char* dst, const unsigned char* src, const size_t n) {
+    __m256i v;
+    __m256i le;
+    size_t  i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        v = _mm256_loadu_si256((const __m256i*)&src[i]);
+        _mm256_storeu_si256((__m256i*)&dst[i], RHD_FORMAT_MASK_CHARS_256(v, le));
+    }
+
+    /* Clearing the upper halves avoids AVX to SSE transition penalties in the tail kernel */
+    _mm256_zeroupper();
+    format_chars_sse2(&dst[i], &src[i], n - i);
+}
+
+
+#define RHD_FORMAT_FIXED_X86(w) \
+    RHD_FORMAT_FIXED_KERNEL(__attribute__((target("sse2"))) static, format_chars_sse2, w) \
+    RHD_FORMAT_FIXED_HEX_KERNEL(__attribute__((target("ssse3"))) static, format_hexs_ssse3, w) \
+    RHD_FORMAT_FIXED_KERNEL(__attribute__((target("ssse3"))) static, format_formatted_chars_ssse3, w) \
+    RHD_FORMAT_FIXED_HEX_KERNEL(__attribute__((target("avx2"))) static, format_hexs_avx2, w) \
+    RHD_FORMAT_FIXED_KERNEL(__attribute__((target("avx2"))) static, format_formatted_chars_avx2, w) \
+    RHD_FORMAT_FIXED_KERNEL(__attribute__((target("avx2"))) static, format_chars_avx2, w)
+RHD_FORMAT_FIXED_WIDTHS(RHD_FORMAT_FIXED_X86)
+
+#endif  /* RHD_FORMAT_X86 */
+
+
+#if defined(RHD_FORMAT_NEON)
+
+/* NEON */
+
+/* Converts vector of nibbles "n" to their hexadecimal digits: n + '0' + (n > 9 ? letters : 0) */
+#define RHD_FORMAT_NIBBLES_TO_HEX_NEON(n, letters) \
+    vaddq_u8(vaddq_u8((n), vdupq_n_u8('0')), vandq_u8(vcgtq_u8((n), vdupq_n_u8(9)), (letters)))
+
+/* Replaces non printable bytes of vector "v" with '.': (v - 0x20) must be <= 0x5E */
+#define RHD_FORMAT_MASK_CHARS_NEON(v) \
+    vbslq_u8(vcleq_u8(vsubq_u8((v), vdupq_n_u8(0x20)), vdupq_n_u8(0x5E)), (v), vdupq_n_u8('.'))
+
+
+static void format_hexs_neon(char* dst, const unsigned char* src, const size_t n, const format_case_t letter_case) {
+    const uint8x16_t letters = vdupq_n_u8(RHD_FORMAT_LETTERS_OFFSET(letter_case));
+    uint8x16_t   v;
+    uint8x16x3_t out;
+    size_t       i;
+
+    out.val[2] = vdupq_n_u8(' ');
+    for (i = 0; i + 16 <= n; i += 16) {
+        v = vld1q_u8(&src[i]);
+        out.val[0] = RHD_FORMAT_NIBBLES_TO_HEX_NEON(vshrq_n_u8(v, 4), letters);
+        out.val[1] = RHD_FORMAT_NIBBLES_TO_HEX_NEON(vandq_u8(v, vdupq_n_u8(0x0F)), letters);
+        vst3q_u8((unsigned char*)&dst[i * 3], out);
+    }
+
+    format_hexs_scalar(&dst[i * 3], &src[i], n - i, letter_case);
+}
+
+
+static void format_formatted_chars_neon(char* dst, const unsigned char* src, const size_t n) {
+    uint8x16x3_t out;
+    size_t       i;
+
+    out.val[0] = vdupq_n_u8(' ');
+    out.val[2] = vdupq_n_u8(' ');
+    for (i = 0; i + 16 <= n; i += 16) {
+        out.val[1] = RHD_FORMAT_MASK_CHARS_NEON(vld1q_u8(&src[i]));
+        vst3q_u8((unsigned char*)&dst[i * 3], out);
+    }
+
+    format_formatted_chars_scalar(&dst[i * 3], &src[i], n - i);
+}
+
+
+static void format_chars_neon(char* dst, const unsigned char* src, const size_t n) {
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+        vst1q_u8((unsigned char*)&dst[i], RHD_FORMAT_MASK_CHARS_NEON(vld1q_u8(&src[i])));
+
+    format_chars_scalar(&dst[i], &src[i], n - i);
+}
+
+
+#define RHD_FORMAT_FIXED_NEON(w) \
+    RHD_FORMAT_FIXED_HEX_KERNEL(static, format_hexs_neon, w) \
+    RHD_FORMAT_FIXED_KERNEL(static, format_formatted_chars_neon, w) \
+    RHD_FORMAT_FIXED_KERNEL(static, format_chars_neon, w)
+RHD_FORMAT_FIXED_WIDTHS(RHD_FORMAT_FIXED_NEON)
+
+#endif  /* RHD_FORMAT_NEON */
+
+
+/* FIXED WIDTHS */
+
+static void format_select_fixed(void) {
+#define RHD_FORMAT_SELECT_SCALAR(w) \
+    RHD_FORMAT_SELECT_FIXED(hexs, format_hexs_scalar, w) \
+    RHD_FORMAT_SELECT_FIXED(formatted_chars, format_formatted_chars_scalar, w) \
+    RHD_FORMAT_SELECT_FIXED(chars, format_chars_scalar, w)
+    RHD_FORMAT_FIXED_WIDTHS(RHD_FORMAT_SELECT_SCALAR)
+
+#if defined(RHD_FORMAT_X86)
+#define RHD_FORMAT_SELECT_X86(w) \
+    RHD_FORMAT_SELECT_FIXED(chars, format_chars_sse2, w) \
+    RHD_FORMAT_SELECT_FIXED(hexs, format_hexs_ssse3, w) \
+    RHD_FORMAT_SELECT_FIXED(formatted_chars, format_formatted_chars_ssse3, w) \
+    RHD_FORMAT_SELECT_FIXED(hexs, format_hexs_avx2, w) \
+    RHD_FORMAT_SELECT_FIXED(formatted_chars, format_formatted_chars_avx2, w) \
+    RHD_FORMAT_SELECT_FIXED(chars, format_chars_avx2, w)
+    RHD_FORMAT_FIXED_WIDTHS(RHD_FORMAT_SELECT_X86)
+#elif defined(RHD_FORMAT_NEON)
+#define RHD_FORMAT_SELECT_NEON(w) \
+    RHD_FORMAT_SELECT_FIXED(hexs, format_hexs_neon, w) \
+    RHD_FORMAT_SELECT_FIXED(formatted_chars, format_formatted_chars_neon, w) \
+    RHD_FORMAT_SELECT_FIXED(chars, format_chars_neon, w)
+    RHD_FORMAT_FIXED_WIDTHS(RHD_FORMAT_SELECT_NEON)
+#endif
+}
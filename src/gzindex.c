@@ -0,0 +1,666 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file gzindex.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for pread and pthreads) */
+
+/* C89 standard */
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef RHD_ZLIB
+#include <zlib.h>
+#endif
+
+#include "file.h"
+#include "stats.h"
+
+#include "gzindex.h"
+
+
+#ifdef RHD_ZLIB
+
+/* Decompressed bytes between two access points */
+#define RHD_GZINDEX_SPAN ((off_t)1 << 20)
+
+/* Length of the content before an access point needed to decompress from it (the max
+   distance of the back-references of deflate) */
+#define RHD_GZINDEX_WINDOW_LEN ((size_t)1 << 15)
+
+/* Amount of compressed bytes read at once */
+#define RHD_GZINDEX_INPUT_LEN ((size_t)1 << 14)
+
+/* Length of the gzip trailer (CRC-32 and length of the member) */
+#define RHD_GZINDEX_TRAILER_LEN 8
+
+/* Files compressed in less bytes than this are indexed again, instead of saving their index */
+#define RHD_GZINDEX_SAVE_MIN ((off_t)1 << 22)
+
+/* First bytes of the content of a sidecar file */
+#define RHD_GZINDEX_MAGIC "RHDGZI1\n"
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Struct containing an access point, where decompressing can start (in the middle of the
+ * deflate stream of a member of the file, at the start of one of its blocks)
+ */
+typedef struct gzindex_point_tag {
+    off_t         out;    /* Offset of the decompressed content */
+    off_t         in;     /* Offset of the first compressed byte (that is partial, if "bits" > 0) */
+    int           bits;   /* Bits of the byte before "in" that belong to the block */
+    unsigned char window[RHD_GZINDEX_WINDOW_LEN];
+} gzindex_point_t;
+
+/**
+ * Struct containing a decompression in progress
+ */
+typedef struct gzindex_decoder_tag {
+    z_stream      strm;
+    off_t         in;       /* Offset of the next compressed byte to read */
+    off_t         out;      /* Offset of the next decompressed byte */
+    int           is_raw;   /* 1 while decompressing the member of the access point it started from */
+    size_t        trailer;  /* Bytes of the trailer of that member still to skip */
+    unsigned char input[RHD_GZINDEX_INPUT_LEN];
+} gzindex_decoder_t;
+
+/**
+ * Struct containing the index of a gzip file
+ */
+struct gzindex_tag {
+    int                fd;
+    off_t              len;       /* Decompressed length */
+    gzindex_point_t*   points;    /* Ordered by "out" (the first one is at 0) */
+    size_t             n_points;
+    size_t             cap;
+    gzindex_decoder_t* cursor;    /* Decoder of the last read, where the next one continues if it
+                                     is closer than the access points (like sequential reads) */
+    pthread_mutex_t    lock;      /* Protects "cursor" */
+};
+
+/**
+ * Struct containing what identifies the file of a sidecar file
+ */
+typedef struct gzindex_key_tag {
+    dev_t  dev;
+    ino_t  ino;
+    off_t  size;
+    time_t mtime;
+    long   mtime_nsec;
+    off_t  span;
+} gzindex_key_t;
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Builds the index of the file, decompressing it whole.
+ * If successful returns 0, else the same codes of gzindex_open().
+ */
+static int gzindex_build(gzindex_t* index);
+
+/**
+ * Appends an access point, at the current position of "strm" (whose last "window" is circular,
+ * with the next byte to write at "window" + RHD_GZINDEX_WINDOW_LEN - "strm->avail_out").
+ * If successful returns 0, else 1.
+ */
+static int gzindex_add(gzindex_t* index, const z_stream* strm, const unsigned char* window,
+                       const off_t in, const off_t out);
+
+/**
+ * Allocates "decoder", starting from the access point "point".
+ * If successful returns 0, else 1.
+ */
+static int gzindex_decoder_start(gzindex_t* index, gzindex_decoder_t** decoder, const gzindex_point_t* point);
+
+/**
+ * Decompresses into "dst" (at most) "len" bytes of the content of the file starting from "pos",
+ * continuing with "decoder" (whose position must not be after "pos").
+ * If successful returns the amount of bytes decompressed, else (size_t)-1 (then "decoder" can
+ * only be freed).
+ */
+static size_t gzindex_decoder_run(gzindex_t* index, gzindex_decoder_t* decoder, unsigned char* dst, const off_t pos, const size_t len);
+
+/**
+ * Frees "decoder" (if not NULL).
+ */
+static void gzindex_decoder_free(gzindex_decoder_t* decoder);
+
+/**
+ * Reads into "buf" the next compressed bytes (at most RHD_GZINDEX_INPUT_LEN) of the file,
+ * starting from "*in" (that is moved after them), and makes them the input of "strm".
+ * If successful returns the amount of bytes read (0 at the end of the file), else (size_t)-1.
+ */
+static size_t gzindex_input(gzindex_t* index, z_stream* strm, unsigned char* buf, off_t* in);
+
+/**
+ * Loads the index from the "sidecar" file, if it holds the one of the file with the given "key".
+ * If successful returns 0, else 1.
+ */
+static int gzindex_load(gzindex_t* index, const char* sidecar, const gzindex_key_t* key);
+
+/**
+ * Checks that the access points of the index (loaded from a sidecar file) are consistent with each
+ * other, and with the file with the given "key" (so that a corrupt sidecar file is never used).
+ * If they are returns 0, else 1.
+ */
+static int gzindex_check(gzindex_t* index, const gzindex_key_t* key);
+
+/**
+ * Saves the index to the "sidecar" file, with the given "key".
+ * If successful returns 0, else 1.
+ */
+static int gzindex_save(gzindex_t* index, const char* sidecar, const gzindex_key_t* key);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int gzindex_open(gzindex_t** index, const int fd, const struct stat* st, const char* sidecar) {
+    gzindex_t*    x;
+    gzindex_key_t key;
+    unsigned char magic[2];
+    int           ret;
+
+    /* Only regular files starting with the magic bytes of gzip are indexed */
+    *index = NULL;
+    if (!S_ISREG(st->st_mode) || pread(fd, magic, sizeof(magic), 0) != (ssize_t)sizeof(magic) ||
+        magic[0] != 0x1F || magic[1] != 0x8B)
+        return 1;
+
+    if ((x = calloc(1, sizeof(*x))) == NULL)
+        return 2;
+    if (pthread_mutex_init(&x->lock, NULL) != 0) {
+        free(x);
+        return 2;
+    }
+    x->fd = fd;
+
+    memset(&key, 0, sizeof(key));
+    key.dev        = st->st_dev;
+    key.ino        = st->st_ino;
+    key.size       = st->st_size;
+    key.mtime      = st->st_mtime;
+    key.mtime_nsec = file_mtime_nsec(st);
+    key.span       = RHD_GZINDEX_SPAN;
+
+    /* Loading the index from its sidecar file spares decompressing the whole file again */
+    if (sidecar == NULL || gzindex_load(x, sidecar, &key) != 0) {
+        if ((ret = gzindex_build(x)) != 0) {
+            gzindex_close(x);
+            return ret;
+        }
+        if (sidecar != NULL && st->st_size >= RHD_GZINDEX_SAVE_MIN)
+            gzindex_save(x, sidecar, &key);
+    }
+
+    *index = x;
+    return 0;
+}
+
+
+void gzindex_close(gzindex_t* index) {
+    gzindex_decoder_free(index->cursor);
+    pthread_mutex_destroy(&index->lock);
+    free(index->points);
+    free(index);
+}
+
+
+off_t gzindex_length(gzindex_t* index) {
+    return index->len;
+}
+
+
+size_t gzindex_read(gzindex_t* index, unsigned char* dst, const off_t pos, const size_t len) {
+    const gzindex_point_t* point;
+    gzindex_decoder_t*     decoder;
+    size_t                 n_bytes_read;
+    size_t                 first;
+    size_t                 last;
+    size_t                 mid;
+
+    if (pos < 0)
+        return (size_t)-1;
+    if (pos >= index->len || len == 0)
+        return 0;
+
+    /* Find the last access point before "pos" */
+    for (first = 0, last = index->n_points; last - first > 1;) {
+        mid = first + (last - first) / 2;
+        if (index->points[mid].out <= pos)
+            first = mid;
+        else
+            last = mid;
+    }
+    point = &index->points[first];
+
+    /* Continue the last read, if it ended between the access point and "pos" */
+    pthread_mutex_lock(&index->lock);
+    if (index->cursor != NULL && index->cursor->out <= pos && index->cursor->out >= point->out) {
+        if ((n_bytes_read = gzindex_decoder_run(index, index->cursor, dst, pos, len)) == (size_t)-1) {
+            gzindex_decoder_free(index->cursor);
+            index->cursor = NULL;
+        }
+        pthread_mutex_unlock(&index->lock);
+        return n_bytes_read;
+    }
+    pthread_mutex_unlock(&index->lock);
+
+    /* Else start from the access point (without holding the lock), then make this read the one
+       to continue */
+    if (gzindex_decoder_start(index, &decoder, point) != 0)
+        return (size_t)-1;
+    if ((n_bytes_read = gzindex_decoder_run(index, decoder, dst, pos, len)) == (size_t)-1) {
+        gzindex_decoder_free(decoder);
+        return (size_t)-1;
+    }
+    pthread_mutex_lock(&index->lock);
+    gzindex_decoder_free(index->cursor);
+    index->cursor = decoder;
+    pthread_mutex_unlock(&index->lock);
+
+    return n_bytes_read;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static int gzindex_build(gzindex_t* index) {
+    unsigned char input[RHD_GZINDEX_INPUT_LEN];
+    unsigned char window[RHD_GZINDEX_WINDOW_LEN];
+    z_stream      strm;
+    off_t         in;
+    off_t         total_in;
+    off_t         total_out;
+    off_t         last;
+    int           is_member_new;
+    int           ret;
+
+    memset(&strm, 0, sizeof(strm));
+    memset(window, 0, sizeof(window));
+    if (inflateInit2(&strm, 31) != Z_OK)
+        return 2;
+
+    /* Decompress the whole file (into the circular "window", that holds the last decompressed
+       bytes), stopping at the end of each deflate block to add an access point every
+       RHD_GZINDEX_SPAN bytes */
+    in            = 0;
+    total_in      = 0;
+    total_out     = 0;
+    last          = 0;
+    is_member_new = 1;
+    for (;;) {
+        if (strm.avail_in == 0) {
+            switch (gzindex_input(index, &strm, input, &in)) {
+                case (size_t)-1:
+                    inflateEnd(&strm);
+                    return 2;
+                case 0:
+                    /* The file ended in the middle of a member */
+                    inflateEnd(&strm);
+                    return 2;
+                default:
+                    break;
+            }
+        }
+        if (strm.avail_out == 0) {
+            strm.next_out  = window;
+            strm.avail_out = (uInt)sizeof(window);
+        }
+
+        total_in  += strm.avail_in;
+        total_out += strm.avail_out;
+        ret        = inflate(&strm, Z_BLOCK);
+        total_in  -= strm.avail_in;
+        total_out -= strm.avail_out;
+
+        /* (bytes that are not a gzip member after the first one are ignored, like gzip does) */
+        if (ret == Z_DATA_ERROR && is_member_new && index->n_points > 0)
+            break;
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            inflateEnd(&strm);
+            return 2;
+        }
+
+        if (ret == Z_STREAM_END) {
+            /* The file can hold multiple members (their content is concatenated) */
+            if (strm.avail_in == 0) {
+                if (gzindex_input(index, &strm, input, &in) == 0)
+                    break;
+            }
+            if (inflateReset(&strm) != Z_OK) {
+                inflateEnd(&strm);
+                return 2;
+            }
+            is_member_new = 1;
+            continue;
+        }
+        if (total_out > 0)
+            is_member_new = 0;
+
+        /* At the end of a block (not the last one of its member) */
+        if ((strm.data_type & 128) && !(strm.data_type & 64) && (index->n_points == 0 || total_out - last >= RHD_GZINDEX_SPAN)) {
+            if (gzindex_add(index, &strm, window, total_in, total_out) != 0) {
+                inflateEnd(&strm);
+                return 2;
+            }
+            last = total_out;
+        }
+    }
+    inflateEnd(&strm);
+
+    index->len = total_out;
+    return index->n_points > 0 ? 0 : 2;
+}
+
+
+static int gzindex_add(gzindex_t* index, const z_stream* strm, const unsigned char* window,
+                       const off_t in, const off_t out) {
+    gzindex_point_t* new_points;
+    gzindex_point_t* point;
+    size_t           left;
+
+    if (index->n_points == index->cap) {
+        if ((new_points = realloc(index->points, (index->cap == 0 ? 16 : index->cap * 2) * sizeof(*new_points))) == NULL)
+            return 1;
+        stats_add(RHD_STATS_ALLOCS, 1);
+        index->points = new_points;
+        index->cap    = index->cap == 0 ? 16 : index->cap * 2;
+    }
+
+    point       = &index->points[index->n_points++];
+    point->out  = out;
+    point->in   = in;
+    point->bits = strm->data_type & 7;
+
+    /* Unroll the circular window (the oldest bytes are the ones after the next byte to write) */
+    left = strm->avail_out;
+    if (left > 0)
+        memcpy(point->window, &window[RHD_GZINDEX_WINDOW_LEN - left], left);
+    if (left < RHD_GZINDEX_WINDOW_LEN)
+        memcpy(&point->window[left], window, RHD_GZINDEX_WINDOW_LEN - left);
+
+    return 0;
+}
+
+
+static int gzindex_decoder_start(gzindex_t* index, gzindex_decoder_t** decoder, const gzindex_point_t* point) {
+    gzindex_decoder_t* d;
+
+    if ((d = calloc(1, sizeof(*d))) == NULL)
+        return 1;
+    stats_add(RHD_STATS_ALLOCS, 1);
+    if (inflateInit2(&d->strm, -15) != Z_OK) {
+        free(d);
+        return 1;
+    }
+    d->in     = point->in;
+    d->out    = point->out;
+    d->is_raw = 1;
+
+    /* The member of the access point is decompressed as a raw deflate stream, starting with the
+       bits of the partial byte before it (if any), and with the content before it */
+    if (point->bits > 0) {
+        stats_add(RHD_STATS_READS, 1);
+        if (pread(index->fd, d->input, 1, d->in - 1) != 1) {
+            gzindex_decoder_free(d);
+            return 1;
+        }
+        inflatePrime(&d->strm, point->bits, d->input[0] >> (8 - point->bits));
+    }
+    if (inflateSetDictionary(&d->strm, point->window, (uInt)RHD_GZINDEX_WINDOW_LEN) != Z_OK) {
+        gzindex_decoder_free(d);
+        return 1;
+    }
+
+    *decoder = d;
+    return 0;
+}
+
+
+static size_t gzindex_decoder_run(gzindex_t* index, gzindex_decoder_t* decoder, unsigned char* dst, const off_t pos, const size_t len) {
+    unsigned char discard[RHD_GZINDEX_INPUT_LEN];
+    z_stream*     strm = &decoder->strm;
+    size_t        n_bytes_read;
+    size_t        n;
+    uInt          avail;
+    int           is_skipping;
+    int           ret;
+
+    /* Decompress (discarding the bytes before "pos") until "len" bytes are decompressed. The
+       following members of the file are decompressed as gzip streams (skipping their headers). */
+    n_bytes_read = 0;
+    while (n_bytes_read < len && decoder->out < index->len) {
+        if (strm->avail_in == 0) {
+            if ((n = gzindex_input(index, strm, decoder->input, &decoder->in)) == (size_t)-1)
+                return (size_t)-1;
+            if (n == 0)
+                break;
+        }
+
+        if (decoder->trailer > 0) {
+            avail             = strm->avail_in < decoder->trailer ? strm->avail_in : (uInt)decoder->trailer;
+            strm->next_in    += avail;
+            strm->avail_in   -= avail;
+            decoder->trailer -= avail;
+            if (decoder->trailer == 0 && inflateReset2(strm, 31) != Z_OK)
+                return (size_t)-1;
+            continue;
+        }
+
+        if ((is_skipping = decoder->out < pos)) {
+            strm->next_out  = discard;
+            strm->avail_out = (uInt)(pos - decoder->out < (off_t)sizeof(discard) ? (size_t)(pos - decoder->out) : sizeof(discard));
+        } else {
+            strm->next_out  = &dst[n_bytes_read];
+            strm->avail_out = (uInt)(len - n_bytes_read);
+        }
+        avail         = strm->avail_out;
+        ret           = inflate(strm, Z_NO_FLUSH);
+        decoder->out += (off_t)(avail - strm->avail_out);
+        if (!is_skipping)
+            n_bytes_read += avail - strm->avail_out;
+
+        if (ret == Z_STREAM_END) {
+            /* The member decompressed as a raw deflate stream has its trailer left, the following
+               ones (decompressed as gzip streams) don't */
+            if (decoder->is_raw) {
+                decoder->trailer = RHD_GZINDEX_TRAILER_LEN;
+                decoder->is_raw  = 0;
+            } else if (inflateReset(strm) != Z_OK) {
+                return (size_t)-1;
+            }
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            return (size_t)-1;
+        }
+    }
+
+    return n_bytes_read;
+}
+
+
+static void gzindex_decoder_free(gzindex_decoder_t* decoder) {
+    if (decoder == NULL)
+        return;
+    inflateEnd(&decoder->strm);
+    free(decoder);
+}
+
+
+static size_t gzindex_input(gzindex_t* index, z_stream* strm, unsigned char* buf, off_t* in) {
+    ssize_t n;
+
+    do {
+        stats_add(RHD_STATS_READS, 1);
+        n = pread(index->fd, buf, RHD_GZINDEX_INPUT_LEN, *in);
+    } while (n == -1 && errno == EINTR);
+    if (n == -1)
+        return (size_t)-1;
+
+    *in           += (off_t)n;
+    strm->next_in  = buf;
+    strm->avail_in = (uInt)n;
+
+    return (size_t)n;
+}
+
+
+static int gzindex_load(gzindex_t* index, const char* sidecar, const gzindex_key_t* key) {
+    gzindex_key_t other;
+    char          magic[sizeof(RHD_GZINDEX_MAGIC) - 1];
+    FILE*         f;
+    size_t        n_points;
+    int           is_key_matching;
+    int           ret;
+
+    if ((f = fopen(sidecar, "rb")) == NULL)
+        return 1;
+
+    ret             = 1;
+    is_key_matching = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                      memcmp(magic, RHD_GZINDEX_MAGIC, sizeof(magic)) == 0 &&
+                      fread(&other, sizeof(other), 1, f) == 1 && memcmp(key, &other, sizeof(other)) == 0;
+    if (is_key_matching && fread(&index->len, sizeof(index->len), 1, f) == 1 &&
+        fread(&n_points, sizeof(n_points), 1, f) == 1 && index->len >= 0 &&
+        n_points > 0 && n_points <= (size_t)(index->len / RHD_GZINDEX_SPAN) + 1 &&
+        (index->points = malloc(n_points * sizeof(*index->points))) != NULL) {
+        stats_add(RHD_STATS_ALLOCS, 1);
+        index->cap = n_points;
+        if (fread(index->points, sizeof(*index->points), n_points, f) == n_points) {
+            index->n_points = n_points;
+            ret             = gzindex_check(index, key);
+        }
+    }
+    fclose(f);
+
+    /* The sidecar file of this file that is truncated or corrupt is removed (the index is then
+       built again, and saved to a new one). The one of another file (whose name collides) is
+       left alone. */
+    if (ret != 0 && is_key_matching)
+        remove(sidecar);
+
+    if (ret != 0) {
+        free(index->points);
+        index->points   = NULL;
+        index->n_points = 0;
+        index->cap      = 0;
+        index->len      = 0;
+    }
+
+    return ret;
+}
+
+
+static int gzindex_check(gzindex_t* index, const gzindex_key_t* key) {
+    const gzindex_point_t* point;
+    size_t                 i;
+
+    /* The first access point is at the start of the content, and the offsets never decrease */
+    if (index->points[0].out != 0)
+        return 1;
+    for (i = 0; i < index->n_points; i++) {
+        point = &index->points[i];
+        if (point->bits < 0 || point->bits > 7 || point->in < (point->bits > 0 ? 1 : 0) ||
+            point->in > key->size || point->out > index->len)
+            return 1;
+        if (i > 0 && (point->in < point[-1].in || point->out < point[-1].out))
+            return 1;
+    }
+
+    return 0;
+}
+
+
+static int gzindex_save(gzindex_t* index, const char* sidecar, const gzindex_key_t* key) {
+    char  temp[FILENAME_MAX + 4];
+    FILE* f;
+    int   ret;
+
+    if (strlen(sidecar) >= FILENAME_MAX)
+        return 1;
+
+    /* Write a temporary file, then rename it, so that a sidecar file is never half written */
+    sprintf(temp, "%s.tmp", sidecar);
+    if ((f = fopen(temp, "wb")) == NULL)
+        return 1;
+    ret = fwrite(RHD_GZINDEX_MAGIC, 1, sizeof(RHD_GZINDEX_MAGIC) - 1, f) != sizeof(RHD_GZINDEX_MAGIC) - 1 ||
+          fwrite(key, sizeof(*key), 1, f) != 1 ||
+          fwrite(&index->len, sizeof(index->len), 1, f) != 1 ||
+          fwrite(&index->n_points, sizeof(index->n_points), 1, f) != 1 ||
+          fwrite(index->points, sizeof(*index->points), index->n_points, f) != index->n_points;
+    if (fclose(f) == EOF)
+        ret = 1;
+    if (ret == 0 && rename(temp, sidecar) != 0)
+        ret = 1;
+    if (ret != 0)
+        remove(temp);
+
+    return ret;
+}
+
+
+#else  /* RHD_ZLIB */
+
+/* Without zlib no file is a gzip file (see gzindex_open()) */
+
+int gzindex_open(gzindex_t** index, const int fd, const struct stat* st, const char* sidecar) {
+    (void)fd;
+    (void)st;
+    (void)sidecar;
+    *index = NULL;
+    return 1;
+}
+
+
+void gzindex_close(gzindex_t* index) {
+    (void)index;
+}
+
+
+off_t gzindex_length(gzindex_t* index) {
+    (void)index;
+    return -1;
+}
+
+
+size_t gzindex_read(gzindex_t* index, unsigned char* dst, const off_t pos, const size_t len) {
+    (void)index;
+    (void)dst;
+    (void)pos;
+    (void)len;
+    return (size_t)-1;
+}
+
+#endif  /* RHD_ZLIB */
@@ -0,0 +1,236 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file hits.c */
+
+
+/* C89 standard */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "hits.h"
+
+
+/* Max amount of bytes of a delta (7 bits per byte) */
+#define RHD_HITS_DELTA_MAX ((sizeof(off_t) * 8 + 6) / 7)
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Decodes the delta starting at "data[*pos]", moving "*pos" after it.
+ */
+static off_t hits_decode(const unsigned char* data, size_t* pos);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int hits_append(hits_t* hits, const off_t hit) {
+    off_t*         new_bases;
+    size_t*        new_starts;
+    unsigned char* new_data;
+    size_t         new_cap;
+    off_t          delta;
+
+    if (hits->n_hits % RHD_HITS_BLOCK_LEN == 0) {
+        /* First hit of a new block */
+        if (hits->n_blocks == hits->blocks_cap) {
+            new_cap = hits->blocks_cap == 0 ? 16 : hits->blocks_cap * 2;
+            if ((new_bases = realloc(hits->bases, new_cap * sizeof(*hits->bases))) == NULL)
+                return 1;
+            hits->bases = new_bases;
+            if ((new_starts = realloc(hits->starts, new_cap * sizeof(*hits->starts))) == NULL)
+                return 1;
+            hits->starts     = new_starts;
+            hits->blocks_cap = new_cap;
+        }
+        hits->bases[hits->n_blocks]  = hit;
+        hits->starts[hits->n_blocks] = hits->data_len;
+        hits->n_blocks++;
+    } else {
+        /* Distance from the previous hit */
+        if (hits->data_cap - hits->data_len < RHD_HITS_DELTA_MAX) {
+            new_cap = hits->data_cap < 64 ? 64 : hits->data_cap * 2;
+            if ((new_data = realloc(hits->data, new_cap)) == NULL)
+                return 1;
+            hits->data     = new_data;
+            hits->data_cap = new_cap;
+        }
+        for (delta = hit - hits->last; delta >= 0x80; delta >>= 7)
+            hits->data[hits->data_len++] = (unsigned char)((delta & 0x7F) | 0x80);
+        hits->data[hits->data_len++] = (unsigned char)delta;
+    }
+
+    hits->last = hit;
+    hits->n_hits++;
+
+    return 0;
+}
+
+
+off_t hits_get(const hits_t* hits, const size_t i) {
+    off_t  hit;
+    size_t pos;
+    size_t k;
+
+    hit = hits->bases[i / RHD_HITS_BLOCK_LEN];
+    pos = hits->starts[i / RHD_HITS_BLOCK_LEN];
+    for (k = 0; k < i % RHD_HITS_BLOCK_LEN; k++)
+        hit += hits_decode(hits->data, &pos);
+
+    return hit;
+}
+
+
+size_t hits_lower_bound(const hits_t* hits, const off_t from, const int is_strict) {
+    off_t  hit;
+    size_t lo;
+    size_t hi;
+    size_t mid;
+    size_t pos;
+    size_t i;
+
+    /* Binary search of the first block starting with a matching hit */
+    lo = 0;
+    hi = hits->n_blocks;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (is_strict ? hits->bases[mid] <= from : hits->bases[mid] < from)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    /* The first matching hit could still be inside the block before it */
+    if (lo > 0) {
+        hit = hits->bases[lo - 1];
+        pos = hits->starts[lo - 1];
+        for (i = (lo - 1) * RHD_HITS_BLOCK_LEN + 1; i < lo * RHD_HITS_BLOCK_LEN && i < hits->n_hits; i++) {
+            hit += hits_decode(hits->data, &pos);
+            if (is_strict ? hit > from : hit >= from)
+                return i;
+        }
+    }
+
+    return lo == hits->n_blocks ? hits->n_hits : lo * RHD_HITS_BLOCK_LEN;
+}
+
+
+int hits_save(const hits_t* hits, FILE* f) {
+    if (fwrite(&hits->n_hits, sizeof(hits->n_hits), 1, f) != 1 ||
+        fwrite(&hits->data_len, sizeof(hits->data_len), 1, f) != 1 ||
+        fwrite(&hits->last, sizeof(hits->last), 1, f) != 1)
+        return 1;
+    if (hits->n_blocks > 0 &&
+        (fwrite(hits->bases, sizeof(*hits->bases), hits->n_blocks, f) != hits->n_blocks ||
+         fwrite(hits->starts, sizeof(*hits->starts), hits->n_blocks, f) != hits->n_blocks))
+        return 1;
+    if (hits->data_len > 0 && fwrite(hits->data, 1, hits->data_len, f) != hits->data_len)
+        return 1;
+
+    return 0;
+}
+
+
+int hits_load(hits_t* hits, FILE* f) {
+    size_t n;
+    size_t count;
+    size_t pos;
+
+    if (fread(&hits->n_hits, sizeof(hits->n_hits), 1, f) != 1 ||
+        fread(&hits->data_len, sizeof(hits->data_len), 1, f) != 1 ||
+        fread(&hits->last, sizeof(hits->last), 1, f) != 1)
+        return 1;
+
+    /* A block for each RHD_HITS_BLOCK_LEN hits, and at most RHD_HITS_DELTA_MAX bytes for each of the others */
+    hits->n_blocks = (hits->n_hits + RHD_HITS_BLOCK_LEN - 1) / RHD_HITS_BLOCK_LEN;
+    if (hits->data_len > (hits->n_hits - hits->n_blocks) * RHD_HITS_DELTA_MAX)
+        return 1;
+
+    hits->blocks_cap = hits->n_blocks;
+    hits->data_cap   = hits->data_len;
+    if (hits->n_blocks > 0) {
+        if ((hits->bases = malloc(hits->n_blocks * sizeof(*hits->bases))) == NULL ||
+            (hits->starts = malloc(hits->n_blocks * sizeof(*hits->starts))) == NULL)
+            return 1;
+        if (fread(hits->bases, sizeof(*hits->bases), hits->n_blocks, f) != hits->n_blocks ||
+            fread(hits->starts, sizeof(*hits->starts), hits->n_blocks, f) != hits->n_blocks)
+            return 1;
+    }
+    if (hits->data_len > 0) {
+        if ((hits->data = malloc(hits->data_len)) == NULL ||
+            fread(hits->data, 1, hits->data_len, f) != hits->data_len)
+            return 1;
+    }
+
+    /* The deltas of each block must end where the next block starts (so that decoding never
+       reads past them) */
+    for (n = 0; n < hits->n_blocks; n++) {
+        count = n + 1 < hits->n_blocks ? RHD_HITS_BLOCK_LEN - 1 : hits->n_hits - n * RHD_HITS_BLOCK_LEN - 1;
+        for (pos = hits->starts[n]; count > 0 && pos < hits->data_len; pos++) {
+            if (!(hits->data[pos] & 0x80))
+                count--;
+        }
+        if (count > 0 || pos != (n + 1 < hits->n_blocks ? hits->starts[n + 1] : hits->data_len))
+            return 1;
+    }
+
+    return 0;
+}
+
+
+void hits_free(hits_t* hits) {
+    free(hits->bases);
+    free(hits->starts);
+    free(hits->data);
+    hits->n_hits     = 0;
+    hits->n_blocks   = 0;
+    hits->bases      = NULL;
+    hits->starts     = NULL;
+    hits->blocks_cap = 0;
+    hits->data       = NULL;
+    hits->data_len   = 0;
+    hits->data_cap   = 0;
+    hits->last       = 0;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static off_t hits_decode(const unsigned char* data, size_t* pos) {
+    off_t  delta;
+    size_t shift;
+
+    delta = 0;
+    shift = 0;
+    do {
+        delta |= (off_t)(data[*pos] & 0x7F) << shift;
+        shift += 7;
+    } while (data[(*pos)++] & 0x80);
+
+    return delta;
+}
@@ -0,0 +1,234 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file inspect.c */
+
+
+/* C89 standard */
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "inspect.h"
+
+
+/* Bits of each half of a 64 bits value (each one is held in an unsigned long, which is at least 32 bits wide) */
+#define RHD_INSPECT_HALF_MASK 0xFFFFFFFFul
+
+/* Range of the timestamps that are shown (from year 1 to year 9999) */
+#define RHD_INSPECT_TIME_MIN -62135596800.0
+#define RHD_INSPECT_TIME_MAX 253402300799.0
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Gets into "hi" and "lo" the two halves of the 64 bits integer made of the "n" bytes of "bytes"
+ * (from 1 to 8), read with the given byte order (sign-extended if "is_signed").
+ */
+static void inspect_read(const unsigned char* bytes, const size_t n, const int is_big_endian, const int is_signed,
+                         unsigned long* hi, unsigned long* lo);
+
+/**
+ * Writes into "dst" the 64 bits unsigned integer made of the halves "hi" and "lo" in decimal form
+ * (C89 has no 64 bits integer type, so it is divided by 10 in pieces of 16 bits).
+ */
+static void inspect_format_dec(char* dst, const unsigned long hi, const unsigned long lo);
+
+/**
+ * Writes into "dst" the "n" bytes of "bytes" (4 or 8) read with the given byte order as a float
+ * (or a double), or "-" if the floating types of the machine are not that long.
+ */
+static void inspect_format_float(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+void inspect_decode(char lines[RHD_INSPECT_LINES][RHD_INSPECT_LINE_MAX], const off_t pos,
+                    const unsigned char* bytes, const size_t n, const int is_big_endian) {
+    static const char* const names[RHD_INSPECT_LINES - 1] = {
+        "u8", "i8", "u16", "i16", "u32", "i32", "u64", "i64", "f32", "f64", "t32", "t64"
+    };
+    static const size_t      lens[RHD_INSPECT_LINES - 1] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8, 4, 8};
+    unsigned char            pos_bytes[8];
+    char                     value[RHD_INSPECT_VALUE_MAX];
+    size_t                   i;
+
+    /* Position (as a big endian integer, so that it can be formatted like the values, since
+       off_t is 64 bits wide) */
+    for (i = 0; i < 8; i++)
+        pos_bytes[7 - i] = (unsigned char)((pos >> (i * 8)) & 0xFF);
+    inspect_format_hex(value, pos_bytes, 8, 1);
+    sprintf(lines[0], "@ %s %s endian", value, is_big_endian ? "big" : "little");
+
+    for (i = 0; i < RHD_INSPECT_LINES - 1; i++) {
+        if (lens[i] > n)
+            strcpy(value, "-");
+        else if (names[i][0] == 'f')
+            inspect_format_float(value, bytes, lens[i], is_big_endian);
+        else if (names[i][0] == 't')
+            inspect_format_time(value, bytes, lens[i], is_big_endian);
+        else
+            inspect_format_int(value, bytes, lens[i], is_big_endian, names[i][0] == 'i');
+        sprintf(lines[i + 1], "%-4s %s", names[i], value);
+    }
+}
+
+
+void inspect_format_int(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian, const int is_signed) {
+    unsigned long hi;
+    unsigned long lo;
+
+    inspect_read(bytes, n, is_big_endian, is_signed, &hi, &lo);
+
+    /* Negative numbers are written as the minus sign followed by their absolute value */
+    if (is_signed && (hi & 0x80000000ul)) {
+        lo    = (~lo + 1) & RHD_INSPECT_HALF_MASK;
+        hi    = (~hi + (lo == 0)) & RHD_INSPECT_HALF_MASK;
+        *dst++ = '-';
+    }
+    inspect_format_dec(dst, hi, lo);
+}
+
+
+void inspect_format_hex(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian) {
+    unsigned long hi;
+    unsigned long lo;
+
+    inspect_read(bytes, n, is_big_endian, 0, &hi, &lo);
+    if (hi != 0)
+        sprintf(dst, "0x%lX%08lX", hi, lo);
+    else
+        sprintf(dst, "0x%lX", lo);
+}
+
+
+void inspect_format_time(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian) {
+    unsigned long hi;
+    unsigned long lo;
+    double        seconds;
+    time_t        t;
+    struct tm*    tm;
+
+    /* Timestamps of 4 bytes are unsigned (so that they reach 2106), those of 8 bytes are signed */
+    inspect_read(bytes, n, is_big_endian, n == 8, &hi, &lo);
+    if (n == 8 && (hi & 0x80000000ul)) {
+        lo      = (~lo + 1) & RHD_INSPECT_HALF_MASK;
+        hi      = (~hi + (lo == 0)) & RHD_INSPECT_HALF_MASK;
+        seconds = -((double)hi * 4294967296.0 + (double)lo);
+    } else {
+        seconds = (double)hi * 4294967296.0 + (double)lo;
+    }
+
+    /* (the conversion to time_t must not overflow, since it would be undefined) */
+    strcpy(dst, "-");
+    if (seconds < RHD_INSPECT_TIME_MIN || seconds > RHD_INSPECT_TIME_MAX)
+        return;
+    if (sizeof(time_t) < 8 && (seconds < -2147483648.0 || seconds > 2147483647.0))
+        return;
+    t = (time_t)seconds;
+    if ((tm = gmtime(&t)) == NULL || strftime(dst, RHD_INSPECT_VALUE_MAX, "%Y-%m-%d %H:%M:%S", tm) == 0)
+        strcpy(dst, "-");
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static void inspect_read(const unsigned char* bytes, const size_t n, const int is_big_endian, const int is_signed,
+                         unsigned long* hi, unsigned long* lo) {
+    unsigned char le[8];
+    unsigned char fill;
+    size_t        i;
+
+    /* Put the bytes in little endian order, then sign-extend them (or pad them with zeros) */
+    for (i = 0; i < n; i++)
+        le[i] = is_big_endian ? bytes[n - 1 - i] : bytes[i];
+    fill = (unsigned char)(is_signed && (le[n - 1] & 0x80) ? 0xFF : 0x00);
+    for (; i < 8; i++)
+        le[i] = fill;
+
+    *lo = (unsigned long)le[0] | (unsigned long)le[1] << 8 | (unsigned long)le[2] << 16 | (unsigned long)le[3] << 24;
+    *hi = (unsigned long)le[4] | (unsigned long)le[5] << 8 | (unsigned long)le[6] << 16 | (unsigned long)le[7] << 24;
+}
+
+
+static void inspect_format_dec(char* dst, const unsigned long hi, const unsigned long lo) {
+    unsigned long pieces[4];
+    unsigned long rem;
+    char          temp[20];
+    size_t        n_digits;
+    size_t        i;
+
+    pieces[0] = hi >> 16;
+    pieces[1] = hi & 0xFFFF;
+    pieces[2] = lo >> 16;
+    pieces[3] = lo & 0xFFFF;
+
+    /* Get digits (from the least significant one), dividing the pieces by 10 from the most significant one */
+    n_digits = 0;
+    do {
+        rem = 0;
+        for (i = 0; i < 4; i++) {
+            pieces[i] |= rem << 16;
+            rem        = pieces[i] % 10;
+            pieces[i] /= 10;
+        }
+        temp[n_digits++] = (char)('0' + rem);
+    } while (pieces[0] != 0 || pieces[1] != 0 || pieces[2] != 0 || pieces[3] != 0);
+
+    while (n_digits > 0)
+        *dst++ = temp[--n_digits];
+    *dst = '\0';
+}
+
+
+static void inspect_format_float(char* dst, const unsigned char* bytes, const size_t n, const int is_big_endian) {
+    const unsigned int one = 1;
+    unsigned char      host[8];
+    float              f;
+    double             d;
+    int                is_host_big_endian;
+    size_t             i;
+
+    if ((n == 4 && sizeof(f) != 4) || (n == 8 && sizeof(d) != 8)) {
+        strcpy(dst, "-");
+        return;
+    }
+
+    /* Put the bytes in the byte order of the machine */
+    is_host_big_endian = *(const unsigned char*)&one == 0;
+    for (i = 0; i < n; i++)
+        host[i] = is_big_endian == is_host_big_endian ? bytes[i] : bytes[n - 1 - i];
+
+    if (n == 4) {
+        memcpy(&f, host, sizeof(f));
+        sprintf(dst, "%.9g", (double)f);
+    } else {
+        memcpy(&d, host, sizeof(d));
+        sprintf(dst, "%.17g", d);
+    }
+}
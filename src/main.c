@@ -36,48 +36,176 @@
 #define RHD_MAIN_VER RHD_MAIN_STR(RHD_MAIN_VER_MAJOR) "." RHD_MAIN_STR(RHD_MAIN_VER_MINOR) "." RHD_MAIN_STR(RHD_MAIN_VER_PATCH)
 
 
+/* Widest row accepted by -w (in bytes, rows are never wider than the terminal anyway) */
+#define RHD_MAIN_WIDTH_MAX 4096
+
+#define RHD_MAIN_USAGE "Usage: %s [-v | --version] [-h | --help] [-f | --follow] [--diff] [--stats] [-e | --edit] [-w | --width <bytes>] [--no-mmap] [--no-decompress] [--window <length>] [-d | --dump [-s | --offset <offset>] [-n | --length <length>] | --ranges <list-path>] <file-path>...\n"
+
+
 /* C89 standard */
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "dump.h"
+#include "errors.h"
+#include "file.h"
+#include "offset.h"
 #include "raw_terminal.h"
+#include "stats.h"
 
 
 /* --------------------------------- MAIN ---------------------------------- */
 
 int main(int argc, char* argv[]) {
-    char* filename;
-    int   i;
+    const char* filenames[RHD_TERM_PANES_MAX];
+    size_t      n_files;
+    rhd_file_t* file;
+    int         is_dump;
+    int         is_follow;
+    int         is_diff;
+    int         is_stats;
+    off_t       offset;
+    off_t       length;
+    const char* ranges;
+    off_t       window;
+    off_t       width;
+    int         i;
 
     /* If no arguments were given, exit */
     if (argc < 2) {
         fprintf(stderr, "ERROR: Arguments missing!\n");
-        fprintf(stderr, "Usage: %s [-v | --version] [-h | --help] <file-path>\n", argv[0]);
+        fprintf(stderr, RHD_MAIN_USAGE, argv[0]);
         exit(EXIT_FAILURE);
     }
 
+    /* The files still open at exit are closed then */
+    file_close_at_exit();
+
     /* Handle arguments */
-    filename = NULL;
+    n_files   = 0;
+    is_dump   = 0;
+    is_follow = 0;
+    is_diff   = 0;
+    is_stats  = 0;
+    offset    = 0;
+    length    = -1;
+    ranges    = NULL;
     for (i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            fprintf(stdout, "Usage: %s [-v | --version] [-h | --help] <file-path>\n", argv[0]);
+            fprintf(stdout, RHD_MAIN_USAGE, argv[0]);
             fprintf(stdout, "\nUsable commands:\n");
             fprintf(stdout, "         W = move up one row\n");
             fprintf(stdout, "         S = move down one row\n");
             fprintf(stdout, "         A = move up one page\n");
             fprintf(stdout, "         D = move down one page\n");
+            fprintf(stdout, "      HOME = go to the start of the file\n");
+            fprintf(stdout, "       END = go to the end of the file\n");
+            fprintf(stdout, "         G = go to an offset (decimal, or hexadecimal with \"0x\")\n");
+            fprintf(stdout, "         %% = go to a percentage of the file (0-100)\n");
+            fprintf(stdout, "         / = search a hexadecimal pattern (like \"7F 45 4C 46\") or a text (quote it to\n");
+            fprintf(stdout, "             force a text, like \"\"cafe\")\n");
+            fprintf(stdout, "         n = go to the next hit of the last search\n");
+            fprintf(stdout, "         N = go to the previous hit of the last search\n");
+            fprintf(stdout, "       ESC = cancel the running search (and leave the edit mode)\n");
             fprintf(stdout, "         H = hexadecimal view (linked to char view)\n");
             fprintf(stdout, "         C = char view (linked to hexadecimal view)\n");
             fprintf(stdout, "    CTRL+C = compacted char view\n");
-            fprintf(stdout, "    CTRL+Q = quit\n");
+            fprintf(stdout, "         x = go to the next row with a difference (with --diff)\n");
+            fprintf(stdout, "         X = go to the previous row with a difference (with --diff)\n");
+            fprintf(stdout, "         i = show the inspector (the values of the bytes at the cursor, and the fields of\n");
+            fprintf(stdout, "             the headers of ELF, PE and PNG files)\n");
+            fprintf(stdout, "    ARROWS = move the cursor (with the inspector)\n");
+            fprintf(stdout, "         e = switch the byte order of the values (with the inspector)\n");
+            fprintf(stdout, "         t = hide/show the fields of the headers (with the inspector)\n");
+            fprintf(stdout, "         # = show the stats row (cost of the last frame, and counters of reads, seeks,\n");
+            fprintf(stdout, "             writes, allocations and page cache hits)\n");
+            fprintf(stdout, "         o = hide/show the offsets column\n");
+            fprintf(stdout, "         m = hide/show the entropy map of the file (from '.' for few distinct bytes to\n");
+            fprintf(stdout, "             '@' for random or compressed bytes, and '_' for zero fill)\n");
+            fprintf(stdout, "     [ / ] = go to the previous/next region of the entropy map\n");
+            fprintf(stdout, "    CTRL+E = enter/leave the edit mode (with --edit), where the hex digits typed change\n");
+            fprintf(stdout, "             the byte at the cursor of the inspector\n");
+            fprintf(stdout, "    CTRL+Z = undo the last change not saved yet\n");
+            fprintf(stdout, "    CTRL+Y = redo the last change undone\n");
+            fprintf(stdout, "    CTRL+S = save the changes (writing only the bytes changed)\n");
+            fprintf(stdout, "       TAB = switch to the next file (when showing several files side by side)\n");
+            fprintf(stdout, "    CTRL+Q = quit (press it twice if there are changes not saved yet)\n");
+            fprintf(stdout, "\nOptions:\n");
+            fprintf(stdout, "    -f | --follow = start from the end of the file, and keep showing its new bytes as it\n");
+            fprintf(stdout, "                    grows (while on its last page)\n");
+            fprintf(stdout, "    --diff = compare two files side by side: they scroll together, and the bytes that\n");
+            fprintf(stdout, "             differ are highlighted\n");
+            fprintf(stdout, "    --stats = at exit, write to stderr the counters of the stats row (and the averages per\n");
+            fprintf(stdout, "              frame), to tell if the time goes in reading the file or in the terminal\n");
+            fprintf(stdout, "    -e | --edit = open the files for update, so that they can be changed (see CTRL+E)\n");
+            fprintf(stdout, "    -w | --width <bytes> = show <bytes> bytes per row (if they fit), whatever the size of\n");
+            fprintf(stdout, "                           the terminal, so that the offsets of the rows stay the same\n");
+            fprintf(stdout, "    --no-mmap = never map the file in memory (read it through the page cache instead)\n");
+            fprintf(stdout, "    --no-decompress = show compressed files (gzip) as they are, instead of decompressed\n");
+            fprintf(stdout, "    --window <length> = navigating a stream (like a pipe, or \"-\" for stdin), keep only its\n");
+            fprintf(stdout, "                        last <length> bytes (in a temporary file, 64 MiB by default)\n");
+            fprintf(stdout, "\nDump mode (-d | --dump):\n");
+            fprintf(stdout, "    Writes the file to stdout in the same format as \"hexdump -C\", without\n");
+            fprintf(stdout, "    using the terminal. If <file-path> is \"-\" or missing, stdin is used.\n");
+            fprintf(stdout, "    -s | --offset <offset> = start from <offset> (decimal, or hexadecimal with \"0x\")\n");
+            fprintf(stdout, "    -n | --length <length> = dump only <length> bytes\n");
+            fprintf(stdout, "    --ranges <list-path> = dump only the ranges listed in <list-path> (\"-\" for stdin), one\n");
+            fprintf(stdout, "                           \"<offset> <length>\" per line (implies -d, \"#\" starts a comment)\n");
             exit(EXIT_SUCCESS);
         } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--version") == 0) {
             fprintf(stdout, "%s version %s\n", argv[0], RHD_MAIN_VER);
             exit(EXIT_SUCCESS);
+        } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--follow") == 0) {
+            is_follow = 1;
+        } else if (strcmp(argv[i], "--diff") == 0) {
+            is_diff = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            is_stats = 1;
+        } else if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--edit") == 0) {
+            term_edit();
+        } else if (strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--width") == 0) {
+            if (++i >= argc || offset_parse(argv[i], &width) != 0 || width <= 0 || width > RHD_MAIN_WIDTH_MAX) {
+                fprintf(stderr, "ERROR: Invalid or missing row width!\n");
+                exit(EXIT_FAILURE);
+            }
+            term_row_width((size_t)width);
+        } else if (strcmp(argv[i], "--no-mmap") == 0) {
+            file_disable_mmap();
+        } else if (strcmp(argv[i], "--no-decompress") == 0) {
+            file_disable_decompress();
+        } else if (strcmp(argv[i], "--window") == 0) {
+            if (++i >= argc || offset_parse(argv[i], &window) != 0 || window <= 0) {
+                fprintf(stderr, "ERROR: Invalid or missing window length!\n");
+                exit(EXIT_FAILURE);
+            }
+            file_stream_window(window);
+        } else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--dump") == 0) {
+            is_dump = 1;
+        } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--offset") == 0) {
+            if (++i >= argc || offset_parse(argv[i], &offset) != 0) {
+                fprintf(stderr, "ERROR: Invalid or missing offset!\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--length") == 0) {
+            if (++i >= argc || offset_parse(argv[i], &length) != 0) {
+                fprintf(stderr, "ERROR: Invalid or missing length!\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--ranges") == 0) {
+            if (++i >= argc) {
+                fprintf(stderr, "ERROR: Missing list of ranges!\n");
+                exit(EXIT_FAILURE);
+            }
+            ranges  = argv[i];
+            is_dump = 1;
         } else {
-            if (filename == NULL) {
-                filename = argv[i];
+            if (n_files < RHD_TERM_PANES_MAX) {
+                filenames[n_files++] = argv[i];
             } else {
                 fprintf(stderr, "ERROR: Given too many files! (maybe an unrecognized argument was passed?)\n");
                 exit(EXIT_FAILURE);
@@ -85,8 +213,53 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    /* Initialize terminal */
-    if (term_init(filename) != 0)
+    /* Dump mode doesn't use the terminal at all */
+    if (is_dump) {
+        if (n_files > 1) {
+            fprintf(stderr, "ERROR: Dump mode takes a single file!\n");
+            exit(EXIT_FAILURE);
+        }
+        if (ranges != NULL && (offset != 0 || length != -1)) {
+            fprintf(stderr, "ERROR: The ranges can't be given together with an offset or a length!\n");
+            exit(EXIT_FAILURE);
+        }
+        if (ranges != NULL && (n_files == 0 || strcmp(filenames[0], RHD_FILE_STDIN) == 0)) {
+            fprintf(stderr, "ERROR: Ranges can be dumped only from seekable files!\n");
+            exit(EXIT_FAILURE);
+        }
+        if (file_open(&file, n_files == 0 ? RHD_FILE_STDIN : filenames[0], "rb") != 0) {
+            fprintf(stderr, "ERROR: Could not open file!\n");
+            fprintf(stderr, "    -> %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        if ((ranges != NULL ? dump_ranges_file(file, ranges) : dump_file(file, offset, length)) != 0) {
+            error_flush();
+            exit(EXIT_FAILURE);
+        }
+        if (is_stats)
+            stats_print(stderr);
+        exit(EXIT_SUCCESS);
+    }
+
+    /* The interactive mode needs a file */
+    if (n_files == 0) {
+        fprintf(stderr, "ERROR: Arguments missing!\n");
+        fprintf(stderr, RHD_MAIN_USAGE, argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    /* The diff view compares exactly two files */
+    if (is_diff && n_files != 2) {
+        fprintf(stderr, "ERROR: Diff mode takes two files!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Initialize terminal (following the file, and comparing the files, if requested) */
+    if (is_follow)
+        file_follow();
+    if (is_diff)
+        term_diff();
+    if (term_init(filenames, n_files) != 0)
         exit(EXIT_FAILURE);
 
     /* Main terminal loop */
@@ -97,5 +270,9 @@ int main(int argc, char* argv[]) {
     if (term_disable_raw_mode() != 0)
         exit(EXIT_FAILURE);
 
+    /* Report the counters (once the terminal is back to its initial state) */
+    if (is_stats)
+        stats_print(stderr);
+
     exit(EXIT_SUCCESS);
 }
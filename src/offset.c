@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file offset.c */
+
+
+/* C89 standard */
+#include <limits.h>
+#include <stddef.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "offset.h"
+
+
+/* Biggest value representable by off_t (which is signed) */
+#define RHD_OFFSET_MAX ((((off_t)1 << (sizeof(off_t) * CHAR_BIT - 2)) - 1) * 2 + 1)
+
+#define RHD_OFFSET_HEX_DIGITS "0123456789ABCDEF"
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int offset_parse(const char* str, off_t* offset) {
+    off_t value;
+    int   base;
+    int   digit;
+
+    /* Get base from prefix */
+    base = 10;
+    if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        base = 16;
+        str += 2;
+    }
+
+    /* Empty numbers are not valid */
+    if (*str == '\0')
+        return 1;
+
+    /* Accumulate digits, checking for overflow */
+    value = 0;
+    for (; *str != '\0'; str++) {
+        if (*str >= '0' && *str <= '9')
+            digit = *str - '0';
+        else if (base == 16 && *str >= 'a' && *str <= 'f')
+            digit = *str - 'a' + 10;
+        else if (base == 16 && *str >= 'A' && *str <= 'F')
+            digit = *str - 'A' + 10;
+        else
+            return 1;
+
+        if (value > (RHD_OFFSET_MAX - digit) / base)
+            return 1;
+        value = value * base + digit;
+    }
+
+    *offset = value;
+    return 0;
+}
+
+
+size_t offset_hex_digits(off_t offset) {
+    size_t n_digits;
+
+    n_digits = 1;
+    while ((offset >>= 4) > 0)
+        n_digits++;
+
+    return n_digits;
+}
+
+
+void offset_format_hex(char* dst, off_t offset, const size_t n_digits) {
+    const char* digits = RHD_OFFSET_HEX_DIGITS;
+    size_t      i;
+
+    /* From the least significant digit (the remaining ones become zeros) */
+    for (i = n_digits; i > 0; i--) {
+        dst[i - 1] = digits[offset & 0x0F];
+        offset >>= 4;
+    }
+}
+
+
+int offset_add_hex(char* digits, const size_t n_digits, off_t value) {
+    const char* hex = RHD_OFFSET_HEX_DIGITS;
+    size_t      i;
+    int         digit;
+    int         carry;
+
+    /* Add "value" one digit at a time, stopping as soon as there is nothing left to carry */
+    carry = 0;
+    for (i = n_digits; i > 0 && (value > 0 || carry > 0); i--) {
+        digit         = digits[i - 1] <= '9' ? digits[i - 1] - '0' : digits[i - 1] - 'A' + 10;
+        digit        += (int)(value & 0x0F) + carry;
+        carry         = digit >> 4;
+        digits[i - 1] = hex[digit & 0x0F];
+        value >>= 4;
+    }
+
+    return value > 0 || carry > 0;
+}
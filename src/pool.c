@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file pool.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for pthreads and sysconf) */
+
+/* C89 standard */
+#include <stddef.h>
+
+/* POSIX standard */
+#include <pthread.h>
+#include <unistd.h>
+
+#include "pool.h"
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Body of the worker threads: runs the next task, until there are none left
+ */
+static void* pool_worker(void* arg);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+size_t pool_threads(void) {
+    long n_cpus;
+
+    if ((n_cpus = sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+        return 1;
+    return (size_t)n_cpus < RHD_POOL_THREADS_MAX ? (size_t)n_cpus : RHD_POOL_THREADS_MAX;
+}
+
+
+int pool_start(pool_t* pool, const size_t n_threads, const size_t n_tasks, pool_task_t task, void* ctx) {
+    size_t i;
+
+    pool->n_threads    = 0;
+    pool->n_tasks      = n_tasks;
+    pool->task         = task;
+    pool->ctx          = ctx;
+    pool->next_task    = 0;
+    pool->is_cancelled = 0;
+    if (pthread_mutex_init(&pool->lock, NULL) != 0)
+        return 1;
+
+    /* More threads than tasks would just exit */
+    for (i = 0; i < n_threads && i < n_tasks && i < RHD_POOL_THREADS_MAX; i++) {
+        pool->workers[i].pool  = pool;
+        pool->workers[i].index = i;
+        if (pthread_create(&pool->workers[i].thread, NULL, pool_worker, &pool->workers[i]) != 0)
+            break;
+        pool->n_threads++;
+    }
+
+    /* If no thread could be started, nobody would ever run the tasks */
+    if (pool->n_threads == 0 && n_tasks > 0) {
+        pthread_mutex_destroy(&pool->lock);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+void pool_cancel(pool_t* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->is_cancelled = 1;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+void pool_join(pool_t* pool) {
+    size_t i;
+
+    for (i = 0; i < pool->n_threads; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+    pool->n_threads = 0;
+    pthread_mutex_destroy(&pool->lock);
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static void* pool_worker(void* arg) {
+    pool_worker_t* worker = (pool_worker_t*)arg;
+    pool_t*        pool   = worker->pool;
+    size_t         task;
+
+    for (;;) {
+        /* Take next task */
+        pthread_mutex_lock(&pool->lock);
+        if (pool->is_cancelled || pool->next_task >= pool->n_tasks) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        task = pool->next_task++;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->task(pool->ctx, task, worker->index);
+    }
+}
@@ -27,6 +27,7 @@
 #define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for sigaction) */
 
 /* C89 standard */
+#include <ctype.h>
 #include <errno.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -34,14 +35,25 @@
 #include <string.h>
 
 /* POSIX standard */
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <sys/ioctl.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "abuf.h"
+#include "diff.h"
+#include "entropy.h"
 #include "errors.h"
 #include "file.h"
+#include "format.h"
+#include "inspect.h"
+#include "offset.h"
+#include "search.h"
+#include "stats.h"
+#include "template.h"
 
 #include "raw_terminal.h"
 
@@ -50,15 +62,89 @@
 #define RHD_TERM_OUTPUT_FORMCHAR_INIT {RHD_TERM_OUTPUT_FORMCHAR, 0, 0, file_append_formatted_chars}
 #define RHD_TERM_OUTPUT_CHAR_INIT     {RHD_TERM_OUTPUT_CHAR    , 0, 0, file_append_chars          }
 
-#define RHD_TERM_OUTPUT_DEFAULT &output_formhex
+#define RHD_TERM_OUTPUT_DEFAULT RHD_TERM_OUTPUT_FORMHEX
+
+/* Separator between the rows of the panes (see term_pane_t), and before the inspector */
+#define RHD_TERM_PANE_SEPARATOR "|"
+
+/* Width of the inspector, that is shown only if the panes keep at least RHD_TERM_INSPECT_MIN_COLS
+   columns (8 bytes in hexadecimal) */
+#define RHD_TERM_INSPECT_COLS     44
+#define RHD_TERM_INSPECT_MIN_COLS 24
+
+/* Max amount of template fields of the page listed by the inspector */
+#define RHD_TERM_INSPECT_FIELDS_MAX 128
+
+/* Entropy minimap (the column on the far right): from RHD_TERM_MINIMAP_RAMP[0] for the bytes with
+   0 bits of entropy, to RHD_TERM_MINIMAP_RAMP[8] for those with 8 bits (random, like compressed or
+   encrypted data), RHD_TERM_MINIMAP_ZERO for zero fills, and RHD_TERM_MINIMAP_PENDING for the
+   buckets not scanned yet */
+#define RHD_TERM_MINIMAP_RAMP    ".:-=+*#%@"
+#define RHD_TERM_MINIMAP_ZERO    '_'
+#define RHD_TERM_MINIMAP_PENDING ' '
+
+/* Offsets column on the left of each pane: at least RHD_TERM_GUTTER_DIGITS_MIN hexadecimal digits
+   (more if the files are longer), then RHD_TERM_GUTTER_GAP spaces. It is shown only if at least a
+   byte fits next to it. */
+#define RHD_TERM_GUTTER_DIGITS_MIN 8
+#define RHD_TERM_GUTTER_DIGITS_MAX (2 * sizeof(off_t))
+#define RHD_TERM_GUTTER_GAP        "  "
 
 #define RHD_TERM_CTRL_KEY(k) ((k) & 0x1f)
 
+/* Max time to wait for the rest of an escape sequence after ESC */
+#define RHD_TERM_ESC_TIMEOUT_MS 50
+
+/* Max amount of rows (and columns) of the window of the headless mode (see term_headless()) */
+#define RHD_TERM_HEADLESS_SIZE_MAX 1000
+
+/* Min time between two frames (at most 60 frames per second, see term_screen_request()) */
+#define RHD_TERM_FRAME_MS (1000 / 60)
+
+/* Max length of the status message, and of the input of a prompt */
+#define RHD_TERM_STATUS_MAX 128
+#define RHD_TERM_PROMPT_MAX 64
+
+/* Max time between two keypresses of the same navigation key for them to be an auto-repeat */
+#define RHD_TERM_NAV_REPEAT_MS 100
+
+/* Amount of auto-repeats after which the movement of a held navigation key doubles */
+#define RHD_TERM_NAV_ACCEL_STEP 16
+
+/* Max multiplier of the movement of a held navigation key */
+#define RHD_TERM_NAV_ACCEL_MAX 8
+
 #define RHD_TERM_VT100_ERASE_LINE   "\x1b[0K"
 #define RHD_TERM_VT100_CUR_TOP_LEFT "\x1b[1;1H"
 #define RHD_TERM_VT100_CUR_HIDE     "\x1b[?25l"
 #define RHD_TERM_VT100_CUR_SHOW     "\x1b[?25h"
 #define RHD_TERM_VT100_ERASE_SCREEN "\x1b[2J"
+#define RHD_TERM_VT100_REVERSE      "\x1b[7m"
+#define RHD_TERM_VT100_NORMAL       "\x1b[m"
+#define RHD_TERM_VT100_UNDERLINE    "\x1b[4m"
+#define RHD_TERM_VT100_UNDERLINE_NO "\x1b[24m"
+#define RHD_TERM_VT100_REGION_RESET "\x1b[r"
+
+/* Amount of pages read ahead in the direction of the movement (see term_nav_move()) */
+#define RHD_TERM_NAV_PREFETCH_PAGES 4
+
+/* Formats of the VT100 sequences that need a number (at most RHD_TERM_VT100_SEQ_MAX chars) */
+#define RHD_TERM_VT100_CUR_ROW_FMT   "\x1b[%u;1H"
+#define RHD_TERM_VT100_SCROLL_UP_FMT "\x1b[%uS"
+#define RHD_TERM_VT100_SCROLL_DN_FMT "\x1b[%uT"
+#define RHD_TERM_VT100_REGION_FMT    "\x1b[1;%ur"
+#define RHD_TERM_VT100_SEQ_MAX       16
+
+/* Max length of a row: as wide as the terminal, plus the sequences that style the status row
+   (or the cursor) */
+#define RHD_TERM_ROW_CAP(cols) ((size_t)(cols) + sizeof(RHD_TERM_VT100_REVERSE) - 1 + sizeof(RHD_TERM_VT100_NORMAL) - 1 + \
+                                sizeof(RHD_TERM_VT100_UNDERLINE) - 1 + sizeof(RHD_TERM_VT100_UNDERLINE_NO) - 1)
+
+/* Size of a full frame: a scroll region and a scroll, and every row (preceded by a cursor
+   movement, and followed by RHD_TERM_VT100_ERASE_LINE), and then RHD_TERM_VT100_CUR_TOP_LEFT */
+#define RHD_TERM_FRAME_CAP(rows, cols) \
+    ((size_t)(rows) * (RHD_TERM_ROW_CAP(cols) + RHD_TERM_VT100_SEQ_MAX + sizeof(RHD_TERM_VT100_ERASE_LINE) - 1) + \
+     2 * RHD_TERM_VT100_SEQ_MAX + sizeof(RHD_TERM_VT100_CUR_TOP_LEFT) - 1)
 
 
 /* ------------------------------- TYPEDEFS -------------------------------- */
@@ -80,6 +166,38 @@ typedef enum term_output_id_tag {
     RHD_TERM_OUTPUT_CHAR
 } term_output_id_t;
 
+/**
+ * Enum type that describes if the shadow frame matches what is on screen
+ */
+typedef enum shadow_state_tag {
+    RHD_TERM_SHADOW_STATE_INVALID,
+    RHD_TERM_SHADOW_STATE_VALID
+} shadow_state_t;
+
+/**
+ * Enum type that describes the keys that are not simple chars (read from escape sequences)
+ */
+typedef enum term_key_tag {
+    RHD_TERM_KEY_ESC       = 0x1b,
+    RHD_TERM_KEY_ENTER     = '\r',
+    RHD_TERM_KEY_BACKSPACE = 0x7f,
+    RHD_TERM_KEY_HOME      = 1000,
+    RHD_TERM_KEY_END,
+    RHD_TERM_KEY_UP,
+    RHD_TERM_KEY_DOWN,
+    RHD_TERM_KEY_RIGHT,
+    RHD_TERM_KEY_LEFT
+} term_key_t;
+
+/**
+ * Enum type that describes the possible results of a prompt
+ */
+typedef enum prompt_tag {
+    RHD_TERM_PROMPT_ACCEPT,
+    RHD_TERM_PROMPT_CANCEL,
+    RHD_TERM_PROMPT_ERROR
+} prompt_t;
+
 /**
  * Enum type that describes the possible keypress actions
  */
@@ -95,11 +213,24 @@ typedef enum keypress_tag {
  */
 typedef struct term_output_tag {
     term_output_id_t id;
-    long int         pos;
-    long int         row_len;
-    size_t           (*file_read_func)(abuf_t*, const size_t);
+    off_t            pos;
+    off_t            row_len;
+    size_t           (*file_read_func)(rhd_file_t*, abuf_t*, const size_t);
 } term_output_t;
 
+/**
+ * Struct type that describes a pane: a file shown in some columns of the screen (panes are
+ * side by side, separated by RHD_TERM_PANE_SEPARATOR), each with its own outputs
+ */
+typedef struct term_pane_tag {
+    rhd_file_t*    file;
+    const char*    filename;
+    term_output_t  outputs[3];     /* Indexed by term_output_id_t */
+    term_output_t* active_output;
+    unsigned int   cols;           /* Width of the pane (separator excluded) */
+    unsigned int   gutter_cols;    /* Width of the offsets column, gap included (0 if hidden) */
+} term_pane_t;
+
 
 /* --------------------------- STATIC VARIABLES ---------------------------- */
 
@@ -120,19 +251,38 @@ static enum term_is_in_loop_tag {
 } term_is_in_loop = RHD_TERM_LOOP_FALSE;
 
 /**
- * Struct that defines the formatted hex output
+ * Set to 1 once at_exit_callback() is registered with atexit() (so that sessions started again
+ * after term_reset() don't register it once more)
+ */
+static int is_at_exit_registered = 0;
+
+/**
+ * Outputs every pane starts with (indexed by term_output_id_t)
  */
-static term_output_t output_formhex = RHD_TERM_OUTPUT_FORMHEX_INIT;
+static const term_output_t output_templates[3] = {
+    RHD_TERM_OUTPUT_FORMHEX_INIT, RHD_TERM_OUTPUT_FORMCHAR_INIT, RHD_TERM_OUTPUT_CHAR_INIT
+};
 
 /**
- * Struct that defines the formatted char output
+ * Struct containing the state of the diff view (see term_diff()), and its pending lookup
  */
-static term_output_t output_formchar = RHD_TERM_OUTPUT_FORMCHAR_INIT;
+static struct diff_view_tag {
+    int          is_enabled;
+    off_t        last_hit;      /* -1 if no difference was found yet */
+    int          is_pending;    /* 1 if waiting for the background comparison to reach the next difference */
+    off_t        pending_from;
+    diff_dir_t   pending_dir;
+} diff_view;
 
 /**
- * Struct that defines the char output
+ * Struct containing the layout of the rows (see term_row_width()), and of the offsets column
+ * (toggled with 'o')
  */
-static term_output_t output_char = RHD_TERM_OUTPUT_CHAR_INIT;
+static struct layout_tag {
+    off_t  row_width;         /* Bytes per row (0 = as many as fit in the pane) */
+    int    is_gutter_hidden;
+    size_t gutter_digits;     /* Digits of the offsets of all panes (to keep their rows aligned) */
+} layout;
 
 /**
  * Struct containing signal data (to handle SIGWINCH)
@@ -140,18 +290,143 @@ static term_output_t output_char = RHD_TERM_OUTPUT_CHAR_INIT;
 static struct sigwinch_tag {
     sigwinch_state_t state;
     struct sigaction sa;
+    int              pipe_fds[2];  /* Self-pipe: the handler writes to [1], term_read_byte() polls [0] */
 } sigwinch;
 
 /**
  * Struct containing terminal data
  */
 static struct terminal_tag {
-    term_output_t* active_output;
+    term_pane_t    panes[RHD_TERM_PANES_MAX];
+    size_t         n_panes;
+    term_pane_t*   pane;           /* Active pane (that receives the keys) */
     unsigned int   screen_rows;
     unsigned int   screen_cols;
+    unsigned int   page_rows;      /* Rows showing the file (all except the stats and status rows) */
+    char           status_msg[RHD_TERM_STATUS_MAX];
+    const char*    prompt_msg;     /* If not NULL, the status row shows the prompt instead */
+    const char*    prompt_buf;
+    abuf_t         frame;          /* Frame buffer, reused by every screen refresh */
+    abuf_t         row;            /* Row buffer, where each row is prepared before diffing it */
     struct termios initial_state;  /* For preservation of initial state */
+    int            tty_fd;         /* Where keys are read from (the standard input, unless it is the file) */
+    int            out_fd;         /* Where frames are written (the standard output, unless headless) */
 } term;
 
+/**
+ * Struct containing the options of the headless mode (see term_headless())
+ */
+static struct headless_tag {
+    int          is_enabled;
+    int          keys_fd;
+    int          frames_fd;
+    unsigned int rows;   /* Size of the window */
+    unsigned int cols;
+} headless;
+
+/**
+ * Struct containing the last search pattern, and its last hit
+ */
+static struct term_search_tag {
+    term_pane_t*  pane;          /* Pane whose file is searched */
+    unsigned char needle[RHD_SEARCH_NEEDLE_MAX];
+    size_t        len;           /* 0 if nothing was searched yet */
+    off_t         last_hit;      /* -1 if the pattern was not found yet */
+    int           is_pending;    /* 1 if waiting for the background search to find the next hit */
+    off_t         pending_from;
+    search_dir_t  pending_dir;
+} term_search;
+
+/**
+ * Struct containing the data needed to accelerate held navigation keys
+ */
+static struct nav_tag {
+    int             last_key;
+    unsigned int    repeats;    /* Amount of consecutive auto-repeats of "last_key" */
+    struct timespec last_time;  /* Time of the last keypress of "last_key" */
+} nav;
+
+/**
+ * Struct containing a copy of the rows currently on screen (so that refreshes
+ * only redraw the rows that changed, or scroll the screen when possible)
+ */
+static struct shadow_tag {
+    shadow_state_t   state;
+    term_output_id_t ids[RHD_TERM_PANES_MAX];   /* Output used to draw the rows of each pane */
+    off_t            poss[RHD_TERM_PANES_MAX];  /* File position of the first row of each pane */
+    size_t           stride;  /* Max length of a row (rows longer than this are never equal) */
+    char*            rows;    /* "screen_rows" rows (status row included), each "stride" chars long */
+    size_t*          lens;    /* Actual length of each row */
+} shadow;
+
+/**
+ * Struct containing the state of the inspector (the column on the right, toggled with 'i'), that
+ * decodes the bytes at the cursor and lists the template fields of the page. Both are decoded
+ * only when shown, and cached until the cursor (or the page) moves.
+ */
+static struct inspect_view_tag {
+    int              is_enabled;
+    int              is_big_endian;
+    int              is_template_hidden;
+    unsigned int     cols;          /* Width of the inspector (0 if it doesn't fit) */
+    off_t            cursor;        /* Offset of the cursor, in the file of the active pane */
+    term_pane_t*     pane;          /* Pane whose file "template" was read from (NULL if none yet) */
+    rhd_template_t*  template;      /* NULL if the format of the file is not known */
+    off_t            lines_pos;     /* Position "lines" were decoded at (-1 if not decoded yet) */
+    size_t           lines_n;       /* Amount of bytes "lines" were decoded from */
+    char             lines[RHD_INSPECT_LINES][RHD_INSPECT_LINE_MAX];
+    off_t            fields_from;   /* Range of the page "fields" were found in (-1 if not found yet) */
+    off_t            fields_to;
+    size_t           n_fields;
+    template_field_t fields[RHD_TERM_INSPECT_FIELDS_MAX];
+    char             field_texts[RHD_TERM_INSPECT_FIELDS_MAX][RHD_TERM_INSPECT_COLS];  /* Name and value */
+} inspect_view;
+
+/**
+ * Struct containing the state of the entropy minimap (the column on the far right, toggled
+ * with 'm'), that maps the file of the active pane as it is scanned in the background
+ */
+static struct minimap_view_tag {
+    int          is_enabled;
+    unsigned int cols;   /* Width of the minimap (0 if it doesn't fit) */
+    term_pane_t* pane;   /* Pane whose file is mapped (NULL if none yet) */
+} minimap_view;
+
+/**
+ * Struct containing the state of the edit mode (toggled with CTRL+E, if the files were opened for
+ * update), where the hex digits typed change the byte at the cursor of the inspector
+ */
+static struct edit_view_tag {
+    int   is_enabled;    /* See term_edit() */
+    int   is_editing;
+    off_t low_pos;       /* Byte whose high digit was just typed (-1 if none) */
+    int   is_quitting;   /* CTRL+Q was pressed once, with changes not saved yet */
+} edit_view;
+
+/**
+ * Struct containing the state of the rendering. Frames are only requested (see term_screen_request()),
+ * and rendered when no key is waiting, so that all the keys received (like the auto-repeats of a
+ * held key) are processed first, and a single frame shows the latest state. Frames are at least
+ * RHD_TERM_FRAME_MS apart, and written without blocking: the part of the last one that the terminal
+ * didn't accept yet is queued, and no new frame is rendered until it is written.
+ */
+static struct render_tag {
+    int             is_pending;      /* A frame was requested */
+    struct timespec last_time;       /* Time of the last frame */
+    size_t          n_sent;          /* Bytes of the frame buffer already written (the rest is queued) */
+    int             is_nonblocking;  /* stdout was made non-blocking (by term_loop()) */
+    int             stdout_flags;    /* Initial file status flags of stdout */
+} render;
+
+/**
+ * Struct containing the data shown in the stats row (above the status row, toggled with '#')
+ */
+static struct stats_view_tag {
+    int           is_enabled;
+    unsigned long frame_ns;   /* Time spent preparing and writing the last frame */
+    size_t        frame_len;  /* Bytes written by the last frame */
+} stats_view;
+
 
 /* --------------------------- STATIC PROTOTYPES --------------------------- */
 
@@ -161,11 +436,24 @@ static struct terminal_tag {
 static void at_exit_callback(void);
 
 /**
- * Handles SIGWINCH signal, and sets term.screen_rows, term.screen_cols and sigwinch.state accordingly.
- * If successful sets sigwinch.state to RHD_TERM_SIGWINCH_STATE_OK, else RHD_TERM_SIGWINCH_STATE_ERROR.
+ * Handles SIGWINCH signal, only writing a byte to the self-pipe (which is async-signal-safe).
+ * The actual handling is done by sigwinch_process(), outside of the signal handler.
  */
 static void sigwinch_handler(int sig);
 
+/**
+ * Creates the self-pipe used by sigwinch_handler() (both ends are non-blocking).
+ * If successful returns 0, else 1.
+ */
+static int sigwinch_pipe_open(void);
+
+/**
+ * Empties the self-pipe (coalescing all the SIGWINCH received so far), then adjusts the
+ * outputs and refreshes the screen (only if in loop). Sets sigwinch.state accordingly.
+ * If successful returns 0, else 1.
+ */
+static int sigwinch_process(void);
+
 /**
  * Uses ioctl() to get terminal window size.
  * If successful returns 0, else 1.
@@ -173,23 +461,35 @@ static void sigwinch_handler(int sig);
 static int term_get_win_size(void);
 
 /**
- * Saves active output.
+ * Saves active output of given "pane".
  * If successful returns 0, else 1.
  */
-static int term_output_save(void);
+static int term_output_save(term_pane_t* pane);
 
 /**
- * Changes active output.
+ * Changes active output of the active pane.
  * If successful returns 0, else 1.
  */
 static int term_output_change(const term_output_id_t output_id);
 
 /**
- * Sets "row_len" and "pos" of all "output_t" variables based on term window size.
+ * Sets the width of all panes (and of their offsets column), and "row_len" and "pos" of all
+ * their outputs, based on term window size (and on the fixed row width, if any).
  * If successful returns 0, else 1.
  */
 static int term_output_adjust_after_sigwinch(void);
 
+/**
+ * Returns the amount of digits needed by the offsets column to show the offsets of all panes
+ * (at least RHD_TERM_GUTTER_DIGITS_MIN, and more for files longer than 4 GiB)
+ */
+static size_t term_gutter_digits(void);
+
+/**
+ * Makes the next pane the active one
+ */
+static void term_pane_next(void);
+
 /**
  * Handles keypresses.
  * Returns:
@@ -201,341 +501,2702 @@ static int term_output_adjust_after_sigwinch(void);
 static int term_process_keypress(void);
 
 /**
- * Waits for key from stdin, and reads it.
+ * Returns the multiplier of the movement of navigation key "c", which grows the longer
+ * the key is held (meaning the longer the terminal auto-repeats it).
+ */
+static off_t term_nav_accel(const int key);
+
+/**
+ * Returns the length of the file of given "pane" (in the diff view, of the longest file,
+ * since the files scroll together).
+ */
+static off_t term_nav_length(term_pane_t* pane);
+
+/**
+ * Returns the position of the last full page of the file of given "pane" (for its active output).
+ */
+static off_t term_nav_last_page(term_pane_t* pane);
+
+/**
+ * Moves the file position indicator of the active pane by "rows" rows of its active output
+ * (towards SEEK_END if positive), computing the target once and clamping it between SEEK_SET and the last full page.
  * If successful returns 0, else 1.
  */
-static int term_read_key(char* c);
+static int term_nav_move(const off_t rows);
 
 /**
- * Refreshes screen.
+ * Moves the file position indicator of given "pane" to the row of its active output
+ * containing "offset" (clamping it to the last full page). If "pane" is the active one,
+ * the cursor of the inspector goes on "offset".
  * If successful returns 0, else 1.
  */
-static int term_screen_refresh(void);
+static int term_nav_jump(term_pane_t* pane, const off_t offset);
 
 /**
- * Fills "ab" with the content of the rows to draw on screen.
+ * Returns the offset of the first row of given "pane" that is still available (see file_first()).
+ */
+static off_t term_nav_first_row(term_pane_t* pane);
+
+/**
+ * In the diff view, moves the file position indicator of the other pane to the one of
+ * given "pane" (so that the files scroll together), else does nothing.
  * If successful returns 0, else 1.
  */
-static int term_screen_prepare_rows(abuf_t* ab);
+static int term_diff_sync(term_pane_t* pane);
 
 /**
- * Clears screen.
+ * Goes to the next row (after the first one on screen) containing a byte that differs
+ * between the files of the diff view, or to the previous one (depending on "dir").
  * If successful returns 0, else 1.
  */
-static int term_screen_clear(void);
+static int term_diff_next(const diff_dir_t dir);
 
+/**
+ * Resolves the pending lookup of a difference (if any), given the "state" of the background
+ * comparison, going to the difference (if found) or setting the status message.
+ * If successful returns 0, else 1.
+ */
+static int term_diff_resolve(const diff_state_t state);
 
-/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+/**
+ * Processes the progress (and end) of the background comparison, then refreshes the
+ * screen (ONLY IF IN LOOP!).
+ * If successful returns 0, else 1.
+ */
+static int term_diff_process(void);
 
-/* TERMINAL */
+/**
+ * Starts mapping the file of the active pane (if it is not the one already mapped), around "pos".
+ * If successful returns 0 (also if the file can't be mapped, setting the status message), else 1.
+ */
+static int term_minimap_prepare(const off_t pos);
 
-int term_init(const char* filename) {
-    struct termios raw;
+/**
+ * Returns the level of bucket "b" of the entropy map: from 0 to 8 (the bits of entropy, rounded),
+ * 9 for zero fills, or -1 if not scanned yet
+ */
+static int term_minimap_level(const size_t b);
 
-    /* If terminal is already in raw mode, return */
-    if (term_is_init == RHD_TERM_INIT_TRUE) {
-        error_queue("WARNING: Terminal is already initialized!");
-        return 0;
-    }
+/**
+ * Goes to the first bucket of the next region of the entropy map (the next bucket with a different
+ * level than the current one), or to the first bucket of the previous region (if not "is_forward").
+ * If successful returns 0, else 1.
+ */
+static int term_minimap_jump(const int is_forward);
 
-    /* Open file with given "filename" */
-    if (file_open(filename, "rb") != 0) {
-        fprintf(stderr, "ERROR: Could not open file!\n");
-        fprintf(stderr, "    -> %s\n", strerror(errno));
-        return 1;
-    }
+/**
+ * Processes the progress (and end) of the background scan of the entropy map, then refreshes
+ * the screen (ONLY IF IN LOOP!).
+ * If successful returns 0, else 1.
+ */
+static int term_minimap_process(void);
 
-    /* Register at_exit_callback() */
-    if (atexit(at_exit_callback) != 0) {
-        fprintf(stderr, "ERROR: Could not set exit handler!\n");
-        return 2;
-    }
+/**
+ * Enters (or leaves) the edit mode, showing the inspector (its cursor is the byte that is changed).
+ * If successful returns 0 (also if the file can't be changed, setting the status message), else 1.
+ */
+static int term_edit_toggle(void);
 
-    /* Initialize variables */
-    term.active_output = RHD_TERM_OUTPUT_DEFAULT;
-    sigwinch.state     = RHD_TERM_SIGWINCH_STATE_OK;
+/**
+ * Changes the high digit (and then the low one) of the byte at the cursor to the hex digit "c",
+ * moving the cursor to the next byte after the low one.
+ * If successful returns 0 (also if the file can't be changed, setting the status message), else 1.
+ */
+static int term_edit_digit(const int c);
 
-    /* Set signal handler for SIGWINCH, and then raise it to initialize terminal window size */
-    memset(&sigwinch.sa, 0, sizeof(sigwinch.sa));
-    sigwinch.sa.sa_handler = sigwinch_handler;
-    sigwinch.sa.sa_flags   = SA_RESTART;
-    if (sigaction(SIGWINCH, &sigwinch.sa, NULL) == -1) {
-        fprintf(stderr, "ERROR: Could not set sigaction for SIGWINCH!\n");
-        fprintf(stderr, "    -> %s\n", strerror(errno));
-        return 3;
-    }
-    if (raise(SIGWINCH) != 0) {
-        fprintf(stderr, "ERROR: Could not raise SIGWINCH!\n");
-        return 4;
-    }
-    if (sigwinch.state == RHD_TERM_SIGWINCH_STATE_ERROR) {
-        fprintf(stderr, "ERROR: Error while handling SIGWINCH!\n");
-        return 5;
-    }
+/**
+ * Undoes the last change of the file of the active pane (or redoes the last one undone, if
+ * "is_redo"), moving the cursor to it.
+ * If successful returns 0, else 1.
+ */
+static int term_edit_undo(const int is_redo);
 
-    /* Get terminal initial state and save it for later */
-    if (tcgetattr(STDIN_FILENO, &term.initial_state) == -1) {
-        fprintf(stderr, "ERROR: Could not get terminal initial state!\n");
-        fprintf(stderr, "    -> %s\n", strerror(errno));
-        return 6;
-    }
+/**
+ * Writes the changes of the files of all panes to them (failing is not an error, the changes are
+ * kept and the status message tells why).
+ */
+static void term_edit_save(void);
 
-    /* Copy initial state, and change flags to make put the terminal in raw mode */
-    raw = term.initial_state;
+/**
+ * Returns 1 if the file of any pane has changes not saved yet, else 0.
+ */
+static int term_edit_is_modified(void);
 
-    /*
-     * BRKINT = turned off so that a break condition will not cause a SIGINT
-     * ICRNL  = turned off so that Carriage Returns aren't translated into New Lines (fixes CTRL+M)
-     * INLCR  = turned off so that New Lines aren't tranlsated into Carriage Returns
-     * INPCK  = turned off to disable parity checking (not on modern terminals)
-     * ISTRIP = turned off so the 8th bit is not stripped (this option is probably already off)
-     * IXON   = turned off to disable software flow control (CTRL+S and CTRL+Q)
-     */
-    raw.c_iflag &= ~(BRKINT | ICRNL | INLCR | INPCK | ISTRIP | IXON);
-    /* OPOST = turned off to disable all output processing features (line '\n' being translated to "\r\n") */
-    raw.c_oflag &= ~(OPOST);
-    /* CS8 = bit mask to set the character size to 8 bits per byte (probably already set like this) */
-    raw.c_cflag |= ~(CS8);
-    /*
-     * ECHO   = turned off to avoid that characters in input are echoed
-     * ICANON = turned off to read byte-by-byte insted of line-by-line
-     * IEXTEN = turned off so to disable CTRL+V (and CTRL+0 on macOS)
-     * ISIG   = turned off to avoid sending signals with CTRL+C and CTRL+Z
-     */
-    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
-    /* VMIN = value that sets the minimum amout of bytes of input needed before theread function can return */
-    raw.c_cc[VMIN] = 0;
-    /* VMIN = value that sets the maximum amout of time to wait before the read function can return (in tenth of a second) */
-    raw.c_cc[VTIME] = 1;
+/**
+ * Moves the cursor of the inspector by "bytes" bytes (towards SEEK_END if positive), scrolling
+ * the page to keep it on screen. Doesn't move past the ends of the file.
+ * If successful returns 0, else 1.
+ */
+static int term_inspect_move(const off_t bytes);
 
-    /* Set terminal in the just defined raw mode */
-    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == -1) {
-        fprintf(stderr, "ERROR: Could not set terminal raw state!\n");
-        fprintf(stderr, "    -> %s\n", strerror(errno));
-        return 7;
-    }
+/**
+ * Keeps the cursor of the inspector on the page of the active pane (starting at "pos"), then
+ * decodes the bytes at the cursor, and finds the template fields of the page (reading the
+ * template of the file first, if the active pane changed), unless they are already cached.
+ * Streams are inspected without the template if it can't be read (see term_inspect_drop_template()).
+ * If successful returns 0, else 1.
+ */
+static int term_inspect_prepare(const off_t pos);
 
-    /* Set terminal in raw mode */
-    term_is_init = RHD_TERM_INIT_TRUE;
+/**
+ * Goes on inspecting the stream of the active pane without its template (the headers it needs
+ * may be past the window of the stream), noting it in the status message
+ */
+static void term_inspect_drop_template(void);
 
-    return 0;
-}
+/**
+ * Reads the new bytes of the stream shown by given "pane" (or the new length of its followed
+ * file), keeping the file position indicator on the bytes still available (and on the last page,
+ * if following the file and it was already there), and refreshes the screen (ONLY IF IN LOOP!).
+ * If successful returns 0, else 1.
+ */
+static int term_stream_process(term_pane_t* pane);
 
+/**
+ * Asks the user for an offset (or a percentage of the file if "is_percentage"), and jumps to it.
+ * If the input is not valid, sets the status message instead.
+ * If successful returns 0, else 1.
+ */
+static int term_command_goto(const int is_percentage);
 
-int term_disable_raw_mode(void) {
-    /* If terminal is not in raw mode, return */
-    if (term_is_init == RHD_TERM_INIT_FALSE) {
-        fprintf(stderr, "WARNING: Terminal was not initialized!");
-        return 0;
-    }
+/**
+ * Asks the user for a search pattern (see search_parse()), starts searching it
+ * (on background threads), and goes to its first hit after the current position.
+ * If the input is not valid, sets the status message instead.
+ * If successful returns 0, else 1.
+ */
+static int term_command_search(void);
 
-    /* Restore terminal initial state */
-    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &term.initial_state) == -1) {
-        fprintf(stderr, "ERROR: Could not set terminal initial state!");
-        return 1;
-    }
+/**
+ * Goes to the hit of the last search pattern after (or before) its last hit (or the current
+ * position, if the last hit is not on screen).
+ * If successful returns 0, else 1.
+ */
+static int term_search_next(const search_dir_t dir);
 
-    /* Close file if open */
-    if (file_close() != 0) {
-        fprintf(stderr, "ERROR: Could not close opened file!\n");
-        fprintf(stderr, "    -> %s\n", strerror(errno));
-        return 2;
-    }
+/**
+ * Goes to the first hit starting at or after "from" (or the last one starting at or before it,
+ * depending on "dir"), waiting for the background search if it didn't reach it yet.
+ * If successful returns 0, else 1.
+ */
+static int term_search_lookup(const off_t from, const search_dir_t dir);
 
-    /* Flush errors queue (if they happened) */
-    error_flush();
+/**
+ * If waiting for a hit, tries to go to it (else shows the progress of the background search,
+ * that is in the given "state").
+ * If successful returns 0, else 1.
+ */
+static int term_search_resolve(const search_state_t state);
 
-    /* Set terminal in raw mode */
-    term_is_init = RHD_TERM_INIT_FALSE;
+/**
+ * Processes a notification of the background search.
+ * If successful returns 0, else 1.
+ */
+static int term_search_process(void);
 
-    return 0;
-}
+/**
+ * Sets the status message to "msg" followed by "offset" (in hexadecimal)
+ */
+static void term_status_offset(const char* msg, const off_t offset);
 
+/**
+ * Writes "offset" into "dst" in hexadecimal (like "0x1F00", and terminated), returning its length
+ */
+static size_t term_format_offset(char* dst, const off_t offset);
 
-int term_loop(void) {
-    int        ret;
-    keypress_t keypress;
+/**
+ * Shows "msg" in the status row, and reads a line of input (at most "size" - 1 chars) into "buf".
+ * Returns:
+ * - RHD_TERM_PROMPT_ACCEPT = input confirmed with ENTER
+ * - RHD_TERM_PROMPT_CANCEL = input cancelled with ESC
+ * - RHD_TERM_PROMPT_ERROR  = error occurred
+ */
+static prompt_t term_prompt(const char* msg, char* buf, const size_t size);
 
-    /* Initialize variables */
-    ret      = 0;
-    keypress = RHD_TERM_KEYPRESS_ACT;
+/**
+ * Reads a key, decoding the escape sequences of the keys in term_key_t.
+ * If successful returns 0, else 1.
+ */
+static int term_read_key(int* key);
 
-    term_is_in_loop = RHD_TERM_LOOP_TRUE;
+/**
+ * Reads the rest of "ESC [ 8 ; <rows> ; <cols> t" (after "ESC [ 8 ;"), resizing the window
+ * of the headless mode to it (see term_headless()) like a SIGWINCH would. If the sequence is not
+ * valid, the window keeps its size.
+ * If successful returns 0, else 1.
+ */
+static int term_headless_resize(void);
 
-    /* Hide cursor */
-    if (write(STDOUT_FILENO, RHD_TERM_VT100_CUR_HIDE, sizeof(RHD_TERM_VT100_CUR_HIDE) - 1) == -1) {
-        error_queue("ERROR: Function write() failed!");
-        return 5;
-    }
+/**
+ * Waits (with poll(), without busy waiting) for a byte from stdin, and reads it.
+ * Waits at most "timeout_ms" milliseconds (forever if negative).
+ * While waiting, SIGWINCH signals and notifications of the background search are processed
+ * when received.
+ * If successful returns 0, else 1 (error) or 2 (timeout).
+ */
+static int term_read_byte(char* c, const int timeout_ms);
 
-    /* Loop */
-    do {
-        /* Check if an eventual SIGWINCH was handled correctly */
-        if (sigwinch.state == RHD_TERM_SIGWINCH_STATE_ERROR) {
-            error_queue("ERROR: SIGWINCH signal was not handled correctly!");
-            ret = 4;
-            break;
+/**
+ * Requests a screen refresh, that happens when no key is waiting to be processed (see render).
+ */
+static void term_screen_request(void);
+
+/**
+ * Returns how long (in milliseconds) term_read_byte() waits before rendering the requested frame:
+ * -1 if there is none (or the last one is still being written), else the time left until
+ * RHD_TERM_FRAME_MS have passed since the last frame (0 if they have).
+ */
+static int term_screen_delay(void);
+
+/**
+ * Refreshes screen (if the last frame was written entirely, else it stays requested).
+ * If successful returns 0, else 1.
+ */
+static int term_screen_refresh(void);
+
+/**
+ * Writes as much of the queued part of the last frame as stdout accepts without blocking.
+ * If successful returns 0, else 1.
+ */
+static int term_screen_flush(void);
+
+/**
+ * Writes the queued part of the last frame (waiting for stdout to accept it), and makes stdout
+ * blocking again.
+ * If successful returns 0, else 1.
+ */
+static int term_screen_drain(void);
+
+/**
+ * Fills "ab" with the content of the rows that changed since the last refresh
+ * (scrolling the screen first, if it makes some rows already on screen reusable).
+ * If successful returns 0, else 1.
+ */
+static int term_screen_prepare_rows(abuf_t* ab);
+
+/**
+ * Fills "row" with the status row (the prompt if active, else the status message), followed by
+ * the position "pos" in the file of the active pane, and its length.
+ * If successful returns 0, else 1.
+ */
+static int term_screen_prepare_status(abuf_t* row, const off_t pos);
+
+/**
+ * Fills "row" with the stats row (the cost of the last frame, and the counters of the hot paths).
+ */
+static int term_screen_prepare_stats(abuf_t* row);
+
+/**
+ * Writes into "info" (that must have room for 64 chars) the information about the last search
+ * shown in the status row (its amount of hits and the index of the current one, or its progress).
+ */
+static void term_screen_search_info(char* info);
+
+/**
+ * Writes into "info" (that must have room for 64 chars) the information about the comparison
+ * of the diff view shown in the status row (the amount of blocks that differ, or its progress).
+ */
+static void term_screen_diff_info(char* info);
+
+/**
+ * Writes into "info" (that must have room for 64 chars) the information about the entropy map
+ * shown in the status row (the entropy of the bucket at "pos", or the progress of the scan).
+ */
+static void term_screen_minimap_info(char* info, const off_t pos);
+
+/**
+ * Writes into "info" (that must have room for 64 chars) the state of the edit mode shown in the
+ * status row (and if the file of the active pane has changes not saved yet).
+ */
+static void term_screen_edit_info(char* info);
+
+/**
+ * Appends to "ab" the "n" bytes of "bytes" formatted for output "output_id", highlighting
+ * those that differ from the "n_other" bytes of "other" (the same row of the other file),
+ * and adds to "n_styles" the length of the sequences used to highlight them.
+ * If successful returns 0, else 1.
+ */
+static int term_screen_append_diff(abuf_t* ab, const term_output_id_t output_id,
+                                   const unsigned char* bytes, const size_t n,
+                                   const unsigned char* other, const size_t n_other, size_t* n_styles);
+
+/**
+ * Appends to "row" the row "y" of the inspector (see term_inspect_prepare()).
+ * If successful returns 0, else 1.
+ */
+static int term_screen_append_inspect(abuf_t* row, const unsigned int y);
+
+/**
+ * Appends to "row" the row "y" of the entropy minimap, reversed if it contains "pos".
+ * If successful returns 0, else 1.
+ */
+static int term_screen_append_minimap(abuf_t* row, const unsigned int y, const off_t pos);
+
+/**
+ * Underlines the chars of the "k"-th byte of the row of a pane (formatted for output "output_id")
+ * that starts at "start" inside "row" (skipping the sequences that highlight the differences),
+ * and adds to "n_styles" the length of the sequences used.
+ * If successful returns 0, else 1.
+ */
+static int term_screen_mark_cursor(abuf_t* row, const size_t start, const size_t k,
+                                   const term_output_id_t output_id, size_t* n_styles);
+
+/**
+ * Appends to "ab" the row "term.row" to draw at row "y" (starting from 0), only if
+ * different from the row in the shadow frame (which is then updated).
+ * If successful returns 0, else 1.
+ */
+static int term_screen_put_row(abuf_t* ab, const unsigned int y);
+
+/**
+ * Resizes the shadow frame after the terminal window size changed, invalidating it.
+ * If successful returns 0, else 1.
+ */
+static int term_shadow_resize(void);
+
+/**
+ * If the rows that will be drawn starting from "poss" (the position of each pane) are the rows
+ * on screen moved up or down (by the same amount of rows in all panes), appends to "ab" the
+ * scroll sequence and moves the shadow rows accordingly.
+ * If successful returns 0, else 1.
+ */
+static int term_screen_scroll(abuf_t* ab, const off_t* poss);
+
+/**
+ * Clears screen.
+ * If successful returns 0, else 1.
+ */
+static int term_screen_clear(void);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+/* TERMINAL */
+
+void term_diff(void) {
+    diff_view.is_enabled = 1;
+    diff_view.last_hit   = -1;
+}
+
+
+void term_row_width(const size_t bytes) {
+    layout.row_width = (off_t)bytes;
+}
+
+
+void term_edit(void) {
+    edit_view.is_enabled = 1;
+    edit_view.low_pos    = -1;
+}
+
+
+void term_headless(const int keys_fd, const int frames_fd, const unsigned int rows, const unsigned int cols) {
+    headless.is_enabled = 1;
+    headless.keys_fd    = keys_fd;
+    headless.frames_fd  = frames_fd;
+    headless.rows       = rows;
+    headless.cols       = cols;
+}
+
+
+int term_init(const char* const* filenames, const size_t n_files) {
+    struct termios raw;
+    term_pane_t*   pane;
+    size_t         i;
+
+    /* If terminal is already in raw mode, return */
+    if (term_is_init == RHD_TERM_INIT_TRUE) {
+        error_queue("WARNING: Terminal is already initialized!");
+        return 0;
+    }
+    if (n_files == 0 || n_files > RHD_TERM_PANES_MAX) {
+        fprintf(stderr, "ERROR: Can show from 1 to %d files!\n", RHD_TERM_PANES_MAX);
+        return 1;
+    }
+    if (diff_view.is_enabled && n_files != 2) {
+        fprintf(stderr, "ERROR: Can compare only two files!\n");
+        return 1;
+    }
+
+    /* Open each file with given "filenames" in its own pane */
+    for (i = 0; i < n_files; i++) {
+        pane = &term.panes[i];
+        if (file_open(&pane->file, filenames[i], edit_view.is_enabled ? "r+b" : "rb") != 0) {
+            fprintf(stderr, "ERROR: Could not open file!\n");
+            fprintf(stderr, "    -> %s: %s\n", filenames[i], strerror(errno));
+            return 1;
+        }
+        term.n_panes++;
+
+        /* Streams (like pipes) are navigated while they are received (but can't be compared) */
+        if (file_length(pane->file) < 0 && diff_view.is_enabled) {
+            fprintf(stderr, "ERROR: Streams can't be compared!\n");
+            fprintf(stderr, "    -> %s\n", filenames[i]);
+            return 1;
+        }
+        if (file_length(pane->file) < 0 && file_stream(pane->file) != 0) {
+            fprintf(stderr, "ERROR: Could not create a buffer for the stream!\n");
+            fprintf(stderr, "    -> %s: %s\n", filenames[i], strerror(errno));
+            return 1;
+        }
+
+        pane->filename = filenames[i];
+        memcpy(pane->outputs, output_templates, sizeof(output_templates));
+        pane->active_output = &pane->outputs[RHD_TERM_OUTPUT_DEFAULT];
+    }
+    term.pane = &term.panes[0];
+
+    /* If the standard input is not a terminal (like when it is the file), read keys from the
+       controlling terminal instead (without a terminal, from the given descriptors) */
+    term.tty_fd = headless.is_enabled ? headless.keys_fd : STDIN_FILENO;
+    term.out_fd = headless.is_enabled ? headless.frames_fd : STDOUT_FILENO;
+    if (!headless.is_enabled && !isatty(STDIN_FILENO) && (term.tty_fd = open("/dev/tty", O_RDWR | O_CLOEXEC)) == -1) {
+        fprintf(stderr, "ERROR: Could not open the controlling terminal!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+        return 1;
+    }
+
+    /* Register at_exit_callback() (only once) */
+    if (!is_at_exit_registered && atexit(at_exit_callback) != 0) {
+        fprintf(stderr, "ERROR: Could not set exit handler!\n");
+        return 2;
+    }
+    is_at_exit_registered = 1;
+
+    /* Initialize variables */
+    sigwinch.state = RHD_TERM_SIGWINCH_STATE_OK;
+
+    /* Set signal handler for SIGWINCH (that writes to a self-pipe), and then process it
+       once to initialize terminal window size */
+    if (sigwinch_pipe_open() != 0) {
+        fprintf(stderr, "ERROR: Could not create pipe for SIGWINCH!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+        return 4;
+    }
+    memset(&sigwinch.sa, 0, sizeof(sigwinch.sa));
+    sigwinch.sa.sa_handler = sigwinch_handler;
+    sigwinch.sa.sa_flags   = SA_RESTART;
+    if (sigaction(SIGWINCH, &sigwinch.sa, NULL) == -1) {
+        fprintf(stderr, "ERROR: Could not set sigaction for SIGWINCH!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+        return 3;
+    }
+    if (sigwinch_process() != 0) {
+        fprintf(stderr, "ERROR: Error while handling SIGWINCH!\n");
+        return 5;
+    }
+
+    /* When following the files, start from their last page */
+    for (i = 0; i < term.n_panes && file_is_followed(); i++) {
+        if (term_nav_jump(&term.panes[i], term_nav_last_page(&term.panes[i])) != 0) {
+            fprintf(stderr, "ERROR: Could not go to the end of the file!\n");
+            return 5;
+        }
+    }
+
+    /* Compare the files of the diff view in the background (from where they are shown) */
+    if (diff_view.is_enabled && diff_start(term.panes[0].file, term.panes[1].file, file_tell(term.panes[0].file)) != 0) {
+        fprintf(stderr, "ERROR: Could not start comparing the files!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+        return 8;
+    }
+
+    /* Without a terminal there is no mode to set */
+    if (headless.is_enabled) {
+        term_is_init = RHD_TERM_INIT_TRUE;
+        return 0;
+    }
+
+    /* Get terminal initial state and save it for later */
+    if (tcgetattr(term.tty_fd, &term.initial_state) == -1) {
+        fprintf(stderr, "ERROR: Could not get terminal initial state!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+        return 6;
+    }
+
+    /* Copy initial state, and change flags to make put the terminal in raw mode */
+    raw = term.initial_state;
+
+    /*
+     * BRKINT = turned off so that a break condition will not cause a SIGINT
+     * ICRNL  = turned off so that Carriage Returns aren't translated into New Lines (fixes CTRL+M)
+     * INLCR  = turned off so that New Lines aren't tranlsated into Carriage Returns
+     * INPCK  = turned off to disable parity checking (not on modern terminals)
+     * ISTRIP = turned off so the 8th bit is not stripped (this option is probably already off)
+     * IXON   = turned off to disable software flow control (CTRL+S and CTRL+Q)
+     */
+    raw.c_iflag &= ~(BRKINT | ICRNL | INLCR | INPCK | ISTRIP | IXON);
+    /* OPOST = turned off to disable all output processing features (line '\n' being translated to "\r\n") */
+    raw.c_oflag &= ~(OPOST);
+    /* CS8 = bit mask to set the character size to 8 bits per byte (probably already set like this) */
+    raw.c_cflag |= ~(CS8);
+    /*
+     * ECHO   = turned off to avoid that characters in input are echoed
+     * ICANON = turned off to read byte-by-byte insted of line-by-line
+     * IEXTEN = turned off so to disable CTRL+V (and CTRL+0 on macOS)
+     * ISIG   = turned off to avoid sending signals with CTRL+C and CTRL+Z
+     */
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    /* VMIN = value that sets the minimum amout of bytes of input needed before theread function can return */
+    raw.c_cc[VMIN] = 0;
+    /* VTIME = value that sets the maximum amout of time to wait before the read function can return (in tenth of a second).
+       The wait happens in poll() instead, so read() never blocks. */
+    raw.c_cc[VTIME] = 0;
+
+    /* Set terminal in the just defined raw mode */
+    if (tcsetattr(term.tty_fd, TCSAFLUSH, &raw) == -1) {
+        fprintf(stderr, "ERROR: Could not set terminal raw state!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+        return 7;
+    }
+
+    /* Set terminal in raw mode */
+    term_is_init = RHD_TERM_INIT_TRUE;
+
+    return 0;
+}
+
+
+int term_disable_raw_mode(void) {
+    /* If terminal is not in raw mode, return */
+    if (term_is_init == RHD_TERM_INIT_FALSE) {
+        fprintf(stderr, "WARNING: Terminal was not initialized!");
+        return 0;
+    }
+
+    /* Restore terminal initial state (and make stdout blocking again, if leaving the loop failed) */
+    if (render.is_nonblocking && fcntl(term.out_fd, F_SETFL, render.stdout_flags) != -1)
+        render.is_nonblocking = 0;
+    if (!headless.is_enabled && tcsetattr(term.tty_fd, TCSAFLUSH, &term.initial_state) == -1) {
+        fprintf(stderr, "ERROR: Could not set terminal initial state!");
+        return 1;
+    }
+
+    /* Stop background search, comparison and entropy map (they read the files) */
+    if (search_stop() != 0) {
+        fprintf(stderr, "ERROR: Could not stop search!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+    }
+    if (diff_stop() != 0) {
+        fprintf(stderr, "ERROR: Could not stop comparing the files!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+    }
+
+    if (entropy_stop() != 0) {
+        fprintf(stderr, "ERROR: Could not stop mapping the entropy of the file!\n");
+        fprintf(stderr, "    -> %s\n", strerror(errno));
+    }
+    minimap_view.pane = NULL;
+
+    /* Free the template of the inspector (it reads the file of its pane) */
+    template_close(inspect_view.template);
+    inspect_view.template = NULL;
+    inspect_view.pane     = NULL;
+
+    /* Close the file of each pane */
+    while (term.n_panes > 0) {
+        term.n_panes--;
+        if (file_close(term.panes[term.n_panes].file) != 0) {
+            fprintf(stderr, "ERROR: Could not close opened file!\n");
+            fprintf(stderr, "    -> %s\n", strerror(errno));
+            return 2;
+        }
+        term.panes[term.n_panes].file = NULL;
+    }
+
+    /* Close the controlling terminal (if it was opened to read keys) */
+    if (term.tty_fd != STDIN_FILENO && !headless.is_enabled) {
+        close(term.tty_fd);
+        term.tty_fd = STDIN_FILENO;
+    }
+
+    /* Restore default SIGWINCH handling, and close self-pipe */
+    signal(SIGWINCH, SIG_DFL);
+    close(sigwinch.pipe_fds[0]);
+    close(sigwinch.pipe_fds[1]);
+    sigwinch.pipe_fds[0] = -1;
+    sigwinch.pipe_fds[1] = -1;
+
+    /* Free frame buffer, row buffer and shadow frame */
+    ab_free(&term.frame);
+    ab_free(&term.row);
+    free(shadow.rows);
+    free(shadow.lens);
+    shadow.rows  = NULL;
+    shadow.lens  = NULL;
+    shadow.state = RHD_TERM_SHADOW_STATE_INVALID;
+
+    /* Flush errors queue (if they happened) */
+    error_flush();
+
+    /* Set terminal in raw mode */
+    term_is_init = RHD_TERM_INIT_FALSE;
+
+    return 0;
+}
+
+
+void term_reset(void) {
+    /* The state of a session can't be dropped while it runs */
+    if (term_is_init == RHD_TERM_INIT_TRUE) {
+        error_queue("WARNING: Terminal is still initialized!");
+        return;
+    }
+
+    /* Close the files left open by a term_init() that failed */
+    while (term.n_panes > 0) {
+        term.n_panes--;
+        if (file_close(term.panes[term.n_panes].file) != 0)
+            error_queue("ERROR: Could not close opened file!");
+    }
+
+    /* Every view starts again as at startup (where each static variable is zero) */
+    memset(&diff_view, 0, sizeof(diff_view));
+    memset(&layout, 0, sizeof(layout));
+    memset(&sigwinch, 0, sizeof(sigwinch));
+    memset(&term, 0, sizeof(term));
+    memset(&headless, 0, sizeof(headless));
+    memset(&term_search, 0, sizeof(term_search));
+    memset(&nav, 0, sizeof(nav));
+    memset(&shadow, 0, sizeof(shadow));
+    memset(&inspect_view, 0, sizeof(inspect_view));
+    memset(&minimap_view, 0, sizeof(minimap_view));
+    memset(&edit_view, 0, sizeof(edit_view));
+    memset(&render, 0, sizeof(render));
+    memset(&stats_view, 0, sizeof(stats_view));
+    term_is_in_loop = RHD_TERM_LOOP_FALSE;
+}
+
+
+int term_loop(void) {
+    int        ret;
+    keypress_t keypress;
+
+    /* Initialize variables */
+    ret      = 0;
+    keypress = RHD_TERM_KEYPRESS_ACT;
+
+    term_is_in_loop = RHD_TERM_LOOP_TRUE;
+
+    /* Hide cursor */
+    if (write(term.out_fd, RHD_TERM_VT100_CUR_HIDE, sizeof(RHD_TERM_VT100_CUR_HIDE) - 1) == -1) {
+        error_queue("ERROR: Function write() failed!");
+        return 5;
+    }
+
+    /* Frames are written without blocking (see render) */
+    if ((render.stdout_flags = fcntl(term.out_fd, F_GETFL)) == -1 ||
+        fcntl(term.out_fd, F_SETFL, render.stdout_flags | O_NONBLOCK) == -1) {
+        error_queue("ERROR: Function fcntl() failed!");
+        return 5;
+    }
+    render.is_nonblocking = 1;
+
+    /* Loop */
+    do {
+        /* If the keypress is an action, it requires a screen refresh (rendered while waiting
+           for the next keypress, once all the keys already received are processed) */
+        if (keypress == RHD_TERM_KEYPRESS_ACT)
+            term_screen_request();
+
+        /* Process the new keypress (SIGWINCH signals, and the frames, are processed while waiting for it) */
+        if ((keypress = term_process_keypress()) == RHD_TERM_KEYPRESS_ERROR) {
+            if (sigwinch.state == RHD_TERM_SIGWINCH_STATE_ERROR) {
+                error_queue("ERROR: SIGWINCH signal was not handled correctly!");
+                ret = 4;
+            } else {
+                error_queue("ERROR: Couldn't process keypress!");
+                ret = 1;
+            }
+            break;
+        }
+    } while (keypress != RHD_TERM_KEYPRESS_QUIT && keypress != RHD_TERM_KEYPRESS_ERROR);
+
+    /* Finish writing the last frame */
+    if (term_screen_drain() != 0) {
+        error_queue("ERROR: Couldn't refresh screen!");
+        ret = 2;
+    }
+
+    if (keypress == RHD_TERM_KEYPRESS_QUIT) {
+        /* If the keypress is a graceful quit, do a final screen refresh */
+        if (term_screen_clear() != 0) {
+            error_queue("ERROR: Couldn't clear screen!");
+            ret = 3;
+        }
+    }
+
+    /* Reset scroll region, and show cursor */
+    if (write(term.out_fd, RHD_TERM_VT100_REGION_RESET, sizeof(RHD_TERM_VT100_REGION_RESET) - 1) == -1 ||
+        write(term.out_fd, RHD_TERM_VT100_CUR_SHOW, sizeof(RHD_TERM_VT100_CUR_SHOW) - 1) == -1) {
+        error_queue("ERROR: Function write() failed!");
+        return 5;
+    }
+
+    term_is_in_loop = RHD_TERM_LOOP_FALSE;
+
+    return ret;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+/* EXIT CALLBACK */
+
+static void at_exit_callback(void) {
+    /* Restore terminal initial state */
+    if (term_is_init == RHD_TERM_INIT_TRUE)
+        term_disable_raw_mode();
+}
+
+
+/* SIGNAL HANDLER */
+
+static void sigwinch_handler(int sig) {
+    int saved_errno;
+
+    /* Only async-signal-safe functions can be used here. If the pipe is full, a
+       SIGWINCH is already waiting to be processed, so the byte can be dropped. */
+    if (sig == SIGWINCH) {
+        saved_errno = errno;
+        if (write(sigwinch.pipe_fds[1], "W", 1) == -1) {
+            /* Nothing to do */
+        }
+        errno = saved_errno;
+    }
+}
+
+
+static int sigwinch_pipe_open(void) {
+    int i;
+
+    if (pipe(sigwinch.pipe_fds) == -1)
+        return 1;
+
+    for (i = 0; i < 2; i++) {
+        if (fcntl(sigwinch.pipe_fds[i], F_SETFL, fcntl(sigwinch.pipe_fds[i], F_GETFL) | O_NONBLOCK) == -1 ||
+            fcntl(sigwinch.pipe_fds[i], F_SETFD, FD_CLOEXEC) == -1)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+static int sigwinch_process(void) {
+    char buf[64];
+
+    /* Empty self-pipe, so that a burst of signals results in a single redraw */
+    while (read(sigwinch.pipe_fds[0], buf, sizeof(buf)) > 0)
+        ;
+
+    /* Adjust output */
+    if (term_output_adjust_after_sigwinch() != 0) {
+        sigwinch.state = RHD_TERM_SIGWINCH_STATE_ERROR;
+        return 1;
+    }
+
+    /* Refresh screen (ONLY IF IN LOOP!) */
+    if (term_is_in_loop == RHD_TERM_LOOP_TRUE)
+        term_screen_request();
+
+    sigwinch.state = RHD_TERM_SIGWINCH_STATE_OK;
+    return 0;
+}
+
+
+/* TERMINAL */
+
+static int term_get_win_size(void) {
+    struct winsize ws;
+
+    /* Tries to use ioctl() with the TIOCGWINSZ request (inside sys/ioctl.h) to get terminal window size
+       (without a terminal, the size is the given one) */
+    if (headless.is_enabled) {
+        ws.ws_row = (unsigned short)headless.rows;
+        ws.ws_col = (unsigned short)headless.cols;
+    } else if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1) {
+        ws.ws_row = 0;
+    }
+    if (ws.ws_row == 0 || ws.ws_col == 0) {
+        error_queue("ERROR: Function ioctl() failed!");
+        return 1;
+    }
+
+    term.screen_rows = ws.ws_row;
+    term.screen_cols = ws.ws_col;
+    term.page_rows   = ws.ws_row > 1 ? ws.ws_row - 1u : 1u;
+    if (stats_view.is_enabled && term.page_rows > 1)
+        term.page_rows--;
+
+    return 0;
+}
+
+
+/* OUTPUT */
+
+static int term_output_save(term_pane_t* pane) {
+    off_t curr_pos;
+
+    /* Get current pos of active output */
+    if ((curr_pos = file_tell(pane->file)) == -1) {
+        error_queue("ERROR: Couldn't get current position in file!");
+        return 1;
+    }
+
+    /* Save "curr_pos" inside active output */
+    pane->active_output->pos = curr_pos;
+
+    /* Make it so that RHD_TERM_OUTPUT_FORMHEX and RHD_TERM_OUTPUT_FORMCHAR share "pos" */
+    switch (pane->active_output->id) {
+        case RHD_TERM_OUTPUT_FORMHEX:
+            pane->outputs[RHD_TERM_OUTPUT_FORMCHAR].pos = curr_pos;
+            break;
+
+        case RHD_TERM_OUTPUT_FORMCHAR:
+            pane->outputs[RHD_TERM_OUTPUT_FORMHEX].pos = curr_pos;
+            break;
+
+        case RHD_TERM_OUTPUT_CHAR:
+            break;
+
+        default:
+            error_queue("ERROR: Unrecognized output id!");
+            return 1;
+    }
+
+    return 0;
+}
+
+
+static int term_output_change(const term_output_id_t output_id) {
+    term_pane_t* other;
+
+    /* Saves active output before changing it */
+    if (term_output_save(term.pane) != 0) {
+        error_queue("ERROR: Couldn't save output!");
+        return 1;
+    }
+
+    /* Changes active output */
+    switch (output_id) {
+        case RHD_TERM_OUTPUT_FORMHEX:
+        case RHD_TERM_OUTPUT_FORMCHAR:
+        case RHD_TERM_OUTPUT_CHAR:
+            term.pane->active_output = &term.pane->outputs[output_id];
+            break;
+
+        default:
+            error_queue("ERROR: Unrecognized output id!");
+            return 1;
+    }
+
+    /* Move file to "pos" of new "active_output" */
+    if (file_seek_set(term.pane->file, term.pane->active_output->pos) == 1) {
+        error_queue("ERROR: Couldn't move file position indicator!");
+        return 1;
+    }
+
+    /* In the diff view the other file is always shown with the same output */
+    if (diff_view.is_enabled) {
+        other                = term.pane == &term.panes[0] ? &term.panes[1] : &term.panes[0];
+        other->active_output = &other->outputs[output_id];
+        return term_diff_sync(term.pane);
+    }
+
+    return 0;
+}
+
+
+static int term_output_adjust_after_sigwinch(void) {
+    term_pane_t*   pane;
+    term_output_t* output;
+    unsigned int   cols;
+    unsigned int   gutter_cols;
+    unsigned int   bytes_cols;
+    size_t         i;
+    size_t         j;
+    off_t          first;
+
+    /* Update terminal window size */
+    if (term_get_win_size() != 0) {
+        error_queue("ERROR: Couldn't get terminal window size!");
+        return 1;
+    }
+
+    /* Make sure that a full frame fits inside the frame buffer */
+    if (ab_reserve(&term.frame, RHD_TERM_FRAME_CAP(term.screen_rows, term.screen_cols)) != 0) {
+        error_queue("ERROR: Function ab_reserve() failed!");
+        return 1;
+    }
+    if (ab_reserve(&term.row, RHD_TERM_ROW_CAP(term.screen_cols)) != 0) {
+        error_queue("ERROR: Function ab_reserve() failed!");
+        return 1;
+    }
+
+    /* The rows on screen are not the ones in the shadow frame anymore */
+    if (term_shadow_resize() != 0) {
+        error_queue("ERROR: Couldn't resize shadow frame!");
+        return 1;
+    }
+
+    /* Split the columns between the panes (the last one gets the remainder, except in the
+       diff view, where the rows of both files must be equally long), after those of the
+       inspector (and its separator) */
+    cols                 = term.screen_cols > term.n_panes - 1 ? term.screen_cols - (unsigned int)(term.n_panes - 1) : 0;
+    layout.gutter_digits = term_gutter_digits();
+    gutter_cols          = layout.is_gutter_hidden ? 0 : (unsigned int)(layout.gutter_digits + sizeof(RHD_TERM_GUTTER_GAP) - 1);
+    inspect_view.cols    = 0;
+    if (inspect_view.is_enabled &&
+        cols >= RHD_TERM_INSPECT_COLS + 1 + (RHD_TERM_INSPECT_MIN_COLS + gutter_cols) * (unsigned int)term.n_panes) {
+        inspect_view.cols = RHD_TERM_INSPECT_COLS;
+        cols             -= RHD_TERM_INSPECT_COLS + 1;
+    }
+    minimap_view.cols = 0;
+    if (minimap_view.is_enabled && cols >= 1 + 1 + (gutter_cols + 3) * (unsigned int)term.n_panes) {
+        minimap_view.cols = 1;
+        cols             -= 1 + 1;
+    }
+    for (i = 0; i < term.n_panes; i++) {
+        pane       = &term.panes[i];
+        pane->cols = cols / (unsigned int)term.n_panes;
+        if (i == term.n_panes - 1 && !diff_view.is_enabled)
+            pane->cols += cols % (unsigned int)term.n_panes;
+
+        /* (the offsets column is shown only if a byte in hexadecimal fits next to it) */
+        pane->gutter_cols = pane->cols >= gutter_cols + 3 ? gutter_cols : 0;
+        bytes_cols = pane->cols - pane->gutter_cols;
+
+        /* Saves output */
+        if (term_output_save(pane) != 0) {
+            error_queue("ERROR: Couldn't save output!");
+            return 1;
+        }
+
+        /* Update outputs "row_len" (meaning the amount of bytes that appears in a row of the pane,
+           fixed if requested and if it fits), and "pos" (adjusting them based on the new "row_len",
+           without going before the window of a stream, see term_nav_first_row()) */
+        first = file_first(pane->file);
+        for (j = 0; j < 3; j++) {
+            output          = &pane->outputs[j];
+            output->row_len = (off_t)(output->id == RHD_TERM_OUTPUT_CHAR ? bytes_cols : bytes_cols / 3);
+            if (layout.row_width > 0 && layout.row_width < output->row_len)
+                output->row_len = layout.row_width;
+            if (output->row_len == 0)
+                output->row_len = 1;
+            output->pos     = output->pos - (output->pos % output->row_len);
+            if (output->pos < first)
+                output->pos = first + (output->row_len - first % output->row_len) % output->row_len;
+        }
+
+        /* Move file to "pos" of "active_output" */
+        if (file_seek_set(pane->file, pane->active_output->pos) != 0) {
+            error_queue("ERROR: Couldn't move file position indicator!");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+static size_t term_gutter_digits(void) {
+    size_t n_digits;
+    size_t i;
+    off_t  len;
+
+    /* (the last offset shown is the one of the last byte) */
+    n_digits = RHD_TERM_GUTTER_DIGITS_MIN;
+    for (i = 0; i < term.n_panes; i++) {
+        if ((len = file_length(term.panes[i].file)) > 1 && offset_hex_digits(len - 1) > n_digits)
+            n_digits = offset_hex_digits(len - 1);
+    }
+
+    return n_digits;
+}
+
+
+/* PANES */
+
+static void term_pane_next(void) {
+    size_t i;
+
+    i         = (size_t)(term.pane - term.panes);
+    term.pane = &term.panes[(i + 1) % term.n_panes];
+    sprintf(term.status_msg, "File %lu of %lu: ",
+            (unsigned long)((i + 1) % term.n_panes) + 1, (unsigned long)term.n_panes);
+    strncat(term.status_msg, term.pane->filename, RHD_TERM_STATUS_MAX - strlen(term.status_msg) - 1);
+}
+
+
+/* INPUT */
+
+static int term_process_keypress(void) {
+    off_t page;
+    int   c;
+
+    /* Read key */
+    if (term_read_key(&c) != 0)
+        return RHD_TERM_KEYPRESS_ERROR;
+
+    /* Saving the "page" needs to happen after term_read_key().
+       This is because term_read_key() is where the loop interrupts to wait for stdin.
+       While it is interrupted, if the terminal window is resized, the signal SIGWINCH
+       will be processed, possibly modifing "page_rows" (and all outputs' "row_len"). */
+    page = (off_t)term.page_rows;
+
+    /* A status message is shown until the next keypress (as is the request to confirm quitting) */
+    term.status_msg[0] = '\0';
+    if (c != RHD_TERM_CTRL_KEY('q'))
+        edit_view.is_quitting = 0;
+
+    /* In the edit mode the hex digits change the byte at the cursor, instead of being commands */
+    if (edit_view.is_editing && c >= 0 && c <= 0x7F && isxdigit(c)) {
+        if (term_edit_digit(c) != 0)
+            return RHD_TERM_KEYPRESS_ERROR;
+        return RHD_TERM_KEYPRESS_ACT;
+    }
+
+    /* Handle keypress */
+    switch (c) {
+        case RHD_TERM_CTRL_KEY('q'):
+            /* (quitting with changes not saved yet needs to be confirmed) */
+            if (!edit_view.is_quitting && term_edit_is_modified()) {
+                edit_view.is_quitting = 1;
+                strcpy(term.status_msg, "Changes not saved! (CTRL+S to save them, or CTRL+Q again to quit)");
+                return RHD_TERM_KEYPRESS_ACT;
+            }
+            return RHD_TERM_KEYPRESS_QUIT;
+
+        case RHD_TERM_CTRL_KEY('e'):
+            if (term_edit_toggle() != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case RHD_TERM_CTRL_KEY('z'):
+        case RHD_TERM_CTRL_KEY('y'):
+            if (term_edit_undo(c == RHD_TERM_CTRL_KEY('y')) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case RHD_TERM_CTRL_KEY('s'):
+            term_edit_save();
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'w':
+        case 'W':
+            if (term_nav_move(-1 * term_nav_accel(c)) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 's':
+        case 'S':
+            if (term_nav_move(term_nav_accel(c)) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'a':
+        case 'A':
+            if (term_nav_move(-1 * page * term_nav_accel(c)) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'd':
+        case 'D':
+            if (term_nav_move(page * term_nav_accel(c)) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case RHD_TERM_KEY_HOME:
+            if (term_nav_jump(term.pane, 0) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case RHD_TERM_KEY_END:
+            if (term_nav_jump(term.pane, term_nav_last_page(term.pane)) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'g':
+        case 'G':
+            if (term_command_goto(0) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case '%':
+            if (term_command_goto(1) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case '/':
+            if (term_command_search() != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'n':
+            if (term_search_next(RHD_SEARCH_DIR_FORWARD) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'N':
+            if (term_search_next(RHD_SEARCH_DIR_BACKWARD) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'x':
+            if (term_diff_next(RHD_DIFF_DIR_FORWARD) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'X':
+            if (term_diff_next(RHD_DIFF_DIR_BACKWARD) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case '\t':
+            if (term.n_panes == 1)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            term_pane_next();
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'i':
+        case 'I':
+            /* The inspector takes the columns on the right, so the layout changes like after a resize
+               (the edit mode needs its cursor) */
+            inspect_view.is_enabled = !inspect_view.is_enabled;
+            edit_view.is_editing    = edit_view.is_editing && inspect_view.is_enabled;
+            if (term_output_adjust_after_sigwinch() != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            if (inspect_view.is_enabled && inspect_view.cols == 0)
+                strcpy(term.status_msg, "Terminal too narrow for the inspector!");
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'm':
+        case 'M':
+            /* The minimap takes the column on the far right, so the layout changes like after a resize */
+            minimap_view.is_enabled = !minimap_view.is_enabled;
+            if (term_output_adjust_after_sigwinch() != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            if (minimap_view.is_enabled && minimap_view.cols == 0)
+                strcpy(term.status_msg, "Terminal too narrow for the entropy map!");
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case '[':
+        case ']':
+            if (minimap_view.cols == 0)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            if (term_minimap_jump(c == ']') != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'e':
+        case 'E':
+            if (inspect_view.cols == 0)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            inspect_view.is_big_endian = !inspect_view.is_big_endian;
+            inspect_view.lines_pos     = -1;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 't':
+        case 'T':
+            if (inspect_view.cols == 0)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            if (inspect_view.template == NULL) {
+                strcpy(term.status_msg, "No template for this file! (known formats: ELF, PE and PNG)");
+                return RHD_TERM_KEYPRESS_ACT;
+            }
+            inspect_view.is_template_hidden = !inspect_view.is_template_hidden;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case RHD_TERM_KEY_UP:
+        case RHD_TERM_KEY_DOWN:
+        case RHD_TERM_KEY_RIGHT:
+        case RHD_TERM_KEY_LEFT:
+            if (inspect_view.cols == 0)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            edit_view.low_pos = -1;
+            if (term_inspect_move(c == RHD_TERM_KEY_UP    ? -1 * term.pane->active_output->row_len :
+                                  c == RHD_TERM_KEY_DOWN  ? term.pane->active_output->row_len :
+                                  c == RHD_TERM_KEY_RIGHT ? 1 : -1) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case '#':
+            /* The stats row takes the last row of the page, so the layout changes like after a resize */
+            stats_view.is_enabled = !stats_view.is_enabled;
+            if (term_output_adjust_after_sigwinch() != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'o':
+        case 'O':
+            /* The offsets column takes columns from the bytes, so the layout changes like after a resize */
+            layout.is_gutter_hidden = !layout.is_gutter_hidden;
+            if (term_output_adjust_after_sigwinch() != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case RHD_TERM_KEY_ESC:
+            /* Leave the edit mode, cancel background search (its end is notified like any other),
+               and stop waiting for the next difference (the comparison goes on) */
+            edit_view.is_editing = 0;
+            search_cancel();
+            if (diff_view.is_pending) {
+                diff_view.is_pending = 0;
+                strcpy(term.status_msg, "Lookup cancelled");
+            }
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'h':
+        case 'H':
+            if (term.pane->active_output->id == RHD_TERM_OUTPUT_FORMHEX)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            if (term_output_change(RHD_TERM_OUTPUT_FORMHEX) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case 'c':
+        case 'C':
+            if (term.pane->active_output->id == RHD_TERM_OUTPUT_FORMCHAR)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            if (term_output_change(RHD_TERM_OUTPUT_FORMCHAR) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        case RHD_TERM_CTRL_KEY('c'):
+            if (term.pane->active_output->id == RHD_TERM_OUTPUT_CHAR)
+                return RHD_TERM_KEYPRESS_IGNORE;
+            if (term_output_change(RHD_TERM_OUTPUT_CHAR) != 0)
+                return RHD_TERM_KEYPRESS_ERROR;
+            return RHD_TERM_KEYPRESS_ACT;
+
+        default:
+            return RHD_TERM_KEYPRESS_IGNORE;
+    }
+}
+
+
+static off_t term_nav_accel(const int key) {
+    struct timespec now;
+    long int        elapsed_ms;
+    off_t           accel;
+
+    /* If the time can't be read, don't accelerate (nor without a terminal, where the keys arrive
+       as fast as they are read, like auto-repeats) */
+    if (headless.is_enabled || clock_gettime(CLOCK_MONOTONIC, &now) == -1)
+        return 1;
+
+    /* Count consecutive keypresses of the same key, close enough to be an auto-repeat */
+    elapsed_ms = (long int)(now.tv_sec - nav.last_time.tv_sec) * 1000 + (now.tv_nsec - nav.last_time.tv_nsec) / 1000000;
+    if (key == nav.last_key && elapsed_ms <= RHD_TERM_NAV_REPEAT_MS)
+        nav.repeats++;
+    else
+        nav.repeats = 0;
+    nav.last_key  = key;
+    nav.last_time = now;
+
+    /* Double the movement every RHD_TERM_NAV_ACCEL_STEP repeats (up to RHD_TERM_NAV_ACCEL_MAX) */
+    for (accel = 1; accel < RHD_TERM_NAV_ACCEL_MAX && (unsigned int)accel * RHD_TERM_NAV_ACCEL_STEP <= nav.repeats; accel *= 2)
+        ;
+
+    return accel;
+}
+
+
+static off_t term_nav_length(term_pane_t* pane) {
+    off_t  len;
+    size_t i;
+
+    if (!diff_view.is_enabled)
+        return file_length(pane->file);
+
+    len = 0;
+    for (i = 0; i < term.n_panes; i++) {
+        if (file_length(term.panes[i].file) > len)
+            len = file_length(term.panes[i].file);
+    }
+    return len;
+}
+
+
+static off_t term_nav_last_page(term_pane_t* pane) {
+    off_t row_len;
+    off_t last_row;
+    off_t len;
+
+    row_len = pane->active_output->row_len;
+    if ((len = term_nav_length(pane)) <= 0)
+        return 0;
+
+    /* The last full page is the one ending with the last row of the file */
+    last_row = (len - 1) - ((len - 1) % row_len);
+    if (last_row - (off_t)(term.page_rows - 1) * row_len < term_nav_first_row(pane))
+        return term_nav_first_row(pane);
+    return last_row - (off_t)(term.page_rows - 1) * row_len;
+}
+
+
+static off_t term_nav_first_row(term_pane_t* pane) {
+    off_t row_len;
+    off_t first;
+
+    row_len = pane->active_output->row_len;
+    first   = file_first(pane->file);
+
+    /* Rows start at multiples of the row length, so the first row is the next full one */
+    return first + (row_len - first % row_len) % row_len;
+}
+
+
+static int term_nav_move(const off_t rows) {
+    term_pane_t* pane = term.pane;
+    off_t        pos;
+    off_t        target;
+    off_t        last_page;
+    off_t        page_len;
+
+    if ((pos = file_tell(pane->file)) == -1) {
+        error_queue("ERROR: Couldn't get current position in file!");
+        return 1;
+    }
+
+    /* Compute target, clamping it between SEEK_SET and the last full page
+       (moving towards SEEK_END never moves towards SEEK_SET, even if past the last full page) */
+    target    = pos + rows * pane->active_output->row_len;
+    last_page = term_nav_last_page(pane);
+    if (rows > 0 && target > last_page)
+        target = pos > last_page ? pos : last_page;
+    if (target < term_nav_first_row(pane))
+        target = term_nav_first_row(pane);
+
+    /* Move the file position indicator (only once) */
+    if (target != pos && (file_seek_set(pane->file, target) != 0 || term_diff_sync(pane) != 0)) {
+        error_queue("ERROR: Couldn't move file position indicator!");
+        return 1;
+    }
+
+    /* Read ahead the next pages in the direction of the movement */
+    page_len = (off_t)term.page_rows * pane->active_output->row_len;
+    if (rows > 0)
+        file_prefetch(pane->file, target + page_len, RHD_TERM_NAV_PREFETCH_PAGES * page_len);
+    else if (rows < 0)
+        file_prefetch(pane->file, target - RHD_TERM_NAV_PREFETCH_PAGES * page_len, RHD_TERM_NAV_PREFETCH_PAGES * page_len);
+
+    return 0;
+}
+
+
+static int term_nav_jump(term_pane_t* pane, const off_t offset) {
+    off_t target;
+    off_t last_page;
+
+    /* Align target to the start of its row, and clamp it to the last full page */
+    target    = offset - (offset % pane->active_output->row_len);
+    last_page = term_nav_last_page(pane);
+    if (target > last_page)
+        target = last_page;
+    if (target < term_nav_first_row(pane))
+        target = term_nav_first_row(pane);
+
+    if (file_seek_set(pane->file, target) != 0 || term_diff_sync(pane) != 0) {
+        error_queue("ERROR: Couldn't move file position indicator!");
+        return 1;
+    }
+
+    /* The cursor goes on the offset (if it is shown, it is then kept on the page) */
+    if (pane == term.pane)
+        inspect_view.cursor = offset;
+
+    return 0;
+}
+
+
+static int term_diff_sync(term_pane_t* pane) {
+    off_t  pos;
+    size_t i;
+
+    if (!diff_view.is_enabled)
+        return 0;
+
+    /* (the other file may be shorter, so it can also be shown past its end) */
+    if ((pos = file_tell(pane->file)) == -1)
+        return 1;
+    for (i = 0; i < term.n_panes; i++) {
+        if (&term.panes[i] != pane && file_seek_set(term.panes[i].file, pos) != 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+static int term_diff_next(const diff_dir_t dir) {
+    off_t pos;
+    off_t row_len;
+    off_t from;
+
+    if (!diff_view.is_enabled) {
+        strcpy(term.status_msg, "Not comparing files! (see --diff)");
+        return 0;
+    }
+
+    /* Start from the row after (or before) the last difference if it is on screen, else
+       from the row after the first one on screen (or from the byte before it) */
+    if ((pos = file_tell(term.pane->file)) == -1)
+        return 1;
+    row_len = term.pane->active_output->row_len;
+    from    = pos;
+    if (diff_view.last_hit >= pos && diff_view.last_hit < pos + (off_t)term.page_rows * row_len)
+        from = diff_view.last_hit - diff_view.last_hit % row_len;
+    diff_view.is_pending   = 1;
+    diff_view.pending_from = dir == RHD_DIFF_DIR_FORWARD ? from + row_len : from - 1;
+    diff_view.pending_dir  = dir;
+
+    return term_diff_resolve(diff_poll(NULL, NULL, NULL));
+}
+
+
+static int term_diff_resolve(const diff_state_t state) {
+    off_t hit;
+
+    if (!diff_view.is_pending)
+        return 0;
+
+    switch (diff_find(diff_view.pending_from, diff_view.pending_dir, &hit)) {
+        case RHD_DIFF_RESULT_FOUND:
+            diff_view.is_pending = 0;
+            diff_view.last_hit   = hit;
+            if (term_nav_jump(term.pane, hit) != 0)
+                return 1;
+            term_status_offset("Difference at offset ", hit);
+            return 0;
+
+        case RHD_DIFF_RESULT_NOT_FOUND:
+            diff_view.is_pending = 0;
+            strcpy(term.status_msg, "No more differences!");
+            return 0;
+
+        case RHD_DIFF_RESULT_ERROR:
+            diff_view.is_pending = 0;
+            error_queue("ERROR: Couldn't read files while comparing them!");
+            return 1;
+
+        default:
+            break;
+    }
+
+    /* The difference is in a block not compared yet */
+    if (state == RHD_DIFF_STATE_RUNNING) {
+        strcpy(term.status_msg, "Comparing... (ESC to cancel)");
+        return 0;
+    }
+    diff_view.is_pending = 0;
+    error_queue("ERROR: Couldn't read files while comparing them!");
+    return 1;
+}
+
+
+static int term_diff_process(void) {
+    /* The status row shows the progress of the comparison */
+    if (term_diff_resolve(diff_poll(NULL, NULL, NULL)) != 0)
+        return 1;
+
+    /* Refresh screen (ONLY IF IN LOOP!) */
+    if (term_is_in_loop == RHD_TERM_LOOP_TRUE)
+        term_screen_request();
+
+    return 0;
+}
+
+
+static int term_minimap_prepare(const off_t pos) {
+    if (minimap_view.pane == term.pane)
+        return 0;
+
+    /* (scanning the stream would need all of it, and its bytes come and go) */
+    minimap_view.pane = term.pane;
+    if (file_is_stream(term.pane->file)) {
+        if (entropy_stop() != 0) {
+            error_queue("ERROR: Couldn't stop mapping the entropy of the file!");
+            return 1;
+        }
+        strcpy(term.status_msg, "No entropy map for streams!");
+        return 0;
+    }
+    if (entropy_start(term.pane->file, pos) != 0) {
+        error_queue("ERROR: Couldn't start mapping the entropy of the file!");
+        return 1;
+    }
+
+    return 0;
+}
+
+
+static int term_minimap_level(const size_t b) {
+    entropy_bucket_t bucket;
+
+    if (entropy_bucket(b, &bucket) != 0 || !bucket.is_done)
+        return -1;
+    if (bucket.is_zero)
+        return 9;
+
+    return (int)((bucket.entropy + 50) / 100);
+}
+
+
+static int term_minimap_jump(const int is_forward) {
+    entropy_bucket_t bucket;
+    off_t            pos;
+    size_t           n;
+    size_t           b;
+    int              level;
+    int              other;
+
+    if ((n = entropy_buckets()) == 0 || minimap_view.pane != term.pane)
+        return 0;
+    pos = inspect_view.cols > 0 ? inspect_view.cursor : file_tell(term.pane->file);
+    if (pos == -1) {
+        error_queue("ERROR: Couldn't get current position in file!");
+        return 1;
+    }
+    /* (a jump lands on the start of the row holding the region, so the current region is the
+       one at the end of the top row) */
+    if (inspect_view.cols == 0)
+        pos += term.pane->active_output->row_len - 1;
+
+    /* Walk the buckets from the current one, until the level changes (the regions not mapped
+       yet can't be crossed) */
+    b     = entropy_bucket_of(pos);
+    level = term_minimap_level(b);
+    other = level;
+    while (other == level && level != -1 && (is_forward ? b + 1 < n : b > 0)) {
+        b     = is_forward ? b + 1 : b - 1;
+        other = term_minimap_level(b);
+    }
+    if (level == -1 || other == -1) {
+        strcpy(term.status_msg, "The entropy map is not built there yet!");
+        return 0;
+    }
+    if (other == level) {
+        strcpy(term.status_msg, is_forward ? "No other region after this one!" : "No other region before this one!");
+        return 0;
+    }
+
+    /* (going backward, the region starts at its first bucket) */
+    while (!is_forward && b > 0 && term_minimap_level(b - 1) == other)
+        b--;
+    if (entropy_bucket(b, &bucket) != 0)
+        return 0;
+    term_status_offset(other == 9 ? "Zero fill at " : "Region at ", bucket.start);
+
+    return term_nav_jump(term.pane, bucket.start);
+}
+
+
+static int term_minimap_process(void) {
+    if (entropy_poll(NULL, NULL) == RHD_ENTROPY_STATE_ERROR) {
+        error_queue("ERROR: Couldn't read the file while mapping its entropy!");
+        return 1;
+    }
+
+    /* Refresh screen (ONLY IF IN LOOP!) */
+    if (term_is_in_loop == RHD_TERM_LOOP_TRUE)
+        term_screen_request();
+
+    return 0;
+}
+
+
+static int term_edit_toggle(void) {
+    if (edit_view.is_editing) {
+        edit_view.is_editing = 0;
+        return 0;
+    }
+    if (!edit_view.is_enabled) {
+        strcpy(term.status_msg, "The files are read-only! (open them with --edit to change them)");
+        return 0;
+    }
+    if (!file_is_writable(term.pane->file)) {
+        strcpy(term.status_msg, "This file can't be changed!");
+        return 0;
+    }
+
+    /* The inspector takes the columns on the right, so the layout changes like after a resize */
+    if (!inspect_view.is_enabled) {
+        inspect_view.is_enabled = 1;
+        if (term_output_adjust_after_sigwinch() != 0)
+            return 1;
+    }
+    if (inspect_view.cols == 0) {
+        strcpy(term.status_msg, "Terminal too narrow for the inspector!");
+        return 0;
+    }
+
+    edit_view.is_editing = 1;
+    edit_view.low_pos    = -1;
+    return 0;
+}
+
+
+static int term_edit_digit(const int c) {
+    unsigned char        buf[1];
+    const unsigned char* view;
+    unsigned char        byte;
+    unsigned int         digit;
+
+    if (inspect_view.cols == 0) {
+        strcpy(term.status_msg, "Terminal too narrow for the inspector!");
+        return 0;
+    }
+    if (!file_is_writable(term.pane->file)) {
+        strcpy(term.status_msg, "This file can't be changed!");
+        return 0;
+    }
+    if (file_read_at(term.pane->file, &view, buf, inspect_view.cursor, 1) != 1) {
+        error_queue("ERROR: Couldn't read the byte at the cursor!");
+        return 1;
+    }
+
+    /* The first digit typed is the high one, and the second the low one */
+    digit = (unsigned int)(isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+    if (inspect_view.cursor != edit_view.low_pos)
+        byte = (unsigned char)((digit << 4) | (view[0] & 0x0F));
+    else
+        byte = (unsigned char)((view[0] & 0xF0) | digit);
+    if (file_write(term.pane->file, inspect_view.cursor, &byte, 1) != 0) {
+        error_queue("ERROR: Couldn't change the byte at the cursor!");
+        return 1;
+    }
+
+    /* (the inspector decodes the bytes again) */
+    inspect_view.lines_pos   = -1;
+    inspect_view.fields_from = -1;
+    if (inspect_view.cursor != edit_view.low_pos) {
+        edit_view.low_pos = inspect_view.cursor;
+        return 0;
+    }
+    edit_view.low_pos = -1;
+    return term_inspect_move(1);
+}
+
+
+static int term_edit_undo(const int is_redo) {
+    off_t pos;
+
+    if ((is_redo ? file_redo(term.pane->file, &pos) : file_undo(term.pane->file, &pos)) != 0) {
+        error_queue("ERROR: Couldn't undo the change to the file!");
+        return 1;
+    }
+    if (pos == -1) {
+        strcpy(term.status_msg, is_redo ? "Nothing to redo!" : "Nothing to undo!");
+        return 0;
+    }
+    term_status_offset(is_redo ? "Redone change at " : "Undone change at ", pos);
+
+    /* (the inspector decodes the bytes again, at the change) */
+    edit_view.low_pos        = -1;
+    inspect_view.lines_pos   = -1;
+    inspect_view.fields_from = -1;
+    if (inspect_view.cols > 0)
+        return term_inspect_move(pos - inspect_view.cursor);
+    return 0;
+}
+
+
+static void term_edit_save(void) {
+    size_t n_extents;
+    size_t total;
+    size_t i;
+
+    total = 0;
+    for (i = 0; i < term.n_panes; i++) {
+        if (file_save(term.panes[i].file, &n_extents) != 0) {
+            sprintf(term.status_msg, "Couldn't save the changes! (%.80s)", strerror(errno));
+            return;
+        }
+        total += n_extents;
+    }
+    edit_view.low_pos = -1;
+
+    if (total == 0)
+        strcpy(term.status_msg, "No changes to save!");
+    else
+        sprintf(term.status_msg, "Saved the changes (%lu extents written)", (unsigned long)total);
+}
+
+
+static int term_edit_is_modified(void) {
+    size_t i;
+
+    for (i = 0; i < term.n_panes; i++) {
+        if (file_is_modified(term.panes[i].file))
+            return 1;
+    }
+    return 0;
+}
+
+
+static int term_inspect_move(const off_t bytes) {
+    off_t pos;
+    off_t row_len;
+    off_t page_len;
+    off_t target;
+    off_t len;
+
+    if ((pos = file_tell(term.pane->file)) == -1) {
+        error_queue("ERROR: Couldn't get current position in file!");
+        return 1;
+    }
+    row_len  = term.pane->active_output->row_len;
+    page_len = (off_t)term.page_rows * row_len;
+
+    /* (the cursor stays on the bytes of the file that are available) */
+    target = inspect_view.cursor + bytes;
+    len    = file_length(term.pane->file);
+    if (target < file_first(term.pane->file) || (len >= 0 && target >= len))
+        return 0;
+
+    /* Scroll by the rows needed to show the target */
+    if (target < pos && term_nav_move(-1 * ((pos - target + row_len - 1) / row_len)) != 0)
+        return 1;
+    if (target >= pos + page_len && term_nav_move((target - pos - page_len) / row_len + 1) != 0)
+        return 1;
+
+    inspect_view.cursor = target;
+    return 0;
+}
+
+
+static int term_inspect_prepare(const off_t pos) {
+    unsigned char        buf[RHD_INSPECT_BYTES];
+    const unsigned char* view;
+    char                 name[RHD_TEMPLATE_NAME_MAX];
+    char                 value[RHD_TEMPLATE_VALUE_MAX];
+    char                 text[RHD_TEMPLATE_NAME_MAX + RHD_TEMPLATE_VALUE_MAX];
+    off_t                row_len;
+    off_t                page_end;
+    off_t                len;
+    size_t               n;
+    size_t               i;
+
+    /* Read the template of the file of the active pane (the first time it is inspected), with
+       the cursor starting from its page */
+    if (inspect_view.pane != term.pane) {
+        template_close(inspect_view.template);
+        inspect_view.template = NULL;
+        if (template_open(&inspect_view.template, term.pane->file) != 0) {
+            if (!file_is_stream(term.pane->file)) {
+                error_queue("ERROR: Couldn't read the template of the file!");
+                return 1;
+            }
+            term_inspect_drop_template();
         }
+        inspect_view.pane        = term.pane;
+        inspect_view.cursor      = pos;
+        inspect_view.lines_pos   = -1;
+        inspect_view.fields_from = -1;
+    }
 
-        /* If the keypress is an action, it requires a screen refresh */
-        if (keypress == RHD_TERM_KEYPRESS_ACT) {
-            if (term_screen_refresh() != 0) {
-                error_queue("ERROR: Couldn't refresh screen!");
-                ret = 2;
-                break;
+    /* Keep the cursor on the page, in the same column (and on the bytes of the file) */
+    row_len  = term.pane->active_output->row_len;
+    page_end = pos + (off_t)term.page_rows * row_len;
+    if (inspect_view.cursor < pos)
+        inspect_view.cursor = pos + inspect_view.cursor % row_len;
+    else if (inspect_view.cursor >= page_end)
+        inspect_view.cursor = page_end - row_len + inspect_view.cursor % row_len;
+    if ((len = file_length(term.pane->file)) > 0 && inspect_view.cursor >= len)
+        inspect_view.cursor = len - 1 >= pos ? len - 1 : pos;
+
+    /* Decode the bytes at the cursor (again even if it didn't move, while they were not all
+       there yet, since the file may grow) */
+    if (inspect_view.cursor != inspect_view.lines_pos || inspect_view.lines_n < RHD_INSPECT_BYTES) {
+        if ((n = file_read_at(term.pane->file, &view, buf, inspect_view.cursor, sizeof(buf))) == (size_t)-1) {
+            error_queue("ERROR: Couldn't read the bytes at the cursor!");
+            return 1;
+        }
+        inspect_decode(inspect_view.lines, inspect_view.cursor, view, n, inspect_view.is_big_endian);
+        inspect_view.lines_pos = inspect_view.cursor;
+        inspect_view.lines_n   = n;
+    }
+
+    /* Find the template fields of the page (with their name and value) */
+    if (inspect_view.template == NULL || inspect_view.is_template_hidden ||
+        (pos == inspect_view.fields_from && page_end == inspect_view.fields_to))
+        return 0;
+    if ((n = template_fields(inspect_view.template, pos, page_end, inspect_view.fields, RHD_TERM_INSPECT_FIELDS_MAX)) == (size_t)-1) {
+        if (!file_is_stream(term.pane->file)) {
+            error_queue("ERROR: Couldn't read the template fields!");
+            return 1;
+        }
+        term_inspect_drop_template();
+        return 0;
+    }
+    for (i = 0; i < n; i++) {
+        template_field_name(&inspect_view.fields[i], name);
+        if (template_field_value(inspect_view.template, &inspect_view.fields[i], value) != 0) {
+            if (!file_is_stream(term.pane->file)) {
+                error_queue("ERROR: Couldn't read the template fields!");
+                return 1;
             }
+            term_inspect_drop_template();
+            return 0;
         }
+        /* (truncated, leaving room for the marker of the field at the cursor) */
+        sprintf(text, "%-20s %s", name, value);
+        text[sizeof(inspect_view.field_texts[i]) - 3] = '\0';
+        strcpy(inspect_view.field_texts[i], text);
+    }
+    inspect_view.n_fields    = n;
+    inspect_view.fields_from = pos;
+    inspect_view.fields_to   = page_end;
 
-        /* Process the new keypress */
-        if ((keypress = term_process_keypress()) == RHD_TERM_KEYPRESS_ERROR) {
-            error_queue("ERROR: Couldn't process keypress!");
-            ret = 1;
+    return 0;
+}
+
+
+static void term_inspect_drop_template(void) {
+    template_close(inspect_view.template);
+    inspect_view.template = NULL;
+    inspect_view.n_fields = 0;
+    strcpy(term.status_msg, "No template: the start of the stream is past its window! (see --window)");
+}
+
+
+static int term_command_goto(const int is_percentage) {
+    char  buf[RHD_TERM_PROMPT_MAX];
+    off_t len;
+    off_t value;
+
+    /* Ask for the offset (or the percentage) */
+    switch (term_prompt(is_percentage ? "Go to percentage: " : "Go to offset: ",
+                        buf, sizeof(buf))) {
+        case RHD_TERM_PROMPT_ACCEPT:
             break;
+        case RHD_TERM_PROMPT_CANCEL:
+            return 0;
+        default:
+            return 1;
+    }
+
+    /* Parse it, and convert the percentage to an offset */
+    len = term_nav_length(term.pane);
+    if (offset_parse(buf, &value) != 0 || (is_percentage && value > 100)) {
+        strcpy(term.status_msg, is_percentage ? "Invalid percentage!" : "Invalid offset!");
+        return 0;
+    }
+    if (is_percentage)
+        value = (len / 100) * value + (len % 100) * value / 100;
+    if (value >= len && len > 0) {
+        if (!is_percentage) {
+            strcpy(term.status_msg, "Offset is past the end of the file!");
+            return 0;
         }
-    } while (keypress != RHD_TERM_KEYPRESS_QUIT && keypress != RHD_TERM_KEYPRESS_ERROR);
+        value = len - 1;
+    }
 
-    if (keypress == RHD_TERM_KEYPRESS_QUIT) {
-        /* If the keypress is a graceful quit, do a final screen refresh */
-        if (term_screen_clear() != 0) {
-            error_queue("ERROR: Couldn't clear screen!");
-            ret = 3;
+    return term_nav_jump(term.pane, value);
+}
+
+
+static int term_command_search(void) {
+    char  buf[RHD_TERM_PROMPT_MAX];
+    off_t pos;
+
+    switch (term_prompt("Search (hex or text): ", buf, sizeof(buf))) {
+        case RHD_TERM_PROMPT_ACCEPT:
+            break;
+        case RHD_TERM_PROMPT_CANCEL:
+            return 0;
+        default:
+            return 1;
+    }
+
+    /* Streams keep changing (and keep only their last bytes), so they can't be searched */
+    if (file_is_stream(term.pane->file)) {
+        strcpy(term.status_msg, "Streams can't be searched!");
+        return 0;
+    }
+
+    term_search.last_hit = -1;
+    if (search_parse(buf, term_search.needle, &term_search.len) != 0) {
+        term_search.len = 0;
+        strcpy(term.status_msg, "Invalid search pattern!");
+        return 0;
+    }
+
+    /* Search the whole file, starting from the current position */
+    term_search.pane = term.pane;
+    if ((pos = file_tell(term.pane->file)) == -1
+        || search_start(term.pane->file, term_search.needle, term_search.len, pos) != 0) {
+        error_queue("ERROR: Couldn't start search!");
+        return 1;
+    }
+
+    return term_search_lookup(pos, RHD_SEARCH_DIR_FORWARD);
+}
+
+
+static int term_search_next(const search_dir_t dir) {
+    off_t pos;
+    off_t from;
+    int   is_restart;
+
+    if (term_search.len == 0) {
+        strcpy(term.status_msg, "No previous search!");
+        return 0;
+    }
+
+    /* The pattern is searched in the file shown in the active pane */
+    is_restart = term_search.pane != term.pane;
+    if (is_restart) {
+        if (file_is_stream(term.pane->file)) {
+            strcpy(term.status_msg, "Streams can't be searched!");
+            return 0;
         }
+        term_search.pane     = term.pane;
+        term_search.last_hit = -1;
     }
 
-    /* Show cursor */
-    if (write(STDOUT_FILENO, RHD_TERM_VT100_CUR_SHOW, sizeof(RHD_TERM_VT100_CUR_SHOW) - 1) == -1) {
-        error_queue("ERROR: Function write() failed!");
-        return 5;
+    /* Continue after (or before) the last hit if it is on screen, else from the current position */
+    if ((pos = file_tell(term.pane->file)) == -1)
+        return 1;
+    if (term_search.last_hit >= pos
+        && term_search.last_hit < pos + (off_t)term.page_rows * term.pane->active_output->row_len)
+        from = dir == RHD_SEARCH_DIR_FORWARD ? term_search.last_hit + 1 : term_search.last_hit - 1;
+    else
+        from = dir == RHD_SEARCH_DIR_FORWARD ? pos : pos - 1;
+
+    /* If the last search didn't search the whole file (or searched another one), search it again */
+    switch (search_poll(NULL, NULL)) {
+        case RHD_SEARCH_STATE_RUNNING:
+        case RHD_SEARCH_STATE_DONE:
+            if (!is_restart)
+                break;
+            /* FALLTHROUGH */
+        default:
+            if (search_start(term.pane->file, term_search.needle, term_search.len, from < 0 ? 0 : from) != 0) {
+                error_queue("ERROR: Couldn't start search!");
+                return 1;
+            }
     }
 
-    term_is_in_loop = RHD_TERM_LOOP_FALSE;
+    return term_search_lookup(from, dir);
+}
+
+
+static int term_search_lookup(const off_t from, const search_dir_t dir) {
+    term_search.is_pending   = 1;
+    term_search.pending_from = from;
+    term_search.pending_dir  = dir;
+
+    return term_search_resolve(search_poll(NULL, NULL));
+}
+
+
+static int term_search_resolve(const search_state_t state) {
+    off_t hit;
+
+    if (!term_search.is_pending)
+        return 0;
+
+    switch (search_find(term_search.pending_from, term_search.pending_dir, &hit)) {
+        case RHD_SEARCH_RESULT_FOUND:
+            term_search.is_pending = 0;
+            term_search.last_hit   = hit;
+            if (term_nav_jump(term_search.pane, hit) != 0)
+                return 1;
+            term_status_offset("Found at offset ", hit);
+            return 0;
+
+        case RHD_SEARCH_RESULT_NOT_FOUND:
+            /* Keep the last hit, so that the opposite direction still continues from it */
+            term_search.is_pending = 0;
+            strcpy(term.status_msg, "Pattern not found!");
+            return 0;
+
+        default:
+            break;
+    }
+
+    /* The hit is in a part of the file not searched yet */
+    switch (state) {
+        case RHD_SEARCH_STATE_RUNNING:
+            strcpy(term.status_msg, "Searching... (ESC to cancel)");
+            return 0;
+        case RHD_SEARCH_STATE_CANCELLED:
+            term_search.is_pending = 0;
+            strcpy(term.status_msg, "Search cancelled");
+            return 0;
+        default:
+            term_search.is_pending = 0;
+            error_queue("ERROR: Couldn't read file while searching!");
+            return 1;
+    }
+}
+
+
+static int term_search_process(void) {
+    search_state_t state;
+
+    /* The status row shows the progress of the search */
+    state = search_poll(NULL, NULL);
+    if (term_search_resolve(state) != 0)
+        return 1;
+
+    /* Refresh screen (ONLY IF IN LOOP!) */
+    if (term_is_in_loop == RHD_TERM_LOOP_TRUE)
+        term_screen_request();
+
+    return 0;
+}
+
+
+static int term_stream_process(term_pane_t* pane) {
+    off_t pos;
+    int   is_pinned;
+
+    /* When following the file, the view stays pinned to the last page (if it is there) */
+    if ((pos = file_tell(pane->file)) == -1)
+        return 1;
+    is_pinned = file_is_followed() && pos >= term_nav_last_page(pane);
+
+    if (file_stream_pull(pane->file) != 0 || file_follow_pull(pane->file) != 0) {
+        error_queue("ERROR: Couldn't read the new bytes of the file!");
+        return 1;
+    }
+
+    /* If the bytes on screen were overwritten (by the new ones), go to the first row still
+       available, and if the file was truncated go to its last page */
+    if (is_pinned || (pos > 0 && pos >= file_length(pane->file))) {
+        if (term_nav_jump(pane, term_nav_last_page(pane)) != 0)
+            return 1;
+    } else if (pos < term_nav_first_row(pane)) {
+        if (term_nav_jump(pane, term_nav_first_row(pane)) != 0)
+            return 1;
+    }
+
+    /* Refresh screen (ONLY IF IN LOOP!) */
+    if (term_is_in_loop == RHD_TERM_LOOP_TRUE)
+        term_screen_request();
+
+    return 0;
+}
+
+
+static void term_status_offset(const char* msg, const off_t offset) {
+    strcpy(term.status_msg, msg);
+    term_format_offset(&term.status_msg[strlen(term.status_msg)], offset);
+}
+
+
+static size_t term_format_offset(char* dst, const off_t offset) {
+    size_t n;
+
+    n      = offset_hex_digits(offset);
+    dst[0] = '0';
+    dst[1] = 'x';
+    offset_format_hex(&dst[2], offset, n);
+    dst[n + 2] = '\0';
+
+    return n + 2;
+}
+
+
+static prompt_t term_prompt(const char* msg, char* buf, const size_t size) {
+    prompt_t ret;
+    size_t   len;
+    int      key;
+
+    len    = 0;
+    buf[0] = '\0';
+
+    /* Make the status row show the prompt */
+    term.prompt_msg = msg;
+    term.prompt_buf = buf;
+
+    for (;;) {
+        term_screen_request();
+        if (term_read_key(&key) != 0) {
+            ret = RHD_TERM_PROMPT_ERROR;
+            break;
+        }
+
+        if (key == RHD_TERM_KEY_ESC) {
+            ret = RHD_TERM_PROMPT_CANCEL;
+            break;
+        } else if (key == RHD_TERM_KEY_ENTER) {
+            ret = RHD_TERM_PROMPT_ACCEPT;
+            break;
+        } else if (key == RHD_TERM_KEY_BACKSPACE || key == RHD_TERM_CTRL_KEY('h')) {
+            if (len > 0)
+                buf[--len] = '\0';
+        } else if (key < 0x80 && isprint(key) && len + 1 < size) {
+            buf[len++] = (char)key;
+            buf[len]   = '\0';
+        }
+    }
+
+    term.prompt_msg = NULL;
+    term.prompt_buf = NULL;
 
     return ret;
 }
 
 
-/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+static int term_read_key(int* key) {
+    char seq[3];
+    int  ret;
+
+    if (term_read_byte(&seq[0], -1) != 0)
+        return 1;
+
+    /* Simple chars */
+    *key = (unsigned char)seq[0];
+    if (seq[0] != '\x1b')
+        return 0;
+
+    /* Escape sequences ("ESC [ x", "ESC [ n ~" or "ESC O x"). If the sequence doesn't
+       arrive (or is not recognized), the key is just ESC */
+    if ((ret = term_read_byte(&seq[0], RHD_TERM_ESC_TIMEOUT_MS)) != 0 ||
+        (ret = term_read_byte(&seq[1], RHD_TERM_ESC_TIMEOUT_MS)) != 0)
+        return ret == 1;
+
+    if (seq[0] == '[' && seq[1] >= '0' && seq[1] <= '9') {
+        if ((ret = term_read_byte(&seq[2], RHD_TERM_ESC_TIMEOUT_MS)) != 0)
+            return ret == 1;
+
+        /* Without a terminal the window is resized by the keys (then the next key is read) */
+        if (headless.is_enabled && seq[1] == '8' && seq[2] == ';') {
+            if (term_headless_resize() != 0)
+                return 1;
+            return term_read_key(key);
+        }
+
+        if (seq[2] == '~') {
+            switch (seq[1]) {
+                case '1':
+                case '7':
+                    *key = RHD_TERM_KEY_HOME;
+                    break;
+                case '4':
+                case '8':
+                    *key = RHD_TERM_KEY_END;
+                    break;
+                default:
+                    break;
+            }
+        }
+    } else if (seq[0] == '[' || seq[0] == 'O') {
+        switch (seq[1]) {
+            case 'A':
+                *key = RHD_TERM_KEY_UP;
+                break;
+            case 'B':
+                *key = RHD_TERM_KEY_DOWN;
+                break;
+            case 'C':
+                *key = RHD_TERM_KEY_RIGHT;
+                break;
+            case 'D':
+                *key = RHD_TERM_KEY_LEFT;
+                break;
+            case 'H':
+                *key = RHD_TERM_KEY_HOME;
+                break;
+            case 'F':
+                *key = RHD_TERM_KEY_END;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return 0;
+}
+
+
+static int term_headless_resize(void) {
+    unsigned int size[2];
+    size_t       i;
+    char         c;
+    int          ret;
+
+    /* "<rows> ; <cols> t" (both from 1 to RHD_TERM_HEADLESS_SIZE_MAX) */
+    for (i = 0; i < 2; i++) {
+        size[i] = 0;
+        while ((ret = term_read_byte(&c, RHD_TERM_ESC_TIMEOUT_MS)) == 0 && c >= '0' && c <= '9' &&
+               size[i] <= RHD_TERM_HEADLESS_SIZE_MAX)
+            size[i] = size[i] * 10 + (unsigned int)(c - '0');
+        if (ret != 0)
+            return ret == 1;
+        if (c != (i == 0 ? ';' : 't') || size[i] == 0 || size[i] > RHD_TERM_HEADLESS_SIZE_MAX)
+            return 0;
+    }
+
+    headless.rows = size[0];
+    headless.cols = size[1];
+    return sigwinch_process();
+}
+
+
+static int term_read_byte(char* c, const int timeout_ms) {
+    struct pollfd  fds[6 + 2 * RHD_TERM_PANES_MAX];
+    struct pollfd* pane_fds;
+    ssize_t        n_bytes_read;
+    size_t         i;
+    int            n_fds;
+    int            wait_ms;
+
+    fds[0].fd     = term.tty_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd     = sigwinch.pipe_fds[0];
+    fds[1].events = POLLIN;
+    fds[2].fd     = search_fd();  /* Ignored by poll() if -1 */
+    fds[2].events = POLLIN;
+    fds[3].fd     = diff_fd();    /* Ignored by poll() if -1 */
+    fds[3].events = POLLIN;
+    fds[4].fd     = entropy_fd(); /* Ignored by poll() if -1 */
+    fds[4].events = POLLIN;
+    fds[5].events = POLLOUT;
+
+    /* Each pane has the stream it navigates, and the file it follows (ignored by poll() if -1) */
+    pane_fds = &fds[6];
+    for (i = 0; i < term.n_panes; i++) {
+        pane_fds[2 * i].events     = POLLIN;
+        pane_fds[2 * i + 1].fd     = file_follow_fd(term.panes[i].file);
+        pane_fds[2 * i + 1].events = POLLIN;
+    }
+
+    /* Wait (blocking in poll()) for key press or SIGWINCH, and get char pressed */
+    for (;;) {
+        for (i = 0; i < term.n_panes; i++)
+            pane_fds[2 * i].fd = file_stream_fd(term.panes[i].file);  /* -1 once the whole stream is received */
+
+        /* Without a terminal every requested frame is rendered before reading the next key, so
+           that the frames don't depend on the timing of the keys */
+        if (headless.is_enabled && timeout_ms == -1 && render.is_pending && term_screen_refresh() != 0)
+            return 1;
+
+        /* While waiting for a new key, the requested frame is rendered if none arrives before it is
+           due, and the queued part of the last frame is written as soon as stdout accepts it */
+        wait_ms = timeout_ms;
+        if (timeout_ms == -1)
+            wait_ms = term_screen_delay();
+        fds[5].fd = render.n_sent < term.frame.len ? term.out_fd : -1;
+
+        if ((n_fds = poll(fds, (nfds_t)(6 + 2 * term.n_panes), wait_ms)) == -1) {
+            if (errno == EINTR)
+                continue;
+            error_queue("ERROR: Function poll() failed!");
+            return 1;
+        }
+        if (n_fds == 0 && timeout_ms != -1)
+            return 2;
+
+        if (fds[5].revents & (POLLOUT | POLLERR | POLLHUP)) {
+            if (term_screen_flush() != 0)
+                return 1;
+        }
+
+        /* Process SIGWINCH in the main loop, not in the signal handler */
+        if (fds[1].revents & POLLIN) {
+            if (sigwinch_process() != 0)
+                return 1;
+        }
+
+        /* Process progress (and end) of the background search, comparison, and entropy map */
+        if (fds[2].revents & POLLIN) {
+            if (term_search_process() != 0)
+                return 1;
+        }
+        if (fds[3].revents & POLLIN) {
+            if (term_diff_process() != 0)
+                return 1;
+        }
+        if (fds[4].revents & POLLIN) {
+            if (term_minimap_process() != 0)
+                return 1;
+        }
+
+        /* Process the new bytes of the streams (if navigating some), or of the followed files */
+        for (i = 0; i < term.n_panes; i++) {
+            if ((pane_fds[2 * i].revents & (POLLIN | POLLHUP | POLLERR)) || (pane_fds[2 * i + 1].revents & POLLIN)) {
+                if (term_stream_process(&term.panes[i]) != 0)
+                    return 1;
+            }
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            if ((n_bytes_read = read(term.tty_fd, c, 1)) == 1)
+                return 0;
+            if ((n_bytes_read == -1 && errno != EAGAIN && errno != EINTR) ||
+                (n_bytes_read == 0 && (fds[0].revents & POLLHUP))) {
+                error_queue("ERROR: Couldn't read keypress!");
+                return 1;
+            }
+        }
+
+        /* No key is waiting: render the requested frame, if it is due */
+        if (timeout_ms == -1 && term_screen_delay() == 0 && term_screen_refresh() != 0)
+            return 1;
+    }
+}
+
+
+/* OUTPUT */
+
+static void term_screen_request(void) {
+    render.is_pending = 1;
+}
+
+
+static int term_screen_delay(void) {
+    struct timespec now;
+    long int        elapsed_ms;
+
+    if (!render.is_pending || render.n_sent < term.frame.len)
+        return -1;
+
+    /* If the time can't be read, the frame is rendered right away */
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == -1)
+        return 0;
+    elapsed_ms = (long int)(now.tv_sec - render.last_time.tv_sec) * 1000 + (now.tv_nsec - render.last_time.tv_nsec) / 1000000;
+    if (elapsed_ms < 0 || elapsed_ms >= RHD_TERM_FRAME_MS)
+        return 0;
+
+    return (int)(RHD_TERM_FRAME_MS - elapsed_ms);
+}
+
+
+static int term_screen_refresh(void) {
+    abuf_t*         ab = &term.frame;
+    struct timespec start;
+    struct timespec end;
+
+    /* The frame buffer still holds the part of the last frame not written yet */
+    if (render.n_sent < ab->len) {
+        render.is_pending = 1;
+        return 0;
+    }
+    render.is_pending = 0;
+
+    /* If the time can't be read, the frame is reported as taking no time */
+    if (clock_gettime(CLOCK_MONOTONIC, &start) == -1)
+        start.tv_sec = start.tv_nsec = 0;
+    render.last_time = start;
+
+    /* Empty frame buffer (keeping its memory) */
+    ab_reset(ab);
+    render.n_sent = 0;
+
+    /* The offsets column widens as the files grow (while followed, or streamed) */
+    if (term_gutter_digits() != layout.gutter_digits && term_output_adjust_after_sigwinch() != 0)
+        return 1;
+
+    /* Initialize content of "ab" for screen refresh (only the rows that changed) */
+    if (term_screen_prepare_rows(ab) != 0)
+        return 1;
+
+    /* If nothing changed, there is nothing to write */
+    if (ab->len == 0)
+        return 0;
+
+    /* Initialize end of "ab" for screen refresh */
+    if (ab_append(ab, RHD_TERM_VT100_CUR_TOP_LEFT, sizeof(RHD_TERM_VT100_CUR_TOP_LEFT) - 1) == 1) {
+        error_queue("ERROR: Function ab_append() failed!");
+        return 1;
+    }
+
+    /* Write "ab" (actual screen refresh), queuing what stdout doesn't accept right away */
+    if (term_screen_flush() != 0)
+        return 1;
 
-/* EXIT CALLBACK */
+    /* Cost of the frame (shown by the next one, if the stats row is enabled) */
+    if (clock_gettime(CLOCK_MONOTONIC, &end) == -1)
+        end = start;
+    stats_view.frame_ns  = (unsigned long)(end.tv_sec - start.tv_sec) * 1000000000ul + (unsigned long)end.tv_nsec
+                           - (unsigned long)start.tv_nsec;
+    stats_view.frame_len = ab->len;
+    stats_add(RHD_STATS_FRAMES, 1);
+    stats_add(RHD_STATS_RENDER_NS, stats_view.frame_ns);
 
-static void at_exit_callback(void) {
-    /* Restore terminal initial state */
-    if (term_is_init == RHD_TERM_INIT_TRUE)
-        term_disable_raw_mode();
+    return 0;
 }
 
 
-/* SIGNAL HANDLER */
+static int term_screen_flush(void) {
+    ssize_t n_bytes_written;
 
-static void sigwinch_handler(int sig) {
-    switch (sig) {
-        case SIGWINCH:
-            /* Adjust output */
-            if (term_output_adjust_after_sigwinch() != 0) {
-                sigwinch.state = RHD_TERM_SIGWINCH_STATE_ERROR;
+    while (render.n_sent < term.frame.len) {
+        if ((n_bytes_written = write(term.out_fd, &term.frame.b[render.n_sent], term.frame.len - render.n_sent)) == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
                 break;
-            }
+            error_queue("ERROR: Function write() failed!");
+            return 1;
+        }
+        render.n_sent += (size_t)n_bytes_written;
+        stats_add(RHD_STATS_WRITES, 1);
+        stats_add(RHD_STATS_WRITTEN, (unsigned long)n_bytes_written);
+    }
 
-            /* Refresh screen (ONLY IF IN LOOP!) */
-            if (term_is_in_loop == RHD_TERM_LOOP_TRUE) {
-                if (term_screen_refresh() != 0) {
-                    sigwinch.state = RHD_TERM_SIGWINCH_STATE_ERROR;
-                    break;
-                }
-            }
+    return 0;
+}
 
-            sigwinch.state = RHD_TERM_SIGWINCH_STATE_OK;
-            break;
 
-        default:
-            break;
+static int term_screen_drain(void) {
+    struct pollfd fd;
+    int           ret;
+
+    ret       = 0;
+    fd.fd     = term.out_fd;
+    fd.events = POLLOUT;
+    while (ret == 0 && render.n_sent < term.frame.len) {
+        if (poll(&fd, 1, -1) == -1 && errno != EINTR) {
+            error_queue("ERROR: Function poll() failed!");
+            ret = 1;
+        } else {
+            ret = term_screen_flush();
+        }
+    }
+
+    /* (stdout is shared with the other programs using the terminal) */
+    if (render.is_nonblocking) {
+        if (fcntl(term.out_fd, F_SETFL, render.stdout_flags) == -1) {
+            error_queue("ERROR: Function fcntl() failed!");
+            ret = 1;
+        }
+        render.is_nonblocking = 0;
     }
+
+    return ret;
 }
 
 
-/* TERMINAL */
+static int term_screen_prepare_rows(abuf_t* ab) {
+    char                 seq[RHD_TERM_VT100_SEQ_MAX];
+    char                 offsets[RHD_TERM_PANES_MAX][RHD_TERM_GUTTER_DIGITS_MAX];
+    off_t                poss[RHD_TERM_PANES_MAX];
+    size_t               bytes[RHD_TERM_PANES_MAX];
+    const unsigned char* windows[RHD_TERM_PANES_MAX];
+    size_t               n_windows[RHD_TERM_PANES_MAX];
+    term_pane_t*         pane;
+    term_output_t*       output;
+    off_t                cursor_row;
+    off_t                pos;
+    size_t               active;
+    size_t               start;
+    size_t               n_styles;
+    size_t               n;
+    size_t               i;
+    unsigned int         y;
+
+    /* Get position of the first row of each pane */
+    for (i = 0; i < term.n_panes; i++) {
+        if ((poss[i] = file_tell(term.panes[i].file)) == -1) {
+            error_queue("ERROR: Couldn't get current position in file!");
+            return 1;
+        }
+        bytes[i] = 0;
 
-static int term_get_win_size(void) {
-    struct winsize ws;
+        /* (then the offset in the offsets column is just incremented by each row) */
+        offset_format_hex(offsets[i], poss[i], layout.gutter_digits);
+    }
 
-    /* Tries to use ioctl() with the TIOCGWINSZ request (inside sys/ioctl.h) to get terminal window size */
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1 || ws.ws_row == 0 || ws.ws_col == 0) {
-        error_queue("ERROR: Function ioctl() failed!");
-        return 1;
+    /* If the screen was not drawn yet, limit scrolling to the rows showing the file
+       (so that the status row doesn't move) */
+    if (shadow.state == RHD_TERM_SHADOW_STATE_INVALID && term.page_rows > 1) {
+        sprintf(seq, RHD_TERM_VT100_REGION_FMT, term.page_rows);
+        if (ab_append(ab, seq, strlen(seq)) == 1) {
+            error_queue("ERROR: Function ab_append() failed!");
+            return 1;
+        }
     }
 
-    term.screen_rows = ws.ws_row;
-    term.screen_cols = ws.ws_col;
+    /* Reuse the rows already on screen, if the pages just moved by some rows */
+    if (term_screen_scroll(ab, poss) != 0)
+        return 1;
 
-    return 0;
-}
+    /* The inspector is decoded only while it is shown */
+    active = (size_t)(term.pane - term.panes);
+    if (inspect_view.cols > 0 && term_inspect_prepare(poss[active]) != 0)
+        return 1;
+    if (minimap_view.cols > 0 && term_minimap_prepare(poss[active]) != 0)
+        return 1;
+    pos = inspect_view.cols > 0 ? inspect_view.cursor : poss[active];
 
+    /* Loop all rows of terminal showing the files */
+    for (y = 0; y < term.page_rows; y++) {
+        cursor_row = poss[active] + (off_t)bytes[active];
 
-/* OUTPUT */
+        /* In the diff view, the rows of both files are needed to format each of them */
+        for (i = 0; diff_view.is_enabled && i < term.n_panes; i++) {
+            n_windows[i] = file_read_window(term.panes[i].file, &windows[i], (size_t)term.panes[i].active_output->row_len);
+            bytes[i]    += n_windows[i];
+        }
 
-static int term_output_save(void) {
-    long int curr_pos;
+        /* Fill "term.row" buffer with characters read from the current row
+           of each file, with the correct mode ("read_file_func") */
+        ab_reset(&term.row);
+        for (i = 0; i < term.n_panes; i++) {
+            pane     = &term.panes[i];
+            output   = pane->active_output;
+            start    = term.row.len;
+            n_styles = 0;
+            if (pane->gutter_cols > 0 &&
+                (ab_append(&term.row, offsets[i], layout.gutter_digits) == 1 ||
+                 ab_append(&term.row, RHD_TERM_GUTTER_GAP, sizeof(RHD_TERM_GUTTER_GAP) - 1) == 1)) {
+                error_queue("ERROR: Function ab_append() failed!");
+                return 1;
+            }
+            if (!diff_view.is_enabled) {
+                n         = output->file_read_func(pane->file, &term.row, (size_t)output->row_len);
+                bytes[i] += n;
+            } else {
+                n = n_windows[i];
+                if (term_screen_append_diff(&term.row, output->id, windows[i], n_windows[i],
+                                            windows[1 - i], n_windows[1 - i], &n_styles) != 0)
+                    return 1;
+            }
 
-    /* Get current pos of active output */
-    if ((curr_pos = file_tell()) == -1) {
-        error_queue("ERROR: Couldn't get current position in file!");
-        return 1;
-    }
+            /* (rows past the end of the file have no offset) */
+            if (pane->gutter_cols > 0) {
+                if (n == 0)
+                    memset(&term.row.b[start], ' ', layout.gutter_digits);
+                offset_add_hex(offsets[i], layout.gutter_digits, output->row_len);
+            }
 
-    /* Save "curr_pos" inside active output */
-    term.active_output->pos = curr_pos;
+            /* (the cursor is shown only with the inspector, in the active pane) */
+            if (inspect_view.cols > 0 && i == active && inspect_view.cursor >= cursor_row &&
+                inspect_view.cursor < cursor_row + output->row_len &&
+                term_screen_mark_cursor(&term.row, start + pane->gutter_cols, (size_t)(inspect_view.cursor - cursor_row),
+                                        output->id, &n_styles) != 0)
+                return 1;
+            if (i == term.n_panes - 1 && inspect_view.cols == 0 && minimap_view.cols == 0)
+                break;
 
-    /* Make it so that RHD_TERM_OUTPUT_FORMHEX and RHD_TERM_OUTPUT_FORMCHAR share "pos" */
-    switch (term.active_output->id) {
-        case RHD_TERM_OUTPUT_FORMHEX:
-            output_formchar.pos = curr_pos;
-            break;
+            /* (padding the row of the pane to its width, before the separator) */
+            while (term.row.len - start - n_styles < pane->cols) {
+                if (ab_append(&term.row, " ", 1) == 1)
+                    return 1;
+            }
+            if (ab_append(&term.row, RHD_TERM_PANE_SEPARATOR, sizeof(RHD_TERM_PANE_SEPARATOR) - 1) == 1) {
+                error_queue("ERROR: Function ab_append() failed!");
+                return 1;
+            }
+        }
 
-        case RHD_TERM_OUTPUT_FORMCHAR:
-            output_formhex.pos = curr_pos;
-            break;
+        if (inspect_view.cols > 0) {
+            start = term.row.len;
+            if (term_screen_append_inspect(&term.row, y) != 0)
+                return 1;
 
-        case RHD_TERM_OUTPUT_CHAR:
-            break;
+            /* (padding the row of the inspector to its width, before the minimap) */
+            while (minimap_view.cols > 0 && term.row.len - start < inspect_view.cols) {
+                if (ab_append(&term.row, " ", 1) == 1)
+                    return 1;
+            }
+            if (minimap_view.cols > 0 &&
+                ab_append(&term.row, RHD_TERM_PANE_SEPARATOR, sizeof(RHD_TERM_PANE_SEPARATOR) - 1) == 1) {
+                error_queue("ERROR: Function ab_append() failed!");
+                return 1;
+            }
+        }
+        if (minimap_view.cols > 0 && term_screen_append_minimap(&term.row, y, pos) != 0)
+            return 1;
+        if (term_screen_put_row(ab, y) != 0)
+            return 1;
+    }
 
-        default:
-            error_queue("ERROR: Unrecognized output id!");
+    /* Stats row (if there is room for it, between the page and the status row) */
+    if (stats_view.is_enabled && term.page_rows + 1 < term.screen_rows) {
+        if (term_screen_prepare_stats(&term.row) != 0 || term_screen_put_row(ab, term.page_rows) != 0)
+            return 1;
+    }
+
+    /* Status row */
+    if (term.page_rows < term.screen_rows) {
+        if (term_screen_prepare_status(&term.row, pos) != 0 ||
+            term_screen_put_row(ab, term.screen_rows - 1) != 0)
+            return 1;
+    }
+
+    /* The shadow frame now matches the screen */
+    shadow.state = RHD_TERM_SHADOW_STATE_VALID;
+    for (i = 0; i < term.n_panes; i++) {
+        shadow.ids[i]  = term.panes[i].active_output->id;
+        shadow.poss[i] = poss[i];
+
+        /* Moves the file position indicator back to the beginning of the terminal page
+           (meaning where the file position indicator was before calling this function) */
+        if (file_move(term.panes[i].file, -1 * (off_t)bytes[i]) != 0) {
+            error_queue("ERROR: Couldn't save output!");
             return 1;
+        }
     }
 
     return 0;
 }
 
 
-static int term_output_change(const term_output_id_t output_id) {
-    /* Saves active output before changing it */
-    if (term_output_save() != 0) {
-        error_queue("ERROR: Couldn't save output!");
+static int term_screen_prepare_status(abuf_t* row, const off_t pos) {
+    char        info[5 * 64];
+    const char* texts[2];
+    off_t       file_len;
+    size_t      info_len;
+    size_t      len;
+    size_t      n;
+    size_t      i;
+
+    ab_reset(row);
+    if (ab_append(row, RHD_TERM_VT100_REVERSE, sizeof(RHD_TERM_VT100_REVERSE) - 1) == 1) {
+        error_queue("ERROR: Function ab_append() failed!");
         return 1;
     }
 
-    /* Changes active output */
-    switch (output_id) {
-        case RHD_TERM_OUTPUT_FORMHEX:
-            term.active_output = &output_formhex;
-            break;
-
-        case RHD_TERM_OUTPUT_FORMCHAR:
-            term.active_output = &output_formchar;
-            break;
-
-        case RHD_TERM_OUTPUT_CHAR:
-            term.active_output = &output_char;
-            break;
+    /* Text of the status row: the prompt if active, else the status message.
+       The information about the last search (and the active pane) is aligned to the right */
+    texts[0] = term.prompt_msg != NULL ? term.prompt_msg : term.status_msg;
+    texts[1] = term.prompt_msg != NULL ? term.prompt_buf : "";
+    term_screen_search_info(info);
+    term_screen_diff_info(info + strlen(info));
+    term_screen_minimap_info(info + strlen(info), pos);
+    term_screen_edit_info(info + strlen(info));
+    if (term.n_panes > 1)
+        sprintf(info + strlen(info), " file %lu/%lu ",
+                (unsigned long)(term.pane - term.panes) + 1, (unsigned long)term.n_panes);
+    if ((file_len = file_length(term.pane->file)) >= 0) {
+        strcat(info, " ");
+        term_format_offset(info + strlen(info), pos);
+        strcat(info, " of ");
+        term_format_offset(info + strlen(info), file_len);
+        if (file_len > 0)
+            sprintf(info + strlen(info), " (%u%%)", (unsigned int)(pos < file_len ? pos * 100 / file_len : 100));
+        strcat(info, " ");
+    }
+    info_len = strlen(info) < term.screen_cols ? strlen(info) : term.screen_cols;
+
+    /* (truncated to the terminal width, leaving room for the information) */
+    len = 0;
+    for (i = 0; i < 2; i++) {
+        n = strlen(texts[i]);
+        if (n > term.screen_cols - info_len - len)
+            n = term.screen_cols - info_len - len;
+        if (ab_append(row, texts[i], n) == 1)
+            return 1;
+        len += n;
+    }
 
-        default:
-            error_queue("ERROR: Unrecognized output id!");
+    /* Fill the rest of the row with (reversed) spaces */
+    for (; len < term.screen_cols - info_len; len++) {
+        if (ab_append(row, " ", 1) == 1)
             return 1;
     }
 
-    /* Move file to "pos" of new "active_output" */
-    if (file_seek_set(term.active_output->pos) == 1) {
-        error_queue("ERROR: Couldn't move file position indicator!");
+    if (ab_append(row, info, info_len) == 1 ||
+        ab_append(row, RHD_TERM_VT100_NORMAL, sizeof(RHD_TERM_VT100_NORMAL) - 1) == 1) {
+        error_queue("ERROR: Function ab_append() failed!");
         return 1;
     }
 
@@ -543,193 +3204,414 @@ static int term_output_change(const term_output_id_t output_id) {
 }
 
 
-static int term_output_adjust_after_sigwinch(void) {
-    /* Update terminal window size */
-    if (term_get_win_size() != 0) {
-        error_queue("ERROR: Couldn't get terminal window size!");
+static int term_screen_prepare_stats(abuf_t* row) {
+    char          stats[256];
+    unsigned long hits;
+    unsigned long lookups;
+    size_t        n;
+
+    /* The last frame (its render time in ms, with 2 decimals), then the counters since the start */
+    sprintf(stats, " frame %lu.%02lu ms %lu B | writes %lu (%lu KiB) | allocs %lu | reads %lu | seeks %lu | cache ",
+            stats_view.frame_ns / 1000000, stats_view.frame_ns / 10000 % 100, (unsigned long)stats_view.frame_len,
+            stats_get(RHD_STATS_WRITES), stats_get(RHD_STATS_WRITTEN) / 1024, stats_get(RHD_STATS_ALLOCS),
+            stats_get(RHD_STATS_READS), stats_get(RHD_STATS_SEEKS));
+
+    /* (the page cache is not used by mapped files) */
+    hits    = stats_get(RHD_STATS_CACHE_HITS);
+    lookups = hits + stats_get(RHD_STATS_CACHE_MISSES);
+    if (lookups > 0)
+        sprintf(stats + strlen(stats), "%lu%% hits ", hits * 100 / lookups);
+    else
+        strcat(stats, "unused ");
+
+    ab_reset(row);
+    n = strlen(stats) < term.screen_cols ? strlen(stats) : term.screen_cols;
+    if (ab_append(row, stats, n) == 1) {
+        error_queue("ERROR: Function ab_append() failed!");
         return 1;
     }
 
-    /* Saves output */
-    if (term_output_save() != 0) {
-        error_queue("ERROR: Couldn't save output!");
-        return 1;
+    return 0;
+}
+
+
+static void term_screen_search_info(char* info) {
+    off_t  scanned;
+    off_t  total;
+    size_t n_hits;
+    size_t i;
+
+    info[0] = '\0';
+    if (term_search.len == 0)
+        return;
+
+    /* "hit <index> of <count>" once the search is done, else its progress */
+    if ((n_hits = search_count()) != (size_t)-1) {
+        if (term_search.last_hit >= 0 && (i = search_index(term_search.last_hit)) != (size_t)-1)
+            sprintf(info, " hit %lu of %lu ", (unsigned long)i + 1, (unsigned long)n_hits);
+        else
+            sprintf(info, " %lu hits ", (unsigned long)n_hits);
+    } else if (search_poll(&scanned, &total) == RHD_SEARCH_STATE_RUNNING) {
+        sprintf(info, " searching %u%% ", (unsigned int)(total > 0 ? scanned * 100 / total : 0));
     }
+}
 
-    /* Update outputs "row_len" (meaning the amount of bytes that appears in a row in the term) */
-    output_formhex.row_len  = term.screen_cols / 3;
-    output_formchar.row_len = term.screen_cols / 3;
-    output_char.row_len     = term.screen_cols;
 
-    /* Update outputs "pos" (adjusting them based on the new "row_len") */
-    output_formhex.pos  = output_formhex.pos  - (output_formhex.pos  % output_formhex.row_len );
-    output_formchar.pos = output_formchar.pos - (output_formchar.pos % output_formchar.row_len);
-    output_char.pos     = output_char.pos     - (output_char.pos     % output_char.row_len    );
+static void term_screen_diff_info(char* info) {
+    size_t compared;
+    size_t different;
+    size_t total;
 
-    /* Move file to "pos" of "active_output" */
-    if (file_seek_set(term.active_output->pos) != 0) {
-        error_queue("ERROR: Couldn't move file position indicator!");
-        return 1;
-    }
+    info[0] = '\0';
+    if (!diff_view.is_enabled)
+        return;
 
-    return 0;
+    /* "<count> of <total> MiB differ" once all blocks are compared, else its progress */
+    switch (diff_poll(&compared, &different, &total)) {
+        case RHD_DIFF_STATE_DONE:
+            if (different == 0)
+                strcpy(info, " identical ");
+            else
+                sprintf(info, " %lu of %lu MiB differ ", (unsigned long)different, (unsigned long)total);
+            break;
+        case RHD_DIFF_STATE_RUNNING:
+            sprintf(info, " comparing %u%% ", (unsigned int)(total > 0 ? compared * 100 / total : 0));
+            break;
+        default:
+            break;
+    }
 }
 
 
-/* INPUT */
+static void term_screen_minimap_info(char* info, const off_t pos) {
+    entropy_bucket_t bucket;
+    size_t           scanned;
+    size_t           total;
 
-static int term_process_keypress(void) {
-    long int     row_len;
-    char         c;
-    unsigned int i;
+    info[0] = '\0';
+    if (minimap_view.cols == 0 || minimap_view.pane != term.pane)
+        return;
 
-    /* Read key */
-    if (term_read_key(&c) != 0)
-        return RHD_TERM_KEYPRESS_ERROR;
+    /* The entropy of the bytes around the position, then the progress (while scanning) */
+    if (entropy_bucket(entropy_bucket_of(pos), &bucket) == 0 && bucket.is_done) {
+        if (bucket.is_zero)
+            strcpy(info, " zeros ");
+        else
+            sprintf(info, " entropy %u.%02u ", bucket.entropy / 100, bucket.entropy % 100);
+    }
+    if (entropy_poll(&scanned, &total) == RHD_ENTROPY_STATE_RUNNING)
+        sprintf(info + strlen(info), " mapping %u%% ", (unsigned int)(total > 0 ? scanned * 100 / total : 0));
+}
 
-    /* Saving the "row_len" needs to happen after term_read_key().
-       This is because term_read_key() is where the loop interrupts to wait for stdin.
-       While it is interrupted, if the terminal window is resized, the signal SIGWINCH
-       will be handled, possibly modifing all outputs' "row_len". But when the execution
-       resumes, the old "row_len" will be used. */
-    row_len = term.active_output->row_len;
 
-    /* Handle keypress */
-    switch (c) {
-        case RHD_TERM_CTRL_KEY('q'):
-            return RHD_TERM_KEYPRESS_QUIT;
+static void term_screen_edit_info(char* info) {
+    info[0] = '\0';
+    if (edit_view.is_editing)
+        strcpy(info, edit_view.low_pos == -1 ? " EDIT " : " EDIT (low digit) ");
+    if (file_is_modified(term.pane->file))
+        strcat(info, " modified ");
+}
 
-        case 'w':
-        case 'W':
-            if (file_move(-1 * row_len) != 0)
-                return RHD_TERM_KEYPRESS_ERROR;
-            return RHD_TERM_KEYPRESS_ACT;
 
-        case 's':
-        case 'S':
-            if (file_move(row_len) != 0)
-                return RHD_TERM_KEYPRESS_ERROR;
-            return RHD_TERM_KEYPRESS_ACT;
+static int term_screen_append_diff(abuf_t* ab, const term_output_id_t output_id,
+                                   const unsigned char* bytes, const size_t n,
+                                   const unsigned char* other, const size_t n_other, size_t* n_styles) {
+    size_t i;
+    size_t j;
+    int    is_different;
+    int    ret;
 
-        case 'a':
-        case 'A':
-            if (file_move(-1 * (long int)term.screen_rows * row_len) != 0)
-                return RHD_TERM_KEYPRESS_ERROR;
-            return RHD_TERM_KEYPRESS_ACT;
+    /* Format the bytes in runs that are all equal (or all different) to the other file,
+       reversing the colors of the different ones */
+    for (i = 0; i < n; i = j) {
+        is_different = i >= n_other || bytes[i] != other[i];
+        for (j = i + 1; j < n && (j >= n_other || bytes[j] != other[j]) == is_different; j++)
+            ;
 
-        case 'd':
-        case 'D':
-            for (i = 0; i < term.screen_rows; i++) {
-                if (file_move(row_len) != 0)
-                    return RHD_TERM_KEYPRESS_ERROR;
-            }
-            return RHD_TERM_KEYPRESS_ACT;
+        if (i > 0 && output_id != RHD_TERM_OUTPUT_CHAR && ab_append(ab, " ", 1) == 1)
+            return 1;
+        if (is_different) {
+            if (ab_append(ab, RHD_TERM_VT100_REVERSE, sizeof(RHD_TERM_VT100_REVERSE) - 1) == 1)
+                return 1;
+            *n_styles += sizeof(RHD_TERM_VT100_REVERSE) - 1 + sizeof(RHD_TERM_VT100_NORMAL) - 1;
+        }
 
-        case 'h':
-        case 'H':
-            if (term.active_output->id == RHD_TERM_OUTPUT_FORMHEX)
-                return RHD_TERM_KEYPRESS_IGNORE;
-            if (term_output_change(RHD_TERM_OUTPUT_FORMHEX) != 0)
-                return RHD_TERM_KEYPRESS_ERROR;
-            return RHD_TERM_KEYPRESS_ACT;
+        switch (output_id) {
+            case RHD_TERM_OUTPUT_FORMHEX:
+                ret = format_append_hexs(ab, &bytes[i], j - i, RHD_FORMAT_CASE_UPPER);
+                break;
+            case RHD_TERM_OUTPUT_FORMCHAR:
+                ret = format_append_formatted_chars(ab, &bytes[i], j - i);
+                break;
+            default:
+                ret = format_append_chars(ab, &bytes[i], j - i);
+                break;
+        }
+        if (ret != 0 ||
+            (is_different && ab_append(ab, RHD_TERM_VT100_NORMAL, sizeof(RHD_TERM_VT100_NORMAL) - 1) == 1)) {
+            error_queue("ERROR: Function ab_append() failed!");
+            return 1;
+        }
+    }
 
-        case 'c':
-        case 'C':
-            if (term.active_output->id == RHD_TERM_OUTPUT_FORMCHAR)
-                return RHD_TERM_KEYPRESS_IGNORE;
-            if (term_output_change(RHD_TERM_OUTPUT_FORMCHAR) != 0)
-                return RHD_TERM_KEYPRESS_ERROR;
-            return RHD_TERM_KEYPRESS_ACT;
+    return 0;
+}
 
-        case RHD_TERM_CTRL_KEY('c'):
-            if (term.active_output->id == RHD_TERM_OUTPUT_CHAR)
-                return RHD_TERM_KEYPRESS_IGNORE;
-            if (term_output_change(RHD_TERM_OUTPUT_CHAR) != 0)
-                return RHD_TERM_KEYPRESS_ERROR;
-            return RHD_TERM_KEYPRESS_ACT;
 
-        default:
-            return RHD_TERM_KEYPRESS_IGNORE;
+static int term_screen_append_inspect(abuf_t* row, const unsigned int y) {
+    char         line[RHD_INSPECT_LINE_MAX + RHD_TERM_INSPECT_COLS];
+    size_t       first;
+    size_t       i;
+    unsigned int n_rows;
+    size_t       n;
+
+    /* The values at the cursor, then (after an empty row) the format and the template fields */
+    line[0] = '\0';
+    if (y < RHD_INSPECT_LINES) {
+        sprintf(line, " %s", inspect_view.lines[y]);
+    } else if (y == RHD_INSPECT_LINES + 1 && inspect_view.template != NULL) {
+        sprintf(line, " %s%s", template_format(inspect_view.template), inspect_view.is_template_hidden ? " (hidden)" : "");
+    } else if (y > RHD_INSPECT_LINES + 1 && inspect_view.template != NULL && !inspect_view.is_template_hidden) {
+        /* The fields listed start from the one at the cursor (or the next one), unless
+           that would leave some rows empty */
+        n_rows = term.page_rows - (RHD_INSPECT_LINES + 2);
+        for (first = 0; first < inspect_view.n_fields &&
+                        inspect_view.fields[first].pos + inspect_view.fields[first].len <= inspect_view.cursor; first++)
+            ;
+        if (inspect_view.n_fields - first < n_rows)
+            first = inspect_view.n_fields > n_rows ? inspect_view.n_fields - n_rows : 0;
+        if ((i = first + (y - (RHD_INSPECT_LINES + 2))) < inspect_view.n_fields)
+            sprintf(line, "%c%s", inspect_view.fields[i].pos <= inspect_view.cursor &&
+                                  inspect_view.cursor < inspect_view.fields[i].pos + inspect_view.fields[i].len ? '>' : ' ',
+                    inspect_view.field_texts[i]);
     }
-}
 
+    n = strlen(line) < inspect_view.cols ? strlen(line) : inspect_view.cols;
+    if (ab_append(row, line, n) == 1) {
+        error_queue("ERROR: Function ab_append() failed!");
+        return 1;
+    }
+
+    return 0;
+}
 
-static int term_read_key(char *c) {
-    ssize_t n_bytes_read;
 
-    /* Wait for key press, and get char pressed */
-    while ((n_bytes_read = read(STDIN_FILENO, c, 1)) != 1) {
-        if (n_bytes_read == -1 && errno != EAGAIN) {
-            error_queue("ERROR: Couldn't read keypress!");
-            return 1;
+static int term_screen_append_minimap(abuf_t* row, const unsigned int y, const off_t pos) {
+    size_t n;
+    size_t first;
+    size_t last;
+    size_t b;
+    int    level;
+    int    max;
+    int    is_zero;
+    int    is_mapped;
+    int    is_here;
+    char   c;
+
+    /* Each row of the minimap covers the same share of the buckets (a bucket can be on more rows,
+       if there are fewer buckets than rows) */
+    c       = RHD_TERM_MINIMAP_PENDING;
+    is_here = 0;
+    if ((n = entropy_buckets()) > 0 && minimap_view.pane == term.pane) {
+        first = (size_t)y * n / term.page_rows;
+        last  = ((size_t)y + 1) * n / term.page_rows;
+        if (last <= first)
+            last = first + 1;
+
+        /* (the row shows its most random bucket, so that small random regions are not hidden,
+           or a zero fill if all of its buckets are zero fills) */
+        max       = 0;
+        is_zero   = 1;
+        is_mapped = 1;
+        for (b = first; b < last && is_mapped; b++) {
+            if ((level = term_minimap_level(b)) == -1) {
+                is_mapped = 0;
+            } else if (level != 9) {
+                is_zero = 0;
+                max     = level > max ? level : max;
+            }
         }
+        if (is_mapped)
+            c = is_zero ? RHD_TERM_MINIMAP_ZERO : RHD_TERM_MINIMAP_RAMP[max];
+        b       = entropy_bucket_of(pos);
+        is_here = b >= first && b < last;
+    }
+
+    if ((is_here && ab_append(row, RHD_TERM_VT100_REVERSE, sizeof(RHD_TERM_VT100_REVERSE) - 1) == 1) ||
+        ab_append(row, &c, 1) == 1 ||
+        (is_here && ab_append(row, RHD_TERM_VT100_NORMAL, sizeof(RHD_TERM_VT100_NORMAL) - 1) == 1)) {
+        error_queue("ERROR: Function ab_append() failed!");
+        return 1;
     }
 
     return 0;
 }
 
 
-/* OUTPUT */
+static int term_screen_mark_cursor(abuf_t* row, const size_t start, const size_t k,
+                                   const term_output_id_t output_id, size_t* n_styles) {
+    const size_t on_len  = sizeof(RHD_TERM_VT100_UNDERLINE) - 1;
+    const size_t off_len = sizeof(RHD_TERM_VT100_UNDERLINE_NO) - 1;
+    size_t       at;
+    size_t       width;
+    size_t       begin;
+    size_t       end;
+    size_t       i;
 
-static int term_screen_refresh(void) {
-    abuf_t ab = ABUF_INIT;
+    /* Chars of the byte (see file_append_formatted_hexs() and the others) */
+    switch (output_id) {
+        case RHD_TERM_OUTPUT_FORMHEX:
+            at    = 3 * k;
+            width = 2;
+            break;
+        case RHD_TERM_OUTPUT_FORMCHAR:
+            at    = 3 * k + 1;
+            width = 1;
+            break;
+        default:
+            at    = k;
+            width = 1;
+            break;
+    }
 
-    /* Initialize start of "ab" for screen refresh */
-    if (ab_append(&ab, RHD_TERM_VT100_CUR_TOP_LEFT, sizeof(RHD_TERM_VT100_CUR_TOP_LEFT) - 1) == 1) {
-        error_queue("ERROR: Function ab_append() failed!");
+    /* Find them, skipping the sequences in between (so that the underline starts after them,
+       and ends before the next ones) */
+    begin = start;
+    end   = start;
+    for (i = 0; i < at + width; i++) {
+        while (end < row->len && row->b[end] == '\x1b') {
+            while (end < row->len && row->b[end] != 'm')
+                end++;
+            end++;
+        }
+        if (i == at)
+            begin = end;
+        end++;
+    }
+    if (end > row->len)
+        return 0;
+
+    /* Insert the sequences (the one after the chars first, so that "begin" stays valid) */
+    if (ab_extend(row, on_len + off_len) == NULL) {
+        error_queue("ERROR: Function ab_extend() failed!");
         return 1;
     }
+    memmove(&row->b[end + off_len], &row->b[end], row->len - end);
+    memcpy(&row->b[end], RHD_TERM_VT100_UNDERLINE_NO, off_len);
+    memmove(&row->b[begin + on_len], &row->b[begin], row->len + off_len - begin);
+    memcpy(&row->b[begin], RHD_TERM_VT100_UNDERLINE, on_len);
+    row->len  += on_len + off_len;
+    *n_styles += on_len + off_len;
+
+    return 0;
+}
 
-    /* Initialize content of "ab" for screen refresh */
-    term_screen_prepare_rows(&ab);
 
-    /* Initialize end of "ab" for screen refresh */
-    if (ab_append(&ab, RHD_TERM_VT100_CUR_TOP_LEFT, sizeof(RHD_TERM_VT100_CUR_TOP_LEFT) - 1) == 1) {
+static int term_screen_put_row(abuf_t* ab, const unsigned int y) {
+    char  seq[RHD_TERM_VT100_SEQ_MAX];
+    char* shadow_row;
+
+    /* If the row on screen is already the same, skip it */
+    shadow_row = &shadow.rows[y * shadow.stride];
+    if (shadow.state == RHD_TERM_SHADOW_STATE_VALID && shadow.lens[y] == term.row.len &&
+        memcmp(shadow_row, term.row.b, term.row.len) == 0)
+        return 0;
+
+    /* Move cursor to the start of the row, then add the row and erase the rest of the line */
+    sprintf(seq, RHD_TERM_VT100_CUR_ROW_FMT, y + 1);
+    if (ab_append(ab, seq, strlen(seq)) == 1 ||
+        ab_append(ab, term.row.b, term.row.len) == 1 ||
+        ab_append(ab, RHD_TERM_VT100_ERASE_LINE, sizeof(RHD_TERM_VT100_ERASE_LINE) - 1) == 1) {
         error_queue("ERROR: Function ab_append() failed!");
         return 1;
     }
 
-    /* Write "ab" (actual screen refresh) */
-    if (write(STDOUT_FILENO, ab.b, ab.len) == -1) {
-        error_queue("ERROR: Function write() failed!");
-        return 1;
+    /* Save the row in the shadow frame (rows that don't fit will never be equal) */
+    if (term.row.len <= shadow.stride) {
+        memcpy(shadow_row, term.row.b, term.row.len);
+        shadow.lens[y] = term.row.len;
+    } else {
+        shadow.lens[y] = (size_t)-1;
     }
 
-    ab_free(&ab);
+    return 0;
+}
+
+
+static int term_shadow_resize(void) {
+    char*   new_rows;
+    size_t* new_lens;
+
+    shadow.state = RHD_TERM_SHADOW_STATE_INVALID;
+
+    /* Reallocate shadow rows (each one as long as the longest row) */
+    if ((new_rows = realloc(shadow.rows, term.screen_rows * RHD_TERM_ROW_CAP(term.screen_cols))) == NULL)
+        return 1;
+    shadow.rows = new_rows;
+    if ((new_lens = realloc(shadow.lens, term.screen_rows * sizeof(*shadow.lens))) == NULL)
+        return 1;
+    shadow.lens   = new_lens;
+    shadow.stride = RHD_TERM_ROW_CAP(term.screen_cols);
 
     return 0;
 }
 
 
-static int term_screen_prepare_rows(abuf_t* ab) {
-    size_t       bytes;
-    unsigned int y;
+static int term_screen_scroll(abuf_t* ab, const off_t* poss) {
+    char           seq[RHD_TERM_VT100_SEQ_MAX];
+    term_output_t* output;
+    off_t          delta;
+    int            is_up;
+    unsigned int   n;
+    unsigned int   y;
+    size_t         i;
 
-    /* Loop all rows of terminal */
-    bytes = 0;
-    for (y = 0; y < term.screen_rows; y++) {
+    if (shadow.state == RHD_TERM_SHADOW_STATE_INVALID)
+        return 0;
 
-        /* Fill "ab" buffer with characters read from the current row
-           of the file, with the correct mode ("read_file_func") */
-        bytes += term.active_output->file_read_func(ab, term.active_output->row_len);
+    /* The rows on screen can be reused only if each pane was drawn with the same output,
+       and moved by the same amount of rows (less than a page) in the same direction */
+    n     = 0;
+    is_up = 0;
+    for (i = 0; i < term.n_panes; i++) {
+        output = term.panes[i].active_output;
+        if (shadow.ids[i] != output->id)
+            return 0;
+        delta = poss[i] > shadow.poss[i] ? poss[i] - shadow.poss[i] : shadow.poss[i] - poss[i];
+        if (delta % output->row_len != 0 || delta / output->row_len >= term.page_rows)
+            return 0;
+        if (i == 0) {
+            n     = (unsigned int)(delta / output->row_len);
+            is_up = poss[i] > shadow.poss[i];
+        } else if (n != (unsigned int)(delta / output->row_len) || (n != 0 && is_up != (poss[i] > shadow.poss[i]))) {
+            return 0;
+        }
+    }
+    if (n == 0)
+        return 0;
 
-        /* Add newline at the end, except for last row */
-        if (ab_append(ab, RHD_TERM_VT100_ERASE_LINE, sizeof(RHD_TERM_VT100_ERASE_LINE) - 1) == 1) {
-            error_queue("ERROR: Function ab_append() failed!");
-            return 1;
+    if (is_up) {
+        /* Scroll up (the content moves up, and the bottom "n" rows become empty) */
+        sprintf(seq, RHD_TERM_VT100_SCROLL_UP_FMT, n);
+        for (y = 0; y + n < term.page_rows; y++) {
+            memcpy(&shadow.rows[y * shadow.stride], &shadow.rows[(y + n) * shadow.stride], shadow.stride);
+            shadow.lens[y] = shadow.lens[y + n];
         }
-        if (y < term.screen_rows - 1) {
-            if (ab_append(ab, "\r\n", 2) == 1) {
-                error_queue("ERROR: Function ab_append() failed!");
-                return 1;
-            }
+        for (; y < term.page_rows; y++)
+            shadow.lens[y] = 0;
+    } else {
+        /* Scroll down (the content moves down, and the top "n" rows become empty) */
+        sprintf(seq, RHD_TERM_VT100_SCROLL_DN_FMT, n);
+        for (y = term.page_rows; y-- > n;) {
+            memcpy(&shadow.rows[y * shadow.stride], &shadow.rows[(y - n) * shadow.stride], shadow.stride);
+            shadow.lens[y] = shadow.lens[y - n];
         }
+        for (y = 0; y < n; y++)
+            shadow.lens[y] = 0;
     }
 
-    /* Moves the file position indicator back to the beginning of the terminal page
-       (meaning where the file position indicator was before calling this function) */
-    if (file_move(-1 * ((long int)bytes)) != 0) {  /* DANGEROUS: converting size_t to long int */
-        error_queue("ERROR: Couldn't save output!");
+    if (ab_append(ab, seq, strlen(seq)) == 1) {
+        error_queue("ERROR: Function ab_append() failed!");
         return 1;
     }
 
@@ -739,9 +3621,10 @@ static int term_screen_prepare_rows(abuf_t* ab) {
 
 static int term_screen_clear(void) {
     /* Clear screen */
-    if (write(STDOUT_FILENO, RHD_TERM_VT100_ERASE_SCREEN, sizeof(RHD_TERM_VT100_ERASE_SCREEN) - 1) == -1) {
+    if (write(term.out_fd, RHD_TERM_VT100_ERASE_SCREEN, sizeof(RHD_TERM_VT100_ERASE_SCREEN) - 1) == -1) {
         error_queue("ERROR: Function write() failed!");
         return 1;
     }
+    shadow.state = RHD_TERM_SHADOW_STATE_INVALID;
     return 0;
 }
@@ -0,0 +1,181 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file rawhexdump.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for pthreads) */
+
+/* C89 standard */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "dump.h"
+#include "file.h"
+#include "format.h"
+
+#include "rawhexdump.h"
+
+
+/* Amount of bytes read from the file at once (must be a multiple of RHD_DUMP_ROW_LEN), in a buffer
+   on the stack of the calling thread (unless the file is memory-mapped, then it is viewed directly) */
+#define RHD_CHUNK_LEN (RHD_DUMP_ROW_LEN * 256)
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Struct containing a file open for dumping (only read with file_read_at(), that doesn't use
+ * the file position indicator, so that the handle can be shared by multiple threads)
+ */
+struct rhd_dump_tag {
+    rhd_file_t* file;
+    off_t       len;
+};
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Makes format_init() be called only once, before formatting from any thread
+ */
+static pthread_once_t format_once = PTHREAD_ONCE_INIT;
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int rhd_dump_open(rhd_dump_t** dump, const char* filename) {
+    rhd_dump_t* d;
+
+    *dump = NULL;
+    if (pthread_once(&format_once, format_init) != 0)
+        return 1;
+
+    /* The standard input is never used (file_open() would read it for RHD_FILE_STDIN) */
+    if (strcmp(filename, RHD_FILE_STDIN) == 0)
+        return 2;
+
+    if ((d = malloc(sizeof(*d))) == NULL)
+        return 1;
+    if (file_open_plain(&d->file, filename, "rb") != 0) {
+        free(d);
+        return 1;
+    }
+    if ((d->len = file_length(d->file)) < 0) {
+        file_close(d->file);
+        free(d);
+        return 2;
+    }
+
+    *dump = d;
+    return 0;
+}
+
+
+int rhd_dump_close(rhd_dump_t* dump) {
+    int ret;
+
+    ret = file_close(dump->file);
+    free(dump);
+
+    return ret;
+}
+
+
+off_t rhd_dump_length(rhd_dump_t* dump) {
+    return dump->len;
+}
+
+
+size_t rhd_dump_bound(const size_t length) {
+    /* The last row only contains the offset of the end of the dump */
+    return RHD_DUMP_ROWS_MAX(length) + RHD_DUMP_ROW_MAX;
+}
+
+
+int rhd_dump_format(rhd_dump_t* dump, const off_t offset, const off_t length, char* out, const size_t out_len, size_t* n_chars) {
+    unsigned char        chunk[RHD_CHUNK_LEN];
+    const unsigned char* view;
+    dump_squeeze_t       squeeze;
+    off_t                pos;
+    off_t                start;
+    off_t                end;
+    size_t               len;
+    size_t               n_bytes_read;
+
+    *n_chars = 0;
+    if (offset < 0)
+        return 2;
+    start = offset < dump->len ? offset : dump->len;
+    end   = length >= 0 && length < dump->len - start ? start + length : dump->len;
+    if (out_len < rhd_dump_bound((size_t)(end - start)))
+        return 1;
+
+    /* Dump rows, chunk by chunk (the squeezed runs of identical rows go on between chunks) */
+    squeeze.has_prev     = 0;
+    squeeze.is_squeezing = 0;
+    for (pos = start; pos < end; pos += (off_t)n_bytes_read) {
+        len = end - pos < (off_t)RHD_CHUNK_LEN ? (size_t)(end - pos) : RHD_CHUNK_LEN;
+        if ((n_bytes_read = file_read_at(dump->file, &view, chunk, pos, len)) == (size_t)-1)
+            return 3;
+        if (n_bytes_read == 0)
+            break;
+        *n_chars += dump_format_rows(&out[*n_chars], pos, view, n_bytes_read, &squeeze);
+    }
+
+    /* (like "hexdump -C", the offset of the end is shown also when nothing was dumped, unless it is 0) */
+    if (pos > 0) {
+        *n_chars += dump_format_offset(&out[*n_chars], pos);
+        out[(*n_chars)++] = '\n';
+    }
+
+    return 0;
+}
+
+
+int rhd_format(const unsigned char* data, const size_t n, const off_t offset, char* out, const size_t out_len, size_t* n_chars) {
+    dump_squeeze_t squeeze;
+
+    *n_chars = 0;
+    if (offset < 0)
+        return 2;
+    if (out_len < rhd_dump_bound(n))
+        return 1;
+    if (pthread_once(&format_once, format_init) != 0)
+        return 1;
+
+    squeeze.has_prev     = 0;
+    squeeze.is_squeezing = 0;
+    *n_chars = dump_format_rows(out, offset, data, n, &squeeze);
+    if (offset + (off_t)n > 0) {
+        *n_chars += dump_format_offset(&out[*n_chars], offset + (off_t)n);
+        out[(*n_chars)++] = '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,887 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file search.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for pthreads, pipe, fcntl and fstat) */
+
+/* C89 standard */
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "hits.h"
+#include "pool.h"
+
+#include "search.h"
+
+
+/* SIMD kernels are picked at runtime on x86 (GCC/Clang) */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RHD_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+/* Bytes of the file scanned by each task of the pool (consecutive chunks overlap by the needle length - 1) */
+#define RHD_SEARCH_CHUNK_LEN ((size_t)1 << 22)
+
+/* Bytes scanned between two progress notifications */
+#define RHD_SEARCH_PROGRESS_LEN ((off_t)1 << 26)
+
+/* Files shorter than this are searched again, instead of saving their index to a sidecar file */
+#define RHD_SEARCH_INDEX_MIN ((off_t)1 << 24)
+
+/* First bytes of the content of a sidecar file */
+#define RHD_SEARCH_INDEX_MAGIC "RHDIDX1\n"
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Function pointer type shared by all search kernels
+ */
+typedef const unsigned char* (*search_kernel_t)(const unsigned char*, const size_t, const unsigned char*, const size_t);
+
+/**
+ * Struct containing the hits found inside a chunk
+ */
+typedef struct search_chunk_tag {
+    off_t* hits;
+    size_t n_hits;
+    int    is_done;
+} search_chunk_t;
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Selects the fastest search kernel supported by the running CPU
+ */
+static void search_select_kernel(void);
+
+/**
+ * Resolver used before search_select_kernel() is called: selects the kernel and then searches
+ */
+static const unsigned char* search_memmem_resolve(const unsigned char* hay, const size_t hay_len,
+                                                  const unsigned char* needle, const size_t needle_len);
+
+/**
+ * Scalar kernel (memchr() for the first byte, then memcmp()), also used for the tails of SIMD kernels
+ */
+static const unsigned char* search_memmem_scalar(const unsigned char* hay, const size_t hay_len,
+                                                 const unsigned char* needle, const size_t needle_len);
+
+#if defined(RHD_SEARCH_X86)
+/**
+ * SSE2 (16 starts per step) and AVX2 (32 starts per step) kernels: the first and the last byte of
+ * the needle are compared with all starts at once, and only the starts matching both get memcmp()
+ */
+static const unsigned char* search_memmem_sse2(const unsigned char* hay, const size_t hay_len,
+                                               const unsigned char* needle, const size_t needle_len);
+static const unsigned char* search_memmem_avx2(const unsigned char* hay, const size_t hay_len,
+                                               const unsigned char* needle, const size_t needle_len);
+#endif
+
+/**
+ * Task searching a chunk of the file (run by the pool)
+ */
+static void search_chunk(void* ctx, const size_t task, const size_t worker);
+
+/**
+ * Appends "hit" to the "n_hits" hits of "hits" (of capacity "cap"), growing it geometrically.
+ * If successful returns 0, else 1.
+ */
+static int search_hits_append(off_t** hits, size_t* n_hits, size_t* cap, const off_t hit);
+
+/**
+ * Merges the hits of all chunks into a single ordered list (called when all chunks are done).
+ * If successful returns 0, else 1.
+ */
+static int search_merge(void);
+
+/**
+ * Searches the ordered "hits" (of "n_hits" hits) for the first hit starting at or after "from",
+ * or the last one starting at or before "from" (depending on "dir").
+ * If found returns its index, else "n_hits".
+ */
+static size_t search_lookup(const off_t* hits, const size_t n_hits, const off_t from, const search_dir_t dir);
+
+/**
+ * Writes into "path" the path of the sidecar file holding the index of the current needle
+ * inside the file (of status "st"), creating its directory if needed.
+ * If successful returns 0, else 1.
+ */
+static int search_index_path(char* path, const struct stat* st);
+
+/**
+ * Writes (or checks, if "is_reading") the key of the sidecar file of the current needle.
+ * If successful (and matching) returns 0, else 1.
+ */
+static int search_index_key(FILE* f, const struct stat* st, const int is_reading);
+
+/**
+ * Loads the hits of the current needle from its sidecar file (if any).
+ * If successful returns 0, else 1.
+ */
+static int search_index_load(void);
+
+/**
+ * Saves the hits of the current needle to its sidecar file.
+ * If successful returns 0, else 1.
+ */
+static int search_index_save(void);
+
+/**
+ * Makes search_fd() readable
+ */
+static void search_notify(void);
+
+/**
+ * Cancels the background search (if any), waits for it, and frees its hits
+ */
+static void search_join(void);
+
+/**
+ * Returns the value of hexadecimal digit "c"
+ */
+static unsigned char search_hex_value(const char c);
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Selected search kernel
+ */
+static search_kernel_t search_kernel = search_memmem_resolve;
+
+/**
+ * Mutex protecting the fields of "search" shared with the background threads
+ */
+static pthread_mutex_t search_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Struct containing the background search
+ */
+static struct search_tag {
+    pool_t          pool;
+    int             is_running;    /* 1 if "pool" was started and not joined yet */
+    int             is_pipe_open;
+    int             pipe_fds[2];   /* The background threads write to [1], search_fd() is [0] */
+    unsigned char   needle[RHD_SEARCH_NEEDLE_MAX];
+    size_t          needle_len;
+    rhd_file_t*     file;          /* File being searched */
+    off_t           file_len;
+    size_t          n_chunks;
+    size_t          first_chunk;   /* Chunk searched first (the tasks of the pool wrap around from it) */
+    unsigned char*  bufs;          /* Chunk buffer of each thread (used when the file is not memory-mapped) */
+
+    /* Shared with the background threads (protected by "search_lock") */
+    search_state_t  state;
+    search_chunk_t* chunks;
+    size_t          n_done;
+    off_t           scanned;
+    off_t           notified;      /* Value of "scanned" at the last progress notification */
+    hits_t          hits;          /* Ordered hits of the whole file (once RHD_SEARCH_STATE_DONE) */
+    int             is_saved;      /* 1 if "hits" is already in the sidecar file */
+} search;
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int search_parse(const char* str, unsigned char* needle, size_t* len) {
+    size_t i;
+    size_t n_digits;
+    size_t str_len;
+
+    /* Check if "str" is a hexadecimal pattern */
+    n_digits = 0;
+    for (i = 0; str[0] != '"' && str[i] != '\0'; i++) {
+        if (str[i] == ' ')
+            continue;
+        if (!isxdigit((unsigned char)str[i]))
+            break;
+        n_digits++;
+    }
+
+    /* Hexadecimal pattern: a byte for each pair of digits */
+    if (str[0] != '"' && str[i] == '\0' && n_digits > 0 && n_digits % 2 == 0) {
+        if (n_digits / 2 > RHD_SEARCH_NEEDLE_MAX)
+            return 1;
+        for (*len = 0, n_digits = 0, i = 0; str[i] != '\0'; i++) {
+            if (str[i] == ' ')
+                continue;
+            if (n_digits++ % 2 == 0)
+                needle[*len] = (unsigned char)(search_hex_value(str[i]) << 4);
+            else
+                needle[(*len)++] |= search_hex_value(str[i]);
+        }
+        return 0;
+    }
+
+    /* ASCII string (without the quotes, if quoted) */
+    if (str[0] == '"') {
+        str++;
+        str_len = strlen(str);
+        if (str_len > 0 && str[str_len - 1] == '"')
+            str_len--;
+    } else {
+        str_len = strlen(str);
+    }
+    if (str_len == 0 || str_len > RHD_SEARCH_NEEDLE_MAX)
+        return 1;
+    memcpy(needle, str, str_len);
+    *len = str_len;
+
+    return 0;
+}
+
+
+const unsigned char* search_memmem(const unsigned char* hay, const size_t hay_len,
+                                   const unsigned char* needle, const size_t needle_len) {
+    return search_kernel(hay, hay_len, needle, needle_len);
+}
+
+
+int search_start(rhd_file_t* f, const unsigned char* needle, const size_t len, const off_t from) {
+    size_t n_threads;
+    int    i;
+
+    if (len == 0 || len > RHD_SEARCH_NEEDLE_MAX || file_length(f) < 0)
+        return 1;
+
+    /* Stop previous search (its threads still read the file it was searching) */
+    search_join();
+    search.file     = f;
+    search.file_len = file_length(f);
+
+    /* Open notification pipe (reused by following searches). Both ends of the pipe
+       are non blocking, so that notifying never blocks the background threads */
+    if (!search.is_pipe_open) {
+        if (pipe(search.pipe_fds) == -1)
+            return 1;
+        search.is_pipe_open = 1;
+        for (i = 0; i < 2; i++) {
+            if (fcntl(search.pipe_fds[i], F_SETFL, fcntl(search.pipe_fds[i], F_GETFL) | O_NONBLOCK) == -1 ||
+                fcntl(search.pipe_fds[i], F_SETFD, FD_CLOEXEC) == -1)
+                return 1;
+        }
+    }
+
+    /* Allocate chunks and the chunk buffers (reused by following searches) */
+    n_threads = pool_threads();
+    search.n_chunks = (size_t)((search.file_len + (off_t)RHD_SEARCH_CHUNK_LEN - 1) / (off_t)RHD_SEARCH_CHUNK_LEN);
+    if ((search.chunks = calloc(search.n_chunks + 1, sizeof(*search.chunks))) == NULL)
+        return 1;
+    if (search.bufs == NULL && (search.bufs = malloc(n_threads * (RHD_SEARCH_CHUNK_LEN + RHD_SEARCH_NEEDLE_MAX))) == NULL)
+        return 1;
+
+    /* The kernel must be selected before multiple threads can use it */
+    search_select_kernel();
+
+    memcpy(search.needle, needle, len);
+    search.needle_len  = len;
+    search.first_chunk = from > 0 && from < search.file_len ? (size_t)(from / (off_t)RHD_SEARCH_CHUNK_LEN) : 0;
+    search.n_done      = 0;
+    search.scanned     = 0;
+    search.notified    = 0;
+    search.state       = RHD_SEARCH_STATE_RUNNING;
+    search.is_saved    = 0;
+
+    /* If the same needle was already searched in the same file, just reload its hits (unless the
+       file has changes not saved yet, as the index is of the file on disk) */
+    if (search.file_len >= RHD_SEARCH_INDEX_MIN && !file_is_modified(search.file) && search_index_load() == 0) {
+        search.scanned  = search.file_len;
+        search.is_saved = 1;
+        search.state    = RHD_SEARCH_STATE_DONE;
+        search_notify();
+        return 0;
+    }
+    hits_free(&search.hits);
+
+    /* Empty files have no hits */
+    if (search.n_chunks == 0) {
+        search.state = search_merge() == 0 ? RHD_SEARCH_STATE_DONE : RHD_SEARCH_STATE_ERROR;
+        search_notify();
+        return 0;
+    }
+
+    if (pool_start(&search.pool, n_threads, search.n_chunks, search_chunk, NULL) != 0) {
+        search.state = RHD_SEARCH_STATE_IDLE;
+        return 1;
+    }
+    search.is_running = 1;
+
+    return 0;
+}
+
+
+int search_fd(void) {
+    return search.is_pipe_open ? search.pipe_fds[0] : -1;
+}
+
+
+search_state_t search_poll(off_t* scanned, off_t* total) {
+    char           buf[64];
+    search_state_t state;
+
+    /* Empty notification pipe */
+    if (search.is_pipe_open) {
+        while (read(search.pipe_fds[0], buf, sizeof(buf)) > 0)
+            ;
+    }
+
+    pthread_mutex_lock(&search_lock);
+    state = search.state;
+    if (total != NULL) {
+        *scanned = search.scanned;
+        *total   = search.file_len;
+    }
+    pthread_mutex_unlock(&search_lock);
+
+    /* Join ended background threads */
+    if (state != RHD_SEARCH_STATE_RUNNING && search.is_running) {
+        pool_join(&search.pool);
+        search.is_running = 0;
+    }
+
+    /* Save the index of long files (failing is not an error, the file will just be searched again) */
+    if (state == RHD_SEARCH_STATE_DONE && !search.is_saved && search.file_len >= RHD_SEARCH_INDEX_MIN &&
+        !file_is_modified(search.file)) {
+        search_index_save();
+        search.is_saved = 1;
+    }
+
+    return state;
+}
+
+
+search_result_t search_find(const off_t from, const search_dir_t dir, off_t* hit) {
+    search_result_t ret;
+    search_chunk_t* chunk;
+    size_t          c;
+    size_t          i;
+
+    if (from < 0 || from >= search.file_len)
+        return RHD_SEARCH_RESULT_NOT_FOUND;
+
+    pthread_mutex_lock(&search_lock);
+
+    /* Once done, all hits are in a single ordered index */
+    if (search.state == RHD_SEARCH_STATE_DONE) {
+        i = hits_lower_bound(&search.hits, from, dir == RHD_SEARCH_DIR_BACKWARD);
+        if (dir == RHD_SEARCH_DIR_BACKWARD)
+            i = i > 0 ? i - 1 : search.hits.n_hits;
+        ret = i < search.hits.n_hits ? RHD_SEARCH_RESULT_FOUND : RHD_SEARCH_RESULT_NOT_FOUND;
+        if (ret == RHD_SEARCH_RESULT_FOUND)
+            *hit = hits_get(&search.hits, i);
+        pthread_mutex_unlock(&search_lock);
+        return ret;
+    }
+
+    /* Else walk the chunks from the one containing "from", until a chunk not searched yet */
+    ret = RHD_SEARCH_RESULT_NOT_FOUND;
+    c   = (size_t)(from / (off_t)RHD_SEARCH_CHUNK_LEN);
+    for (;;) {
+        chunk = &search.chunks[c];
+        if (!chunk->is_done) {
+            ret = RHD_SEARCH_RESULT_PENDING;
+            break;
+        }
+        if ((i = search_lookup(chunk->hits, chunk->n_hits, from, dir)) < chunk->n_hits) {
+            *hit = chunk->hits[i];
+            ret  = RHD_SEARCH_RESULT_FOUND;
+            break;
+        }
+        if (dir == RHD_SEARCH_DIR_FORWARD ? ++c >= search.n_chunks : c-- == 0)
+            break;
+    }
+
+    pthread_mutex_unlock(&search_lock);
+    return ret;
+}
+
+
+size_t search_count(void) {
+    size_t n_hits;
+
+    pthread_mutex_lock(&search_lock);
+    n_hits = search.state == RHD_SEARCH_STATE_DONE ? search.hits.n_hits : (size_t)-1;
+    pthread_mutex_unlock(&search_lock);
+
+    return n_hits;
+}
+
+
+size_t search_index(const off_t hit) {
+    size_t i;
+
+    pthread_mutex_lock(&search_lock);
+    i = (size_t)-1;
+    if (search.state == RHD_SEARCH_STATE_DONE) {
+        i = hits_lower_bound(&search.hits, hit, 0);
+        if (i == search.hits.n_hits || hits_get(&search.hits, i) != hit)
+            i = (size_t)-1;
+    }
+    pthread_mutex_unlock(&search_lock);
+
+    return i;
+}
+
+
+void search_cancel(void) {
+    pthread_mutex_lock(&search_lock);
+    if (search.state == RHD_SEARCH_STATE_RUNNING)
+        search.state = RHD_SEARCH_STATE_CANCELLED;
+    pthread_mutex_unlock(&search_lock);
+
+    if (search.is_running) {
+        pool_cancel(&search.pool);
+        search_notify();
+    }
+}
+
+
+int search_stop(void) {
+    int ret;
+
+    search_join();
+
+    /* Free chunk buffers, and close notification pipe */
+    free(search.bufs);
+    search.bufs = NULL;
+    ret = 0;
+    if (search.is_pipe_open) {
+        if (close(search.pipe_fds[0]) == -1)
+            ret = 1;
+        if (close(search.pipe_fds[1]) == -1)
+            ret = 1;
+        search.is_pipe_open = 0;
+    }
+
+    return ret;
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static void search_chunk(void* ctx, const size_t task, const size_t worker) {
+    const unsigned char* view;
+    const unsigned char* found;
+    unsigned char*       buf;
+    off_t*               hits;
+    size_t               n_hits;
+    size_t               cap;
+    search_chunk_t*      chunk;
+    off_t                start;
+    off_t                end;
+    size_t               span;
+    size_t               n;
+    size_t               c;
+    int                  is_failed;
+    int                  is_due;
+
+    (void)ctx;
+
+    /* Chunk of starts [start, end) (it also reads the needle length - 1 bytes after "end") */
+    c     = (search.first_chunk + task) % search.n_chunks;
+    start = (off_t)c * (off_t)RHD_SEARCH_CHUNK_LEN;
+    end   = search.file_len - start > (off_t)RHD_SEARCH_CHUNK_LEN ? start + (off_t)RHD_SEARCH_CHUNK_LEN : search.file_len;
+    span  = (size_t)(end - start) + search.needle_len - 1;
+    if ((off_t)span > search.file_len - start)
+        span = (size_t)(search.file_len - start);
+
+    /* Collect all hits of the chunk */
+    hits      = NULL;
+    n_hits    = 0;
+    cap       = 0;
+    is_failed = 0;
+    buf       = &search.bufs[worker * (RHD_SEARCH_CHUNK_LEN + RHD_SEARCH_NEEDLE_MAX)];
+    if ((n = file_read_at(search.file, &view, buf, start, span)) == (size_t)-1) {
+        is_failed = 1;
+    } else {
+        found = view;
+        while (!is_failed && (found = search_memmem(found, n - (size_t)(found - view), search.needle, search.needle_len)) != NULL) {
+            is_failed = search_hits_append(&hits, &n_hits, &cap, start + (off_t)(found - view));
+            found++;
+        }
+    }
+
+    /* Publish the hits (or the failure, that stops the whole search) */
+    pthread_mutex_lock(&search_lock);
+    if (is_failed) {
+        free(hits);
+        search.state = RHD_SEARCH_STATE_ERROR;
+        is_due       = 1;
+    } else {
+        chunk          = &search.chunks[c];
+        chunk->hits    = hits;
+        chunk->n_hits  = n_hits;
+        chunk->is_done = 1;
+        search.n_done++;
+        search.scanned += end - start;
+        if ((is_due = n_hits > 0 || search.scanned - search.notified >= RHD_SEARCH_PROGRESS_LEN))
+            search.notified = search.scanned;
+        if (search.n_done == search.n_chunks && search.state == RHD_SEARCH_STATE_RUNNING) {
+            search.state = search_merge() == 0 ? RHD_SEARCH_STATE_DONE : RHD_SEARCH_STATE_ERROR;
+            is_due = 1;
+        }
+    }
+    pthread_mutex_unlock(&search_lock);
+
+    if (is_failed)
+        pool_cancel(&search.pool);
+    if (is_due)
+        search_notify();
+}
+
+
+static int search_hits_append(off_t** hits, size_t* n_hits, size_t* cap, const off_t hit) {
+    off_t* new_hits;
+    size_t new_cap;
+
+    if (*n_hits == *cap) {
+        new_cap = *cap == 0 ? 16 : *cap * 2;
+        if ((new_hits = realloc(*hits, new_cap * sizeof(**hits))) == NULL)
+            return 1;
+        *hits = new_hits;
+        *cap  = new_cap;
+    }
+
+    (*hits)[(*n_hits)++] = hit;
+    return 0;
+}
+
+
+static int search_merge(void) {
+    size_t c;
+    size_t i;
+    int    ret;
+
+    /* Chunks are in file order, and so are the hits of each chunk */
+    ret = 0;
+    for (c = 0; c < search.n_chunks; c++) {
+        for (i = 0; ret == 0 && i < search.chunks[c].n_hits; i++)
+            ret = hits_append(&search.hits, search.chunks[c].hits[i]);
+        free(search.chunks[c].hits);
+        search.chunks[c].hits   = NULL;
+        search.chunks[c].n_hits = 0;
+    }
+
+    return ret;
+}
+
+
+static size_t search_lookup(const off_t* hits, const size_t n_hits, const off_t from, const search_dir_t dir) {
+    size_t lo;
+    size_t hi;
+    size_t mid;
+
+    /* Binary search of the first hit >= "from" (or > "from" backward: the hit before it is then the answer) */
+    lo = 0;
+    hi = n_hits;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (dir == RHD_SEARCH_DIR_FORWARD ? hits[mid] < from : hits[mid] <= from)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (dir == RHD_SEARCH_DIR_FORWARD)
+        return lo;
+    return lo > 0 ? lo - 1 : n_hits;
+}
+
+
+static void search_notify(void) {
+    ssize_t ret;
+
+    /* If the pipe is full, a notification is already pending */
+    do {
+        ret = write(search.pipe_fds[1], "", 1);
+    } while (ret == -1 && errno == EINTR);
+}
+
+
+static void search_join(void) {
+    size_t c;
+
+    if (search.is_running) {
+        search_cancel();
+        pool_join(&search.pool);
+        search.is_running = 0;
+    }
+
+    /* Free hits */
+    if (search.chunks != NULL) {
+        for (c = 0; c < search.n_chunks; c++)
+            free(search.chunks[c].hits);
+        free(search.chunks);
+        search.chunks = NULL;
+    }
+    hits_free(&search.hits);
+    search.state = RHD_SEARCH_STATE_IDLE;
+}
+
+
+/* INDEX */
+
+static int search_index_path(char* path, const struct stat* st) {
+    char          name[64];
+    unsigned long hash;
+    size_t        i;
+
+    /* Name: FNV-1a hash of the identity of the file and of the needle (the sidecar file holds
+       the whole key, so that collisions are detected) */
+    hash = 2166136261UL;
+    for (i = 0; i < search.needle_len; i++)
+        hash = ((hash ^ search.needle[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)st->st_ino) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)st->st_size) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)st->st_mtime) * 16777619UL) & 0xFFFFFFFFUL;
+    hash = ((hash ^ (unsigned long)file_mtime_nsec(st)) * 16777619UL) & 0xFFFFFFFFUL;
+    sprintf(name, "%08lx-%lu.idx", hash, (unsigned long)search.needle_len);
+
+    return file_sidecar_path(path, name);
+}
+
+
+static int search_index_key(FILE* f, const struct stat* st, const int is_reading) {
+    struct key_tag {
+        dev_t  dev;
+        ino_t  ino;
+        off_t  size;
+        time_t mtime;
+        long   mtime_nsec;
+        size_t needle_len;
+    } key;
+    struct key_tag other;
+    unsigned char  needle[RHD_SEARCH_NEEDLE_MAX];
+    char           magic[sizeof(RHD_SEARCH_INDEX_MAGIC) - 1];
+
+    memset(&key, 0, sizeof(key));
+    key.dev        = st->st_dev;
+    key.ino        = st->st_ino;
+    key.size       = st->st_size;
+    key.mtime      = st->st_mtime;
+    key.mtime_nsec = file_mtime_nsec(st);
+    key.needle_len = search.needle_len;
+
+    if (!is_reading) {
+        if (fwrite(RHD_SEARCH_INDEX_MAGIC, 1, sizeof(magic), f) != sizeof(magic) ||
+            fwrite(&key, sizeof(key), 1, f) != 1 ||
+            fwrite(search.needle, 1, search.needle_len, f) != search.needle_len)
+            return 1;
+        return 0;
+    }
+
+    if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) || memcmp(magic, RHD_SEARCH_INDEX_MAGIC, sizeof(magic)) != 0 ||
+        fread(&other, sizeof(other), 1, f) != 1 || memcmp(&key, &other, sizeof(key)) != 0 ||
+        fread(needle, 1, search.needle_len, f) != search.needle_len || memcmp(needle, search.needle, search.needle_len) != 0)
+        return 1;
+
+    return 0;
+}
+
+
+static int search_index_load(void) {
+    char        path[RHD_FILE_PATH_MAX];
+    struct stat st;
+    FILE*       f;
+    int         ret;
+
+    if (file_stat(search.file, &st) != 0 || search_index_path(path, &st) != 0 || (f = fopen(path, "rb")) == NULL)
+        return 1;
+
+    hits_free(&search.hits);
+    ret = search_index_key(f, &st, 1) != 0 || hits_load(&search.hits, f) != 0;
+    fclose(f);
+    if (ret != 0)
+        hits_free(&search.hits);
+
+    return ret;
+}
+
+
+static int search_index_save(void) {
+    char        path[RHD_FILE_PATH_MAX];
+    char        temp[RHD_FILE_PATH_MAX + 4];
+    struct stat st;
+    FILE*       f;
+    int         ret;
+
+    if (file_stat(search.file, &st) != 0 || search_index_path(path, &st) != 0)
+        return 1;
+
+    /* Write a temporary file, then rename it, so that a sidecar file is never half written */
+    sprintf(temp, "%s.tmp", path);
+    if ((f = fopen(temp, "wb")) == NULL)
+        return 1;
+    ret = search_index_key(f, &st, 0) != 0 || hits_save(&search.hits, f) != 0;
+    if (fclose(f) == EOF)
+        ret = 1;
+    if (ret == 0 && rename(temp, path) != 0)
+        ret = 1;
+    if (ret != 0)
+        remove(temp);
+
+    return ret;
+}
+
+
+static unsigned char search_hex_value(const char c) {
+    if (c >= '0' && c <= '9')
+        return (unsigned char)(c - '0');
+    if (c >= 'a' && c <= 'f')
+        return (unsigned char)(c - 'a' + 10);
+    return (unsigned char)(c - 'A' + 10);
+}
+
+
+/* KERNELS */
+
+static void search_select_kernel(void) {
+    search_kernel = search_memmem_scalar;
+
+#if defined(RHD_SEARCH_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        search_kernel = search_memmem_sse2;
+    if (__builtin_cpu_supports("avx2"))
+        search_kernel = search_memmem_avx2;
+#endif
+}
+
+
+static const unsigned char* search_memmem_resolve(const unsigned char* hay, const size_t hay_len,
+                                                  const unsigned char* needle, const size_t needle_len) {
+    search_select_kernel();
+    return search_kernel(hay, hay_len, needle, needle_len);
+}
+
+
+static const unsigned char* search_memmem_scalar(const unsigned char* hay, const size_t hay_len,
+                                                 const unsigned char* needle, const size_t needle_len) {
+    const unsigned char* p;
+    const unsigned char* end;
+
+    if (needle_len == 0 || needle_len > hay_len)
+        return NULL;
+
+    /* Possible starts are [hay, end) */
+    end = &hay[hay_len - needle_len + 1];
+    for (p = hay; p < end; p++) {
+        if ((p = memchr(p, needle[0], (size_t)(end - p))) == NULL)
+            return NULL;
+        if (memcmp(&p[1], &needle[1], needle_len - 1) == 0)
+            return p;
+    }
+
+    return NULL;
+}
+
+
+#if defined(RHD_SEARCH_X86)
+
+__attribute__((target("sse2")))
+static const unsigned char* search_memmem_sse2(const unsigned char* hay, const size_t hay_len,
+                                               const unsigned char* needle, const size_t needle_len) {
+    __m128i      first;
+    __m128i      last;
+    __m128i      eq;
+    unsigned int mask;
+    unsigned int bit;
+    size_t       i;
+
+    /* Single bytes are left to memchr() */
+    if (needle_len < 2 || needle_len > hay_len)
+        return search_memmem_scalar(hay, hay_len, needle, needle_len);
+
+    first = _mm_set1_epi8((char)needle[0]);
+    last  = _mm_set1_epi8((char)needle[needle_len - 1]);
+
+    for (i = 0; i + needle_len - 1 + 16 <= hay_len; i += 16) {
+        eq   = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&hay[i]), first),
+                             _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&hay[i + needle_len - 1]), last));
+        mask = (unsigned int)_mm_movemask_epi8(eq);
+        while (mask != 0) {
+            bit = (unsigned int)__builtin_ctz(mask);
+            if (memcmp(&hay[i + bit + 1], &needle[1], needle_len - 2) == 0)
+                return &hay[i + bit];
+            mask &= mask - 1;
+        }
+    }
+
+    return search_memmem_scalar(&hay[i], hay_len - i, needle, needle_len);
+}
+
+
+__attribute__((target("avx2")))
+static const unsigned char* search_memmem_avx2(const unsigned char* hay, const size_t hay_len,
+                                               const unsigned char* needle, const size_t needle_len) {
+    __m256i      first;
+    __m256i      last;
+    __m256i      eq;
+    unsigned int mask;
+    unsigned int bit;
+    size_t       i;
+
+    /* Single bytes are left to memchr() */
+    if (needle_len < 2 || needle_len > hay_len)
+        return search_memmem_scalar(hay, hay_len, needle, needle_len);
+
+    first = _mm256_set1_epi8((char)needle[0]);
+    last  = _mm256_set1_epi8((char)needle[needle_len - 1]);
+
+    for (i = 0; i + needle_len - 1 + 32 <= hay_len; i += 32) {
+        eq   = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&hay[i]), first),
+                                _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&hay[i + needle_len - 1]), last));
+        mask = (unsigned int)_mm256_movemask_epi8(eq);
+        while (mask != 0) {
+            bit = (unsigned int)__builtin_ctz(mask);
+            if (memcmp(&hay[i + bit + 1], &needle[1], needle_len - 2) == 0) {
+                _mm256_zeroupper();
+                return &hay[i + bit];
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    /* Clearing the upper halves avoids AVX to SSE transition penalties in the tail kernel */
+    _mm256_zeroupper();
+    return search_memmem_sse2(&hay[i], hay_len - i, needle, needle_len);
+}
+
+#endif  /* RHD_SEARCH_X86 */
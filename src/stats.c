@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file stats.c */
+
+
+#include "stats.h"
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Value of each counter (indexed by stats_counter_t)
+ */
+static unsigned long stats_counters[RHD_STATS_COUNTERS];
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+void stats_add(const stats_counter_t counter, const unsigned long n) {
+    /* The counters are also updated by the background threads: with GCC/Clang they are relaxed
+       atomics (which don't order anything, so they stay cheap), else concurrent updates may be lost */
+#if defined(__GNUC__)
+    __atomic_fetch_add(&stats_counters[counter], n, __ATOMIC_RELAXED);
+#else
+    stats_counters[counter] += n;
+#endif
+}
+
+
+unsigned long stats_get(const stats_counter_t counter) {
+#if defined(__GNUC__)
+    return __atomic_load_n(&stats_counters[counter], __ATOMIC_RELAXED);
+#else
+    return stats_counters[counter];
+#endif
+}
+
+
+void stats_print(FILE* stream) {
+    unsigned long frames;
+    unsigned long hits;
+    unsigned long lookups;
+
+    frames  = stats_get(RHD_STATS_FRAMES);
+    hits    = stats_get(RHD_STATS_CACHE_HITS);
+    lookups = hits + stats_get(RHD_STATS_CACHE_MISSES);
+
+    fprintf(stream, "Stats:\n");
+    fprintf(stream, "    frames = %lu", frames);
+    if (frames > 0)
+        fprintf(stream, " (%lu us and %lu bytes per frame)", stats_get(RHD_STATS_RENDER_NS) / frames / 1000,
+                stats_get(RHD_STATS_WRITTEN) / frames);
+    fprintf(stream, "\n");
+    fprintf(stream, "    writes = %lu (%lu bytes)\n", stats_get(RHD_STATS_WRITES), stats_get(RHD_STATS_WRITTEN));
+    fprintf(stream, "    allocs = %lu\n", stats_get(RHD_STATS_ALLOCS));
+    fprintf(stream, "    reads  = %lu\n", stats_get(RHD_STATS_READS));
+    fprintf(stream, "    seeks  = %lu\n", stats_get(RHD_STATS_SEEKS));
+    fprintf(stream, "    cache  = ");
+    if (lookups > 0)
+        fprintf(stream, "%lu.%lu%% hits (of %lu pages)\n", hits * 100 / lookups, hits * 1000 / lookups % 10, lookups);
+    else
+        fprintf(stream, "unused\n");
+}
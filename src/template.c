@@ -0,0 +1,679 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file template.c */
+
+
+/* C89 standard */
+#include <ctype.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+
+#include "file.h"
+#include "inspect.h"
+
+#include "template.h"
+
+
+/* Max amount of tables of a template (the headers are tables with a single entry) */
+#define RHD_TEMPLATE_TABLES_MAX 4
+
+/* Bytes read at the start of the file to recognize its format (the longest header is the DOS one) */
+#define RHD_TEMPLATE_PROBE_LEN 64
+
+/* Max amount of bytes of a RHD_TEMPLATE_KIND_TEXT field that are shown */
+#define RHD_TEMPLATE_TEXT_MAX 16
+
+/* Max length of the names read from the ELF section names */
+#define RHD_TEMPLATE_STRTAB_MAX 24
+
+/* Amount of chunks of a PNG file remembered at first (then doubled when needed) */
+#define RHD_TEMPLATE_CHUNKS_INIT 64
+
+/* Amount of fields in a static array of template_def_t */
+#define RHD_TEMPLATE_DEFS(defs) (sizeof(defs) / sizeof((defs)[0]))
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Struct type that describes a field of the entries of a table (relative to the start of the entry)
+ */
+typedef struct template_def_tag {
+    off_t           offset;
+    off_t           len;
+    const char*     name;
+    template_kind_t kind;
+} template_def_t;
+
+/**
+ * Struct type that describes a table of the headers: "n_entries" entries of "entry_len" bytes,
+ * starting from "pos", each made of the fields "defs"
+ */
+typedef struct template_table_tag {
+    const char*           group;  /* NULL for the headers (that have a single entry) */
+    off_t                 pos;
+    size_t                n_entries;
+    off_t                 entry_len;
+    const template_def_t* defs;
+    size_t                n_defs;
+} template_table_t;
+
+/**
+ * Struct type of a template (see rhd_template_t)
+ */
+struct rhd_template_tag {
+    rhd_file_t*      file;
+    const char*      format;
+    int              is_big_endian;
+    template_table_t tables[RHD_TEMPLATE_TABLES_MAX];
+    size_t           n_tables;
+    off_t            strtab;      /* Position of the ELF section names (-1 if unknown) */
+    int              is_png;
+    off_t*           chunks;      /* Position of the PNG chunks walked so far */
+    size_t           n_chunks;
+    size_t           cap_chunks;
+    off_t            chunks_end;  /* Position of the next PNG chunk to walk (-1 if all were walked) */
+};
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/* ELF (see the System V ABI): file header, program headers and section headers */
+static const template_def_t elf32_header[] = {
+    {0, 4, "EI_MAG", RHD_TEMPLATE_KIND_TEXT},      {4, 1, "EI_CLASS", RHD_TEMPLATE_KIND_DEC},
+    {5, 1, "EI_DATA", RHD_TEMPLATE_KIND_DEC},      {6, 1, "EI_VERSION", RHD_TEMPLATE_KIND_DEC},
+    {7, 1, "EI_OSABI", RHD_TEMPLATE_KIND_DEC},     {16, 2, "e_type", RHD_TEMPLATE_KIND_DEC},
+    {18, 2, "e_machine", RHD_TEMPLATE_KIND_DEC},   {20, 4, "e_version", RHD_TEMPLATE_KIND_DEC},
+    {24, 4, "e_entry", RHD_TEMPLATE_KIND_HEX},     {28, 4, "e_phoff", RHD_TEMPLATE_KIND_HEX},
+    {32, 4, "e_shoff", RHD_TEMPLATE_KIND_HEX},     {36, 4, "e_flags", RHD_TEMPLATE_KIND_HEX},
+    {40, 2, "e_ehsize", RHD_TEMPLATE_KIND_DEC},    {42, 2, "e_phentsize", RHD_TEMPLATE_KIND_DEC},
+    {44, 2, "e_phnum", RHD_TEMPLATE_KIND_DEC},     {46, 2, "e_shentsize", RHD_TEMPLATE_KIND_DEC},
+    {48, 2, "e_shnum", RHD_TEMPLATE_KIND_DEC},     {50, 2, "e_shstrndx", RHD_TEMPLATE_KIND_DEC}
+};
+static const template_def_t elf64_header[] = {
+    {0, 4, "EI_MAG", RHD_TEMPLATE_KIND_TEXT},      {4, 1, "EI_CLASS", RHD_TEMPLATE_KIND_DEC},
+    {5, 1, "EI_DATA", RHD_TEMPLATE_KIND_DEC},      {6, 1, "EI_VERSION", RHD_TEMPLATE_KIND_DEC},
+    {7, 1, "EI_OSABI", RHD_TEMPLATE_KIND_DEC},     {16, 2, "e_type", RHD_TEMPLATE_KIND_DEC},
+    {18, 2, "e_machine", RHD_TEMPLATE_KIND_DEC},   {20, 4, "e_version", RHD_TEMPLATE_KIND_DEC},
+    {24, 8, "e_entry", RHD_TEMPLATE_KIND_HEX},     {32, 8, "e_phoff", RHD_TEMPLATE_KIND_HEX},
+    {40, 8, "e_shoff", RHD_TEMPLATE_KIND_HEX},     {48, 4, "e_flags", RHD_TEMPLATE_KIND_HEX},
+    {52, 2, "e_ehsize", RHD_TEMPLATE_KIND_DEC},    {54, 2, "e_phentsize", RHD_TEMPLATE_KIND_DEC},
+    {56, 2, "e_phnum", RHD_TEMPLATE_KIND_DEC},     {58, 2, "e_shentsize", RHD_TEMPLATE_KIND_DEC},
+    {60, 2, "e_shnum", RHD_TEMPLATE_KIND_DEC},     {62, 2, "e_shstrndx", RHD_TEMPLATE_KIND_DEC}
+};
+static const template_def_t elf32_phdr[] = {
+    {0, 4, "p_type", RHD_TEMPLATE_KIND_HEX},       {4, 4, "p_offset", RHD_TEMPLATE_KIND_HEX},
+    {8, 4, "p_vaddr", RHD_TEMPLATE_KIND_HEX},      {12, 4, "p_paddr", RHD_TEMPLATE_KIND_HEX},
+    {16, 4, "p_filesz", RHD_TEMPLATE_KIND_DEC},    {20, 4, "p_memsz", RHD_TEMPLATE_KIND_DEC},
+    {24, 4, "p_flags", RHD_TEMPLATE_KIND_HEX},     {28, 4, "p_align", RHD_TEMPLATE_KIND_HEX}
+};
+static const template_def_t elf64_phdr[] = {
+    {0, 4, "p_type", RHD_TEMPLATE_KIND_HEX},       {4, 4, "p_flags", RHD_TEMPLATE_KIND_HEX},
+    {8, 8, "p_offset", RHD_TEMPLATE_KIND_HEX},     {16, 8, "p_vaddr", RHD_TEMPLATE_KIND_HEX},
+    {24, 8, "p_paddr", RHD_TEMPLATE_KIND_HEX},     {32, 8, "p_filesz", RHD_TEMPLATE_KIND_DEC},
+    {40, 8, "p_memsz", RHD_TEMPLATE_KIND_DEC},     {48, 8, "p_align", RHD_TEMPLATE_KIND_HEX}
+};
+static const template_def_t elf32_shdr[] = {
+    {0, 4, "sh_name", RHD_TEMPLATE_KIND_STRTAB},   {4, 4, "sh_type", RHD_TEMPLATE_KIND_DEC},
+    {8, 4, "sh_flags", RHD_TEMPLATE_KIND_HEX},     {12, 4, "sh_addr", RHD_TEMPLATE_KIND_HEX},
+    {16, 4, "sh_offset", RHD_TEMPLATE_KIND_HEX},   {20, 4, "sh_size", RHD_TEMPLATE_KIND_DEC},
+    {24, 4, "sh_link", RHD_TEMPLATE_KIND_DEC},     {28, 4, "sh_info", RHD_TEMPLATE_KIND_DEC},
+    {32, 4, "sh_addralign", RHD_TEMPLATE_KIND_DEC}, {36, 4, "sh_entsize", RHD_TEMPLATE_KIND_DEC}
+};
+static const template_def_t elf64_shdr[] = {
+    {0, 4, "sh_name", RHD_TEMPLATE_KIND_STRTAB},   {4, 4, "sh_type", RHD_TEMPLATE_KIND_DEC},
+    {8, 8, "sh_flags", RHD_TEMPLATE_KIND_HEX},     {16, 8, "sh_addr", RHD_TEMPLATE_KIND_HEX},
+    {24, 8, "sh_offset", RHD_TEMPLATE_KIND_HEX},   {32, 8, "sh_size", RHD_TEMPLATE_KIND_DEC},
+    {40, 4, "sh_link", RHD_TEMPLATE_KIND_DEC},     {44, 4, "sh_info", RHD_TEMPLATE_KIND_DEC},
+    {48, 8, "sh_addralign", RHD_TEMPLATE_KIND_DEC}, {56, 8, "sh_entsize", RHD_TEMPLATE_KIND_DEC}
+};
+
+/* PE (see the Microsoft PE format): DOS header, signature and COFF header, optional header and sections */
+static const template_def_t pe_dos[] = {
+    {0, 2, "e_magic", RHD_TEMPLATE_KIND_TEXT},     {60, 4, "e_lfanew", RHD_TEMPLATE_KIND_HEX}
+};
+static const template_def_t pe_coff[] = {
+    {0, 4, "Signature", RHD_TEMPLATE_KIND_TEXT},            {4, 2, "Machine", RHD_TEMPLATE_KIND_HEX},
+    {6, 2, "NumberOfSections", RHD_TEMPLATE_KIND_DEC},      {8, 4, "TimeDateStamp", RHD_TEMPLATE_KIND_TIME},
+    {12, 4, "PointerToSymbolTable", RHD_TEMPLATE_KIND_HEX}, {16, 4, "NumberOfSymbols", RHD_TEMPLATE_KIND_DEC},
+    {20, 2, "SizeOfOptionalHeader", RHD_TEMPLATE_KIND_DEC}, {22, 2, "Characteristics", RHD_TEMPLATE_KIND_HEX}
+};
+static const template_def_t pe32_optional[] = {
+    {0, 2, "Magic", RHD_TEMPLATE_KIND_HEX},                 {2, 1, "MajorLinkerVersion", RHD_TEMPLATE_KIND_DEC},
+    {3, 1, "MinorLinkerVersion", RHD_TEMPLATE_KIND_DEC},    {4, 4, "SizeOfCode", RHD_TEMPLATE_KIND_DEC},
+    {16, 4, "AddressOfEntryPoint", RHD_TEMPLATE_KIND_HEX},  {20, 4, "BaseOfCode", RHD_TEMPLATE_KIND_HEX},
+    {24, 4, "BaseOfData", RHD_TEMPLATE_KIND_HEX},           {28, 4, "ImageBase", RHD_TEMPLATE_KIND_HEX},
+    {32, 4, "SectionAlignment", RHD_TEMPLATE_KIND_HEX},     {36, 4, "FileAlignment", RHD_TEMPLATE_KIND_HEX},
+    {56, 4, "SizeOfImage", RHD_TEMPLATE_KIND_DEC},          {60, 4, "SizeOfHeaders", RHD_TEMPLATE_KIND_DEC},
+    {64, 4, "CheckSum", RHD_TEMPLATE_KIND_HEX},             {68, 2, "Subsystem", RHD_TEMPLATE_KIND_DEC},
+    {70, 2, "DllCharacteristics", RHD_TEMPLATE_KIND_HEX}
+};
+static const template_def_t pe32plus_optional[] = {
+    {0, 2, "Magic", RHD_TEMPLATE_KIND_HEX},                 {2, 1, "MajorLinkerVersion", RHD_TEMPLATE_KIND_DEC},
+    {3, 1, "MinorLinkerVersion", RHD_TEMPLATE_KIND_DEC},    {4, 4, "SizeOfCode", RHD_TEMPLATE_KIND_DEC},
+    {16, 4, "AddressOfEntryPoint", RHD_TEMPLATE_KIND_HEX},  {20, 4, "BaseOfCode", RHD_TEMPLATE_KIND_HEX},
+    {24, 8, "ImageBase", RHD_TEMPLATE_KIND_HEX},            {32, 4, "SectionAlignment", RHD_TEMPLATE_KIND_HEX},
+    {36, 4, "FileAlignment", RHD_TEMPLATE_KIND_HEX},        {56, 4, "SizeOfImage", RHD_TEMPLATE_KIND_DEC},
+    {60, 4, "SizeOfHeaders", RHD_TEMPLATE_KIND_DEC},        {64, 4, "CheckSum", RHD_TEMPLATE_KIND_HEX},
+    {68, 2, "Subsystem", RHD_TEMPLATE_KIND_DEC},            {70, 2, "DllCharacteristics", RHD_TEMPLATE_KIND_HEX}
+};
+static const template_def_t pe_section[] = {
+    {0, 8, "Name", RHD_TEMPLATE_KIND_TEXT},                 {8, 4, "VirtualSize", RHD_TEMPLATE_KIND_DEC},
+    {12, 4, "VirtualAddress", RHD_TEMPLATE_KIND_HEX},       {16, 4, "SizeOfRawData", RHD_TEMPLATE_KIND_DEC},
+    {20, 4, "PointerToRawData", RHD_TEMPLATE_KIND_HEX},     {36, 4, "Characteristics", RHD_TEMPLATE_KIND_HEX}
+};
+
+/* PNG (see the PNG specification): signature, and the fields of the IHDR chunk (after its length and type) */
+static const template_def_t png_signature[] = {
+    {0, 8, "signature", RHD_TEMPLATE_KIND_HEX}
+};
+static const template_def_t png_ihdr[] = {
+    {8, 4, "width", RHD_TEMPLATE_KIND_DEC},        {12, 4, "height", RHD_TEMPLATE_KIND_DEC},
+    {16, 1, "bit_depth", RHD_TEMPLATE_KIND_DEC},   {17, 1, "color_type", RHD_TEMPLATE_KIND_DEC},
+    {18, 1, "compression", RHD_TEMPLATE_KIND_DEC}, {19, 1, "filter", RHD_TEMPLATE_KIND_DEC},
+    {20, 1, "interlace", RHD_TEMPLATE_KIND_DEC}
+};
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Returns the unsigned integer made of the "n" bytes of "bytes" (from 1 to 8), read with the
+ * given byte order (or -1 if it doesn't fit in an off_t).
+ */
+static off_t template_uint(const unsigned char* bytes, const size_t n, const int is_big_endian);
+
+/**
+ * Adds a table to "template" (see template_table_t), unless it is empty or starts past the
+ * end of the file (the amount of entries is limited to those that start inside the file).
+ */
+static void template_table_add(rhd_template_t* template, const char* group, const off_t pos, size_t n_entries,
+                               const off_t entry_len, const template_def_t* defs, const size_t n_defs);
+
+/**
+ * Reads the layout of the ELF file of "template" (with the first "n" bytes "probe").
+ * If successful returns 0, else 1.
+ */
+static int template_open_elf(rhd_template_t* template, const unsigned char* probe, const size_t n);
+
+/**
+ * Reads the layout of the PE file of "template" (with the first "n" bytes "probe").
+ * If successful returns 0, else 1.
+ */
+static int template_open_pe(rhd_template_t* template, const unsigned char* probe, const size_t n);
+
+/**
+ * Inserts "field" in the "n" fields sorted by position (at most "max"), dropping the last one
+ * if they are already "max". Returns 0 if "field" was kept, else 1.
+ */
+static int template_insert(template_field_t* fields, size_t* n, const size_t max, const template_field_t* field);
+
+/**
+ * Adds to the "n" fields (at most "max") those of "table" that overlap [from, to), numbering
+ * its entries from "first_index".
+ */
+static void template_table_fields(const template_table_t* table, const size_t first_index, const off_t from, const off_t to,
+                                  template_field_t* fields, size_t* n, const size_t max);
+
+/**
+ * Adds to the "n" fields (at most "max") those of the PNG chunks of "template" that overlap
+ * [from, to), walking the chunks up to "to" first (if not yet walked).
+ * If successful returns 0, else 1.
+ */
+static int template_chunk_fields(rhd_template_t* template, const off_t from, const off_t to,
+                                 template_field_t* fields, size_t* n, const size_t max);
+
+
+/* --------------------------- GLOBAL FUNCTIONS ---------------------------- */
+
+int template_open(rhd_template_t** template, rhd_file_t* f) {
+    unsigned char        buf[RHD_TEMPLATE_PROBE_LEN];
+    const unsigned char* probe;
+    rhd_template_t*      t;
+    size_t               n;
+
+    *template = NULL;
+    if ((n = file_read_at(f, &probe, buf, 0, sizeof(buf))) == (size_t)-1)
+        return 1;
+
+    if ((t = (rhd_template_t*)calloc(1, sizeof(*t))) == NULL)
+        return 1;
+    t->file       = f;
+    t->strtab     = -1;
+    t->chunks_end = -1;
+
+    if (n >= 16 && memcmp(probe, "\x7F" "ELF", 4) == 0) {
+        if (template_open_elf(t, probe, n) != 0) {
+            template_close(t);
+            return 1;
+        }
+    } else if (n >= RHD_TEMPLATE_PROBE_LEN && memcmp(probe, "MZ", 2) == 0) {
+        if (template_open_pe(t, probe, n) != 0) {
+            template_close(t);
+            return 1;
+        }
+    } else if (n >= 8 && memcmp(probe, "\x89PNG\r\n\x1A\n", 8) == 0) {
+        t->format        = "PNG";
+        t->is_big_endian = 1;
+        t->is_png        = 1;
+        t->chunks_end    = 8;
+        template_table_add(t, NULL, 0, 1, 8, png_signature, RHD_TEMPLATE_DEFS(png_signature));
+    }
+
+    /* Unknown format (or an executable without the headers it claims) */
+    if (t->format == NULL) {
+        template_close(t);
+        return 0;
+    }
+
+    *template = t;
+    return 0;
+}
+
+
+const char* template_format(const rhd_template_t* template) {
+    return template->format;
+}
+
+
+size_t template_fields(rhd_template_t* template, const off_t from, const off_t to,
+                       template_field_t* fields, const size_t max) {
+    size_t n;
+    size_t i;
+
+    n = 0;
+    for (i = 0; i < template->n_tables; i++)
+        template_table_fields(&template->tables[i], 0, from, to, fields, &n, max);
+    if (template->is_png && template_chunk_fields(template, from, to, fields, &n, max) != 0)
+        return (size_t)-1;
+
+    return n;
+}
+
+
+void template_field_name(const template_field_t* field, char* dst) {
+    if (field->group != NULL)
+        sprintf(dst, "%s[%lu].%s", field->group, (unsigned long)field->index, field->name);
+    else
+        strcpy(dst, field->name);
+}
+
+
+int template_field_value(rhd_template_t* template, const template_field_t* field, char* dst) {
+    unsigned char        buf[RHD_TEMPLATE_TEXT_MAX > RHD_TEMPLATE_STRTAB_MAX ? RHD_TEMPLATE_TEXT_MAX : RHD_TEMPLATE_STRTAB_MAX];
+    const unsigned char* view;
+    size_t               len;
+    size_t               n;
+    size_t               i;
+    off_t                name;
+
+    if (field->kind == RHD_TEMPLATE_KIND_BLOB) {
+        sprintf(dst, "(%lu bytes)", (unsigned long)field->len);
+        return 0;
+    }
+
+    /* (the fields cut by the end of the file have no value) */
+    len = (size_t)(field->kind == RHD_TEMPLATE_KIND_TEXT && field->len > RHD_TEMPLATE_TEXT_MAX ? RHD_TEMPLATE_TEXT_MAX : field->len);
+    if ((n = file_read_at(template->file, &view, buf, field->pos, len)) == (size_t)-1)
+        return 1;
+    if (n < len) {
+        strcpy(dst, "-");
+        return 0;
+    }
+
+    switch (field->kind) {
+        case RHD_TEMPLATE_KIND_TEXT:
+            /* Quoted, with the non printable chars as '.' (except the '\0' that pad it) */
+            while (n > 0 && view[n - 1] == '\0')
+                n--;
+            dst[0] = '"';
+            for (i = 0; i < n; i++)
+                dst[i + 1] = isprint(view[i]) ? (char)view[i] : '.';
+            strcpy(&dst[n + 1], "\"");
+            break;
+        case RHD_TEMPLATE_KIND_HEX:
+            inspect_format_hex(dst, view, n, template->is_big_endian);
+            break;
+        case RHD_TEMPLATE_KIND_TIME:
+            inspect_format_time(dst, view, n, template->is_big_endian);
+            break;
+        case RHD_TEMPLATE_KIND_STRTAB:
+            /* The offset, followed by the name it points to (if inside the section names) */
+            inspect_format_int(dst, view, n, template->is_big_endian, 0);
+            if (template->strtab < 0 || (name = template_uint(view, n, template->is_big_endian)) < 0)
+                break;
+            if ((n = file_read_at(template->file, &view, buf, template->strtab + name, RHD_TEMPLATE_STRTAB_MAX)) == (size_t)-1)
+                return 1;
+            for (i = 0; i < n && view[i] != '\0' && isprint(view[i]); i++)
+                ;
+            if (i > 0)
+                sprintf(dst + strlen(dst), " (%.*s)", (int)i, (const char*)view);
+            break;
+        default:
+            inspect_format_int(dst, view, n, template->is_big_endian, 0);
+            break;
+    }
+
+    return 0;
+}
+
+
+void template_close(rhd_template_t* template) {
+    if (template == NULL)
+        return;
+    free(template->chunks);
+    free(template);
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static off_t template_uint(const unsigned char* bytes, const size_t n, const int is_big_endian) {
+    off_t  value;
+    size_t i;
+
+    /* (off_t is 64 bits wide, so only the values of 8 bytes with the highest bit set don't fit) */
+    value = 0;
+    for (i = 0; i < n; i++)
+        value = (value << 8) | bytes[is_big_endian ? i : n - 1 - i];
+
+    return value;
+}
+
+
+static void template_table_add(rhd_template_t* template, const char* group, const off_t pos, size_t n_entries,
+                               const off_t entry_len, const template_def_t* defs, const size_t n_defs) {
+    template_table_t* table;
+    off_t             length;
+
+    if (template->n_tables == RHD_TEMPLATE_TABLES_MAX || pos < 0 || n_entries == 0 || entry_len <= 0)
+        return;
+
+    /* (the length of streams is unknown, so all their entries are kept) */
+    if ((length = file_length(template->file)) >= 0) {
+        if (pos >= length)
+            return;
+        if ((off_t)n_entries > (length - pos + entry_len - 1) / entry_len)
+            n_entries = (size_t)((length - pos + entry_len - 1) / entry_len);
+    }
+
+    table            = &template->tables[template->n_tables++];
+    table->group     = group;
+    table->pos       = pos;
+    table->n_entries = n_entries;
+    table->entry_len = entry_len;
+    table->defs      = defs;
+    table->n_defs    = n_defs;
+}
+
+
+static int template_open_elf(rhd_template_t* template, const unsigned char* probe, const size_t n) {
+    static const char* const formats[2][2] = {
+        {"ELF32 little endian", "ELF32 big endian"}, {"ELF64 little endian", "ELF64 big endian"}
+    };
+    unsigned char            buf[8];
+    const unsigned char*     view;
+    const unsigned char*     h;
+    int                      is_64;
+    int                      is_be;
+    off_t                    phoff;
+    off_t                    shoff;
+    size_t                   phnum;
+    size_t                   shnum;
+    size_t                   shstrndx;
+    off_t                    phentsize;
+    off_t                    shentsize;
+    size_t                   len;
+    size_t                   n_read;
+
+    /* EI_CLASS (1 = 32 bits, 2 = 64 bits) and EI_DATA (1 = little endian, 2 = big endian) */
+    if ((probe[4] != 1 && probe[4] != 2) || (probe[5] != 1 && probe[5] != 2))
+        return 0;
+    is_64 = probe[4] == 2;
+    is_be = probe[5] == 2;
+    if (n < (size_t)(is_64 ? 64 : 52))
+        return 0;
+
+    /* Offsets of the fields of the file header that locate the tables (see elf32_header and elf64_header) */
+    h         = probe;
+    phoff     = is_64 ? template_uint(&h[32], 8, is_be) : template_uint(&h[28], 4, is_be);
+    shoff     = is_64 ? template_uint(&h[40], 8, is_be) : template_uint(&h[32], 4, is_be);
+    phentsize = template_uint(&h[is_64 ? 54 : 42], 2, is_be);
+    phnum     = (size_t)template_uint(&h[is_64 ? 56 : 44], 2, is_be);
+    shentsize = template_uint(&h[is_64 ? 58 : 46], 2, is_be);
+    shnum     = (size_t)template_uint(&h[is_64 ? 60 : 48], 2, is_be);
+    shstrndx  = (size_t)template_uint(&h[is_64 ? 62 : 50], 2, is_be);
+
+    template->format        = formats[is_64][is_be];
+    template->is_big_endian = is_be;
+    if (is_64) {
+        template_table_add(template, NULL, 0, 1, 64, elf64_header, RHD_TEMPLATE_DEFS(elf64_header));
+        if (phoff > 0 && phentsize >= 56)
+            template_table_add(template, "phdr", phoff, phnum, phentsize, elf64_phdr, RHD_TEMPLATE_DEFS(elf64_phdr));
+        if (shoff > 0 && shentsize >= 64)
+            template_table_add(template, "shdr", shoff, shnum, shentsize, elf64_shdr, RHD_TEMPLATE_DEFS(elf64_shdr));
+    } else {
+        template_table_add(template, NULL, 0, 1, 52, elf32_header, RHD_TEMPLATE_DEFS(elf32_header));
+        if (phoff > 0 && phentsize >= 32)
+            template_table_add(template, "phdr", phoff, phnum, phentsize, elf32_phdr, RHD_TEMPLATE_DEFS(elf32_phdr));
+        if (shoff > 0 && shentsize >= 40)
+            template_table_add(template, "shdr", shoff, shnum, shentsize, elf32_shdr, RHD_TEMPLATE_DEFS(elf32_shdr));
+    }
+
+    /* The section names are in the section "shstrndx" (its "sh_offset") */
+    if (shoff > 0 && shstrndx < shnum) {
+        len = (size_t)(is_64 ? 8 : 4);
+        if ((n_read = file_read_at(template->file, &view, buf, shoff + (off_t)shstrndx * shentsize + (is_64 ? 24 : 16), len)) == (size_t)-1)
+            return 1;
+        if (n_read == len)
+            template->strtab = template_uint(view, len, is_be);
+    }
+
+    return 0;
+}
+
+
+static int template_open_pe(rhd_template_t* template, const unsigned char* probe, const size_t n) {
+    unsigned char        buf[26];
+    const unsigned char* view;
+    off_t                nt;
+    off_t                optional_len;
+    size_t               n_sections;
+    off_t                magic;
+    size_t               n_read;
+
+    (void)n;
+
+    /* The signature and COFF header start at "e_lfanew", followed by the Magic of the optional header */
+    nt = template_uint(&probe[60], 4, 0);
+    if ((n_read = file_read_at(template->file, &view, buf, nt, sizeof(buf))) == (size_t)-1)
+        return 1;
+    if (n_read < sizeof(buf) || memcmp(view, "PE\0\0", 4) != 0)
+        return 0;
+    n_sections   = (size_t)template_uint(&view[6], 2, 0);
+    optional_len = template_uint(&view[20], 2, 0);
+    magic        = template_uint(&view[24], 2, 0);
+
+    template->format = magic == 0x20B ? "PE32+" : "PE32";
+    template_table_add(template, NULL, 0, 1, 64, pe_dos, RHD_TEMPLATE_DEFS(pe_dos));
+    template_table_add(template, NULL, nt, 1, 24, pe_coff, RHD_TEMPLATE_DEFS(pe_coff));
+    if (magic == 0x20B)
+        template_table_add(template, NULL, nt + 24, 1, optional_len, pe32plus_optional, RHD_TEMPLATE_DEFS(pe32plus_optional));
+    else
+        template_table_add(template, NULL, nt + 24, 1, optional_len, pe32_optional, RHD_TEMPLATE_DEFS(pe32_optional));
+    template_table_add(template, "section", nt + 24 + optional_len, n_sections, 40, pe_section, RHD_TEMPLATE_DEFS(pe_section));
+
+    return 0;
+}
+
+
+static int template_insert(template_field_t* fields, size_t* n, const size_t max, const template_field_t* field) {
+    size_t i;
+
+    /* Find where it goes (after the fields at the same position), then shift the following ones */
+    for (i = *n; i > 0 && fields[i - 1].pos > field->pos; i--)
+        ;
+    if (i == max)
+        return 1;
+    if (*n == max)
+        (*n)--;
+    memmove(&fields[i + 1], &fields[i], (*n - i) * sizeof(*fields));
+    fields[i] = *field;
+    (*n)++;
+
+    return 0;
+}
+
+
+static void template_table_fields(const template_table_t* table, const size_t first_index, const off_t from, const off_t to,
+                                  template_field_t* fields, size_t* n, const size_t max) {
+    template_field_t field;
+    off_t            entry_pos;
+    size_t           entry;
+    size_t           i;
+
+    /* Only the entries that overlap [from, to) are looked at */
+    entry = from > table->pos ? (size_t)((from - table->pos) / table->entry_len) : 0;
+    for (; entry < table->n_entries; entry++) {
+        if ((entry_pos = table->pos + (off_t)entry * table->entry_len) >= to)
+            return;
+
+        for (i = 0; i < table->n_defs; i++) {
+            /* (the fields that don't fit in the entry are not there, like in a short PE optional header) */
+            if (table->defs[i].offset + table->defs[i].len > table->entry_len)
+                continue;
+            field.pos   = entry_pos + table->defs[i].offset;
+            field.len   = table->defs[i].len;
+            field.group = table->group;
+            field.index = first_index + entry;
+            field.name  = table->defs[i].name;
+            field.kind  = table->defs[i].kind;
+            if (field.pos + field.len <= from || field.pos >= to)
+                continue;
+
+            /* Once the fields are full, the following ones (further in the file) are dropped too */
+            if (template_insert(fields, n, max, &field) != 0)
+                return;
+        }
+    }
+}
+
+
+static int template_chunk_fields(rhd_template_t* template, const off_t from, const off_t to,
+                                 template_field_t* fields, size_t* n, const size_t max) {
+    unsigned char        buf[8];
+    const unsigned char* view;
+    template_field_t     field;
+    template_table_t     ihdr;
+    off_t*               new_chunks;
+    off_t                length;
+    off_t                file_len;
+    size_t               lo;
+    size_t               hi;
+    size_t               i;
+
+    /* Walk the chunks up to "to" (each one is: length, type, data and CRC) */
+    file_len = file_length(template->file);
+    while (template->chunks_end >= 0 && template->chunks_end < to) {
+        if ((i = file_read_at(template->file, &view, buf, template->chunks_end, 8)) == (size_t)-1)
+            return 1;
+        if (i < 8 || (length = template_uint(view, 4, 1)) > 0x7FFFFFFF) {
+            template->chunks_end = -1;
+            break;
+        }
+        if (template->n_chunks == template->cap_chunks) {
+            template->cap_chunks = template->cap_chunks == 0 ? RHD_TEMPLATE_CHUNKS_INIT : template->cap_chunks * 2;
+            if ((new_chunks = (off_t*)realloc(template->chunks, template->cap_chunks * sizeof(*new_chunks))) == NULL)
+                return 1;
+            template->chunks = new_chunks;
+        }
+        template->chunks[template->n_chunks++] = template->chunks_end;
+        template->chunks_end += 12 + length;
+        if (file_len >= 0 && template->chunks_end >= file_len)
+            template->chunks_end = -1;
+    }
+
+    /* Find the last chunk that starts at or before "from" (binary search) */
+    lo = 0;
+    hi = template->n_chunks;
+    while (hi - lo > 1) {
+        i = lo + (hi - lo) / 2;
+        if (template->chunks[i] <= from)
+            lo = i;
+        else
+            hi = i;
+    }
+
+    for (i = lo; i < template->n_chunks && template->chunks[i] < to; i++) {
+        if (file_read_at(template->file, &view, buf, template->chunks[i], 8) != 8)
+            return 1;
+        length = template_uint(view, 4, 1);
+
+        field.group = "chunk";
+        field.index = i;
+        field.pos   = template->chunks[i];
+        field.len   = 4;
+        field.name  = "length";
+        field.kind  = RHD_TEMPLATE_KIND_DEC;
+        if (field.pos + field.len > from && template_insert(fields, n, max, &field) != 0)
+            return 0;
+        field.pos  += 4;
+        field.name  = "type";
+        field.kind  = RHD_TEMPLATE_KIND_TEXT;
+        if (field.pos + field.len > from && field.pos < to && template_insert(fields, n, max, &field) != 0)
+            return 0;
+
+        /* The data of IHDR is decoded (like a table with a single entry), the others are not */
+        if (memcmp(&view[4], "IHDR", 4) == 0 && length >= 13) {
+            ihdr.group     = "chunk";
+            ihdr.pos       = template->chunks[i];
+            ihdr.n_entries = 1;
+            ihdr.entry_len = 8 + length;
+            ihdr.defs      = png_ihdr;
+            ihdr.n_defs    = RHD_TEMPLATE_DEFS(png_ihdr);
+            template_table_fields(&ihdr, i, from, to, fields, n, max);
+        } else if (length > 0) {
+            field.pos  = template->chunks[i] + 8;
+            field.len  = length;
+            field.name = "data";
+            field.kind = RHD_TEMPLATE_KIND_BLOB;
+            if (field.pos + field.len > from && field.pos < to && template_insert(fields, n, max, &field) != 0)
+                return 0;
+        }
+
+        field.pos  = template->chunks[i] + 8 + length;
+        field.len  = 4;
+        field.name = "crc";
+        field.kind = RHD_TEMPLATE_KIND_HEX;
+        if (field.pos + field.len > from && field.pos < to && template_insert(fields, n, max, &field) != 0)
+            return 0;
+    }
+
+    return 0;
+}
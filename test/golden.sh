@@ -0,0 +1,82 @@
+#!/bin/sh
+#
+# MIT License
+#
+# Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Compares the dumps of the files of test/data with the golden files of test/golden (in the
+# layout of "hexdump -C"), reading them memory-mapped, through the page cache, and from a pipe.
+# Usage: test/golden.sh <rawhexdump> (from the root of the repository)
+
+BIN=${1:-build/rawhexdump}
+DATA=test/data
+GOLDEN=test/golden
+
+OUT=${TMPDIR:-/tmp}/rhd-golden.$$
+trap 'rm -f "$OUT"' EXIT
+
+n_failures=0
+
+# check <name> <golden file> <command...> (the command must succeed, writing the golden file on stdout)
+check() {
+    name=$1
+    expected=$GOLDEN/$2
+    shift 2
+    if "$@" >"$OUT" 2>/dev/null && cmp -s "$OUT" "$expected"; then
+        echo "ok    $name"
+    else
+        echo "FAIL  $name"
+        n_failures=$((n_failures + 1))
+    fi
+}
+
+# Plain dumps
+check dump-mixed           dump-mixed.txt           "$BIN" -d "$DATA/mixed.bin"
+check dump-short           dump-short.txt           "$BIN" -d "$DATA/short.bin"
+check dump-empty           dump-empty.txt           "$BIN" -d "$DATA/empty.bin"
+
+# Offset and length
+check dump-mixed-s-n       dump-mixed-s100-n300.txt "$BIN" -d -s 100 -n 300 "$DATA/mixed.bin"
+check dump-mixed-s         dump-mixed-s53.txt       "$BIN" -d -s 0x35 "$DATA/mixed.bin"
+
+# Offset at and past the end (only the offset of the end of the file is shown)
+check dump-short-s-eof     dump-short-s-end.txt     "$BIN" -d -s 13 "$DATA/short.bin"
+check dump-short-s-past    dump-short-s-end.txt     "$BIN" -d -s 100 "$DATA/short.bin"
+
+# From a pipe
+check dump-pipe            dump-mixed.txt           sh -c "cat '$DATA/mixed.bin' | '$BIN' -d -"
+check dump-pipe-s-n        dump-mixed-s100-n300.txt sh -c "cat '$DATA/mixed.bin' | '$BIN' -d -s 100 -n 300 -"
+check dump-pipe-s-past     dump-short-s-end.txt     sh -c "cat '$DATA/short.bin' | '$BIN' -d -s 100 -"
+
+# Through the page cache
+check dump-no-mmap         dump-mixed.txt           "$BIN" -d --no-mmap "$DATA/mixed.bin"
+check dump-no-mmap-s-n     dump-mixed-s100-n300.txt "$BIN" -d --no-mmap -s 100 -n 300 "$DATA/mixed.bin"
+check dump-no-mmap-s-past  dump-short-s-end.txt     "$BIN" -d --no-mmap -s 100 "$DATA/short.bin"
+
+# Ranges
+check dump-ranges          dump-mixed-ranges.txt    "$BIN" -d --ranges "$DATA/ranges.txt" "$DATA/mixed.bin"
+check dump-no-mmap-ranges  dump-mixed-ranges.txt    "$BIN" -d --no-mmap --ranges "$DATA/ranges.txt" "$DATA/mixed.bin"
+
+if [ "$n_failures" -ne 0 ]; then
+    echo "ERROR: $n_failures dumps differ from the golden files!" >&2
+    exit 1
+fi
+exit 0
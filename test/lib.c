@@ -0,0 +1,268 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file lib.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for pthreads) */
+
+/* C89 standard */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "rawhexdump.h"
+
+
+/* Directories of the dumped files, and of the expected dumps (relative to the root of the repository) */
+#define RHD_LIB_DATA_DIR   "test/data/"
+#define RHD_LIB_GOLDEN_DIR "test/golden/"
+
+/* Max length of the dumped files, and of the expected dumps */
+#define RHD_LIB_FILE_MAX 8192
+
+/* Amount of threads dumping at the same time (all with the same handles), and of times each one
+   dumps every case */
+#define RHD_LIB_THREADS 8
+#define RHD_LIB_ROUNDS  50
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Struct describing a case: a dump, and the dump it must be equal to
+ */
+typedef struct lib_case_tag {
+    const char* name;
+    const char* filename;  /* File dumped (in RHD_LIB_DATA_DIR) */
+    off_t       offset;
+    off_t       length;
+    const char* golden;    /* Expected dump (in RHD_LIB_GOLDEN_DIR, or NULL for the one of rhd_format()) */
+} lib_case_t;
+
+/**
+ * Struct containing what a case needs, loaded before the threads start
+ */
+typedef struct lib_data_tag {
+    rhd_dump_t*   dump;
+    unsigned char bytes[RHD_LIB_FILE_MAX];   /* Whole file */
+    size_t        n_bytes;
+    char          expected[RHD_LIB_FILE_MAX];
+    size_t        expected_len;
+    size_t        n_failures;   /* Set once the threads are done */
+} lib_data_t;
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * The cases (the gzip file must be dumped as it is, even if the library is built with zlib)
+ */
+static const lib_case_t lib_cases[] = {
+    { "mixed",        "mixed.bin",    0,    -1,  "dump-mixed.txt"           },
+    { "short",        "short.bin",    0,    -1,  "dump-short.txt"           },
+    { "empty",        "empty.bin",    0,    -1,  "dump-empty.txt"           },
+    { "mixed-s-n",    "mixed.bin",    100,  300, "dump-mixed-s100-n300.txt" },
+    { "mixed-s",      "mixed.bin",    0x35, -1,  "dump-mixed-s53.txt"       },
+    { "short-s-eof",  "short.bin",    13,   -1,  "dump-short-s-end.txt"     },
+    { "short-s-past", "short.bin",    100,  -1,  "dump-short-s-end.txt"     },
+    { "gzip",         "mixed.bin.gz", 0,    -1,  NULL                       }
+};
+
+/**
+ * What the cases need (indexed like lib_cases)
+ */
+static lib_data_t lib_data[sizeof(lib_cases) / sizeof(lib_cases[0])];
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Reads the whole file "path" into "buf" (of RHD_LIB_FILE_MAX chars), setting "n" to its length.
+ * If successful returns 0, else 1.
+ */
+static int lib_read(const char* path, void* buf, size_t* n);
+
+/**
+ * Returns the amount of bytes of the file of "c" that it dumps, setting "start" to the first one
+ * (an offset past the end of the file is the end, like for "hexdump -s")
+ */
+static size_t lib_range(const lib_case_t* c, const lib_data_t* data, off_t* start);
+
+/**
+ * Opens the handle of the file of "c", and loads its bytes and the dump expected into "data".
+ * If successful returns 0, else 1.
+ */
+static int lib_load(const lib_case_t* c, lib_data_t* data);
+
+/**
+ * Thread that dumps every case RHD_LIB_ROUNDS times, with rhd_dump_format() and rhd_format(),
+ * counting the dumps that differ from the expected ones into the array of counts "arg"
+ */
+static void* lib_thread(void* arg);
+
+
+/* --------------------------------- MAIN ---------------------------------- */
+
+int main(int argc, char* argv[]) {
+    static size_t n_failures[RHD_LIB_THREADS][sizeof(lib_cases) / sizeof(lib_cases[0])];
+    pthread_t     threads[RHD_LIB_THREADS];
+    size_t        n_cases;
+    size_t        n_failed;
+    size_t        i;
+    size_t        k;
+
+    (void)argc;
+
+    /* Load every case, then dump them all from every thread at the same time */
+    n_cases = sizeof(lib_cases) / sizeof(lib_cases[0]);
+    for (i = 0; i < n_cases; i++) {
+        if (lib_load(&lib_cases[i], &lib_data[i]) != 0) {
+            fprintf(stderr, "ERROR: Could not load the case \"%s\"!\n", lib_cases[i].name);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (k = 0; k < RHD_LIB_THREADS; k++) {
+        if (pthread_create(&threads[k], NULL, lib_thread, n_failures[k]) != 0) {
+            fprintf(stderr, "ERROR: Could not create a thread!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (k = 0; k < RHD_LIB_THREADS; k++)
+        pthread_join(threads[k], NULL);
+
+    n_failed = 0;
+    for (i = 0; i < n_cases; i++) {
+        for (k = 0; k < RHD_LIB_THREADS; k++)
+            lib_data[i].n_failures += n_failures[k][i];
+        if (lib_data[i].n_failures > 0) {
+            fprintf(stdout, "FAIL  lib-%s (%s, %lu dumps differ)\n", lib_cases[i].name, argv[0], (unsigned long)lib_data[i].n_failures);
+            n_failed++;
+        } else {
+            fprintf(stdout, "ok    lib-%s (%s)\n", lib_cases[i].name, argv[0]);
+        }
+        if (rhd_dump_close(lib_data[i].dump) != 0)
+            n_failed++;
+    }
+
+    if (n_failed > 0) {
+        fprintf(stderr, "ERROR: %lu cases failed!\n", (unsigned long)n_failed);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static int lib_read(const char* path, void* buf, size_t* n) {
+    FILE* f;
+    int   ret;
+
+    if ((f = fopen(path, "rb")) == NULL)
+        return 1;
+    *n  = fread(buf, 1, RHD_LIB_FILE_MAX, f);
+    ret = ferror(f) || fgetc(f) != EOF;
+    fclose(f);
+
+    return ret;
+}
+
+
+static size_t lib_range(const lib_case_t* c, const lib_data_t* data, off_t* start) {
+    *start = c->offset < (off_t)data->n_bytes ? c->offset : (off_t)data->n_bytes;
+    if (c->length >= 0 && c->length < (off_t)data->n_bytes - *start)
+        return (size_t)c->length;
+    return data->n_bytes - (size_t)*start;
+}
+
+
+static int lib_load(const lib_case_t* c, lib_data_t* data) {
+    char   path[256];
+    off_t  start;
+    size_t n;
+
+    sprintf(path, RHD_LIB_DATA_DIR "%.200s", c->filename);
+    if (lib_read(path, data->bytes, &data->n_bytes) != 0 || rhd_dump_open(&data->dump, path) != 0)
+        return 1;
+    if (rhd_dump_length(data->dump) != (off_t)data->n_bytes)
+        return 1;
+
+    /* Without a golden file, the dump of the bytes of the file is expected */
+    if (c->golden != NULL) {
+        sprintf(path, RHD_LIB_GOLDEN_DIR "%.200s", c->golden);
+        return lib_read(path, data->expected, &data->expected_len);
+    }
+    n = lib_range(c, data, &start);
+    if (rhd_dump_bound(n) > sizeof(data->expected))
+        return 1;
+    return rhd_format(&data->bytes[start], n, start, data->expected, sizeof(data->expected), &data->expected_len) != 0;
+}
+
+
+static void* lib_thread(void* arg) {
+    size_t*            n_failures;
+    char*              out;
+    const lib_case_t*  c;
+    const lib_data_t*  data;
+    off_t              start;
+    size_t             out_len;
+    size_t             n_chars;
+    size_t             n;
+    size_t             round;
+    size_t             i;
+
+    n_failures = (size_t*)arg;
+    out_len    = rhd_dump_bound(RHD_LIB_FILE_MAX);
+    if ((out = malloc(out_len)) == NULL) {
+        for (i = 0; i < sizeof(lib_cases) / sizeof(lib_cases[0]); i++)
+            n_failures[i]++;
+        return NULL;
+    }
+
+    for (round = 0; round < RHD_LIB_ROUNDS; round++) {
+        for (i = 0; i < sizeof(lib_cases) / sizeof(lib_cases[0]); i++) {
+            c    = &lib_cases[i];
+            data = &lib_data[i];
+
+            /* From the file of the handle */
+            if (rhd_dump_format(data->dump, c->offset, c->length, out, out_len, &n_chars) != 0 ||
+                n_chars != data->expected_len || memcmp(out, data->expected, n_chars) != 0)
+                n_failures[i]++;
+
+            /* From its bytes in memory */
+            n = lib_range(c, data, &start);
+            if (rhd_format(&data->bytes[start], n, start, out, out_len, &n_chars) != 0 ||
+                n_chars != data->expected_len || memcmp(out, data->expected, n_chars) != 0)
+                n_failures[i]++;
+        }
+    }
+
+    free(out);
+    return NULL;
+}
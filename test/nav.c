@@ -0,0 +1,518 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025-2026 Lorenzo Pegorari (@LorenzoPegorari)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/** @file nav.c */
+
+
+#define _XOPEN_SOURCE 700  /* Incorporating POSIX 2017 (for mkstemp, pread and waitpid) */
+
+/* C89 standard */
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX standard */
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "errors.h"
+#include "file.h"
+#include "raw_terminal.h"
+
+
+#define RHD_NAV_USAGE "Usage: %s [-u | --update] [<scenario>...]\n"
+
+/* Directories of the navigated files, and of the expected screens (relative to the root of the repository) */
+#define RHD_NAV_DATA_DIR   "test/data/"
+#define RHD_NAV_GOLDEN_DIR "test/golden/"
+
+/* Max size of the emulated terminal */
+#define RHD_NAV_ROWS_MAX 100
+#define RHD_NAV_COLS_MAX 300
+
+/* Length of the stream navigated by the scenarios on RHD_FILE_STDIN, and its window */
+#define RHD_NAV_STREAM_LEN    3000000
+#define RHD_NAV_STREAM_WINDOW 65536
+
+/* Max amount of frames written by a scenario */
+#define RHD_NAV_FRAMES_MAX ((size_t)1 << 24)
+
+/* Resize sequence of the headless mode (see term_headless()) */
+#define RHD_NAV_RESIZE_SEQ "\x1b[8;"
+
+
+/* ------------------------------- TYPEDEFS -------------------------------- */
+
+/**
+ * Struct describing a scenario: the keys pressed in a session, and what it must show at the end
+ */
+typedef struct nav_scenario_tag {
+    const char*  name;      /* (the expected screen is RHD_NAV_GOLDEN_DIR "nav-<name>.txt") */
+    const char*  filename;  /* File navigated (a stream of RHD_NAV_STREAM_LEN bytes if RHD_FILE_STDIN) */
+    unsigned int rows;      /* Initial size of the window */
+    unsigned int cols;
+    const char*  keys;      /* Keys pressed (followed by CTRL+Q) */
+    const char*  expected;  /* Text that the last screen must contain (if not NULL, instead of the golden file) */
+} nav_scenario_t;
+
+/**
+ * Struct containing the emulated terminal (the subset of VT100 used by the frames)
+ */
+typedef struct nav_screen_tag {
+    char         cells[RHD_NAV_ROWS_MAX][RHD_NAV_COLS_MAX];
+    char         last[RHD_NAV_ROWS_MAX][RHD_NAV_COLS_MAX];  /* Cells right before the last clear */
+    int          is_cleared;
+    unsigned int y;       /* Cursor */
+    unsigned int x;
+    unsigned int top;     /* Scroll region */
+    unsigned int bottom;
+} nav_screen_t;
+
+
+/* --------------------------- STATIC VARIABLES ---------------------------- */
+
+/**
+ * Scenarios (each one is a session of the viewer, in a child process)
+ */
+static const nav_scenario_t nav_scenarios[] = {
+    { "scroll",    RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "sssssw", NULL },
+    { "end",       RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "\x1b[Fsssw", NULL },
+    { "home",      RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "\x1b[F\x1b[H", NULL },
+    { "goto",      RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "g0x200\r", NULL },
+    { "resize",    RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "ss\x1b[8;20;100ts\x1b[8;9;43tw", NULL },
+    { "narrow",    RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "\x1b[8;16;30tssss", NULL },
+    { "formchar",  RHD_NAV_DATA_DIR "mixed.bin", 12, 120, "cs", NULL },
+    { "char",      RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "\x03s", NULL },
+    { "gutter",    RHD_NAV_DATA_DIR "mixed.bin", 12, 80,  "os", NULL },
+    { "short",     RHD_NAV_DATA_DIR "short.bin", 6,  80,  "ssw", NULL },
+    { "inspector", RHD_NAV_DATA_DIR "tiny.png",  24, 100, "i\x1b[B\x1b[B\x1b[C", NULL },
+    { "stream-inspector", RHD_FILE_STDIN, 12, 120, "i", "No template: the start of the stream is past its window!" }
+};
+
+/**
+ * Struct containing the options of the test
+ */
+static struct nav_tag {
+    int    is_updating;  /* Writes the golden files, instead of comparing the screens with them */
+    size_t n_failures;
+} nav;
+
+
+/* --------------------------- STATIC PROTOTYPES --------------------------- */
+
+/**
+ * Runs the session of the scenario "s" in the child process (never returns)
+ */
+static void nav_session(const nav_scenario_t* s, const int keys_fd, const int frames_fd, const int data_fd);
+
+/**
+ * Writes the stream of RHD_NAV_STREAM_LEN bytes into "fd" (from a xorshift generator).
+ * If successful returns 0, else 1.
+ */
+static int nav_stream(const int fd);
+
+/**
+ * Runs the scenario "s", writing the screen shown at the end into "text" (that must have room
+ * for RHD_NAV_ROWS_MAX * (RHD_NAV_COLS_MAX + 1) + 1 chars, a line for each row of the window).
+ * If successful returns 0, else 1.
+ */
+static int nav_run(const nav_scenario_t* s, char* text);
+
+/**
+ * Applies the "len" bytes of "frames" to the emulated terminal "screen"
+ */
+static void nav_emulate(nav_screen_t* screen, const unsigned char* frames, const size_t len);
+
+/**
+ * Scrolls by "n" rows (up if "is_up", else down) the scroll region of "screen"
+ */
+static void nav_scroll(nav_screen_t* screen, const unsigned int n, const int is_up);
+
+/**
+ * Checks the screen of the scenario "s" (comparing it with its golden file, or writing it).
+ * If successful returns 0, else 1.
+ */
+static int nav_check(const nav_scenario_t* s, const char* text);
+
+
+/* --------------------------------- MAIN ---------------------------------- */
+
+int main(int argc, char* argv[]) {
+    static char text[RHD_NAV_ROWS_MAX * (RHD_NAV_COLS_MAX + 1) + 1];
+    size_t      n_run;
+    size_t      i;
+    int         is_selected;
+    int         j;
+
+    /* Handle arguments (the scenarios run are the ones named, or all of them) */
+    nav.is_updating = 0;
+    nav.n_failures  = 0;
+    is_selected     = 0;
+    for (j = 1; j < argc; j++) {
+        if (strcmp(argv[j], "-h") == 0 || strcmp(argv[j], "--help") == 0) {
+            fprintf(stdout, RHD_NAV_USAGE, argv[0]);
+            fprintf(stdout, "\nRuns the navigation scenarios without a terminal, comparing the screens with the golden files.\n");
+            fprintf(stdout, "It must be run from the root of the repository.\n");
+            fprintf(stdout, "\nOptions:\n");
+            fprintf(stdout, "    -u | --update = write the golden files, instead of comparing the screens with them\n");
+            exit(EXIT_SUCCESS);
+        } else if (strcmp(argv[j], "-u") == 0 || strcmp(argv[j], "--update") == 0) {
+            nav.is_updating = 1;
+        } else {
+            is_selected = 1;
+        }
+    }
+
+    /* A session that exits early must not kill the test while its keys are written */
+    signal(SIGPIPE, SIG_IGN);
+
+    n_run = 0;
+    for (i = 0; i < sizeof(nav_scenarios) / sizeof(nav_scenarios[0]); i++) {
+        if (is_selected) {
+            for (j = 1; j < argc; j++) {
+                if (strcmp(argv[j], nav_scenarios[i].name) == 0)
+                    break;
+            }
+            if (j == argc)
+                continue;
+        }
+        n_run++;
+        if (nav_run(&nav_scenarios[i], text) != 0 || nav_check(&nav_scenarios[i], text) != 0) {
+            fprintf(stdout, "FAIL  nav-%s\n", nav_scenarios[i].name);
+            nav.n_failures++;
+        } else {
+            fprintf(stdout, "ok    nav-%s\n", nav_scenarios[i].name);
+        }
+    }
+
+    if (n_run == 0) {
+        fprintf(stderr, "ERROR: No scenario with the given names!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (nav.n_failures > 0) {
+        fprintf(stderr, "ERROR: %lu scenarios failed!\n", (unsigned long)nav.n_failures);
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
+/* --------------------------- STATIC FUNCTIONS ---------------------------- */
+
+static void nav_session(const nav_scenario_t* s, const int keys_fd, const int frames_fd, const int data_fd) {
+    const char* filenames[1];
+
+    /* The stream is read from the standard input */
+    if (data_fd != -1) {
+        if (dup2(data_fd, STDIN_FILENO) == -1)
+            _exit(EXIT_FAILURE);
+        close(data_fd);
+        file_stream_window(RHD_NAV_STREAM_WINDOW);
+    }
+
+    filenames[0] = s->filename;
+    term_headless(keys_fd, frames_fd, s->rows, s->cols);
+    if (term_init(filenames, 1) != 0 || term_loop() != 0 || term_disable_raw_mode() != 0) {
+        error_flush();
+        _exit(EXIT_FAILURE);
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+
+static int nav_stream(const int fd) {
+    unsigned char block[4096];
+    unsigned long state;
+    size_t        len;
+    size_t        n;
+    size_t        i;
+    ssize_t       n_written;
+
+    state = 2463534242UL;
+    for (len = 0; len < RHD_NAV_STREAM_LEN; len += n) {
+        n = RHD_NAV_STREAM_LEN - len < sizeof(block) ? RHD_NAV_STREAM_LEN - len : sizeof(block);
+        for (i = 0; i < n; i++) {
+            state ^= (state << 13) & 0xFFFFFFFFUL;
+            state ^= state >> 17;
+            state ^= (state << 5) & 0xFFFFFFFFUL;
+            block[i] = (unsigned char)state;
+        }
+        for (i = 0; i < n; i += (size_t)n_written) {
+            if ((n_written = write(fd, block + i, n - i)) == -1) {
+                if (errno == EINTR) {
+                    n_written = 0;
+                    continue;
+                }
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+static int nav_run(const nav_scenario_t* s, char* text) {
+    static nav_screen_t screen;
+    unsigned char*      frames;
+    const char*         resize;
+    char                path[4096];
+    unsigned int        rows;
+    unsigned int        cols;
+    unsigned int        y;
+    unsigned int        x;
+    size_t              len;
+    ssize_t             n_read;
+    pid_t               pid;
+    int                 keys_fds[2];
+    int                 data_fds[2];
+    int                 frames_fd;
+    int                 status;
+    int                 ret;
+
+    /* The frames are written into a temporary file, and read back once the session ends */
+    sprintf(path, "%.4000s/rhd-nav-XXXXXX", getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp");
+    if ((frames_fd = mkstemp(path)) == -1) {
+        fprintf(stderr, "ERROR: Could not create the file of the frames!\n");
+        return 1;
+    }
+    unlink(path);
+
+    data_fds[0] = -1;
+    data_fds[1] = -1;
+    if (pipe(keys_fds) == -1 || (strcmp(s->filename, RHD_FILE_STDIN) == 0 && pipe(data_fds) == -1) ||
+        (pid = fork()) == -1) {
+        fprintf(stderr, "ERROR: Could not start the session!\n");
+        close(frames_fd);
+        return 1;
+    }
+    if (pid == 0) {
+        close(keys_fds[1]);
+        if (data_fds[1] != -1)
+            close(data_fds[1]);
+        nav_session(s, keys_fds[0], frames_fd, data_fds[0]);
+    }
+    close(keys_fds[0]);
+
+    /* The whole stream is sent before the keys */
+    ret = 0;
+    if (data_fds[1] != -1) {
+        close(data_fds[0]);
+        ret |= nav_stream(data_fds[1]);
+        close(data_fds[1]);
+    }
+    ret |= write(keys_fds[1], s->keys, strlen(s->keys)) != (ssize_t)strlen(s->keys);
+    ret |= write(keys_fds[1], "\x11", 1) != 1;
+    close(keys_fds[1]);
+
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            close(frames_fd);
+            return 1;
+        }
+    }
+    if (ret != 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+        fprintf(stderr, "ERROR: The session of \"%s\" failed!\n", s->name);
+        close(frames_fd);
+        return 1;
+    }
+
+    /* Replay the frames on the emulated terminal */
+    if ((frames = malloc(RHD_NAV_FRAMES_MAX)) == NULL) {
+        close(frames_fd);
+        return 1;
+    }
+    for (len = 0; len < RHD_NAV_FRAMES_MAX; len += (size_t)n_read) {
+        if ((n_read = pread(frames_fd, frames + len, RHD_NAV_FRAMES_MAX - len, (off_t)len)) <= 0)
+            break;
+    }
+    close(frames_fd);
+    memset(&screen, 0, sizeof(screen));
+    memset(screen.cells, ' ', sizeof(screen.cells));
+    screen.bottom = RHD_NAV_ROWS_MAX - 1;
+    nav_emulate(&screen, frames, len);
+    free(frames);
+
+    /* The window has the size given by the last resize sequence of the keys (if any) */
+    rows = s->rows;
+    cols = s->cols;
+    for (resize = strstr(s->keys, RHD_NAV_RESIZE_SEQ); resize != NULL; resize = strstr(resize + 1, RHD_NAV_RESIZE_SEQ)) {
+        if (sscanf(resize + sizeof(RHD_NAV_RESIZE_SEQ) - 1, "%u;%u", &rows, &cols) != 2)
+            return 1;
+    }
+    if (rows > RHD_NAV_ROWS_MAX || cols > RHD_NAV_COLS_MAX)
+        return 1;
+
+    /* The quit clears the screen: the last screen is the one right before it */
+    len = 0;
+    for (y = 0; y < rows; y++) {
+        for (x = 0; x < cols; x++)
+            text[len + x] = screen.is_cleared ? screen.last[y][x] : screen.cells[y][x];
+        while (x > 0 && text[len + x - 1] == ' ')
+            x--;
+        len += x;
+        text[len++] = '\n';
+    }
+    text[len] = '\0';
+
+    return 0;
+}
+
+
+static void nav_emulate(nav_screen_t* screen, const unsigned char* frames, const size_t len) {
+    unsigned int params[2];
+    size_t       n_params;
+    size_t       i;
+
+    for (i = 0; i < len; i++) {
+        switch (frames[i]) {
+            case '\x1b':
+                if (i + 1 >= len || frames[i + 1] != '[')
+                    break;
+                i += 2;
+                if (i < len && frames[i] == '?')
+                    i++;
+                params[0] = 0;
+                params[1] = 0;
+                for (n_params = 0; i < len && ((frames[i] >= '0' && frames[i] <= '9') || frames[i] == ';'); i++) {
+                    if (frames[i] == ';') {
+                        n_params++;
+                    } else if (n_params < 2 && params[n_params] < 10000) {
+                        params[n_params] = params[n_params] * 10 + (unsigned int)(frames[i] - '0');
+                    }
+                }
+                if (i >= len)
+                    return;
+                switch (frames[i]) {
+                    case 'H':
+                        screen->y = params[0] > 0 ? params[0] - 1 : 0;
+                        screen->x = params[1] > 0 ? params[1] - 1 : 0;
+                        if (screen->y >= RHD_NAV_ROWS_MAX)
+                            screen->y = RHD_NAV_ROWS_MAX - 1;
+                        break;
+                    case 'K':
+                        if (screen->x < RHD_NAV_COLS_MAX)
+                            memset(&screen->cells[screen->y][screen->x], ' ', RHD_NAV_COLS_MAX - screen->x);
+                        break;
+                    case 'J':
+                        memcpy(screen->last, screen->cells, sizeof(screen->cells));
+                        memset(screen->cells, ' ', sizeof(screen->cells));
+                        screen->is_cleared = 1;
+                        break;
+                    case 'S':
+                    case 'T':
+                        nav_scroll(screen, params[0] > 0 ? params[0] : 1, frames[i] == 'S');
+                        break;
+                    case 'r':
+                        screen->top    = params[0] > 0 ? params[0] - 1 : 0;
+                        screen->bottom = params[1] > 0 ? params[1] - 1 : RHD_NAV_ROWS_MAX - 1;
+                        if (screen->bottom >= RHD_NAV_ROWS_MAX || screen->top > screen->bottom) {
+                            screen->top    = 0;
+                            screen->bottom = RHD_NAV_ROWS_MAX - 1;
+                        }
+                        screen->y = 0;
+                        screen->x = 0;
+                        break;
+                    default:
+                        /* (attributes, and showing or hiding the cursor) */
+                        break;
+                }
+                break;
+            case '\r':
+                screen->x = 0;
+                break;
+            case '\n':
+                if (screen->y == screen->bottom)
+                    nav_scroll(screen, 1, 1);
+                else if (screen->y < RHD_NAV_ROWS_MAX - 1)
+                    screen->y++;
+                break;
+            default:
+                if (screen->x < RHD_NAV_COLS_MAX)
+                    screen->cells[screen->y][screen->x] = (char)frames[i];
+                screen->x++;
+                break;
+        }
+    }
+}
+
+
+static void nav_scroll(nav_screen_t* screen, const unsigned int n, const int is_up) {
+    unsigned int height;
+    unsigned int shift;
+
+    height = screen->bottom - screen->top + 1;
+    shift  = n < height ? n : height;
+    if (is_up) {
+        memmove(screen->cells[screen->top], screen->cells[screen->top + shift], (size_t)(height - shift) * RHD_NAV_COLS_MAX);
+        memset(screen->cells[screen->bottom + 1 - shift], ' ', (size_t)shift * RHD_NAV_COLS_MAX);
+    } else {
+        memmove(screen->cells[screen->top + shift], screen->cells[screen->top], (size_t)(height - shift) * RHD_NAV_COLS_MAX);
+        memset(screen->cells[screen->top], ' ', (size_t)shift * RHD_NAV_COLS_MAX);
+    }
+}
+
+
+static int nav_check(const nav_scenario_t* s, const char* text) {
+    static char golden[RHD_NAV_ROWS_MAX * (RHD_NAV_COLS_MAX + 1) + 2];
+    char        path[4096];
+    size_t      len;
+    FILE*       f;
+
+    if (s->expected != NULL) {
+        if (strstr(text, s->expected) != NULL)
+            return 0;
+        fprintf(stderr, "ERROR: The screen of \"%s\" doesn't contain \"%s\"!\n%s", s->name, s->expected, text);
+        return 1;
+    }
+
+    sprintf(path, RHD_NAV_GOLDEN_DIR "nav-%.64s.txt", s->name);
+    if (nav.is_updating) {
+        if ((f = fopen(path, "wb")) == NULL || fwrite(text, 1, strlen(text), f) != strlen(text)) {
+            fprintf(stderr, "ERROR: Could not write \"%s\"!\n", path);
+            if (f != NULL)
+                fclose(f);
+            return 1;
+        }
+        return fclose(f) != 0;
+    }
+
+    if ((f = fopen(path, "rb")) == NULL) {
+        fprintf(stderr, "ERROR: Could not read \"%s\"!\n", path);
+        return 1;
+    }
+    len = fread(golden, 1, sizeof(golden) - 1, f);
+    fclose(f);
+    golden[len] = '\0';
+    if (strcmp(golden, text) != 0) {
+        fprintf(stderr, "ERROR: The screen of \"%s\" differs from \"%s\":\n%s", s->name, path, text);
+        return 1;
+    }
+
+    return 0;
+}